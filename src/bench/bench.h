@@ -0,0 +1,45 @@
+//
+// RT64 BENCH
+//
+
+#pragma once
+
+#include <chrono>
+
+namespace Bench {
+	typedef void (*Function)();
+
+	// Adds a benchmark to the list run by main. Use the BENCHMARK macro instead of creating these directly.
+	struct Registration {
+		Registration(const char *name, Function function);
+	};
+
+	// Minimum time spent running each measurement, so short operations are averaged over many iterations.
+	const double MinimumMeasureMs = 200.0;
+
+	// Calls the function until it has run for the minimum time and returns the average nanoseconds per item.
+	// The function must process itemCount items every time it's called.
+	template<typename T>
+	double measure(T function, size_t itemCount) {
+		function();
+
+		size_t iterations = 0;
+		double elapsedMs = 0.0;
+		auto startTime = std::chrono::high_resolution_clock::now();
+		while (elapsedMs < MinimumMeasureMs) {
+			function();
+			iterations++;
+			elapsedMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - startTime).count();
+		}
+
+		return (elapsedMs * 1000000.0) / ((double)(iterations) * (double)(itemCount));
+	}
+
+	void report(const char *benchmark, const char *variant, double value, const char *unit);
+	void skip(const char *benchmark, const char *reason);
+};
+
+#define BENCHMARK(name) \
+	static void name(); \
+	static Bench::Registration name##Registration(#name, name); \
+	static void name()
@@ -0,0 +1,137 @@
+//
+// RT64 BENCH
+//
+
+#include "bench.h"
+
+// The API benchmarks need the library and a D3D12 device.
+#if defined(_WIN32) && !defined(RT64_MINIMAL)
+
+#include "rt64.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+namespace {
+	struct Vertex {
+		RT64_VECTOR4 position;
+		RT64_VECTOR3 normal;
+		RT64_VECTOR2 uv;
+		RT64_VECTOR4 input1;
+	};
+
+	HWND createHiddenWindow() {
+		WNDCLASS wc;
+		memset(&wc, 0, sizeof(WNDCLASS));
+		wc.lpfnWndProc = DefWindowProc;
+		wc.hInstance = GetModuleHandle(0);
+		wc.lpszClassName = "RT64Bench";
+		RegisterClass(&wc);
+		return CreateWindow(wc.lpszClassName, "RT64 Bench", WS_OVERLAPPEDWINDOW, 0, 0, 640, 360, 0, 0, wc.hInstance, NULL);
+	}
+
+	RT64_INSTANCE_DESC makeInstanceDescription(RT64_MESH *mesh, RT64_TEXTURE *texture, RT64_SHADER *shader, int index) {
+		RT64_INSTANCE_DESC instanceDesc;
+		memset(&instanceDesc, 0, sizeof(RT64_INSTANCE_DESC));
+		instanceDesc.mesh = mesh;
+		instanceDesc.diffuseTexture = texture;
+		instanceDesc.normalTexture = nullptr;
+		instanceDesc.specularTexture = nullptr;
+		instanceDesc.shader = shader;
+		for (int i = 0; i < 4; i++) {
+			instanceDesc.transform.m[i][i] = 1.0f;
+			instanceDesc.previousTransform.m[i][i] = 1.0f;
+		}
+
+		instanceDesc.transform.m[3][0] = (float)(index % 100);
+		instanceDesc.transform.m[3][2] = (float)(index / 100);
+		instanceDesc.previousTransform = instanceDesc.transform;
+		instanceDesc.material.diffuseColorMix = { 1.0f, 1.0f, 1.0f, 0.0f };
+		instanceDesc.material.solidAlphaMultiplier = 1.0f;
+		instanceDesc.material.shadowAlphaMultiplier = 1.0f;
+		instanceDesc.scissorRect = { 0, 0, 0, 0 };
+		instanceDesc.viewportRect = { 0, 0, 0, 0 };
+		instanceDesc.flags = 0;
+		return instanceDesc;
+	}
+};
+
+// Compares applying the descriptions of every instance with one call each against a single batched call.
+BENCHMARK(InstanceDescriptions) {
+	RT64_LIBRARY lib = RT64_LoadLibrary();
+	if (lib.handle == 0) {
+		Bench::skip("InstanceDescriptions", "the library couldn't be loaded");
+		return;
+	}
+
+	HWND hwnd = createHiddenWindow();
+	RT64_DEVICE *device = lib.CreateDevice(hwnd);
+	if (device == nullptr) {
+		Bench::skip("InstanceDescriptions", lib.GetLastError());
+		DestroyWindow(hwnd);
+		RT64_UnloadLibrary(lib);
+		return;
+	}
+
+	RT64_SCENE *scene = lib.CreateScene(device);
+	Vertex vertices[3];
+	memset(vertices, 0, sizeof(vertices));
+	vertices[0].position = { -1.0f, 0.0f, 0.0f, 1.0f };
+	vertices[1].position = { 1.0f, 0.0f, 0.0f, 1.0f };
+	vertices[2].position = { 0.0f, 1.0f, 0.0f, 1.0f };
+	unsigned int indices[] = { 0, 1, 2 };
+	RT64_MESH *mesh = lib.CreateMesh(device, RT64_MESH_RAYTRACE_ENABLED);
+	lib.SetMesh(mesh, vertices, 3, sizeof(Vertex), indices, 3);
+
+	unsigned int whitePixel = 0xFFFFFFFF;
+	RT64_TEXTURE_DESC textureDesc;
+	textureDesc.bytes = &whitePixel;
+	textureDesc.byteCount = sizeof(whitePixel);
+	textureDesc.format = RT64_TEXTURE_FORMAT_RGBA8;
+	textureDesc.width = 1;
+	textureDesc.height = 1;
+	textureDesc.rowPitch = sizeof(whitePixel);
+	RT64_TEXTURE *texture = lib.CreateTexture(device, textureDesc);
+	RT64_SHADER *shader = lib.CreateShader(device, 0x01200a00, RT64_SHADER_FILTER_LINEAR, RT64_SHADER_ADDRESSING_WRAP, RT64_SHADER_ADDRESSING_WRAP, RT64_SHADER_RASTER_ENABLED | RT64_SHADER_RAYTRACE_ENABLED);
+
+	const int InstanceCounts[] = { 1000, 5000 };
+	for (int instanceCount : InstanceCounts) {
+		std::vector<RT64_INSTANCE *> instances(instanceCount);
+		std::vector<RT64_INSTANCE_DESC> instanceDescs(instanceCount);
+		for (int i = 0; i < instanceCount; i++) {
+			instances[i] = lib.CreateInstance(scene);
+			instanceDescs[i] = makeInstanceDescription(mesh, texture, shader, i);
+		}
+
+		double perCallNs = Bench::measure([&]() {
+			for (int i = 0; i < instanceCount; i++) {
+				lib.SetInstanceDescription(instances[i], instanceDescs[i]);
+			}
+		}, instanceCount);
+
+		double batchedNs = Bench::measure([&]() {
+			lib.SetInstanceDescriptions(instances.data(), instanceDescs.data(), instanceCount);
+		}, instanceCount);
+
+		char variant[64];
+		snprintf(variant, sizeof(variant), "per call, %d instances", instanceCount);
+		Bench::report("InstanceDescriptions", variant, perCallNs, "ns/instance");
+		snprintf(variant, sizeof(variant), "batched, %d instances", instanceCount);
+		Bench::report("InstanceDescriptions", variant, batchedNs, "ns/instance");
+
+		for (RT64_INSTANCE *instance : instances) {
+			lib.DestroyInstance(instance);
+		}
+	}
+
+	lib.DestroyShader(shader);
+	lib.DestroyTexture(texture);
+	lib.DestroyMesh(mesh);
+	lib.DestroyScene(scene);
+	lib.DestroyDevice(device);
+	DestroyWindow(hwnd);
+	RT64_UnloadLibrary(lib);
+}
+
+#endif
@@ -0,0 +1,71 @@
+//
+// RT64 BENCH
+//
+
+#include "bench.h"
+
+#ifndef RT64_MINIMAL
+
+#include "rt64.h"
+#include "rt64_material_table.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+// Compares uploading one material per instance against interning them into the view's material table and uploading the
+// table along with one index per instance, on a frame where the materials were marked as changed.
+BENCHMARK(MaterialTableInterning) {
+	// Levels reuse a few dozen distinct materials across all of their instances.
+	const int DistinctMaterials = 48;
+	const int InstanceCounts[] = { 5000, 20000 };
+	for (int instanceCount : InstanceCounts) {
+		std::vector<RT64_MATERIAL> instanceMaterials(instanceCount);
+		for (int i = 0; i < instanceCount; i++) {
+			RT64_MATERIAL &material = instanceMaterials[i];
+			memset(&material, 0, sizeof(RT64_MATERIAL));
+			material.diffuseTexIndex = i % DistinctMaterials;
+			material.diffuseColorMix.x = (float)(i % DistinctMaterials) / DistinctMaterials;
+			material.enabledAttributes = (i & 1) ? RT64_ATTRIBUTE_DIFFUSE_COLOR_MIX : RT64_ATTRIBUTE_NONE;
+		}
+
+		std::vector<RT64_MATERIAL> materialsBuffer(instanceCount);
+		double perInstanceNs = Bench::measure([&]() {
+			memcpy(materialsBuffer.data(), instanceMaterials.data(), instanceCount * sizeof(RT64_MATERIAL));
+		}, instanceCount);
+
+		RT64::MaterialTable materialTable;
+		std::vector<uint32_t> materialIndices(instanceCount);
+		std::vector<uint32_t> materialIndicesBuffer(instanceCount);
+		double internedNs = Bench::measure([&]() {
+			materialTable.begin();
+			for (int i = 0; i < instanceCount; i++) {
+				materialIndices[i] = materialTable.intern(instanceMaterials[i]);
+			}
+
+			if (materialTable.end()) {
+				memcpy(materialsBuffer.data(), materialTable.getMaterials(), materialTable.size() * sizeof(RT64_MATERIAL));
+			}
+
+			memcpy(materialIndicesBuffer.data(), materialIndices.data(), instanceCount * sizeof(uint32_t));
+		}, instanceCount);
+
+		// A frame whose table changed uploads both the table and the indices. One that kept the same table only uploads the indices.
+		const double perInstanceBytes = (double)(instanceCount) * sizeof(RT64_MATERIAL);
+		const double internedBytes = (double)(materialTable.size() * sizeof(RT64_MATERIAL) + instanceCount * sizeof(uint32_t));
+		const double indicesOnlyBytes = (double)(instanceCount) * sizeof(uint32_t);
+
+		char variant[64];
+		snprintf(variant, sizeof(variant), "per instance, %d instances", instanceCount);
+		Bench::report("MaterialTableInterning", variant, perInstanceNs, "ns/instance");
+		Bench::report("MaterialTableInterning", variant, perInstanceBytes, "bytes/frame");
+		snprintf(variant, sizeof(variant), "interned, %d instances", instanceCount);
+		Bench::report("MaterialTableInterning", variant, internedNs, "ns/instance");
+		Bench::report("MaterialTableInterning", variant, internedBytes, "bytes/frame");
+		snprintf(variant, sizeof(variant), "interned, same table, %d instances", instanceCount);
+		Bench::report("MaterialTableInterning", variant, indicesOnlyBytes, "bytes/frame");
+	}
+}
+
+#endif
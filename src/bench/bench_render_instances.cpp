@@ -0,0 +1,220 @@
+//
+// RT64 BENCH
+//
+
+#include "bench.h"
+
+#ifndef RT64_MINIMAL
+
+#include "rt64.h"
+#include "rt64_instance_extraction.h"
+#include "rt64_worker_pool.h"
+
+#include <memory>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+// The view's render instances use D3D12 types, so the layouts are mirrored here with types of the same size. Both layouts
+// are filled through the view's extraction on a single thread, so only the layout differs between them.
+
+namespace {
+	struct alignas(16) Matrix {
+		float m[16];
+	};
+
+	struct Rect {
+		long left, top, right, bottom;
+	};
+
+	struct Viewport {
+		float x, y, width, height, minDepth, maxDepth;
+	};
+
+	// Stands in for the scene's instances, which are allocated one by one.
+	struct SourceInstance {
+		Matrix transform;
+		Matrix previousTransform;
+		RT64_MATERIAL material;
+		const void *mesh;
+		const void *shader;
+		const void *bottomLevelAS;
+		int indexCount;
+		Rect scissorRect;
+		Viewport viewport;
+		unsigned int flags;
+	};
+
+	// Layout used by the view before the change: one struct per instance.
+	struct RenderInstance {
+		SourceInstance *instance;
+		const void *vertexBufferView;
+		const void *indexBufferView;
+		int indexCount;
+		const void *bottomLevelAS;
+		Matrix transform;
+		Matrix transformPrevious;
+		RT64_MATERIAL material;
+		const void *shader;
+		Rect scissorRect;
+		Viewport viewport;
+		unsigned int flags;
+	};
+
+	// Layout used by the view now: one array per field.
+	struct RenderInstances {
+		std::vector<Matrix> transforms;
+		std::vector<Matrix> previousTransforms;
+		std::vector<RT64_MATERIAL> materials;
+		std::vector<const void *> bottomLevelAS;
+		std::vector<unsigned int> flags;
+		std::vector<const void *> shaders;
+		std::vector<const void *> vertexBufferViews;
+		std::vector<const void *> indexBufferViews;
+		std::vector<int> indexCounts;
+		std::vector<Rect> scissorRects;
+		std::vector<Viewport> viewports;
+		std::vector<SourceInstance *> instances;
+
+		void resize(size_t count) {
+			transforms.resize(count);
+			previousTransforms.resize(count);
+			materials.resize(count);
+			bottomLevelAS.resize(count);
+			flags.resize(count);
+			shaders.resize(count);
+			vertexBufferViews.resize(count);
+			indexBufferViews.resize(count);
+			indexCounts.resize(count);
+			scissorRects.resize(count);
+			viewports.resize(count);
+			instances.resize(count);
+		}
+	};
+
+	struct InstanceTransforms {
+		Matrix objectToWorld;
+		Matrix objectToWorldPrevious;
+	};
+};
+
+// Compares extracting the scene's instances into both layouts and streaming the transforms and materials out of them,
+// like the view does when it fills its upload buffers.
+BENCHMARK(RenderInstanceLayout) {
+	const int InstanceCount = 20000;
+	std::vector<std::unique_ptr<SourceInstance>> sourceStorage;
+	std::vector<SourceInstance *> sourceInstances;
+	for (int i = 0; i < InstanceCount; i++) {
+		sourceStorage.emplace_back(new SourceInstance());
+		SourceInstance *instance = sourceStorage.back().get();
+		for (int j = 0; j < 16; j++) {
+			instance->transform.m[j] = (float)(i + j);
+		}
+
+		instance->previousTransform = instance->transform;
+		instance->material.diffuseTexIndex = i % 64;
+		instance->indexCount = 3 * (i % 100 + 1);
+		instance->flags = i & 1;
+		sourceInstances.push_back(instance);
+	}
+
+	std::vector<InstanceTransforms> transformsBuffer(InstanceCount);
+	std::vector<RT64_MATERIAL> materialsBuffer(InstanceCount);
+
+	// Every instance goes in the first list, as this only measures how the lists are laid out.
+	RT64::WorkerPool workerPool(0);
+	RT64::InstanceExtraction extraction;
+	auto classify = [](size_t) {
+		return 0;
+	};
+
+	std::vector<RenderInstance> aosInstances;
+	double aosExtractNs = Bench::measure([&]() {
+		extraction.classify(workerPool, sourceInstances.size(), classify);
+		aosInstances.resize(extraction.getListSize(0));
+		extraction.fill(workerPool, [&](size_t i, size_t, size_t j) {
+			SourceInstance *instance = sourceInstances[i];
+			RenderInstance &renderInstance = aosInstances[j];
+			renderInstance.instance = instance;
+			renderInstance.vertexBufferView = instance->mesh;
+			renderInstance.indexBufferView = instance->mesh;
+			renderInstance.indexCount = instance->indexCount;
+			renderInstance.bottomLevelAS = instance->bottomLevelAS;
+			renderInstance.transform = instance->transform;
+			renderInstance.transformPrevious = instance->previousTransform;
+			renderInstance.material = instance->material;
+			renderInstance.shader = instance->shader;
+			renderInstance.scissorRect = instance->scissorRect;
+			renderInstance.viewport = instance->viewport;
+			renderInstance.flags = instance->flags;
+		});
+	}, InstanceCount);
+
+	RenderInstances soaInstances;
+	double soaExtractNs = Bench::measure([&]() {
+		extraction.classify(workerPool, sourceInstances.size(), classify);
+		soaInstances.resize(extraction.getListSize(0));
+		extraction.fill(workerPool, [&](size_t i, size_t, size_t j) {
+			SourceInstance *instance = sourceInstances[i];
+			soaInstances.instances[j] = instance;
+			soaInstances.vertexBufferViews[j] = instance->mesh;
+			soaInstances.indexBufferViews[j] = instance->mesh;
+			soaInstances.indexCounts[j] = instance->indexCount;
+			soaInstances.bottomLevelAS[j] = instance->bottomLevelAS;
+			soaInstances.transforms[j] = instance->transform;
+			soaInstances.previousTransforms[j] = instance->previousTransform;
+			soaInstances.materials[j] = instance->material;
+			soaInstances.shaders[j] = instance->shader;
+			soaInstances.scissorRects[j] = instance->scissorRect;
+			soaInstances.viewports[j] = instance->viewport;
+			soaInstances.flags[j] = instance->flags;
+		});
+	}, InstanceCount);
+
+	double aosTransformsNs = Bench::measure([&]() {
+		InstanceTransforms *current = transformsBuffer.data();
+		for (const RenderInstance &renderInstance : aosInstances) {
+			current->objectToWorld = renderInstance.transform;
+			current->objectToWorldPrevious = renderInstance.transformPrevious;
+			current++;
+		}
+	}, InstanceCount);
+
+	double soaTransformsNs = Bench::measure([&]() {
+		InstanceTransforms *current = transformsBuffer.data();
+		const size_t count = soaInstances.transforms.size();
+		for (size_t j = 0; j < count; j++) {
+			current[j].objectToWorld = soaInstances.transforms[j];
+			current[j].objectToWorldPrevious = soaInstances.previousTransforms[j];
+		}
+	}, InstanceCount);
+
+	double aosMaterialsNs = Bench::measure([&]() {
+		RT64_MATERIAL *current = materialsBuffer.data();
+		for (const RenderInstance &renderInstance : aosInstances) {
+			*current = renderInstance.material;
+			current++;
+		}
+	}, InstanceCount);
+
+	double soaMaterialsNs = Bench::measure([&]() {
+		memcpy(materialsBuffer.data(), soaInstances.materials.data(), soaInstances.materials.size() * sizeof(RT64_MATERIAL));
+	}, InstanceCount);
+
+	char variant[64];
+	snprintf(variant, sizeof(variant), "array of structs extract, %d", InstanceCount);
+	Bench::report("RenderInstanceLayout", variant, aosExtractNs, "ns/instance");
+	snprintf(variant, sizeof(variant), "struct of arrays extract, %d", InstanceCount);
+	Bench::report("RenderInstanceLayout", variant, soaExtractNs, "ns/instance");
+	snprintf(variant, sizeof(variant), "array of structs transforms, %d", InstanceCount);
+	Bench::report("RenderInstanceLayout", variant, aosTransformsNs, "ns/instance");
+	snprintf(variant, sizeof(variant), "struct of arrays transforms, %d", InstanceCount);
+	Bench::report("RenderInstanceLayout", variant, soaTransformsNs, "ns/instance");
+	snprintf(variant, sizeof(variant), "array of structs materials, %d", InstanceCount);
+	Bench::report("RenderInstanceLayout", variant, aosMaterialsNs, "ns/instance");
+	snprintf(variant, sizeof(variant), "struct of arrays materials, %d", InstanceCount);
+	Bench::report("RenderInstanceLayout", variant, soaMaterialsNs, "ns/instance");
+}
+
+#endif
@@ -0,0 +1,112 @@
+//
+// RT64 BENCH
+//
+
+#include "bench.h"
+
+#ifndef RT64_MINIMAL
+
+#include "rt64_slot_map.h"
+
+#include <algorithm>
+#include <random>
+#include <stdint.h>
+#include <stdio.h>
+#include <vector>
+
+namespace {
+	// Number of instances destroyed and created again on every iteration of the churn measurements.
+	const int ChurnCount = 256;
+
+	struct Instance {
+		int index;
+	};
+};
+
+// Compares the scene's instance registry against the vector it replaced. Churn destroys a random set of instances
+// and creates them again like a level transition does, and iteration walks the instances like View::update does.
+BENCHMARK(SlotMapInstances) {
+	const int InstanceCounts[] = { 1000, 10000, 100000 };
+	for (int instanceCount : InstanceCounts) {
+		std::vector<Instance> storage(instanceCount);
+		for (int i = 0; i < instanceCount; i++) {
+			storage[i].index = i;
+		}
+
+		std::mt19937 random(instanceCount);
+		std::vector<int> victims(instanceCount);
+		for (int i = 0; i < instanceCount; i++) {
+			victims[i] = i;
+		}
+
+		std::shuffle(victims.begin(), victims.end(), random);
+		victims.resize(std::min(ChurnCount, instanceCount));
+
+		// Removing from the vector searches for the instance and shifts everything after it.
+		std::vector<Instance *> vectorInstances;
+		for (Instance &instance : storage) {
+			vectorInstances.push_back(&instance);
+		}
+
+		double vectorChurnNs = Bench::measure([&]() {
+			for (int victim : victims) {
+				Instance *instance = &storage[victim];
+				vectorInstances.erase(std::find(vectorInstances.begin(), vectorInstances.end(), instance));
+			}
+
+			for (int victim : victims) {
+				vectorInstances.push_back(&storage[victim]);
+			}
+		}, victims.size());
+
+		RT64::SlotMap<Instance *> slotMap;
+		std::vector<RT64::SlotHandle> handles(instanceCount);
+		for (int i = 0; i < instanceCount; i++) {
+			handles[i] = slotMap.insert(&storage[i]);
+		}
+
+		double slotMapChurnNs = Bench::measure([&]() {
+			for (int victim : victims) {
+				slotMap.remove(handles[victim]);
+			}
+
+			for (int victim : victims) {
+				handles[victim] = slotMap.insert(&storage[victim]);
+			}
+
+			// The scene compacts once before the views iterate the instances.
+			slotMap.compact();
+		}, victims.size());
+
+		volatile uint64_t sink = 0;
+		double vectorIterateNs = Bench::measure([&]() {
+			uint64_t sum = 0;
+			for (Instance *instance : vectorInstances) {
+				sum += instance->index;
+			}
+
+			sink = sum;
+		}, instanceCount);
+
+		double slotMapIterateNs = Bench::measure([&]() {
+			uint64_t sum = 0;
+			for (Instance *instance : slotMap.getValues()) {
+				sum += instance->index;
+			}
+
+			sink = sum;
+		}, instanceCount);
+
+		char variant[64];
+		snprintf(variant, sizeof(variant), "vector churn, %d instances", instanceCount);
+		Bench::report("SlotMapInstances", variant, vectorChurnNs, "ns/instance");
+		snprintf(variant, sizeof(variant), "slot map churn, %d instances", instanceCount);
+		Bench::report("SlotMapInstances", variant, slotMapChurnNs, "ns/instance");
+		snprintf(variant, sizeof(variant), "vector iterate, %d instances", instanceCount);
+		Bench::report("SlotMapInstances", variant, vectorIterateNs, "ns/instance");
+		snprintf(variant, sizeof(variant), "slot map iterate, %d instances", instanceCount);
+		Bench::report("SlotMapInstances", variant, slotMapIterateNs, "ns/instance");
+	}
+}
+
+#endif
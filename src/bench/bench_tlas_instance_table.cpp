@@ -0,0 +1,99 @@
+//
+// RT64 BENCH
+//
+
+#include "bench.h"
+
+#ifndef RT64_MINIMAL
+
+#include "rt64_tlas_instance_table.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <vector>
+
+namespace {
+	struct Scene {
+		std::vector<float> transforms;
+		std::vector<uint8_t> moving;
+		uint32_t frame;
+	};
+
+	Scene createScene(int instanceCount, int movingPercent) {
+		Scene scene;
+		scene.transforms.assign(instanceCount * 16, 0.0f);
+		scene.moving.resize(instanceCount);
+		scene.frame = 0;
+		for (int i = 0; i < instanceCount; i++) {
+			float *transform = &scene.transforms[i * 16];
+			transform[0] = transform[5] = transform[10] = transform[15] = 1.0f;
+			transform[12] = (float)(i % 100);
+			transform[14] = (float)(i / 100);
+
+			// Spread the moving instances over the scene instead of keeping them together.
+			scene.moving[i] = ((i * 37) % 100) < movingPercent;
+		}
+
+		return scene;
+	}
+
+	// Moves the dynamic instances and fills the table the same way the view does it.
+	void updateTable(Scene &scene, RT64::TopLevelASInstanceTable &table) {
+		scene.frame++;
+		const size_t instanceCount = scene.moving.size();
+		table.resize(instanceCount);
+		for (size_t i = 0; i < instanceCount; i++) {
+			float *transform = &scene.transforms[i * 16];
+			if (scene.moving[i]) {
+				transform[13] = (float)(scene.frame & 0xFF) * 0.01f;
+			}
+
+			table.setInstance(i, transform, (uint32_t)(i), 0xFF, (uint32_t)(i % 16) * 2, 0, 0x10000 + (i % 64) * 0x100);
+		}
+	}
+};
+
+// Measures the bytes written to the TLAS descriptor buffer per frame by the instance table against rewriting every
+// descriptor, for a static scene and scenes with part or all of their instances moving every frame.
+BENCHMARK(TopLevelASInstancePatching) {
+	const int InstanceCounts[] = { 2000, 10000 };
+	const int MovingPercents[] = { 0, 10, 100 };
+	for (int instanceCount : InstanceCounts) {
+		std::vector<RT64::TopLevelASInstanceTable::Desc> buffer(instanceCount);
+		for (int movingPercent : MovingPercents) {
+			Scene scene = createScene(instanceCount, movingPercent);
+			RT64::TopLevelASInstanceTable table;
+
+			// The first upload writes every descriptor, so it's left out of the measurements.
+			updateTable(scene, table);
+			table.upload(buffer.data());
+
+			double patchNs = Bench::measure([&]() {
+				updateTable(scene, table);
+				table.upload(buffer.data());
+			}, instanceCount);
+
+			// Forgetting the buffer's contents every frame makes the table write every descriptor, like the view did before.
+			double rewriteNs = Bench::measure([&]() {
+				table.invalidate();
+				updateTable(scene, table);
+				table.upload(buffer.data());
+			}, instanceCount);
+
+			// The rewrites left the buffer matching the table, so the next frame only writes what moved.
+			updateTable(scene, table);
+			const double patchBytes = (double)(table.upload(buffer.data()));
+			const double rewriteBytes = (double)(instanceCount) * sizeof(RT64::TopLevelASInstanceTable::Desc);
+
+			char variant[64];
+			snprintf(variant, sizeof(variant), "patch, %d%% moving, %d instances", movingPercent, instanceCount);
+			Bench::report("TopLevelASInstancePatching", variant, patchNs, "ns/instance");
+			Bench::report("TopLevelASInstancePatching", variant, patchBytes, "bytes/frame");
+			snprintf(variant, sizeof(variant), "rewrite, %d%% moving, %d instances", movingPercent, instanceCount);
+			Bench::report("TopLevelASInstancePatching", variant, rewriteNs, "ns/instance");
+			Bench::report("TopLevelASInstancePatching", variant, rewriteBytes, "bytes/frame");
+		}
+	}
+}
+
+#endif
@@ -0,0 +1,117 @@
+//
+// RT64 BENCH
+//
+
+#include "bench.h"
+
+#ifndef RT64_MINIMAL
+
+#include "rt64.h"
+#include "rt64_instance_extraction.h"
+#include "rt64_worker_pool.h"
+
+#include <algorithm>
+#include <memory>
+#include <stdio.h>
+#include <thread>
+#include <vector>
+
+namespace {
+	// Same limit as the device, which adds the thread that starts the batch.
+	const unsigned int MaxWorkerThreads = 7;
+
+	struct SourceInstance {
+		float previousTransform[16];
+		float transform[16];
+		RT64_MATERIAL material;
+		bool raytraced;
+		bool background;
+	};
+
+	struct RenderInstances {
+		std::vector<float> transforms;
+		std::vector<RT64_MATERIAL> materials;
+		std::vector<const SourceInstance *> instances;
+
+		void resize(size_t count) {
+			transforms.resize(count * 16);
+			materials.resize(count);
+			instances.resize(count);
+		}
+	};
+
+	// Runs the view's extraction with fills that stand in for the ones View::update does with the D3D12 types.
+	void extract(RT64::WorkerPool &workerPool, RT64::InstanceExtraction &extraction, const std::vector<SourceInstance *> &sourceInstances, RenderInstances *lists[RT64::InstanceExtraction::ListCount]) {
+		extraction.classify(workerPool, sourceInstances.size(), [&](size_t i) {
+			const SourceInstance *instance = sourceInstances[i];
+			return instance->raytraced ? 0 : (instance->background ? 1 : 2);
+		});
+
+		for (size_t l = 0; l < RT64::InstanceExtraction::ListCount; l++) {
+			lists[l]->resize(extraction.getListSize(l));
+		}
+
+		extraction.fill(workerPool, [&](size_t i, size_t listIndex, size_t j) {
+			const SourceInstance *instance = sourceInstances[i];
+			RenderInstances &list = *lists[listIndex];
+			list.instances[j] = instance;
+
+			// Stands in for the interpolation of the transforms between simulation snapshots.
+			float *transform = &list.transforms[j * 16];
+			for (int k = 0; k < 16; k++) {
+				transform[k] = instance->previousTransform[k] + (instance->transform[k] - instance->previousTransform[k]) * 0.5f;
+			}
+
+			list.materials[j] = instance->material;
+			list.materials[j].diffuseTexIndex = (int)(i & 0xFF);
+		});
+	}
+};
+
+// Measures how the view's scene extraction scales with the number of threads that work on it.
+BENCHMARK(WorkerPoolExtraction) {
+	const unsigned int hardwareThreads = std::max(std::thread::hardware_concurrency(), 1U);
+	const unsigned int maxThreads = std::min(hardwareThreads, MaxWorkerThreads + 1);
+
+	// Powers of two and the largest pool the device would create.
+	std::vector<unsigned int> threadCounts;
+	for (unsigned int threadCount = 1; threadCount < maxThreads; threadCount *= 2) {
+		threadCounts.push_back(threadCount);
+	}
+
+	threadCounts.push_back(maxThreads);
+
+	const int InstanceCounts[] = { 5000, 20000 };
+	for (int instanceCount : InstanceCounts) {
+		std::vector<std::unique_ptr<SourceInstance>> sourceStorage;
+		std::vector<SourceInstance *> sourceInstances;
+		for (int i = 0; i < instanceCount; i++) {
+			sourceStorage.emplace_back(new SourceInstance());
+			SourceInstance *instance = sourceStorage.back().get();
+			for (int k = 0; k < 16; k++) {
+				instance->previousTransform[k] = (float)(i + k);
+				instance->transform[k] = (float)(i + k + 1);
+			}
+
+			instance->raytraced = (i % 4) != 0;
+			instance->background = (i % 8) == 0;
+			sourceInstances.push_back(instance);
+		}
+
+		RenderInstances rtInstances, rasterBgInstances, rasterFgInstances;
+		RenderInstances *lists[RT64::InstanceExtraction::ListCount] = { &rtInstances, &rasterBgInstances, &rasterFgInstances };
+		RT64::InstanceExtraction extraction;
+		for (unsigned int threadCount : threadCounts) {
+			RT64::WorkerPool workerPool(threadCount - 1);
+			double extractNs = Bench::measure([&]() {
+				extract(workerPool, extraction, sourceInstances, lists);
+			}, instanceCount);
+
+			char variant[64];
+			snprintf(variant, sizeof(variant), "%u threads, %d instances", threadCount, instanceCount);
+			Bench::report("WorkerPoolExtraction", variant, extractNs, "ns/instance");
+		}
+	}
+}
+
+#endif
@@ -0,0 +1,62 @@
+//
+// RT64 BENCH
+//
+
+#include "bench.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+// Runs the CPU microbenchmarks for the library. The name of a benchmark can be passed to only run the ones that contain it.
+
+namespace {
+	struct Benchmark {
+		const char *name;
+		Bench::Function function;
+	};
+
+	std::vector<Benchmark> &benchmarks() {
+		// Registrations run during static initialization, so the list must be created on first use.
+		static std::vector<Benchmark> list;
+		return list;
+	}
+};
+
+Bench::Registration::Registration(const char *name, Function function) {
+	benchmarks().push_back({ name, function });
+}
+
+void Bench::report(const char *benchmark, const char *variant, double value, const char *unit) {
+	fprintf(stdout, "%-28s %-36s %12.2f %s\n", benchmark, variant, value, unit);
+	fflush(stdout);
+}
+
+void Bench::skip(const char *benchmark, const char *reason) {
+	fprintf(stdout, "%-28s skipped: %s\n", benchmark, reason);
+	fflush(stdout);
+}
+
+int main(int argc, char *argv[]) {
+	const char *filter = (argc > 1) ? argv[1] : nullptr;
+	bool found = false;
+	for (const Benchmark &benchmark : benchmarks()) {
+		if ((filter == nullptr) || (strstr(benchmark.name, filter) != nullptr)) {
+			benchmark.function();
+			found = true;
+		}
+	}
+
+	if (!found) {
+		if (filter != nullptr) {
+			fprintf(stderr, "No benchmarks match %s.\n", filter);
+		}
+		else {
+			fprintf(stderr, "No benchmarks are available in this build.\n");
+		}
+
+		return 1;
+	}
+
+	return 0;
+}
@@ -0,0 +1,629 @@
+//
+// RT64 REPLAY
+//
+
+#include "rt64.h"
+#include "rt64_capture.h"
+#include "stub_library.h"
+
+#define WINDOW_TITLE "RT64 Replay"
+
+#ifdef _WIN32
+#include <Windows.h>
+#endif
+
+#include <stdio.h>
+#include <string.h>
+
+#ifndef RT64_MINIMAL
+
+#include <algorithm>
+#include <chrono>
+#include <unordered_map>
+#include <vector>
+
+// Replays a capture stream recorded with RT64_StartCapture and reports the CPU cost of every call and frame.
+// The stub library replays it without a device, which is the only option outside of Windows.
+
+struct CallStats {
+	unsigned int count = 0;
+	double totalMs = 0.0;
+};
+
+struct {
+	RT64_LIBRARY lib;
+	HWND hwnd = nullptr;
+	std::vector<unsigned char> stream;
+	size_t streamOffset = 0;
+	std::unordered_map<uint64_t, std::vector<unsigned char>> blobs;
+	std::unordered_map<uint32_t, void *> objects;
+	CallStats callStats[RT64_CAPTURE_CALL_MAX];
+	std::vector<double> frameTimes;
+	double frameMs = 0.0;
+	bool checkAllocations = false;
+	bool useStub = false;
+	unsigned int allocatingFrames = 0;
+	int frameAllocations = 0;
+} Replay;
+
+// Frames drawn before the allocation check starts, so the library can create its resources and grow its containers.
+static const unsigned int AllocationWarmupFrames = 60;
+
+static const char *callName(uint32_t call) {
+	switch (call) {
+	case RT64_CAPTURE_CALL_BLOB: return "Blob";
+	case RT64_CAPTURE_CALL_CREATE_DEVICE: return "CreateDevice";
+	case RT64_CAPTURE_CALL_DESTROY_DEVICE: return "DestroyDevice";
+	case RT64_CAPTURE_CALL_DRAW_DEVICE: return "DrawDevice";
+	case RT64_CAPTURE_CALL_CREATE_SCENE: return "CreateScene";
+	case RT64_CAPTURE_CALL_SET_SCENE_DESCRIPTION: return "SetSceneDescription";
+	case RT64_CAPTURE_CALL_SET_SCENE_LIGHTS: return "SetSceneLights";
+	case RT64_CAPTURE_CALL_DESTROY_SCENE: return "DestroyScene";
+	case RT64_CAPTURE_CALL_SET_SCENE_INTERPOLATION: return "SetSceneInterpolation";
+	case RT64_CAPTURE_CALL_CREATE_VIEW: return "CreateView";
+	case RT64_CAPTURE_CALL_SET_VIEW_PERSPECTIVE: return "SetViewPerspective";
+	case RT64_CAPTURE_CALL_SET_VIEW_DESCRIPTION: return "SetViewDescription";
+	case RT64_CAPTURE_CALL_SET_VIEW_SKY_PLANE: return "SetViewSkyPlane";
+	case RT64_CAPTURE_CALL_DESTROY_VIEW: return "DestroyView";
+	case RT64_CAPTURE_CALL_CREATE_MESH: return "CreateMesh";
+	case RT64_CAPTURE_CALL_SET_MESH: return "SetMesh";
+	case RT64_CAPTURE_CALL_SET_MESH_RANGE: return "SetMeshRange";
+	case RT64_CAPTURE_CALL_SET_MESH_VERTICES: return "MapMeshVertices";
+	case RT64_CAPTURE_CALL_SET_MESH_INDICES: return "MapMeshIndices";
+	case RT64_CAPTURE_CALL_DESTROY_MESH: return "DestroyMesh";
+	case RT64_CAPTURE_CALL_CREATE_TEXTURE: return "CreateTexture";
+	case RT64_CAPTURE_CALL_DESTROY_TEXTURE: return "DestroyTexture";
+	case RT64_CAPTURE_CALL_CREATE_SHADER: return "CreateShader";
+	case RT64_CAPTURE_CALL_DESTROY_SHADER: return "DestroyShader";
+	case RT64_CAPTURE_CALL_CREATE_INSTANCE: return "CreateInstance";
+	case RT64_CAPTURE_CALL_SET_INSTANCE_DESCRIPTION: return "SetInstanceDescription";
+	case RT64_CAPTURE_CALL_SET_INSTANCE_DESCRIPTIONS: return "SetInstanceDescriptions";
+	case RT64_CAPTURE_CALL_DESTROY_INSTANCE: return "DestroyInstance";
+	default: return "Unknown";
+	}
+}
+
+template<typename T>
+static T readValue() {
+	T value;
+	memcpy(&value, &Replay.stream[Replay.streamOffset], sizeof(T));
+	Replay.streamOffset += sizeof(T);
+	return value;
+}
+
+template<typename T>
+static T *readObject() {
+	uint32_t objectId = readValue<uint32_t>();
+	auto it = Replay.objects.find(objectId);
+	return (it != Replay.objects.end()) ? (T *)(it->second) : nullptr;
+}
+
+static void storeObject(void *object) {
+	uint32_t objectId = readValue<uint32_t>();
+	Replay.objects[objectId] = object;
+}
+
+static const void *readBlob() {
+	uint64_t hash = readValue<uint64_t>();
+	auto it = Replay.blobs.find(hash);
+	return (it != Replay.blobs.end()) ? it->second.data() : nullptr;
+}
+
+static RT64_INSTANCE_DESC readInstanceDescription() {
+	RT64_INSTANCE_DESC instanceDesc = readValue<RT64_INSTANCE_DESC>();
+	instanceDesc.mesh = readObject<RT64_MESH>();
+	instanceDesc.diffuseTexture = readObject<RT64_TEXTURE>();
+	instanceDesc.normalTexture = readObject<RT64_TEXTURE>();
+	instanceDesc.specularTexture = readObject<RT64_TEXTURE>();
+	instanceDesc.shader = readObject<RT64_SHADER>();
+	return instanceDesc;
+}
+
+static void replayCall(uint32_t call, size_t payloadSize) {
+	RT64_LIBRARY &lib = Replay.lib;
+	switch (call) {
+	case RT64_CAPTURE_CALL_BLOB: {
+		if (payloadSize < sizeof(uint64_t)) {
+			break;
+		}
+
+		// Blobs are copied out of the stream so the calls can read them with the alignment of their types.
+		uint64_t hash = readValue<uint64_t>();
+		const unsigned char *blobData = &Replay.stream[Replay.streamOffset];
+		Replay.blobs[hash].assign(blobData, blobData + payloadSize - sizeof(uint64_t));
+		break;
+	}
+	case RT64_CAPTURE_CALL_CREATE_DEVICE: {
+		RT64_DEVICE *device = lib.CreateDevice(Replay.hwnd);
+		if (device == nullptr) {
+			fprintf(stderr, "Failed to create device: %s\n", lib.GetLastError());
+		}
+
+		storeObject(device);
+		break;
+	}
+	case RT64_CAPTURE_CALL_DESTROY_DEVICE: {
+		RT64_DEVICE *device = readObject<RT64_DEVICE>();
+		if (device != nullptr) {
+			lib.DestroyDevice(device);
+		}
+
+		break;
+	}
+	case RT64_CAPTURE_CALL_DRAW_DEVICE: {
+		RT64_DEVICE *device = readObject<RT64_DEVICE>();
+		readValue<int>(); // vsyncInterval, replay never waits for vsync
+		float deltaTimeMs = readValue<float>();
+		if (device != nullptr) {
+			// Never wait for vsync so the measured time only depends on the work done by the library.
+			lib.DrawDevice(device, 0, deltaTimeMs);
+
+			if (Replay.checkAllocations) {
+				RT64_FRAME_STATS frameStats;
+				lib.GetFrameStats(device, &frameStats);
+				Replay.frameAllocations = frameStats.cpuAllocationCount;
+			}
+		}
+
+		break;
+	}
+	case RT64_CAPTURE_CALL_CREATE_SCENE: {
+		RT64_DEVICE *device = readObject<RT64_DEVICE>();
+		storeObject((device != nullptr) ? lib.CreateScene(device) : nullptr);
+		break;
+	}
+	case RT64_CAPTURE_CALL_SET_SCENE_DESCRIPTION: {
+		RT64_SCENE *scene = readObject<RT64_SCENE>();
+		RT64_SCENE_DESC sceneDesc = readValue<RT64_SCENE_DESC>();
+		if (scene != nullptr) {
+			lib.SetSceneDescription(scene, sceneDesc);
+		}
+
+		break;
+	}
+	case RT64_CAPTURE_CALL_SET_SCENE_LIGHTS: {
+		RT64_SCENE *scene = readObject<RT64_SCENE>();
+		int lightCount = readValue<int>();
+		RT64_LIGHT *lights = (RT64_LIGHT *)(readBlob());
+		if (scene != nullptr) {
+			lib.SetSceneLights(scene, lights, lightCount);
+		}
+
+		break;
+	}
+	case RT64_CAPTURE_CALL_SET_SCENE_INTERPOLATION: {
+		RT64_SCENE *scene = readObject<RT64_SCENE>();
+		bool enabled = readValue<uint8_t>() != 0;
+		float factor = readValue<float>();
+		if (scene != nullptr) {
+			lib.SetSceneInterpolation(scene, enabled, factor);
+		}
+
+		break;
+	}
+	case RT64_CAPTURE_CALL_DESTROY_SCENE: {
+		RT64_SCENE *scene = readObject<RT64_SCENE>();
+		if (scene != nullptr) {
+			lib.DestroyScene(scene);
+		}
+
+		break;
+	}
+	case RT64_CAPTURE_CALL_CREATE_VIEW: {
+		RT64_SCENE *scene = readObject<RT64_SCENE>();
+		storeObject((scene != nullptr) ? lib.CreateView(scene) : nullptr);
+		break;
+	}
+	case RT64_CAPTURE_CALL_SET_VIEW_PERSPECTIVE: {
+		RT64_VIEW *view = readObject<RT64_VIEW>();
+		RT64_MATRIX4 viewMatrix = readValue<RT64_MATRIX4>();
+		float fovRadians = readValue<float>();
+		float nearDist = readValue<float>();
+		float farDist = readValue<float>();
+		bool canReproject = readValue<uint8_t>() != 0;
+		if (view != nullptr) {
+			lib.SetViewPerspective(view, viewMatrix, fovRadians, nearDist, farDist, canReproject);
+		}
+
+		break;
+	}
+	case RT64_CAPTURE_CALL_SET_VIEW_DESCRIPTION: {
+		RT64_VIEW *view = readObject<RT64_VIEW>();
+		RT64_VIEW_DESC viewDesc = readValue<RT64_VIEW_DESC>();
+		if (view != nullptr) {
+			lib.SetViewDescription(view, viewDesc);
+		}
+
+		break;
+	}
+	case RT64_CAPTURE_CALL_SET_VIEW_SKY_PLANE: {
+		RT64_VIEW *view = readObject<RT64_VIEW>();
+		RT64_TEXTURE *texture = readObject<RT64_TEXTURE>();
+		if (view != nullptr) {
+			lib.SetViewSkyPlane(view, texture);
+		}
+
+		break;
+	}
+	case RT64_CAPTURE_CALL_DESTROY_VIEW: {
+		RT64_VIEW *view = readObject<RT64_VIEW>();
+		if (view != nullptr) {
+			lib.DestroyView(view);
+		}
+
+		break;
+	}
+	case RT64_CAPTURE_CALL_CREATE_MESH: {
+		RT64_DEVICE *device = readObject<RT64_DEVICE>();
+		int flags = readValue<int>();
+		storeObject((device != nullptr) ? lib.CreateMesh(device, flags) : nullptr);
+		break;
+	}
+	case RT64_CAPTURE_CALL_SET_MESH: {
+		RT64_MESH *mesh = readObject<RT64_MESH>();
+		int vertexCount = readValue<int>();
+		int vertexStride = readValue<int>();
+		void *vertices = (void *)(readBlob());
+		int indexCount = readValue<int>();
+		unsigned int *indices = (unsigned int *)(readBlob());
+		if ((mesh != nullptr) && (vertices != nullptr) && (indices != nullptr)) {
+			lib.SetMesh(mesh, vertices, vertexCount, vertexStride, indices, indexCount);
+		}
+
+		break;
+	}
+	case RT64_CAPTURE_CALL_SET_MESH_RANGE: {
+		RT64_MESH *mesh = readObject<RT64_MESH>();
+		int vertexStart = readValue<int>();
+		int vertexCount = readValue<int>();
+		void *vertices = (void *)(readBlob());
+		if ((mesh != nullptr) && (vertices != nullptr)) {
+			lib.SetMeshRange(mesh, vertices, vertexStart, vertexCount);
+		}
+
+		break;
+	}
+	case RT64_CAPTURE_CALL_SET_MESH_VERTICES: {
+		RT64_MESH *mesh = readObject<RT64_MESH>();
+		int vertexCount = readValue<int>();
+		int vertexStride = readValue<int>();
+		const void *vertices = readBlob();
+		if ((mesh != nullptr) && (vertices != nullptr)) {
+			void *mappedVertices = lib.MapMeshVertices(mesh, vertexCount, vertexStride);
+			memcpy(mappedVertices, vertices, vertexCount * vertexStride);
+			lib.UnmapMeshVertices(mesh);
+		}
+
+		break;
+	}
+	case RT64_CAPTURE_CALL_SET_MESH_INDICES: {
+		RT64_MESH *mesh = readObject<RT64_MESH>();
+		int indexCount = readValue<int>();
+		const void *indices = readBlob();
+		if ((mesh != nullptr) && (indices != nullptr)) {
+			unsigned int *mappedIndices = lib.MapMeshIndices(mesh, indexCount);
+			memcpy(mappedIndices, indices, indexCount * sizeof(unsigned int));
+			lib.UnmapMeshIndices(mesh);
+		}
+
+		break;
+	}
+	case RT64_CAPTURE_CALL_DESTROY_MESH: {
+		RT64_MESH *mesh = readObject<RT64_MESH>();
+		if (mesh != nullptr) {
+			lib.DestroyMesh(mesh);
+		}
+
+		break;
+	}
+	case RT64_CAPTURE_CALL_CREATE_TEXTURE: {
+		RT64_DEVICE *device = readObject<RT64_DEVICE>();
+		bool async = readValue<uint8_t>() != 0;
+		RT64_TEXTURE_DESC textureDesc = readValue<RT64_TEXTURE_DESC>();
+		textureDesc.bytes = (void *)(readBlob());
+		RT64_TEXTURE *texture = nullptr;
+		if ((device != nullptr) && (textureDesc.bytes != nullptr)) {
+			texture = async ? lib.CreateTextureAsync(device, textureDesc) : lib.CreateTexture(device, textureDesc);
+		}
+
+		storeObject(texture);
+		break;
+	}
+	case RT64_CAPTURE_CALL_DESTROY_TEXTURE: {
+		RT64_TEXTURE *texture = readObject<RT64_TEXTURE>();
+		if (texture != nullptr) {
+			lib.DestroyTexture(texture);
+		}
+
+		break;
+	}
+	case RT64_CAPTURE_CALL_CREATE_SHADER: {
+		RT64_DEVICE *device = readObject<RT64_DEVICE>();
+		unsigned int shaderId = readValue<unsigned int>();
+		unsigned int filter = readValue<unsigned int>();
+		unsigned int hAddr = readValue<unsigned int>();
+		unsigned int vAddr = readValue<unsigned int>();
+		int flags = readValue<int>();
+		storeObject((device != nullptr) ? lib.CreateShader(device, shaderId, filter, hAddr, vAddr, flags) : nullptr);
+		break;
+	}
+	case RT64_CAPTURE_CALL_DESTROY_SHADER: {
+		RT64_SHADER *shader = readObject<RT64_SHADER>();
+		if (shader != nullptr) {
+			lib.DestroyShader(shader);
+		}
+
+		break;
+	}
+	case RT64_CAPTURE_CALL_CREATE_INSTANCE: {
+		RT64_SCENE *scene = readObject<RT64_SCENE>();
+		storeObject((scene != nullptr) ? lib.CreateInstance(scene) : nullptr);
+		break;
+	}
+	case RT64_CAPTURE_CALL_SET_INSTANCE_DESCRIPTION: {
+		RT64_INSTANCE *instance = readObject<RT64_INSTANCE>();
+		unsigned int fieldMask = readValue<uint32_t>();
+		RT64_INSTANCE_DESC instanceDesc = readInstanceDescription();
+		if (instance != nullptr) {
+			lib.UpdateInstanceDescription(instance, &instanceDesc, fieldMask);
+		}
+
+		break;
+	}
+	case RT64_CAPTURE_CALL_SET_INSTANCE_DESCRIPTIONS: {
+		int instanceCount = readValue<int>();
+		std::vector<RT64_INSTANCE *> instances;
+		std::vector<RT64_INSTANCE_DESC> instanceDescs;
+		for (int i = 0; i < instanceCount; i++) {
+			RT64_INSTANCE *instance = readObject<RT64_INSTANCE>();
+			RT64_INSTANCE_DESC instanceDesc = readInstanceDescription();
+			if (instance != nullptr) {
+				instances.push_back(instance);
+				instanceDescs.push_back(instanceDesc);
+			}
+		}
+
+		lib.SetInstanceDescriptions(instances.data(), instanceDescs.data(), (int)(instances.size()));
+		break;
+	}
+	case RT64_CAPTURE_CALL_DESTROY_INSTANCE: {
+		RT64_INSTANCE *instance = readObject<RT64_INSTANCE>();
+		if (instance != nullptr) {
+			lib.DestroyInstance(instance);
+		}
+
+		break;
+	}
+	default:
+		break;
+	}
+}
+
+static bool loadStream(const char *path) {
+	FILE *file = fopen(path, "rb");
+	if (file == nullptr) {
+		fprintf(stderr, "Unable to open %s.\n", path);
+		return false;
+	}
+
+	fseek(file, 0, SEEK_END);
+	long fileSize = ftell(file);
+	fseek(file, 0, SEEK_SET);
+	Replay.stream.resize(fileSize);
+	size_t readSize = fread(Replay.stream.data(), 1, fileSize, file);
+	fclose(file);
+
+	if ((readSize != (size_t)(fileSize)) || (readSize < sizeof(uint32_t) * 2)) {
+		fprintf(stderr, "Unable to read %s.\n", path);
+		return false;
+	}
+
+	uint32_t magic = readValue<uint32_t>();
+	uint32_t version = readValue<uint32_t>();
+	if ((magic != RT64_CAPTURE_MAGIC) || (version != RT64_CAPTURE_VERSION)) {
+		fprintf(stderr, "%s is not a supported capture.\n", path);
+		return false;
+	}
+
+	return true;
+}
+
+static void pumpMessages() {
+#ifdef _WIN32
+	if (Replay.hwnd == nullptr) {
+		return;
+	}
+
+	MSG msg = {};
+	while (PeekMessage(&msg, NULL, 0, 0, PM_REMOVE)) {
+		TranslateMessage(&msg);
+		DispatchMessage(&msg);
+	}
+#endif
+}
+
+static void replayStream() {
+	while ((Replay.streamOffset + sizeof(uint32_t) * 2) <= Replay.stream.size()) {
+		uint32_t call = readValue<uint32_t>();
+		uint32_t payloadSize = readValue<uint32_t>();
+		size_t nextOffset = Replay.streamOffset + payloadSize;
+		if (nextOffset > Replay.stream.size()) {
+			fprintf(stderr, "Capture is truncated.\n");
+			break;
+		}
+
+		auto startTime = std::chrono::high_resolution_clock::now();
+		replayCall(call, payloadSize);
+		double callMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - startTime).count();
+
+		// Skip any trailing data left in the payload by newer versions of the call.
+		Replay.streamOffset = nextOffset;
+
+		if (call < RT64_CAPTURE_CALL_MAX) {
+			Replay.callStats[call].count++;
+			Replay.callStats[call].totalMs += callMs;
+		}
+
+		if (call != RT64_CAPTURE_CALL_BLOB) {
+			Replay.frameMs += callMs;
+		}
+
+		// Every draw closes a frame.
+		if (call == RT64_CAPTURE_CALL_DRAW_DEVICE) {
+			if (Replay.checkAllocations && (Replay.frameTimes.size() >= AllocationWarmupFrames) && (Replay.frameAllocations != 0)) {
+				fprintf(stderr, "Frame %zu made %d allocations.\n", Replay.frameTimes.size(), Replay.frameAllocations);
+				Replay.allocatingFrames++;
+			}
+
+			Replay.frameTimes.push_back(Replay.frameMs);
+			Replay.frameMs = 0.0;
+			pumpMessages();
+		}
+	}
+}
+
+static void printStats() {
+	fprintf(stdout, "%-28s %10s %14s %14s\n", "Call", "Count", "Total (ms)", "Average (us)");
+	for (uint32_t call = 0; call < RT64_CAPTURE_CALL_MAX; call++) {
+		const CallStats &stats = Replay.callStats[call];
+		if ((call == RT64_CAPTURE_CALL_BLOB) || (stats.count == 0)) {
+			continue;
+		}
+
+		fprintf(stdout, "%-28s %10u %14.3f %14.3f\n", callName(call), stats.count, stats.totalMs, (stats.totalMs * 1000.0) / stats.count);
+	}
+
+	if (Replay.frameTimes.empty()) {
+		return;
+	}
+
+	std::vector<double> sortedTimes = Replay.frameTimes;
+	std::sort(sortedTimes.begin(), sortedTimes.end());
+	double totalMs = 0.0;
+	for (double frameTime : sortedTimes) {
+		totalMs += frameTime;
+	}
+
+	auto percentile = [&sortedTimes](double p) {
+		size_t index = std::min((size_t)(p * sortedTimes.size()), sortedTimes.size() - 1);
+		return sortedTimes[index];
+	};
+
+	fprintf(stdout, "\nFrames: %zu\n", sortedTimes.size());
+	fprintf(stdout, "Average: %.3f ms\n", totalMs / sortedTimes.size());
+	fprintf(stdout, "Minimum: %.3f ms\n", sortedTimes.front());
+	fprintf(stdout, "Median: %.3f ms\n", percentile(0.5));
+	fprintf(stdout, "99th percentile: %.3f ms\n", percentile(0.99));
+	fprintf(stdout, "Maximum: %.3f ms\n", sortedTimes.back());
+}
+
+#ifdef _WIN32
+static void createWindow() {
+	// Register window class.
+	WNDCLASS wc;
+	memset(&wc, 0, sizeof(WNDCLASS));
+	wc.lpfnWndProc = DefWindowProc;
+	wc.hInstance = GetModuleHandle(0);
+	wc.hbrBackground = (HBRUSH)(COLOR_BACKGROUND);
+	wc.lpszClassName = "RT64Replay";
+	RegisterClass(&wc);
+
+	// Create window.
+	const int Width = 1280;
+	const int Height = 720;
+	RECT rect;
+	UINT dwStyle = WS_OVERLAPPEDWINDOW | WS_VISIBLE;
+	rect.left = (GetSystemMetrics(SM_CXSCREEN) - Width) / 2;
+	rect.top = (GetSystemMetrics(SM_CYSCREEN) - Height) / 2;
+	rect.right = rect.left + Width;
+	rect.bottom = rect.top + Height;
+	AdjustWindowRectEx(&rect, dwStyle, 0, 0);
+	Replay.hwnd = CreateWindow(wc.lpszClassName, WINDOW_TITLE, dwStyle, rect.left, rect.top, rect.right - rect.left, rect.bottom - rect.top, 0, 0, wc.hInstance, NULL);
+}
+#endif
+
+int main(int argc, char *argv[]) {
+	// Checking the allocations requires a library built with RT64_COUNT_ALLOCATIONS.
+	int argIndex = 1;
+	while ((argIndex < argc) && (strncmp(argv[argIndex], "--", 2) == 0)) {
+		if (strcmp(argv[argIndex], "--check-allocations") == 0) {
+			Replay.checkAllocations = true;
+		}
+		else if (strcmp(argv[argIndex], "--stub") == 0) {
+			Replay.useStub = true;
+		}
+		else {
+			fprintf(stderr, "Unknown option %s.\n", argv[argIndex]);
+			return 1;
+		}
+
+		argIndex++;
+	}
+
+#ifndef _WIN32
+	Replay.useStub = true;
+#endif
+
+	if (argIndex >= argc) {
+		fprintf(stderr, "Usage: %s [--check-allocations] [--stub] <capture>\n", argv[0]);
+		return 1;
+	}
+
+	if (Replay.checkAllocations && Replay.useStub) {
+		fprintf(stderr, "Checking the allocations requires the library instead of the stub.\n");
+		return 1;
+	}
+
+	if (!loadStream(argv[argIndex])) {
+		return 1;
+	}
+
+	if (Replay.useStub) {
+		loadStubLibrary(Replay.lib);
+	}
+	else {
+#ifdef _WIN32
+		Replay.lib = RT64_LoadLibrary();
+		if (Replay.lib.handle == 0) {
+			fprintf(stderr, "Failed to load RT64 library.\n");
+			return 1;
+		}
+
+		createWindow();
+#endif
+	}
+
+	replayStream();
+	printStats();
+
+#ifdef _WIN32
+	if (!Replay.useStub) {
+		DestroyWindow(Replay.hwnd);
+		RT64_UnloadLibrary(Replay.lib);
+	}
+#endif
+
+	if (Replay.checkAllocations) {
+		if (Replay.frameAllocations < 0) {
+			fprintf(stderr, "The library was built without RT64_COUNT_ALLOCATIONS.\n");
+			return 1;
+		}
+		else if (Replay.allocatingFrames > 0) {
+			fprintf(stderr, "%u frames allocated memory after the first %u frames.\n", Replay.allocatingFrames, AllocationWarmupFrames);
+			return 1;
+		}
+
+		fprintf(stdout, "No allocations after the first %u frames.\n", AllocationWarmupFrames);
+	}
+
+	return 0;
+}
+
+#else
+
+int main(int argc, char *argv[]) {
+	fprintf(stderr, "Replaying captures is not supported by the minimal library.\n");
+	return 1;
+}
+
+#endif
@@ -0,0 +1,293 @@
+//
+// RT64 REPLAY
+//
+
+#include "stub_library.h"
+
+#ifndef RT64_MINIMAL
+
+#include <string.h>
+
+#include <vector>
+
+namespace {
+	struct StubObject {
+		std::vector<unsigned char> vertices;
+		size_t vertexStride = 0;
+		std::vector<unsigned int> indices;
+		std::vector<RT64_LIGHT> lights;
+	};
+
+	template<typename T>
+	T *createObject() {
+		return (T *)(new StubObject());
+	}
+
+	void destroyObject(void *object) {
+		delete (StubObject *)(object);
+	}
+
+	StubObject *toObject(void *object) {
+		return (StubObject *)(object);
+	}
+
+	const char *stubGetLastError() {
+		return "";
+	}
+
+	RT64_DEVICE *stubCreateDevice(void *hwnd) {
+		return createObject<RT64_DEVICE>();
+	}
+
+	void stubDestroyDevice(RT64_DEVICE *device) {
+		destroyObject(device);
+	}
+
+	void stubDrawDevice(RT64_DEVICE *device, int vsyncInterval, float deltaTimeMs) { }
+
+	void stubSetDeviceRenderThread(RT64_DEVICE *device, bool enabled) { }
+
+	void stubGetFrameStats(RT64_DEVICE *device, RT64_FRAME_STATS *frameStats) {
+		memset(frameStats, 0, sizeof(RT64_FRAME_STATS));
+		frameStats->cpuAllocationCount = -1;
+	}
+
+	void stubGetMemoryStats(RT64_DEVICE *device, RT64_MEMORY_STATS *memoryStats) {
+		memset(memoryStats, 0, sizeof(RT64_MEMORY_STATS));
+	}
+
+	void stubSetMemoryBudgetCallback(RT64_DEVICE *device, unsigned long long thresholdBytes, RT64_MEMORY_BUDGET_CALLBACK callback, void *userData) { }
+
+	RT64_VIEW *stubCreateView(RT64_SCENE *scene) {
+		return createObject<RT64_VIEW>();
+	}
+
+	void stubSetViewPerspective(RT64_VIEW *view, RT64_MATRIX4 viewMatrix, float fovRadians, float nearDist, float farDist, bool canReproject) { }
+
+	void stubSetViewDescription(RT64_VIEW *view, RT64_VIEW_DESC viewDesc) { }
+
+	void stubSetViewSkyPlane(RT64_VIEW *view, RT64_TEXTURE *texture) { }
+
+	RT64_INSTANCE *stubGetViewRaytracedInstanceAt(RT64_VIEW *view, int x, int y) {
+		return nullptr;
+	}
+
+	bool stubGetViewUpscalerSupport(RT64_VIEW *view, char upscaler) {
+		return false;
+	}
+
+	void stubDestroyView(RT64_VIEW *view) {
+		destroyObject(view);
+	}
+
+	RT64_SCENE *stubCreateScene(RT64_DEVICE *device) {
+		return createObject<RT64_SCENE>();
+	}
+
+	void stubSetSceneDescription(RT64_SCENE *scene, RT64_SCENE_DESC sceneDesc) { }
+
+	void stubSetSceneLights(RT64_SCENE *scene, RT64_LIGHT *lightArray, int lightCount) {
+		toObject(scene)->lights.assign(lightArray, lightArray + lightCount);
+	}
+
+	void stubSetSceneInterpolation(RT64_SCENE *scene, bool enabled, float factor) { }
+
+	void stubDestroyScene(RT64_SCENE *scene) {
+		destroyObject(scene);
+	}
+
+	RT64_MESH *stubCreateMesh(RT64_DEVICE *device, int flags) {
+		return createObject<RT64_MESH>();
+	}
+
+	void stubSetMesh(RT64_MESH *mesh, void *vertexArray, int vertexCount, int vertexStride, unsigned int *indexArray, int indexCount) {
+		StubObject *object = toObject(mesh);
+		const unsigned char *vertexBytes = (const unsigned char *)(vertexArray);
+		object->vertices.assign(vertexBytes, vertexBytes + (size_t)(vertexCount) * vertexStride);
+		object->vertexStride = (size_t)(vertexStride);
+		object->indices.assign(indexArray, indexArray + indexCount);
+	}
+
+	void stubSetMeshRange(RT64_MESH *mesh, void *vertexArray, int vertexStart, int vertexCount) {
+		// Ranges use the stride of the last full upload and must fit inside of it, like the library requires.
+		StubObject *object = toObject(mesh);
+		size_t rangeOffset = (size_t)(vertexStart) * object->vertexStride;
+		size_t rangeSize = (size_t)(vertexCount) * object->vertexStride;
+		if ((rangeSize > 0) && ((rangeOffset + rangeSize) <= object->vertices.size())) {
+			memcpy(&object->vertices[rangeOffset], vertexArray, rangeSize);
+		}
+	}
+
+	void *stubMapMeshVertices(RT64_MESH *mesh, int vertexCount, int vertexStride) {
+		StubObject *object = toObject(mesh);
+		object->vertices.resize((size_t)(vertexCount) * vertexStride);
+		object->vertexStride = (size_t)(vertexStride);
+		return object->vertices.data();
+	}
+
+	void stubUnmapMeshVertices(RT64_MESH *mesh) { }
+
+	unsigned int *stubMapMeshIndices(RT64_MESH *mesh, int indexCount) {
+		StubObject *object = toObject(mesh);
+		object->indices.resize(indexCount);
+		return object->indices.data();
+	}
+
+	void stubUnmapMeshIndices(RT64_MESH *mesh) { }
+
+	void stubDestroyMesh(RT64_MESH *mesh) {
+		destroyObject(mesh);
+	}
+
+	RT64_SHADER *stubCreateShader(RT64_DEVICE *device, unsigned int shaderId, unsigned int filter, unsigned int hAddr, unsigned int vAddr, int flags) {
+		return createObject<RT64_SHADER>();
+	}
+
+	void stubDestroyShader(RT64_SHADER *shader) {
+		destroyObject(shader);
+	}
+
+	RT64_INSTANCE *stubCreateInstance(RT64_SCENE *scene) {
+		return createObject<RT64_INSTANCE>();
+	}
+
+	void stubSetInstanceDescription(RT64_INSTANCE *instance, RT64_INSTANCE_DESC instanceDesc) { }
+
+	void stubSetInstanceDescriptions(RT64_INSTANCE **instances, const RT64_INSTANCE_DESC *instanceDescs, int instanceCount) { }
+
+	void stubUpdateInstanceDescription(RT64_INSTANCE *instance, const RT64_INSTANCE_DESC *instanceDesc, unsigned int fieldMask) { }
+
+	void stubDestroyInstance(RT64_INSTANCE *instance) {
+		destroyObject(instance);
+	}
+
+	void stubBeginFrame(RT64_SCENE *scene) { }
+
+	void stubSubmitDraw(RT64_SCENE *scene, const RT64_DRAW_DESC *drawDesc) { }
+
+	void stubEndFrame(RT64_SCENE *scene) { }
+
+	RT64_TEXTURE *stubCreateTexture(RT64_DEVICE *device, RT64_TEXTURE_DESC textureDesc) {
+		StubObject *object = new StubObject();
+		const unsigned char *textureBytes = (const unsigned char *)(textureDesc.bytes);
+		object->vertices.assign(textureBytes, textureBytes + textureDesc.byteCount);
+		return (RT64_TEXTURE *)(object);
+	}
+
+	bool stubIsTextureReady(RT64_TEXTURE *texture) {
+		return true;
+	}
+
+	void stubDestroyTexture(RT64_TEXTURE *texture) {
+		destroyObject(texture);
+	}
+
+	RT64_INSPECTOR *stubCreateInspector(RT64_DEVICE *device) {
+		return createObject<RT64_INSPECTOR>();
+	}
+
+	bool stubHandleMessageInspector(RT64_INSPECTOR *inspector, UINT msg, WPARAM wParam, LPARAM lParam) {
+		return false;
+	}
+
+	void stubSetSceneInspector(RT64_INSPECTOR *inspector, RT64_SCENE_DESC *sceneDesc) { }
+
+	void stubSetMaterialInspector(RT64_INSPECTOR *inspector, RT64_MATERIAL *material, const char *materialName) { }
+
+	void stubSetLightsInspector(RT64_INSPECTOR *inspector, RT64_LIGHT *lights, int *lightCount, int maxLightCount) { }
+
+	void stubPrintClearInspector(RT64_INSPECTOR *inspector) { }
+
+	void stubPrintMessageInspector(RT64_INSPECTOR *inspector, const char *message) { }
+
+	void stubDestroyInspector(RT64_INSPECTOR *inspector) {
+		destroyObject(inspector);
+	}
+
+	RT64_RECORDER *stubCreateRecorder(RT64_DEVICE *device) {
+		return createObject<RT64_RECORDER>();
+	}
+
+	void stubRecordInstanceDescription(RT64_RECORDER *recorder, RT64_INSTANCE *instance, const RT64_INSTANCE_DESC *instanceDesc, unsigned int fieldMask) { }
+
+	void stubRecordMesh(RT64_RECORDER *recorder, RT64_MESH *mesh, void *vertexArray, int vertexCount, int vertexStride, unsigned int *indexArray, int indexCount) {
+		stubSetMesh(mesh, vertexArray, vertexCount, vertexStride, indexArray, indexCount);
+	}
+
+	void stubRecordSceneLights(RT64_RECORDER *recorder, RT64_SCENE *scene, RT64_LIGHT *lightArray, int lightCount) {
+		stubSetSceneLights(scene, lightArray, lightCount);
+	}
+
+	void stubDestroyRecorder(RT64_RECORDER *recorder) {
+		destroyObject(recorder);
+	}
+
+	bool stubStartCapture(const char *path) {
+		return false;
+	}
+
+	void stubStopCapture() { }
+}
+
+void loadStubLibrary(RT64_LIBRARY &lib) {
+	memset(&lib, 0, sizeof(RT64_LIBRARY));
+	lib.GetLastError = stubGetLastError;
+	lib.CreateDevice = stubCreateDevice;
+	lib.DestroyDevice = stubDestroyDevice;
+	lib.DrawDevice = stubDrawDevice;
+	lib.SetDeviceRenderThread = stubSetDeviceRenderThread;
+	lib.GetFrameStats = stubGetFrameStats;
+	lib.GetMemoryStats = stubGetMemoryStats;
+	lib.SetMemoryBudgetCallback = stubSetMemoryBudgetCallback;
+	lib.CreateView = stubCreateView;
+	lib.SetViewPerspective = stubSetViewPerspective;
+	lib.SetViewDescription = stubSetViewDescription;
+	lib.SetViewSkyPlane = stubSetViewSkyPlane;
+	lib.GetViewRaytracedInstanceAt = stubGetViewRaytracedInstanceAt;
+	lib.GetViewUpscalerSupport = stubGetViewUpscalerSupport;
+	lib.DestroyView = stubDestroyView;
+	lib.CreateScene = stubCreateScene;
+	lib.SetSceneDescription = stubSetSceneDescription;
+	lib.SetSceneLights = stubSetSceneLights;
+	lib.SetSceneInterpolation = stubSetSceneInterpolation;
+	lib.DestroyScene = stubDestroyScene;
+	lib.CreateMesh = stubCreateMesh;
+	lib.SetMesh = stubSetMesh;
+	lib.SetMeshRange = stubSetMeshRange;
+	lib.MapMeshVertices = stubMapMeshVertices;
+	lib.UnmapMeshVertices = stubUnmapMeshVertices;
+	lib.MapMeshIndices = stubMapMeshIndices;
+	lib.UnmapMeshIndices = stubUnmapMeshIndices;
+	lib.DestroyMesh = stubDestroyMesh;
+	lib.CreateShader = stubCreateShader;
+	lib.DestroyShader = stubDestroyShader;
+	lib.CreateInstance = stubCreateInstance;
+	lib.SetInstanceDescription = stubSetInstanceDescription;
+	lib.SetInstanceDescriptions = stubSetInstanceDescriptions;
+	lib.UpdateInstanceDescription = stubUpdateInstanceDescription;
+	lib.DestroyInstance = stubDestroyInstance;
+	lib.BeginFrame = stubBeginFrame;
+	lib.SubmitDraw = stubSubmitDraw;
+	lib.EndFrame = stubEndFrame;
+	lib.CreateTexture = stubCreateTexture;
+	lib.CreateTextureAsync = stubCreateTexture;
+	lib.IsTextureReady = stubIsTextureReady;
+	lib.DestroyTexture = stubDestroyTexture;
+	lib.CreateInspector = stubCreateInspector;
+	lib.HandleMessageInspector = stubHandleMessageInspector;
+	lib.SetSceneInspector = stubSetSceneInspector;
+	lib.SetMaterialInspector = stubSetMaterialInspector;
+	lib.SetLightsInspector = stubSetLightsInspector;
+	lib.PrintClearInspector = stubPrintClearInspector;
+	lib.PrintMessageInspector = stubPrintMessageInspector;
+	lib.DestroyInspector = stubDestroyInspector;
+	lib.CreateRecorder = stubCreateRecorder;
+	lib.RecordInstanceDescription = stubRecordInstanceDescription;
+	lib.RecordMesh = stubRecordMesh;
+	lib.RecordSceneLights = stubRecordSceneLights;
+	lib.DestroyRecorder = stubDestroyRecorder;
+	lib.StartCapture = stubStartCapture;
+	lib.StopCapture = stubStopCapture;
+}
+
+#endif
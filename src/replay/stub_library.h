@@ -0,0 +1,15 @@
+//
+// RT64 REPLAY
+//
+
+#pragma once
+
+#include "rt64.h"
+
+#ifndef RT64_MINIMAL
+
+// Fills the library with functions that accept every call without creating a device, so a capture can be replayed headless.
+// Objects are plain allocations that keep the data handed to them, so the replay still reads and copies every payload.
+void loadStubLibrary(RT64_LIBRARY &lib);
+
+#endif
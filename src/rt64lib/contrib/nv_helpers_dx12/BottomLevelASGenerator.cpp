@@ -41,6 +41,10 @@ Contacts for feedback:
 
 namespace nv_helpers_dx12 {
 
+void BottomLevelASGenerator::Reset() {
+	m_vertexBuffers.clear();
+}
+
 //--------------------------------------------------------------------------------------------------
 // Add a vertex buffer in GPU memory into the acceleration structure. The
 // vertices are supposed to be represented by 3 float32 value
@@ -78,6 +78,8 @@ namespace nv_helpers_dx12
 class BottomLevelASGenerator
 {
 public:
+  void Reset();
+
   /// Add a vertex buffer in GPU memory into the acceleration structure. The
   /// vertices are supposed to be represented by 3 float32 value. Indices are
   /// implicit.
@@ -101,6 +101,28 @@ void TopLevelASGenerator::ComputeASBufferSizes(
                                              // descriptors, containing the matrices,
                                              // indices etc.
 )
+{
+  ComputeASBufferSizes(device, allowUpdate, static_cast<UINT>(m_instances.size()),
+                       scratchSizeInBytes, resultSizeInBytes, descriptorsSizeInBytes);
+}
+
+//--------------------------------------------------------------------------------------------------
+//
+// Same as above, for an application that writes the instance descriptors
+// itself and builds the acceleration structure with Build instead of Generate
+void TopLevelASGenerator::ComputeASBufferSizes(
+    ID3D12Device8* device, // Device on which the build will be performed
+    bool allowUpdate,                        // If true, the resulting acceleration structure will
+                                             // allow iterative updates
+    UINT instanceCount,                      // Number of instances in the acceleration structure
+    UINT64* scratchSizeInBytes,              // Required scratch memory on the GPU to build
+                                             // the acceleration structure
+    UINT64* resultSizeInBytes,               // Required GPU memory to store the acceleration
+                                             // structure
+    UINT64* descriptorsSizeInBytes           // Required GPU memory to store instance
+                                             // descriptors, containing the matrices,
+                                             // indices etc.
+)
 {
   // The generated AS can support iterative updates. This may change the final
   // size of the AS as well as the temporary memory requirements, and hence has
@@ -113,7 +135,7 @@ void TopLevelASGenerator::ComputeASBufferSizes(
   D3D12_BUILD_RAYTRACING_ACCELERATION_STRUCTURE_INPUTS prebuildDesc = {};
   prebuildDesc.Type = D3D12_RAYTRACING_ACCELERATION_STRUCTURE_TYPE_TOP_LEVEL;
   prebuildDesc.DescsLayout = D3D12_ELEMENTS_LAYOUT_ARRAY;
-  prebuildDesc.NumDescs = static_cast<UINT>(m_instances.size());
+  prebuildDesc.NumDescs = instanceCount;
   prebuildDesc.Flags = m_flags;
 
   // This structure is used to hold the sizes of the required scratch memory and
@@ -132,12 +154,20 @@ void TopLevelASGenerator::ComputeASBufferSizes(
   info.ScratchDataSizeInBytes =
       ROUND_UP(info.ScratchDataSizeInBytes, D3D12_CONSTANT_BUFFER_DATA_PLACEMENT_ALIGNMENT);
 
+  // The same scratch buffer is used for the updates, which can require more memory than the build
+  UINT64 updateScratchSizeInBytes =
+      ROUND_UP(info.UpdateScratchDataSizeInBytes, D3D12_CONSTANT_BUFFER_DATA_PLACEMENT_ALIGNMENT);
+  if (allowUpdate && (updateScratchSizeInBytes > info.ScratchDataSizeInBytes))
+  {
+    info.ScratchDataSizeInBytes = updateScratchSizeInBytes;
+  }
+
   m_resultSizeInBytes = info.ResultDataMaxSizeInBytes;
   m_scratchSizeInBytes = info.ScratchDataSizeInBytes;
   // The instance descriptors are stored as-is in GPU memory, so we can deduce
   // the required size from the instance count
   m_instanceDescsSizeInBytes =
-      ROUND_UP(sizeof(D3D12_RAYTRACING_INSTANCE_DESC) * static_cast<UINT64>(m_instances.size()),
+      ROUND_UP(sizeof(D3D12_RAYTRACING_INSTANCE_DESC) * static_cast<UINT64>(instanceCount),
                D3D12_CONSTANT_BUFFER_DATA_PLACEMENT_ALIGNMENT);
 
   *scratchSizeInBytes = m_scratchSizeInBytes;
@@ -204,6 +234,28 @@ void TopLevelASGenerator::Generate(
 
   descriptorsBuffer->Unmap(0, nullptr);
 
+  Build(commandList, scratchBuffer, resultBuffer, descriptorsBuffer, instanceCount, updateOnly, previousResult);
+}
+
+//--------------------------------------------------------------------------------------------------
+//
+// Enqueue the construction of the acceleration structure from instance
+// descriptors the application already wrote to the descriptors buffer.
+// Generate calls this after writing the descriptors of the added instances
+void TopLevelASGenerator::Build(
+    ID3D12GraphicsCommandList4* commandList, // Command list on which the build will be enqueued
+    ID3D12Resource* scratchBuffer,     // Scratch buffer used by the builder to
+                                       // store temporary data
+    ID3D12Resource* resultBuffer,      // Result buffer storing the acceleration structure
+    ID3D12Resource* descriptorsBuffer, // Buffer containing the instance descriptors
+    UINT instanceCount,                // Number of descriptors in the buffer
+    bool updateOnly /*= false*/,       // If true, simply refit the existing
+                                       // acceleration structure
+    ID3D12Resource* previousResult /*= nullptr*/ // Optional previous acceleration
+                                                 // structure, used if an iterative update
+                                                 // is requested
+)
+{
   // If this in an update operation we need to provide the source buffer
   D3D12_GPU_VIRTUAL_ADDRESS pSourceAS = updateOnly ? previousResult->GetGPUVirtualAddress() : 0;
 
@@ -117,6 +117,22 @@ public:
                                      /// indices etc.
   );
 
+  /// Same as above, for an application that writes the instance descriptors
+  /// itself and builds the acceleration structure with Build instead of Generate
+  void ComputeASBufferSizes(
+      ID3D12Device8* device, /// Device on which the build will be performed
+      bool allowUpdate,              /// If true, the resulting acceleration structure will
+                                     /// allow iterative updates
+      UINT instanceCount,            /// Number of instances in the acceleration structure
+      UINT64* scratchSizeInBytes,    /// Required scratch memory on the GPU to
+                                     /// build the acceleration structure
+      UINT64* resultSizeInBytes,     /// Required GPU memory to store the
+                                     /// acceleration structure
+      UINT64* descriptorsSizeInBytes /// Required GPU memory to store instance
+                                     /// descriptors, containing the matrices,
+                                     /// indices etc.
+  );
+
   /// Enqueue the construction of the acceleration structure on a command list,
   /// using application-provided buffers and possibly a pointer to the previous
   /// acceleration structure in case of iterative updates. Note that the update
@@ -134,6 +150,21 @@ public:
                                                /// if an iterative update is requested
   );
 
+  /// Enqueue the construction of the acceleration structure from instance
+  /// descriptors the application already wrote to the descriptors buffer.
+  /// Generate calls this after writing the descriptors of the added instances
+  void Build(
+      ID3D12GraphicsCommandList4* commandList, /// Command list on which the build will be enqueued
+      ID3D12Resource* scratchBuffer,     /// Scratch buffer used by the builder to
+                                         /// store temporary data
+      ID3D12Resource* resultBuffer,      /// Result buffer storing the acceleration structure
+      ID3D12Resource* descriptorsBuffer, /// Buffer containing the instance descriptors
+      UINT instanceCount,                /// Number of descriptors in the buffer
+      bool updateOnly = false, /// If true, simply refit the existing acceleration structure
+      ID3D12Resource* previousResult = nullptr /// Optional previous acceleration structure, used
+                                               /// if an iterative update is requested
+  );
+
 private:
   /// Helper struct storing the instance data
   struct Instance
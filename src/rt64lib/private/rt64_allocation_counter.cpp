@@ -0,0 +1,55 @@
+//
+// RT64
+//
+
+#include "rt64_allocation_counter.h"
+
+#ifdef RT64_COUNT_ALLOCATIONS
+
+#include <atomic>
+#include <new>
+#include <stdlib.h>
+
+namespace {
+	std::atomic<uint64_t> AllocationCount(0);
+};
+
+// The array and non-throwing versions of the operators forward to these ones by default.
+
+void *operator new(size_t size) {
+	AllocationCount.fetch_add(1, std::memory_order_relaxed);
+	void *ptr = malloc((size > 0) ? size : 1);
+	if (ptr == nullptr) {
+		throw std::bad_alloc();
+	}
+
+	return ptr;
+}
+
+void operator delete(void *ptr) noexcept {
+	free(ptr);
+}
+
+void operator delete(void *ptr, size_t size) noexcept {
+	free(ptr);
+}
+
+#endif
+
+// Private
+
+bool RT64::AllocationCounter::isEnabled() {
+#ifdef RT64_COUNT_ALLOCATIONS
+	return true;
+#else
+	return false;
+#endif
+}
+
+uint64_t RT64::AllocationCounter::getCount() {
+#ifdef RT64_COUNT_ALLOCATIONS
+	return AllocationCount.load(std::memory_order_relaxed);
+#else
+	return 0;
+#endif
+}
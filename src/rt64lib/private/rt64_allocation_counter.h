@@ -0,0 +1,17 @@
+//
+// RT64
+//
+
+#pragma once
+
+#include <stdint.h>
+
+namespace RT64 {
+	// Counts the heap allocations made by the library so the frame loop can be checked for allocations. Counting
+	// replaces the global allocation operators of the module, so it's only compiled in when RT64_COUNT_ALLOCATIONS is defined.
+	class AllocationCounter {
+	public:
+		static bool isEnabled();
+		static uint64_t getCount();
+	};
+};
@@ -0,0 +1,158 @@
+//
+// RT64
+//
+
+#ifndef RT64_MINIMAL
+
+#include "rt64_capture.h"
+
+#include "xxhash/xxhash64.h"
+
+namespace RT64 {
+	Capture *GlobalCapture = nullptr;
+	std::atomic<int> GlobalDeviceCount(0);
+};
+
+// Private
+
+RT64::Capture::Capture() {
+	file = nullptr;
+	callId = 0;
+	nextObjectId = 1;
+}
+
+RT64::Capture::~Capture() {
+	close();
+}
+
+bool RT64::Capture::open(const char *path) {
+	assert(file == nullptr);
+	file = fopen(path, "wb");
+	if (file == nullptr) {
+		return false;
+	}
+
+	const uint32_t header[2] = { RT64_CAPTURE_MAGIC, RT64_CAPTURE_VERSION };
+	fwrite(header, sizeof(header), 1, file);
+	return true;
+}
+
+void RT64::Capture::close() {
+	if (file != nullptr) {
+		fclose(file);
+		file = nullptr;
+	}
+
+	objectIds.clear();
+	writtenBlobs.clear();
+	nextObjectId = 1;
+}
+
+void RT64::Capture::writeRecord(uint32_t call, const void *data, size_t size) {
+	const uint32_t recordHeader[2] = { call, (uint32_t)(size) };
+	fwrite(recordHeader, sizeof(recordHeader), 1, file);
+	if (size > 0) {
+		fwrite(data, size, 1, file);
+	}
+}
+
+void RT64::Capture::beginCall(uint32_t call) {
+	assert(call < RT64_CAPTURE_CALL_MAX);
+	callId = call;
+	callData.clear();
+}
+
+void RT64::Capture::endCall() {
+	// Blobs referenced by the call have already been written, so the call can be read back in a single pass.
+	writeRecord(callId, callData.data(), callData.size());
+}
+
+void RT64::Capture::writeData(const void *data, size_t size) {
+	const uint8_t *bytes = (const uint8_t *)(data);
+	callData.insert(callData.end(), bytes, bytes + size);
+}
+
+void RT64::Capture::writeObject(const void *object) {
+	uint32_t objectId = 0;
+	if (object != nullptr) {
+		auto it = objectIds.find(object);
+		if (it != objectIds.end()) {
+			objectId = it->second;
+		}
+		else {
+			objectId = nextObjectId++;
+			objectIds[object] = objectId;
+		}
+	}
+
+	writeValue(objectId);
+}
+
+void RT64::Capture::writeBlob(const void *data, size_t size) {
+	uint64_t hash = 0;
+	if ((data != nullptr) && (size > 0)) {
+		hash = XXHash64::hash(data, size, 0);
+
+		// Identical data is only stored the first time it's seen.
+		if (writtenBlobs.find(hash) == writtenBlobs.end()) {
+			std::vector<uint8_t> blobData(sizeof(hash) + size);
+			memcpy(blobData.data(), &hash, sizeof(hash));
+			memcpy(blobData.data() + sizeof(hash), data, size);
+			writeRecord(RT64_CAPTURE_CALL_BLOB, blobData.data(), blobData.size());
+			writtenBlobs.insert(hash);
+		}
+	}
+
+	writeValue(hash);
+}
+
+void RT64::Capture::forgetObject(const void *object) {
+	objectIds.erase(object);
+}
+
+void RT64::Capture::writeInstanceDescription(const RT64_INSTANCE_DESC &instanceDesc) {
+	RT64_INSTANCE_DESC storedDesc = instanceDesc;
+	storedDesc.mesh = nullptr;
+	storedDesc.diffuseTexture = nullptr;
+	storedDesc.normalTexture = nullptr;
+	storedDesc.specularTexture = nullptr;
+	storedDesc.shader = nullptr;
+	writeValue(storedDesc);
+	writeObject(instanceDesc.mesh);
+	writeObject(instanceDesc.diffuseTexture);
+	writeObject(instanceDesc.normalTexture);
+	writeObject(instanceDesc.specularTexture);
+	writeObject(instanceDesc.shader);
+}
+
+// Public
+
+DLLEXPORT bool RT64_StartCapture(const char *path) {
+	assert(path != nullptr);
+	if (RT64::GlobalCapture != nullptr) {
+		RT64::GlobalLastError = "A capture is already in progress.";
+		return false;
+	}
+
+	if (RT64::GlobalDeviceCount > 0) {
+		RT64::GlobalLastError = "Captures must be started before any device is created.";
+		return false;
+	}
+
+	RT64::Capture *capture = new RT64::Capture();
+	if (!capture->open(path)) {
+		RT64::GlobalLastError = "Unable to open the capture file.";
+		delete capture;
+		return false;
+	}
+
+	RT64::GlobalCapture = capture;
+	return true;
+}
+
+DLLEXPORT void RT64_StopCapture() {
+	delete RT64::GlobalCapture;
+	RT64::GlobalCapture = nullptr;
+}
+
+#endif
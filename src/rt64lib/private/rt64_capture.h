@@ -0,0 +1,51 @@
+//
+// RT64
+//
+
+#pragma once
+
+#include "rt64_common.h"
+
+#include <atomic>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "../public/rt64_capture.h"
+
+namespace RT64 {
+	// Records the public API calls into a binary stream that can be replayed later.
+	class Capture {
+	private:
+		FILE *file;
+		std::vector<uint8_t> callData;
+		uint32_t callId;
+		std::unordered_map<const void *, uint32_t> objectIds;
+		uint32_t nextObjectId;
+		std::unordered_set<uint64_t> writtenBlobs;
+
+		void writeRecord(uint32_t call, const void *data, size_t size);
+	public:
+		Capture();
+		virtual ~Capture();
+		bool open(const char *path);
+		void close();
+		void beginCall(uint32_t call);
+		void endCall();
+		void writeData(const void *data, size_t size);
+		void writeObject(const void *object);
+		void writeBlob(const void *data, size_t size);
+		void forgetObject(const void *object);
+
+		template<typename T>
+		void writeValue(const T &value) {
+			writeData(&value, sizeof(T));
+		}
+
+		void writeInstanceDescription(const RT64_INSTANCE_DESC &instanceDesc);
+	};
+
+	extern Capture *GlobalCapture;
+
+	// Devices alive in the process. A capture can't describe the objects created before it started, so it can only start when there are none.
+	extern std::atomic<int> GlobalDeviceCount;
+};
@@ -23,6 +23,9 @@
 
 #include "../public/rt64.h"
 
+#include "rt64_generation.h"
+#include "rt64_memory_tracker.h"
+
 #define DLLEXPORT extern "C" __declspec(dllexport)  
 
 using namespace DirectX;
@@ -31,7 +34,14 @@ using namespace DirectX;
 #define UAV_INDEX(x) (int)(RT64::UAVIndices::x)
 #define SRV_INDEX(x) (int)(RT64::SRVIndices::x)
 #define CBV_INDEX(x) (int)(RT64::CBVIndices::x)
-#define SRV_TEXTURES_MAX 512
+
+// The bindless range is unbounded in the root signatures and the shaders, as the heaps grow with the slots in use.
+// Unbounded ranges must be the last ones of the descriptor tables.
+#define SRV_BINDLESS_UNBOUNDED UINT_MAX
+
+// The buffers of raytraced meshes take slots out of the same range as the textures. The hit groups see that range a second
+// time as raw buffers in their own register space.
+#define SRV_GEOMETRY_BUFFERS_SPACE 1
 
 namespace RT64 {
 	// Matches order in heap used in shader binding table.
@@ -69,7 +79,13 @@ namespace RT64 {
 		SceneLights,
 		instanceTransforms,
 		instanceMaterials,
+		instanceMaterialIndices,
+		instanceGeometry,
 		gBlueNoise,
+
+		// Start of the bindless range. It holds the Texture2D SRVs of the textures and the raw buffer SRVs of the raytraced
+		// meshes, which share the slots handed out by the device. Shaders read it as gTextures in space 0 and as
+		// gGeometryBuffers in SRV_GEOMETRY_BUFFERS_SPACE, so every slot must only be read through the view that matches it.
 		gTextures,
 		MAX
 	};
@@ -108,11 +124,11 @@ namespace RT64 {
 	enum class SRVIndices : int {
 		SceneBVH,
 		gBackground,
-		vertexBuffer,
-		indexBuffer,
 		SceneLights,
 		instanceTransforms,
 		instanceMaterials,
+		instanceMaterialIndices,
+		instanceGeometry,
 		gBlueNoise,
 		gTextures
 	};
@@ -167,13 +183,19 @@ namespace RT64 {
 	class AllocatedResource {
 	private:
 		D3D12MA::Allocation *d3dMaAllocation;
+		MemoryTracker *memoryTracker;
+		uint64_t generation;
 	public:
 		AllocatedResource() {
 			d3dMaAllocation = nullptr;
+			memoryTracker = nullptr;
+			generation = Generation::None;
 		}
 
-		AllocatedResource(D3D12MA::Allocation *d3dMaAllocation) {
+		AllocatedResource(D3D12MA::Allocation *d3dMaAllocation, MemoryTracker *memoryTracker = nullptr) {
 			this->d3dMaAllocation = d3dMaAllocation;
+			this->memoryTracker = memoryTracker;
+			generation = Generation::next();
 		}
 
 		~AllocatedResource() { }
@@ -197,12 +219,22 @@ namespace RT64 {
 			return (d3dMaAllocation == nullptr);
 		}
 
+		// Every allocation gets a different generation, even if it's placed where a released one used to be.
+		inline uint64_t GetGeneration() const {
+			return generation;
+		}
+
 		void Release() {
 			if (!IsNull()) {
+				if (memoryTracker != nullptr) {
+					memoryTracker->remove(d3dMaAllocation);
+				}
+
 				ID3D12Resource *d3dResource = d3dMaAllocation->GetResource();
 				d3dMaAllocation->Release();
 				d3dResource->Release();
 				d3dMaAllocation = nullptr;
+				generation = Generation::None;
 			}
 		}
 	};
@@ -213,6 +245,12 @@ namespace RT64 {
 		XMMATRIX objectToWorldPrevious;
 	};
 
+	// Slots of the mesh buffers used by a raytraced instance, indexed by the instance ID in the hit groups.
+	struct InstanceGeometry {
+		uint32_t vertexBufferIndex;
+		uint32_t indexBufferIndex;
+	};
+
 	struct AccelerationStructureBuffers {
 		AllocatedResource scratch;
 		UINT64 scratchSize;
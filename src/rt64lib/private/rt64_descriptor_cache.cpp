@@ -0,0 +1,48 @@
+//
+// RT64
+//
+
+#include "rt64_descriptor_cache.h"
+
+#include <assert.h>
+#include <string.h>
+
+// Private
+
+void RT64::DescriptorCache::resize(size_t slotCount) {
+	slots.resize(slotCount);
+	invalidate();
+}
+
+void RT64::DescriptorCache::invalidate() {
+	for (Slot &slot : slots) {
+		slot.valid = false;
+	}
+}
+
+size_t RT64::DescriptorCache::size() const {
+	return slots.size();
+}
+
+bool RT64::DescriptorCache::write(DescriptorWriter *writer, DescriptorWriter::Type type, uint32_t slot, void *resource, uint64_t generation, const void *desc, size_t descSize) {
+	assert(writer != nullptr);
+	assert(slot < slots.size());
+	assert(descSize <= MaxDescSize);
+
+	// The descriptions must be zero-initialized by the caller so the padding doesn't make identical ones look different.
+	Slot &cached = slots[slot];
+	if (cached.valid && (cached.type == type) && (cached.resource == resource) && (cached.generation == generation) &&
+		(cached.descSize == descSize) && (memcmp(cached.desc, desc, descSize) == 0))
+	{
+		return false;
+	}
+
+	writer->write(type, slot, resource, desc);
+	cached.type = type;
+	cached.resource = resource;
+	cached.generation = generation;
+	cached.descSize = descSize;
+	memcpy(cached.desc, desc, descSize);
+	cached.valid = true;
+	return true;
+}
@@ -0,0 +1,57 @@
+//
+// RT64
+//
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+namespace RT64 {
+	// Destination of the descriptors the cache decides to write. The slot is relative to the start of the heap.
+	class DescriptorWriter {
+	public:
+		enum class Type {
+			ShaderResource,
+			UnorderedAccess,
+			ConstantBuffer
+		};
+
+		virtual ~DescriptorWriter() { }
+		virtual void write(Type type, uint32_t slot, void *resource, const void *desc) = 0;
+	};
+
+	// Remembers what was last written to every slot of a persistent descriptor heap, so descriptors are only written
+	// again when the resource, its generation or the description of the view changed. Resources that are recreated
+	// must come with a new generation, as the new one can end up in the same memory the old one used.
+	class DescriptorCache {
+	public:
+		static const size_t MaxDescSize = 64;
+	private:
+		struct Slot {
+			DescriptorWriter::Type type;
+			const void *resource;
+			uint64_t generation;
+			size_t descSize;
+			uint8_t desc[MaxDescSize];
+			bool valid;
+		};
+
+		std::vector<Slot> slots;
+	public:
+		// Changing the amount of slots forgets all of them, as it's expected to be done after recreating the heap.
+		void resize(size_t slotCount);
+		void invalidate();
+		size_t size() const;
+
+		// Returns whether the descriptor was written.
+		bool write(DescriptorWriter *writer, DescriptorWriter::Type type, uint32_t slot, void *resource, uint64_t generation, const void *desc, size_t descSize);
+
+		template<typename T>
+		bool write(DescriptorWriter *writer, DescriptorWriter::Type type, uint32_t slot, void *resource, uint64_t generation, const T &desc) {
+			static_assert(sizeof(T) <= MaxDescSize, "The description is too big to be stored in the cache.");
+			return write(writer, type, slot, resource, generation, &desc, sizeof(T));
+		}
+	};
+};
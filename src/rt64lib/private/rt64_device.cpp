@@ -2,7 +2,9 @@
 // RT64
 //
 
+#include <algorithm>
 #include <cassert>
+#include <chrono>
 
 #include <dwmapi.h>
 
@@ -12,11 +14,15 @@
 
 #ifndef RT64_MINIMAL
 
+#include "rt64_allocation_counter.h"
+#include "rt64_capture.h"
 #include "rt64_mipmaps.h"
 #include "rt64_inspector.h"
+#include "rt64_recorder.h"
 #include "rt64_scene.h"
 #include "rt64_shader.h"
 #include "rt64_texture.h"
+#include "rt64_view.h"
 
 #include "shaders/DirectRayGen.hlsl.h"
 #include "shaders/IndirectRayGen.hlsl.h"
@@ -77,10 +83,22 @@ RT64::Device::Device(HWND hwnd) {
 	surfaceMissID = nullptr;
 	shadowMissID = nullptr;
 	blueNoise = nullptr;
+	placeholderTexture = nullptr;
 	width = 0;
 	height = 0;
 	mipmaps = nullptr;
 	disableMipmaps = false;
+	frameQueuedSemaphore = nullptr;
+	frameFreeSemaphore = nullptr;
+	renderThreadEnabled = false;
+	frameStats = {};
+	lastFrameStats = {};
+	frameAllocationStart = 0;
+
+	// Leave one core for the thread that drives the device.
+	unsigned int hardwareThreads = std::thread::hardware_concurrency();
+	unsigned int workerCount = (hardwareThreads > 1) ? (hardwareThreads - 1) : 0;
+	workerPool = new WorkerPool((workerCount < MaxWorkerThreads) ? workerCount : MaxWorkerThreads);
 
 	updateSize();
 	loadPipeline();
@@ -94,11 +112,20 @@ RT64::Device::Device(HWND hwnd) {
 
 RT64::Device::~Device() {
 #ifndef RT64_MINIMAL
+	setRenderThreadEnabled(false);
+
+	auto recordersCopy = recorders;
+	for (Recorder *recorder : recordersCopy) {
+		delete recorder;
+	}
+
 	auto scenesCopy = scenes;
 	for (Scene *scene : scenesCopy) {
 		delete scene;
 	}
 
+	delete workerPool;
+
 	// TODO: Actually delete stuff instead of just leaking everything.
 #endif
 
@@ -277,7 +304,7 @@ void RT64::Device::createRTVs() {
 	resDesc.DepthOrArraySize = 1;
 	resDesc.MipLevels = 1;
 	resDesc.SampleDesc.Count = 1;
-	d3dRenderTargetReadback = allocateResource(D3D12_HEAP_TYPE_READBACK, &resDesc, D3D12_RESOURCE_STATE_COPY_DEST, nullptr);
+	d3dRenderTargetReadback = allocateResource(RT64_MEMORY_CATEGORY_UPLOAD, D3D12_HEAP_TYPE_READBACK, &resDesc, D3D12_RESOURCE_STATE_COPY_DEST, nullptr);
 }
 
 HWND RT64::Device::getHwnd() const {
@@ -400,10 +427,18 @@ RT64::Mipmaps *RT64::Device::getMipmaps() const {
 	return mipmaps;
 }
 
+RT64::WorkerPool *RT64::Device::getWorkerPool() const {
+	return workerPool;
+}
+
 RT64::Texture *RT64::Device::getBlueNoiseTexture() const {
 	return blueNoise;
 }
 
+RT64::Texture *RT64::Device::getPlaceholderTexture() const {
+	return placeholderTexture;
+}
+
 CD3DX12_VIEWPORT RT64::Device::getD3D12Viewport() const {
 	return d3dViewport;
 }
@@ -412,7 +447,7 @@ CD3DX12_RECT RT64::Device::getD3D12ScissorRect() const {
 	return d3dScissorRect;
 }
 
-RT64::AllocatedResource RT64::Device::allocateResource(D3D12_HEAP_TYPE HeapType, _In_  const D3D12_RESOURCE_DESC *pDesc, D3D12_RESOURCE_STATES InitialResourceState, _In_opt_  const D3D12_CLEAR_VALUE *pOptimizedClearValue, bool committed, bool shared) {
+RT64::AllocatedResource RT64::Device::allocateResource(uint32_t memoryCategory, D3D12_HEAP_TYPE HeapType, _In_  const D3D12_RESOURCE_DESC *pDesc, D3D12_RESOURCE_STATES InitialResourceState, _In_opt_  const D3D12_CLEAR_VALUE *pOptimizedClearValue, bool committed, bool shared) {
 	D3D12MA::ALLOCATION_DESC allocationDesc = {};
 	allocationDesc.HeapType = HeapType;
 	allocationDesc.ExtraHeapFlags = shared ? D3D12_HEAP_FLAG_SHARED : D3D12_HEAP_FLAG_NONE;
@@ -421,10 +456,11 @@ RT64::AllocatedResource RT64::Device::allocateResource(D3D12_HEAP_TYPE HeapType,
 	D3D12MA::Allocation *allocation = nullptr;
 	ID3D12Resource *resource = nullptr;
 	d3dAllocator->CreateResource(&allocationDesc, pDesc, InitialResourceState, pOptimizedClearValue, &allocation, IID_PPV_ARGS(&resource));
-	return AllocatedResource(allocation);
+	frameStats.heapAllocationCount++;
+	return trackAllocation(memoryCategory, allocation);
 }
 
-RT64::AllocatedResource RT64::Device::allocateBuffer(D3D12_HEAP_TYPE HeapType, uint64_t size, D3D12_RESOURCE_FLAGS flags, D3D12_RESOURCE_STATES InitialResourceState, bool committed, bool shared) {
+RT64::AllocatedResource RT64::Device::allocateBuffer(uint32_t memoryCategory, D3D12_HEAP_TYPE HeapType, uint64_t size, D3D12_RESOURCE_FLAGS flags, D3D12_RESOURCE_STATES InitialResourceState, bool committed, bool shared) {
 	D3D12MA::ALLOCATION_DESC allocationDesc = {};
 	allocationDesc.HeapType = HeapType;
 	allocationDesc.ExtraHeapFlags = shared ? D3D12_HEAP_FLAG_SHARED : D3D12_HEAP_FLAG_NONE;
@@ -446,7 +482,20 @@ RT64::AllocatedResource RT64::Device::allocateBuffer(D3D12_HEAP_TYPE HeapType, u
 	D3D12MA::Allocation *allocation = nullptr;
 	ID3D12Resource *resource = nullptr;
 	d3dAllocator->CreateResource(&allocationDesc, &bufDesc, InitialResourceState, nullptr, &allocation, IID_PPV_ARGS(&resource));
-	return AllocatedResource(allocation);
+	frameStats.heapAllocationCount++;
+	return trackAllocation(memoryCategory, allocation);
+}
+
+RT64::AllocatedResource RT64::Device::trackAllocation(uint32_t memoryCategory, D3D12MA::Allocation *allocation) {
+	if (allocation != nullptr) {
+		memoryTracker.add(allocation, memoryCategory, allocation->GetSize());
+	}
+
+	return AllocatedResource(allocation, &memoryTracker);
+}
+
+RT64::MemoryTracker &RT64::Device::getMemoryTracker() {
+	return memoryTracker;
 }
 
 void RT64::Device::setLastCommandQueueBarrier(const D3D12_RESOURCE_BARRIER &barrier) {
@@ -783,6 +832,10 @@ void RT64::Device::loadAssets() {
 
 	loadBlueNoise();
 
+	RT64_LOG_PRINTF("Loading placeholder texture");
+
+	loadPlaceholderTexture();
+
 	RT64_LOG_PRINTF("Waiting for asset load to finish");
 
 	// Close command list and wait for it to finish.
@@ -793,9 +846,94 @@ void RT64::Device::loadAssets() {
 
 void RT64::Device::loadBlueNoise() {
 	blueNoise = new RT64::Texture(this);
+	blueNoise->attach();
 	blueNoise->setRGBA8(LDR_64_64_64_RGB1_BGRA8, sizeof(LDR_64_64_64_RGB1_BGRA8), 512, 512, 512 * 4, false);
 }
 
+void RT64::Device::loadPlaceholderTexture() {
+	// Used in place of textures that are still being uploaded.
+	const uint32_t whitePixel = 0xFFFFFFFF;
+	placeholderTexture = new RT64::Texture(this);
+	placeholderTexture->attach();
+	placeholderTexture->setRGBA8(&whitePixel, sizeof(whitePixel), 1, 1, sizeof(whitePixel), false);
+}
+
+void RT64::Device::processTextureQueue() {
+	textureQueue.retire(d3dFence->GetCompletedValue(), retiredTextures);
+	for (Texture *texture : retiredTextures) {
+		texture->retireUpload();
+	}
+}
+
+void RT64::Device::executeRecorders() {
+	for (Recorder *recorder : recorders) {
+		recorder->execute();
+	}
+}
+
+void RT64::Device::queueTexture(Texture *texture) {
+	// The upload will be complete once the next signal on the fence is reached.
+	textureQueue.push(texture, d3dFenceValue);
+}
+
+void RT64::Device::dequeueTexture(Texture *texture) {
+	if (textureQueue.remove(texture)) {
+		// Flush the upload before the texture's resources are released.
+		if (d3dCommandListOpen) {
+			submitCommandList();
+		}
+
+		waitForGPU();
+		resetCommandList();
+	}
+}
+
+uint32_t RT64::Device::allocateTextureSlot(Texture *texture) {
+	assert(texture != nullptr);
+	uint32_t slot = bindlessSlotAllocator.allocate();
+	if (slot >= slotTextures.size()) {
+		slotTextures.resize(slot + 1, nullptr);
+	}
+
+	slotTextures[slot] = texture;
+	return slot;
+}
+
+uint32_t RT64::Device::allocateMeshSlot(Mesh *mesh) {
+	assert(mesh != nullptr);
+	uint32_t slot = bindlessSlotAllocator.allocate();
+	if (slot >= slotMeshes.size()) {
+		slotMeshes.resize(slot + 1, nullptr);
+	}
+
+	slotMeshes[slot] = mesh;
+	return slot;
+}
+
+void RT64::Device::freeMeshSlot(uint32_t slot) {
+	assert(slot < slotMeshes.size());
+	slotMeshes[slot] = nullptr;
+	bindlessSlotAllocator.free(slot);
+}
+
+RT64::Mesh *RT64::Device::getSlotMesh(uint32_t slot) const {
+	return (slot < slotMeshes.size()) ? slotMeshes[slot] : nullptr;
+}
+
+void RT64::Device::freeTextureSlot(uint32_t slot) {
+	assert(slot < slotTextures.size());
+	slotTextures[slot] = nullptr;
+	bindlessSlotAllocator.free(slot);
+}
+
+RT64::Texture *RT64::Device::getSlotTexture(uint32_t slot) const {
+	return (slot < slotTextures.size()) ? slotTextures[slot] : nullptr;
+}
+
+uint32_t RT64::Device::getBindlessSlotCapacity() const {
+	return bindlessSlotAllocator.getCapacity();
+}
+
 void RT64::Device::createRaytracingPipeline() {
 	RT64_LOG_PRINTF("Raytracing pipeline creation started");
 	if (d3dRtStateObject != nullptr) {
@@ -900,6 +1038,9 @@ void RT64::Device::createRaytracingPipeline() {
 		auto &shadowHitGroup = shader->getShadowHitGroup();
 		surfaceHitGroup.id = d3dRtStateObjectProps->GetShaderIdentifier(surfaceHitGroup.hitGroupName.c_str());
 		shadowHitGroup.id = d3dRtStateObjectProps->GetShaderIdentifier(shadowHitGroup.hitGroupName.c_str());
+
+		// Shader binding tables that reference the old identifiers must be rebuilt.
+		shader->markDirty();
 	}
 
 	RT64_LOG_PRINTF("Raytracing pipeline creation finished");
@@ -949,9 +1090,10 @@ ID3D12RootSignature *RT64::Device::createRayGenSignature() {
 		{ SRV_INDEX(SceneLights), 1, 0, D3D12_DESCRIPTOR_RANGE_TYPE_SRV, HEAP_INDEX(SceneLights) },
 		{ SRV_INDEX(instanceTransforms), 1, 0, D3D12_DESCRIPTOR_RANGE_TYPE_SRV, HEAP_INDEX(instanceTransforms) },
 		{ SRV_INDEX(instanceMaterials), 1, 0, D3D12_DESCRIPTOR_RANGE_TYPE_SRV, HEAP_INDEX(instanceMaterials) },
+		{ SRV_INDEX(instanceMaterialIndices), 1, 0, D3D12_DESCRIPTOR_RANGE_TYPE_SRV, HEAP_INDEX(instanceMaterialIndices) },
 		{ SRV_INDEX(gBlueNoise), 1, 0, D3D12_DESCRIPTOR_RANGE_TYPE_SRV, HEAP_INDEX(gBlueNoise) },
-		{ SRV_INDEX(gTextures), SRV_TEXTURES_MAX, 0, D3D12_DESCRIPTOR_RANGE_TYPE_SRV, HEAP_INDEX(gTextures) },
-		{ CBV_INDEX(gParams), 1, 0, D3D12_DESCRIPTOR_RANGE_TYPE_CBV, HEAP_INDEX(gParams) }
+		{ CBV_INDEX(gParams), 1, 0, D3D12_DESCRIPTOR_RANGE_TYPE_CBV, HEAP_INDEX(gParams) },
+		{ SRV_INDEX(gTextures), SRV_BINDLESS_UNBOUNDED, 0, D3D12_DESCRIPTOR_RANGE_TYPE_SRV, HEAP_INDEX(gTextures) }
 	});
 
 	// Fill out the samplers.
@@ -980,6 +1122,11 @@ void RT64::Device::preRender() {
 	if (d3dCommandListOpen) {
 		submitCommandList();
 		waitForGPU();
+
+		// Includes the mipmaps recorded for the textures retired this frame.
+		if (mipmaps != nullptr) {
+			mipmaps->releaseRecorded();
+		}
 	}
 
 	resetCommandList();
@@ -1015,6 +1162,12 @@ void RT64::Device::postRender(int vsyncInterval) {
 	// Present the frame.
 	D3D12_CHECK(d3dSwapChain->Present(vsyncInterval, 0));
 
+	// The views keep one copy of the buffers the GPU reads from and write over them in place on the next frame, instead of
+	// rotating between copies. That only works because the GPU is done with the frame here. Those buffers are:
+	// - the top level AS instance descriptors, which View::createTopLevelAS patches through TopLevelASInstanceTable;
+	// - the shader binding table storage, which View::createShaderBindingTable rewrites;
+	// - the descriptor heap, which View::createShaderResourceHeap patches through DescriptorCache.
+	// Letting frames overlap would require a ring of copies for each of them.
 	waitForGPU();
 	d3dFrameIndex = d3dSwapChain->GetCurrentBackBufferIndex();
 
@@ -1025,6 +1178,138 @@ void RT64::Device::postRender(int vsyncInterval) {
 }
 
 void RT64::Device::draw(int vsyncInterval, float deltaTimeMs) {
+	if (renderThreadEnabled) {
+		publishFrame(vsyncInterval, deltaTimeMs);
+	}
+	else {
+		frameAllocationStart = AllocationCounter::getCount();
+
+		// Apply the updates recorded by other threads in the order the recorders were created.
+		executeRecorders();
+		renderFrame(vsyncInterval, deltaTimeMs);
+	}
+}
+
+void RT64::Device::publishFrame(int vsyncInterval, float deltaTimeMs) {
+	// Wait for the render thread to release one of the snapshots.
+	WaitForSingleObject(frameFreeSemaphore, INFINITE);
+
+	FrameSnapshot *snapshot = frameQueue.beginWrite();
+	assert(snapshot != nullptr);
+	snapshot->vsyncInterval = vsyncInterval;
+	snapshot->deltaTimeMs = deltaTimeMs;
+	snapshot->stopThread = false;
+	if (snapshot->recordBuffers.size() < (recorders.size() + 1)) {
+		snapshot->recordBuffers.resize(recorders.size() + 1);
+	}
+
+	// The immediate updates were captured when they were made, but the recorders are captured here
+	// so the capture stays on the API thread and keeps the order they'll be applied in.
+	assert(!immediateBuffer.hasMappedBlocks() && "Meshes must be unmapped before the device is drawn.");
+	std::swap(snapshot->recordBuffers[0], immediateBuffer);
+	for (size_t i = 0; i < recorders.size(); i++) {
+		recorders[i]->flush(snapshot->recordBuffers[i + 1]);
+		snapshot->recordBuffers[i + 1].capture();
+	}
+
+	frameQueue.endWrite();
+	ReleaseSemaphore(frameQueuedSemaphore, 1, nullptr);
+}
+
+void RT64::Device::renderThreadLoop() {
+	bool stopThread = false;
+	while (!stopThread) {
+		WaitForSingleObject(frameQueuedSemaphore, INFINITE);
+
+		FrameSnapshot *snapshot = frameQueue.beginRead();
+		assert(snapshot != nullptr);
+		stopThread = snapshot->stopThread;
+		if (!stopThread) {
+			try {
+				frameAllocationStart = AllocationCounter::getCount();
+				for (const RecordBuffer &recordBuffer : snapshot->recordBuffers) {
+					recordBuffer.apply();
+				}
+
+				renderFrame(snapshot->vsyncInterval, snapshot->deltaTimeMs);
+			}
+			RT64_CATCH_EXCEPTION();
+		}
+
+		// Cleared buffers keep their memory so the API thread can reuse it for the next frames.
+		for (RecordBuffer &recordBuffer : snapshot->recordBuffers) {
+			recordBuffer.clear();
+		}
+
+		frameQueue.endRead();
+		ReleaseSemaphore(frameFreeSemaphore, 1, nullptr);
+	}
+}
+
+void RT64::Device::setRenderThreadEnabled(bool v) {
+	if (renderThreadEnabled == v) {
+		return;
+	}
+
+	if (v) {
+		if (frameQueuedSemaphore == nullptr) {
+			frameQueuedSemaphore = CreateSemaphore(nullptr, 0, FrameQueueSize, nullptr);
+			frameFreeSemaphore = CreateSemaphore(nullptr, FrameQueueSize, FrameQueueSize, nullptr);
+		}
+
+		renderThreadEnabled = true;
+		renderThread = std::thread(&Device::renderThreadLoop, this);
+	}
+	else {
+		waitForRenderThread();
+
+		WaitForSingleObject(frameFreeSemaphore, INFINITE);
+		FrameSnapshot *snapshot = frameQueue.beginWrite();
+		assert(snapshot != nullptr);
+		snapshot->stopThread = true;
+		frameQueue.endWrite();
+		ReleaseSemaphore(frameQueuedSemaphore, 1, nullptr);
+
+		renderThread.join();
+		renderThreadEnabled = false;
+	}
+}
+
+bool RT64::Device::isRenderThreadEnabled() const {
+	return renderThreadEnabled;
+}
+
+RT64_FRAME_STATS &RT64::Device::getFrameStats() {
+	return frameStats;
+}
+
+RT64_FRAME_STATS RT64::Device::getLastFrameStats() {
+	std::scoped_lock lock(frameStatsMutex);
+	return lastFrameStats;
+}
+
+RT64::RecordBuffer &RT64::Device::getImmediateBuffer() {
+	return immediateBuffer;
+}
+
+void RT64::Device::waitForRenderThread() {
+	if (!renderThreadEnabled) {
+		return;
+	}
+
+	// All the snapshots are free once the render thread has finished every queued frame.
+	for (UINT i = 0; i < FrameQueueSize; i++) {
+		WaitForSingleObject(frameFreeSemaphore, INFINITE);
+	}
+
+	ReleaseSemaphore(frameFreeSemaphore, FrameQueueSize, nullptr);
+
+	// The render thread is idle, so any pending immediate updates can be applied here before the caller changes anything else.
+	immediateBuffer.apply();
+	immediateBuffer.clear();
+}
+
+void RT64::Device::renderFrame(int vsyncInterval, float deltaTimeMs) {
 	RT64_LOG_PRINTF("Started device draw");
 
 	if (d3dRtStateObjectDirty) {
@@ -1037,6 +1322,9 @@ void RT64::Device::draw(int vsyncInterval, float deltaTimeMs) {
 	
 	// Make sure that the size of the window is up to date.
 	updateSize();
+
+	// Retire any textures that finished uploading since the last frame.
+	processTextureQueue();
 	
 	// Update all scenes as necessary.
 	for (Scene *scene : scenes) {
@@ -1064,7 +1352,7 @@ void RT64::Device::draw(int vsyncInterval, float deltaTimeMs) {
 	// Determine the active view (use the first available view for now).
 	View *activeView = nullptr;
 	for (Scene *scene : scenes) {
-		auto views = scene->getViews();
+		const std::vector<View *> &views = scene->getViews();
 		if (!views.empty()) {
 			activeView = views[0];
 		}
@@ -1078,10 +1366,43 @@ void RT64::Device::draw(int vsyncInterval, float deltaTimeMs) {
 	}
 
 	postRender(vsyncInterval);
+	publishFrameStats();
 
 	RT64_LOG_PRINTF("Finished device draw");
 }
 
+void RT64::Device::publishFrameStats() {
+	// Add the counters of every view to the ones recorded by the device during the frame.
+	for (Scene *scene : scenes) {
+		for (View *view : scene->getViews()) {
+			const RT64_FRAME_STATS &viewStats = view->getFrameStats();
+			frameStats.rtInstanceCount += viewStats.rtInstanceCount;
+			frameStats.rasterBgInstanceCount += viewStats.rasterBgInstanceCount;
+			frameStats.rasterFgInstanceCount += viewStats.rasterFgInstanceCount;
+			frameStats.extractedInstanceCount += viewStats.extractedInstanceCount;
+			frameStats.tlasBuildType = std::max(frameStats.tlasBuildType, viewStats.tlasBuildType);
+			frameStats.constantUploadBytes += viewStats.constantUploadBytes;
+			frameStats.descriptorsWritten += viewStats.descriptorsWritten;
+			frameStats.sbtBuildCount += viewStats.sbtBuildCount;
+			frameStats.sbtRecordsWritten += viewStats.sbtRecordsWritten;
+		}
+	}
+
+	if (AllocationCounter::isEnabled()) {
+		frameStats.cpuAllocationCount = (int)(AllocationCounter::getCount() - frameAllocationStart);
+	}
+	else {
+		frameStats.cpuAllocationCount = -1;
+	}
+
+	{
+		std::scoped_lock lock(frameStatsMutex);
+		lastFrameStats = frameStats;
+	}
+
+	frameStats = {};
+}
+
 void RT64::Device::addScene(Scene *scene) {
 	assert(scene != nullptr);
 	scenes.push_back(scene);
@@ -1118,6 +1439,16 @@ void RT64::Device::removeInspector(Inspector* inspector) {
 	inspectors.erase(std::remove(inspectors.begin(), inspectors.end(), inspector), inspectors.end());
 }
 
+void RT64::Device::addRecorder(Recorder *recorder) {
+	assert(recorder != nullptr);
+	recorders.push_back(recorder);
+}
+
+void RT64::Device::removeRecorder(Recorder *recorder) {
+	assert(recorder != nullptr);
+	recorders.erase(std::remove(recorders.begin(), recorders.end(), recorder), recorders.end());
+}
+
 void RT64::Device::resetCommandList() {
 	RT64_LOG_PRINTF("Command list reset");
 
@@ -1142,6 +1473,8 @@ void RT64::Device::submitCommandList() {
 }
 
 void RT64::Device::waitForGPU() {
+	auto startTime = std::chrono::high_resolution_clock::now();
+
 	// Schedule a signal command in the queue.
 	d3dCommandQueue->Signal(d3dFence, d3dFenceValue);
 
@@ -1149,6 +1482,11 @@ void RT64::Device::waitForGPU() {
 	d3dFence->SetEventOnCompletion(d3dFenceValue, d3dFenceEvent);
 	WaitForSingleObjectEx(d3dFenceEvent, INFINITE, FALSE);
 
+	// Keep track of how long the CPU stalled.
+	std::chrono::duration<float, std::milli> waitTime = std::chrono::high_resolution_clock::now() - startTime;
+	frameStats.gpuWaitCount++;
+	frameStats.gpuWaitMs += waitTime.count();
+
 	// Increment the fence value.
 	d3dFenceValue++;
 }
@@ -1220,7 +1558,20 @@ void RT64::Device::dumpRenderTarget(const std::string &path) {
 
 DLLEXPORT RT64_DEVICE *RT64_CreateDevice(void *hwnd) {
 	try {
-		return (RT64_DEVICE *)(new RT64::Device((HWND)(hwnd)));
+		RT64::Device *device = new RT64::Device((HWND)(hwnd));
+
+#ifndef RT64_MINIMAL
+		RT64::GlobalDeviceCount++;
+
+		RT64::Capture *capture = RT64::GlobalCapture;
+		if (capture != nullptr) {
+			capture->beginCall(RT64_CAPTURE_CALL_CREATE_DEVICE);
+			capture->writeObject(device);
+			capture->endCall();
+		}
+#endif
+
+		return (RT64_DEVICE *)(device);
 	}
 	RT64_CATCH_EXCEPTION();
 	return nullptr;
@@ -1228,6 +1579,18 @@ DLLEXPORT RT64_DEVICE *RT64_CreateDevice(void *hwnd) {
 
 DLLEXPORT void RT64_DestroyDevice(RT64_DEVICE *devicePtr) {
 	assert(devicePtr != nullptr);
+#ifndef RT64_MINIMAL
+	RT64::Capture *capture = RT64::GlobalCapture;
+	if (capture != nullptr) {
+		capture->beginCall(RT64_CAPTURE_CALL_DESTROY_DEVICE);
+		capture->writeObject(devicePtr);
+		capture->endCall();
+		capture->forgetObject(devicePtr);
+	}
+
+	RT64::GlobalDeviceCount--;
+#endif
+
 	try {
 		delete (RT64::Device *)(devicePtr);
 	}
@@ -1238,11 +1601,64 @@ DLLEXPORT void RT64_DestroyDevice(RT64_DEVICE *devicePtr) {
 
 DLLEXPORT void RT64_DrawDevice(RT64_DEVICE *devicePtr, int vsyncInterval, float deltaTimeMs) {
 	assert(devicePtr != nullptr);
+
 	try {
 		RT64::Device *device = (RT64::Device *)(devicePtr);
 		device->draw(vsyncInterval, deltaTimeMs);
 	}
 	RT64_CATCH_EXCEPTION();
+
+	// The draw is captured last so any recorded updates it applied come before it in the capture.
+	RT64::Capture *capture = RT64::GlobalCapture;
+	if (capture != nullptr) {
+		capture->beginCall(RT64_CAPTURE_CALL_DRAW_DEVICE);
+		capture->writeObject(devicePtr);
+		capture->writeValue(vsyncInterval);
+		capture->writeValue(deltaTimeMs);
+		capture->endCall();
+	}
+}
+
+DLLEXPORT void RT64_SetDeviceRenderThread(RT64_DEVICE *devicePtr, bool enabled) {
+	assert(devicePtr != nullptr);
+
+	try {
+		RT64::Device *device = (RT64::Device *)(devicePtr);
+		device->setRenderThreadEnabled(enabled);
+	}
+	RT64_CATCH_EXCEPTION();
+}
+
+DLLEXPORT void RT64_GetFrameStats(RT64_DEVICE *devicePtr, RT64_FRAME_STATS *frameStats) {
+	assert(devicePtr != nullptr);
+	assert(frameStats != nullptr);
+	RT64::Device *device = (RT64::Device *)(devicePtr);
+	*frameStats = device->getLastFrameStats();
+}
+
+DLLEXPORT void RT64_GetMemoryStats(RT64_DEVICE *devicePtr, RT64_MEMORY_STATS *memoryStats) {
+	assert(devicePtr != nullptr);
+	assert(memoryStats != nullptr);
+	static_assert(RT64::MemoryTracker::CategoryCount == RT64_MEMORY_CATEGORY_COUNT, "Memory categories must match.");
+
+	RT64::Device *device = (RT64::Device *)(devicePtr);
+	RT64::MemoryTracker::Totals totals = device->getMemoryTracker().getTotals();
+	for (uint32_t i = 0; i < RT64_MEMORY_CATEGORY_COUNT; i++) {
+		memoryStats->categoryBytes[i] = totals.categoryBytes[i];
+		memoryStats->categoryAllocationCount[i] = totals.categoryAllocationCount[i];
+	}
+
+	D3D12MA::Budget gpuBudget = {};
+	device->getD3D12Allocator()->GetBudget(&gpuBudget, nullptr);
+	memoryStats->totalBytes = totals.totalBytes;
+	memoryStats->gpuUsageBytes = gpuBudget.UsageBytes;
+	memoryStats->gpuBudgetBytes = gpuBudget.BudgetBytes;
+}
+
+DLLEXPORT void RT64_SetMemoryBudgetCallback(RT64_DEVICE *devicePtr, unsigned long long thresholdBytes, RT64_MEMORY_BUDGET_CALLBACK callback, void *userData) {
+	assert(devicePtr != nullptr);
+	RT64::Device *device = (RT64::Device *)(devicePtr);
+	device->getMemoryTracker().setBudget(thresholdBytes, callback, userData);
 }
 
 #endif
\ No newline at end of file
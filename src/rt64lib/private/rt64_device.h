@@ -7,6 +7,14 @@
 #include "rt64_common.h"
 
 #ifndef RT64_MINIMAL
+#include <thread>
+
+#include "rt64_frame_queue.h"
+#include "rt64_recorder.h"
+#include "rt64_texture_queue.h"
+#include "rt64_texture_slot_allocator.h"
+#include "rt64_worker_pool.h"
+
 #include "nv_helpers_dx12/BottomLevelASGenerator.h"
 #include "nv_helpers_dx12/RaytracingPipelineGenerator.h"
 #include "nv_helpers_dx12/RootSignatureGenerator.h"
@@ -17,6 +25,7 @@ namespace RT64 {
 	class Scene;
 	class Shader;
 	class Inspector;
+	class Mesh;
 	class Texture;
 	class Mipmaps;
 
@@ -31,6 +40,15 @@ namespace RT64 {
 
 #ifndef RT64_MINIMAL
 		static const UINT FrameCount = 2;
+		static const UINT FrameQueueSize = 2;
+		static const unsigned int MaxWorkerThreads = 7;
+
+		struct FrameSnapshot {
+			int vsyncInterval;
+			float deltaTimeMs;
+			bool stopThread;
+			std::vector<RecordBuffer> recordBuffers;
+		};
 
 		HWND hwnd;
 		int width;
@@ -39,7 +57,20 @@ namespace RT64 {
 		std::vector<Scene *> scenes;
 		std::vector<Shader *> shaders;
 		std::vector<Inspector *> inspectors;
+		std::vector<Recorder *> recorders;
+		RecordBuffer immediateBuffer;
+		FrameQueue<FrameSnapshot, FrameQueueSize> frameQueue;
+		HANDLE frameQueuedSemaphore;
+		HANDLE frameFreeSemaphore;
+		std::thread renderThread;
+		bool renderThreadEnabled;
+		RT64_FRAME_STATS frameStats;
+		RT64_FRAME_STATS lastFrameStats;
+		std::mutex frameStatsMutex;
+		uint64_t frameAllocationStart;
+		MemoryTracker memoryTracker;
 		Mipmaps *mipmaps;
+		WorkerPool *workerPool;
 
 		CD3DX12_VIEWPORT d3dViewport;
 		CD3DX12_RECT d3dScissorRect;
@@ -81,6 +112,12 @@ namespace RT64 {
 		void *surfaceMissID;
 		void *shadowMissID;
 		Texture *blueNoise;
+		Texture *placeholderTexture;
+		TextureQueue textureQueue;
+		std::vector<Texture *> retiredTextures;
+		TextureSlotAllocator bindlessSlotAllocator;
+		std::vector<Texture *> slotTextures;
+		std::vector<Mesh *> slotMeshes;
 		ID3D12RootSignature *d3dRayGenSignature;
 		ID3D12PipelineState *im3dPipelineStatePoint;
 		ID3D12PipelineState *im3dPipelineStateLine;
@@ -102,6 +139,13 @@ namespace RT64 {
 		void loadPipeline();
 		void loadAssets();
 		void loadBlueNoise();
+		void loadPlaceholderTexture();
+		void processTextureQueue();
+		void executeRecorders();
+		void publishFrame(int vsyncInterval, float deltaTimeMs);
+		void renderThreadLoop();
+		void renderFrame(int vsyncInterval, float deltaTimeMs);
+		void publishFrameStats();
 		void createRaytracingPipeline();
 		void createDxcCompiler();
 		ID3D12RootSignature *createRayGenSignature();
@@ -119,6 +163,14 @@ namespace RT64 {
 		void removeShader(Shader *shader);
 		void addInspector(Inspector* inspector);
 		void removeInspector(Inspector* inspector);
+		void addRecorder(Recorder *recorder);
+		void removeRecorder(Recorder *recorder);
+		void setRenderThreadEnabled(bool v);
+		bool isRenderThreadEnabled() const;
+		RecordBuffer &getImmediateBuffer();
+		void waitForRenderThread();
+		RT64_FRAME_STATS &getFrameStats();
+		RT64_FRAME_STATS getLastFrameStats();
 		HWND getHwnd() const;
 		ID3D12Device8 *getD3D12Device() const;
 		D3D12MA::Allocator *getD3D12Allocator() const;
@@ -149,11 +201,24 @@ namespace RT64 {
 		IDxcCompiler *getDxcCompiler() const;
 		IDxcLibrary *getDxcLibrary() const;
 		Mipmaps *getMipmaps() const;
+		WorkerPool *getWorkerPool() const;
 		Texture *getBlueNoiseTexture() const;
+		Texture *getPlaceholderTexture() const;
+		void queueTexture(Texture *texture);
+		void dequeueTexture(Texture *texture);
+		uint32_t allocateTextureSlot(Texture *texture);
+		void freeTextureSlot(uint32_t slot);
+		Texture *getSlotTexture(uint32_t slot) const;
+		uint32_t allocateMeshSlot(Mesh *mesh);
+		void freeMeshSlot(uint32_t slot);
+		Mesh *getSlotMesh(uint32_t slot) const;
+		uint32_t getBindlessSlotCapacity() const;
 		CD3DX12_VIEWPORT getD3D12Viewport() const;
 		CD3DX12_RECT getD3D12ScissorRect() const;
-		AllocatedResource allocateResource(D3D12_HEAP_TYPE HeapType, _In_  const D3D12_RESOURCE_DESC *pDesc, D3D12_RESOURCE_STATES InitialResourceState, _In_opt_  const D3D12_CLEAR_VALUE *pOptimizedClearValue, bool committed = false, bool shared = false);
-		AllocatedResource allocateBuffer(D3D12_HEAP_TYPE HeapType, uint64_t size, D3D12_RESOURCE_FLAGS flags, D3D12_RESOURCE_STATES InitialResourceState, bool committed = false, bool shared = false);
+		AllocatedResource allocateResource(uint32_t memoryCategory, D3D12_HEAP_TYPE HeapType, _In_  const D3D12_RESOURCE_DESC *pDesc, D3D12_RESOURCE_STATES InitialResourceState, _In_opt_  const D3D12_CLEAR_VALUE *pOptimizedClearValue, bool committed = false, bool shared = false);
+		AllocatedResource allocateBuffer(uint32_t memoryCategory, D3D12_HEAP_TYPE HeapType, uint64_t size, D3D12_RESOURCE_FLAGS flags, D3D12_RESOURCE_STATES InitialResourceState, bool committed = false, bool shared = false);
+		AllocatedResource trackAllocation(uint32_t memoryCategory, D3D12MA::Allocation *allocation);
+		MemoryTracker &getMemoryTracker();
 		void setLastCommandQueueBarrier(const D3D12_RESOURCE_BARRIER &barrier);
 		void submitCommandQueueBarrier();
 		void setLastCopyQueueBarrier(const D3D12_RESOURCE_BARRIER &barrier);
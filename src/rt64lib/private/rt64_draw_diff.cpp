@@ -0,0 +1,145 @@
+//
+// RT64
+//
+
+#include "rt64_draw_diff.h"
+
+#include <assert.h>
+
+// Private
+
+RT64::DrawDiff::DrawDiff() {
+	stats = {};
+}
+
+uint32_t RT64::DrawDiff::allocateSlot() {
+	if (!freeSlots.empty()) {
+		uint32_t slot = freeSlots.back();
+		freeSlots.pop_back();
+		return slot;
+	}
+
+	uint32_t slot = (uint32_t)(slotHashes.size());
+	slotHashes.push_back(0);
+	slotNext.push_back(InvalidSlot);
+	slotMatched.push_back(0);
+	return slot;
+}
+
+void RT64::DrawDiff::resetHashBuckets(size_t hashCount) {
+	// Keep the table at most half full. It only grows, so steady frames reuse the same memory.
+	size_t bucketCount = 16;
+	while (bucketCount < (hashCount * 2)) {
+		bucketCount *= 2;
+	}
+
+	if (hashBuckets.size() < bucketCount) {
+		hashBuckets.resize(bucketCount);
+	}
+
+	for (HashBucket &bucket : hashBuckets) {
+		bucket.occupied = 0;
+	}
+}
+
+RT64::DrawDiff::HashBucket &RT64::DrawDiff::findHashBucket(uint64_t hash) {
+	// The hashes come from XXHash64, so their lower bits can be used directly with linear probing.
+	const size_t mask = hashBuckets.size() - 1;
+	size_t index = (size_t)(hash) & mask;
+	while (hashBuckets[index].occupied && (hashBuckets[index].hash != hash)) {
+		index = (index + 1) & mask;
+	}
+
+	return hashBuckets[index];
+}
+
+void RT64::DrawDiff::diff(const std::vector<uint64_t> &hashes, std::vector<Result> &results, std::vector<uint32_t> &retiredSlots) {
+	stats = {};
+	results.resize(hashes.size());
+	retiredSlots.clear();
+
+	// Chain the slots of the previous frame by their hash. Walking backwards makes each chain
+	// follow the submission order, so repeated content is matched in the same order as before.
+	resetHashBuckets(activeSlots.size());
+	for (size_t i = activeSlots.size(); i > 0; i--) {
+		uint32_t slot = activeSlots[i - 1];
+		HashBucket &bucket = findHashBucket(slotHashes[slot]);
+		if (bucket.occupied) {
+			slotNext[slot] = bucket.slot;
+		}
+		else {
+			slotNext[slot] = InvalidSlot;
+			bucket.hash = slotHashes[slot];
+			bucket.occupied = 1;
+		}
+
+		bucket.slot = slot;
+		slotMatched[slot] = 0;
+	}
+
+	// Reuse the slots whose content is identical.
+	for (size_t i = 0; i < hashes.size(); i++) {
+		HashBucket &bucket = findHashBucket(hashes[i]);
+		if (bucket.occupied && (bucket.slot != InvalidSlot)) {
+			uint32_t slot = bucket.slot;
+			bucket.slot = slotNext[slot];
+			slotMatched[slot] = 1;
+			results[i] = { Match::Reused, slot };
+			stats.reused++;
+		}
+		else {
+			results[i] = { Match::Created, InvalidSlot };
+		}
+	}
+
+	// Recycle the unmatched slots for the remaining draws before creating any new ones.
+	size_t recycleIndex = 0;
+	for (size_t i = 0; i < hashes.size(); i++) {
+		if (results[i].slot != InvalidSlot) {
+			continue;
+		}
+
+		while ((recycleIndex < activeSlots.size()) && slotMatched[activeSlots[recycleIndex]]) {
+			recycleIndex++;
+		}
+
+		if (recycleIndex < activeSlots.size()) {
+			uint32_t slot = activeSlots[recycleIndex++];
+			slotMatched[slot] = 1;
+			results[i] = { Match::Recycled, slot };
+			stats.recycled++;
+		}
+		else {
+			results[i] = { Match::Created, allocateSlot() };
+			stats.created++;
+		}
+
+		slotHashes[results[i].slot] = hashes[i];
+	}
+
+	// Retire the slots that weren't used by this frame.
+	for (uint32_t slot : activeSlots) {
+		if (!slotMatched[slot]) {
+			retiredSlots.push_back(slot);
+			freeSlots.push_back(slot);
+			stats.retired++;
+		}
+	}
+
+	activeSlots.clear();
+	for (const Result &result : results) {
+		activeSlots.push_back(result.slot);
+	}
+}
+
+const std::vector<uint32_t> &RT64::DrawDiff::getActiveSlots() const {
+	return activeSlots;
+}
+
+const RT64::DrawDiff::Stats &RT64::DrawDiff::getStats() const {
+	return stats;
+}
+
+size_t RT64::DrawDiff::getSlotCount() const {
+	return slotHashes.size();
+}
@@ -0,0 +1,63 @@
+//
+// RT64
+//
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+namespace RT64 {
+	// Matches the draws submitted in a frame against the ones from the previous frame by their content hash.
+	// The diff only deals with hashes and slot indices so it doesn't depend on any D3D12 objects.
+	class DrawDiff {
+	public:
+		static constexpr uint32_t InvalidSlot = 0xFFFFFFFF;
+
+		enum class Match {
+			// The slot held the same content on the previous frame.
+			Reused,
+			// The slot was left unmatched by the previous frame and must be updated with the new content.
+			Recycled,
+			// The slot is new and must be created.
+			Created
+		};
+
+		struct Result {
+			Match match;
+			uint32_t slot;
+		};
+
+		struct Stats {
+			uint32_t reused;
+			uint32_t recycled;
+			uint32_t created;
+			uint32_t retired;
+		};
+	private:
+		struct HashBucket {
+			uint64_t hash;
+			uint32_t slot;
+			uint32_t occupied;
+		};
+
+		std::vector<uint64_t> slotHashes;
+		std::vector<uint32_t> slotNext;
+		std::vector<uint8_t> slotMatched;
+		std::vector<uint32_t> activeSlots;
+		std::vector<uint32_t> freeSlots;
+		std::vector<HashBucket> hashBuckets;
+		Stats stats;
+
+		uint32_t allocateSlot();
+		void resetHashBuckets(size_t hashCount);
+		HashBucket &findHashBucket(uint64_t hash);
+	public:
+		DrawDiff();
+		void diff(const std::vector<uint64_t> &hashes, std::vector<Result> &results, std::vector<uint32_t> &retiredSlots);
+		const std::vector<uint32_t> &getActiveSlots() const;
+		const Stats &getStats() const;
+		size_t getSlotCount() const;
+	};
+};
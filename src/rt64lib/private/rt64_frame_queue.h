@@ -0,0 +1,59 @@
+//
+// RT64
+//
+
+#pragma once
+
+#include <atomic>
+#include <stddef.h>
+
+namespace RT64 {
+	// Lock-free queue for handing frames from a single producer thread to a single consumer thread.
+	// Slots are written and read in place so whatever memory they own is reused across frames.
+	template<typename T, size_t Capacity>
+	class FrameQueue {
+	private:
+		T slots[Capacity];
+		std::atomic<size_t> readIndex;
+		std::atomic<size_t> writeIndex;
+	public:
+		FrameQueue() {
+			readIndex = 0;
+			writeIndex = 0;
+		}
+
+		// Returns the slot to write the next frame to or null if the queue is full.
+		T *beginWrite() {
+			size_t writeValue = writeIndex.load(std::memory_order_relaxed);
+			if ((writeValue - readIndex.load(std::memory_order_acquire)) == Capacity) {
+				return nullptr;
+			}
+
+			return &slots[writeValue % Capacity];
+		}
+
+		// Publishes the slot returned by beginWrite to the consumer.
+		void endWrite() {
+			writeIndex.store(writeIndex.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+		}
+
+		// Returns the oldest published frame or null if the queue is empty.
+		T *beginRead() {
+			size_t readValue = readIndex.load(std::memory_order_relaxed);
+			if (readValue == writeIndex.load(std::memory_order_acquire)) {
+				return nullptr;
+			}
+
+			return &slots[readValue % Capacity];
+		}
+
+		// Hands the slot returned by beginRead back to the producer.
+		void endRead() {
+			readIndex.store(readIndex.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+		}
+
+		size_t size() const {
+			return writeIndex.load(std::memory_order_acquire) - readIndex.load(std::memory_order_acquire);
+		}
+	};
+};
@@ -0,0 +1,21 @@
+//
+// RT64
+//
+
+#include "rt64_generation.h"
+
+#include <atomic>
+
+namespace {
+	std::atomic<uint64_t> LastGeneration(RT64::Generation::None);
+};
+
+// Private
+
+uint64_t RT64::Generation::next() {
+	return ++LastGeneration;
+}
+
+uint64_t RT64::Generation::current() {
+	return LastGeneration.load();
+}
@@ -0,0 +1,19 @@
+//
+// RT64
+//
+
+#pragma once
+
+#include <stdint.h>
+
+namespace RT64 {
+	// Objects stamp themselves with a new generation every time they change. Generations come from a single
+	// increasing sequence, so anything newer than the value a consumer recorded on its last pass has changed since.
+	class Generation {
+	public:
+		static const uint64_t None = 0;
+
+		static uint64_t next();
+		static uint64_t current();
+	};
+};
@@ -0,0 +1,84 @@
+//
+// RT64
+//
+
+#include "rt64_hit_group_table.h"
+
+#include <assert.h>
+
+namespace {
+	size_t hashPointer(const void *pointer) {
+		// The shaders are allocated one by one, so the lower bits of their addresses are mostly the same. Multiplying by
+		// the golden ratio spreads the higher bits over the ones used by the mask.
+		uint64_t value = (uint64_t)(reinterpret_cast<uintptr_t>(pointer)) * 0x9E3779B97F4A7C15ULL;
+		return (size_t)(value >> 32);
+	}
+};
+
+// Private
+
+void RT64::HitGroupTable::resizeHashBuckets(size_t bucketCount) {
+	hashBuckets.resize(bucketCount);
+	for (HashBucket &bucket : hashBuckets) {
+		bucket.shader = nullptr;
+	}
+
+	for (size_t i = 0; i < shaders.size(); i++) {
+		HashBucket &bucket = findHashBucket(shaders[i]);
+		bucket.shader = shaders[i];
+		bucket.index = (uint32_t)(i);
+	}
+}
+
+RT64::HitGroupTable::HashBucket &RT64::HitGroupTable::findHashBucket(const Shader *shader) {
+	const size_t mask = hashBuckets.size() - 1;
+	size_t index = hashPointer(shader) & mask;
+	while ((hashBuckets[index].shader != nullptr) && (hashBuckets[index].shader != shader)) {
+		index = (index + 1) & mask;
+	}
+
+	return hashBuckets[index];
+}
+
+void RT64::HitGroupTable::begin() {
+	shaders.clear();
+
+	// The buckets only grow, so the table doesn't need to allocate again once it's big enough.
+	if (hashBuckets.empty()) {
+		hashBuckets.resize(64);
+	}
+
+	for (HashBucket &bucket : hashBuckets) {
+		bucket.shader = nullptr;
+	}
+}
+
+uint32_t RT64::HitGroupTable::intern(Shader *shader) {
+	assert(shader != nullptr);
+	assert(!hashBuckets.empty() && "begin() must be called before interning any shaders.");
+
+	HashBucket &bucket = findHashBucket(shader);
+	if (bucket.shader != nullptr) {
+		return bucket.index;
+	}
+
+	uint32_t index = (uint32_t)(shaders.size());
+	shaders.push_back(shader);
+	bucket.shader = shader;
+	bucket.index = index;
+
+	// Keep the buckets at most half full.
+	if ((shaders.size() * 2) > hashBuckets.size()) {
+		resizeHashBuckets(hashBuckets.size() * 2);
+	}
+
+	return index;
+}
+
+const std::vector<RT64::Shader *> &RT64::HitGroupTable::getShaders() const {
+	return shaders;
+}
+
+size_t RT64::HitGroupTable::size() const {
+	return shaders.size();
+}
@@ -0,0 +1,38 @@
+//
+// RT64
+//
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+namespace RT64 {
+	class Shader;
+
+	// Deduplicates the shaders used by the raytraced instances of a view, so the instances that use the same shader share
+	// its hit groups in the shader binding table. The table is rebuilt on every pass and only grows, so it doesn't allocate
+	// once the view has seen its largest amount of shaders.
+	class HitGroupTable {
+	private:
+		struct HashBucket {
+			Shader *shader;
+			uint32_t index;
+		};
+
+		std::vector<Shader *> shaders;
+		std::vector<HashBucket> hashBuckets;
+
+		void resizeHashBuckets(size_t bucketCount);
+		HashBucket &findHashBucket(const Shader *shader);
+	public:
+		void begin();
+
+		// Returns the index of the shader in the table, which is also the index of its pair of hit groups.
+		uint32_t intern(Shader *shader);
+
+		const std::vector<Shader *> &getShaders() const;
+		size_t size() const;
+	};
+};
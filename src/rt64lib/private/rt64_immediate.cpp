@@ -0,0 +1,314 @@
+//
+// RT64
+//
+
+#ifndef RT64_MINIMAL
+
+#include "../public/rt64.h"
+#include "rt64_capture.h"
+#include "rt64_device.h"
+#include "rt64_immediate.h"
+#include "rt64_instance.h"
+#include "rt64_mesh.h"
+#include "rt64_scene.h"
+
+#include "xxhash/xxhash64.h"
+
+// Private
+
+static unsigned int diffInstanceDescription(const RT64_INSTANCE_DESC &a, const RT64_INSTANCE_DESC &b) {
+	unsigned int fieldMask = 0;
+	fieldMask |= (a.mesh != b.mesh) ? RT64_INSTANCE_FIELD_MESH : 0;
+	fieldMask |= (memcmp(&a.transform, &b.transform, sizeof(RT64_MATRIX4)) != 0) ? RT64_INSTANCE_FIELD_TRANSFORM : 0;
+	fieldMask |= (memcmp(&a.previousTransform, &b.previousTransform, sizeof(RT64_MATRIX4)) != 0) ? RT64_INSTANCE_FIELD_PREVIOUS_TRANSFORM : 0;
+	fieldMask |= (a.diffuseTexture != b.diffuseTexture) ? RT64_INSTANCE_FIELD_DIFFUSE_TEXTURE : 0;
+	fieldMask |= (a.normalTexture != b.normalTexture) ? RT64_INSTANCE_FIELD_NORMAL_TEXTURE : 0;
+	fieldMask |= (a.specularTexture != b.specularTexture) ? RT64_INSTANCE_FIELD_SPECULAR_TEXTURE : 0;
+	fieldMask |= (a.shader != b.shader) ? RT64_INSTANCE_FIELD_SHADER : 0;
+	fieldMask |= (memcmp(&a.material, &b.material, sizeof(RT64_MATERIAL)) != 0) ? RT64_INSTANCE_FIELD_MATERIAL : 0;
+	fieldMask |= (memcmp(&a.scissorRect, &b.scissorRect, sizeof(RT64_RECT)) != 0) ? RT64_INSTANCE_FIELD_SCISSOR_RECT : 0;
+	fieldMask |= (memcmp(&a.viewportRect, &b.viewportRect, sizeof(RT64_RECT)) != 0) ? RT64_INSTANCE_FIELD_VIEWPORT_RECT : 0;
+	fieldMask |= (a.flags != b.flags) ? RT64_INSTANCE_FIELD_FLAGS : 0;
+	return fieldMask;
+}
+
+RT64::Immediate::Immediate(Scene *scene) {
+	assert(scene != nullptr);
+
+	this->scene = scene;
+	frameActive = false;
+}
+
+RT64::Immediate::~Immediate() {
+	scene->getDevice()->waitForRenderThread();
+
+	for (uint32_t slot : drawDiff.getActiveSlots()) {
+		destroyEntry(entries[slot], false);
+	}
+}
+
+void RT64::Immediate::createMesh(Entry &entry, int meshFlags, bool deferred) {
+	entry.mesh = new Mesh(scene->getDevice(), meshFlags);
+	entry.meshFlags = meshFlags;
+	if (deferred) {
+		scene->getDevice()->getImmediateBuffer().recordAttachMesh(entry.mesh);
+	}
+	else {
+		entry.mesh->attach();
+	}
+
+	RT64::Capture *capture = RT64::GlobalCapture;
+	if (capture != nullptr) {
+		capture->beginCall(RT64_CAPTURE_CALL_CREATE_MESH);
+		capture->writeObject(scene->getDevice());
+		capture->writeValue(meshFlags);
+		capture->writeObject(entry.mesh);
+		capture->endCall();
+	}
+}
+
+void RT64::Immediate::destroyMesh(Entry &entry, bool deferred) {
+	RT64::Capture *capture = RT64::GlobalCapture;
+	if (capture != nullptr) {
+		capture->beginCall(RT64_CAPTURE_CALL_DESTROY_MESH);
+		capture->writeObject(entry.mesh);
+		capture->endCall();
+		capture->forgetObject(entry.mesh);
+	}
+
+	if (deferred) {
+		scene->getDevice()->getImmediateBuffer().recordDestroyMesh(entry.mesh);
+	}
+	else {
+		delete entry.mesh;
+	}
+
+	entry.mesh = nullptr;
+}
+
+void RT64::Immediate::updateMesh(Entry &entry, const RT64_DRAW_DESC &drawDesc, bool deferred) {
+	RT64::Capture *capture = RT64::GlobalCapture;
+	if (capture != nullptr) {
+		capture->beginCall(RT64_CAPTURE_CALL_SET_MESH);
+		capture->writeObject(entry.mesh);
+		capture->writeValue(drawDesc.vertexCount);
+		capture->writeValue(drawDesc.vertexStride);
+		capture->writeBlob(drawDesc.vertexArray, (size_t)(drawDesc.vertexCount) * drawDesc.vertexStride);
+		capture->writeValue(drawDesc.indexCount);
+		capture->writeBlob(drawDesc.indexArray, sizeof(unsigned int) * drawDesc.indexCount);
+		capture->endCall();
+	}
+
+	if (deferred) {
+		scene->getDevice()->getImmediateBuffer().recordMesh(entry.mesh, drawDesc.vertexArray, drawDesc.vertexCount, drawDesc.vertexStride, drawDesc.indexArray, drawDesc.indexCount);
+	}
+	else {
+		entry.mesh->updateVertexBuffer(drawDesc.vertexArray, drawDesc.vertexCount, drawDesc.vertexStride);
+		entry.mesh->updateIndexBuffer(drawDesc.indexArray, drawDesc.indexCount);
+		entry.mesh->updateBottomLevelAS();
+	}
+}
+
+void RT64::Immediate::createInstance(Entry &entry, bool deferred) {
+	entry.instance = new Instance(scene);
+	if (deferred) {
+		scene->getDevice()->getImmediateBuffer().recordAttachInstance(entry.instance);
+	}
+	else {
+		entry.instance->attach();
+	}
+
+	RT64::Capture *capture = RT64::GlobalCapture;
+	if (capture != nullptr) {
+		capture->beginCall(RT64_CAPTURE_CALL_CREATE_INSTANCE);
+		capture->writeObject(scene);
+		capture->writeObject(entry.instance);
+		capture->endCall();
+	}
+}
+
+void RT64::Immediate::updateInstance(Entry &entry, const RT64_INSTANCE_DESC &instanceDesc, unsigned int fieldMask, bool deferred) {
+	RT64::Capture *capture = RT64::GlobalCapture;
+	if (capture != nullptr) {
+		capture->beginCall(RT64_CAPTURE_CALL_SET_INSTANCE_DESCRIPTION);
+		capture->writeObject(entry.instance);
+		capture->writeValue((uint32_t)(fieldMask));
+		capture->writeInstanceDescription(instanceDesc);
+		capture->endCall();
+	}
+
+	if (deferred) {
+		scene->getDevice()->getImmediateBuffer().recordInstanceDescription(entry.instance, instanceDesc, fieldMask);
+	}
+	else {
+		entry.instance->setDescription(instanceDesc, fieldMask);
+	}
+
+	entry.instanceDesc = instanceDesc;
+}
+
+void RT64::Immediate::destroyEntry(Entry &entry, bool deferred) {
+	RT64::Capture *capture = RT64::GlobalCapture;
+	if (capture != nullptr) {
+		capture->beginCall(RT64_CAPTURE_CALL_DESTROY_INSTANCE);
+		capture->writeObject(entry.instance);
+		capture->endCall();
+		capture->forgetObject(entry.instance);
+	}
+
+	if (deferred) {
+		scene->getDevice()->getImmediateBuffer().recordDestroyInstance(entry.instance);
+	}
+	else {
+		delete entry.instance;
+	}
+
+	entry.instance = nullptr;
+	destroyMesh(entry, deferred);
+}
+
+void RT64::Immediate::beginFrame() {
+	assert(!frameActive);
+	draws.clear();
+	drawHashes.clear();
+	frameActive = true;
+}
+
+void RT64::Immediate::submitDraw(const RT64_DRAW_DESC &drawDesc) {
+	assert(frameActive);
+	assert(drawDesc.vertexArray != nullptr);
+	assert(drawDesc.vertexCount > 0);
+	assert(drawDesc.indexArray != nullptr);
+	assert(drawDesc.indexCount > 0);
+	assert(drawDesc.shader != nullptr);
+	assert(drawDesc.diffuseTexture != nullptr);
+
+	// Only the mesh contents are hashed. Everything else is compared field by field against the reused instance.
+	XXHash64 hash(0);
+	hash.add(&drawDesc.meshFlags, sizeof(int));
+	hash.add(&drawDesc.vertexStride, sizeof(int));
+	hash.add(drawDesc.vertexArray, (uint64_t)(drawDesc.vertexCount) * drawDesc.vertexStride);
+	hash.add(drawDesc.indexArray, sizeof(unsigned int) * (uint64_t)(drawDesc.indexCount));
+	draws.push_back(drawDesc);
+	drawHashes.push_back(hash.hash());
+}
+
+void RT64::Immediate::endFrame() {
+	assert(frameActive);
+	frameActive = false;
+
+	// Remember the order of the previous frame before the diff replaces it.
+	previousSlots = drawDiff.getActiveSlots();
+	drawDiff.diff(drawHashes, diffResults, retiredSlots);
+	if (entries.size() < drawDiff.getSlotCount()) {
+		entries.resize(drawDiff.getSlotCount(), Entry());
+	}
+
+	// Any created or retired draw changes the order of the slots as well.
+	bool orderChanged = (diffResults.size() != previousSlots.size());
+	for (size_t i = 0; !orderChanged && (i < diffResults.size()); i++) {
+		orderChanged = (diffResults[i].slot != previousSlots[i]);
+	}
+
+	// Creations, destructions and the new order are recorded along with the updates, so the render thread
+	// applies them in the same order without the host having to wait for it.
+	Device *device = scene->getDevice();
+	bool deferred = device->isRenderThreadEnabled();
+	for (uint32_t slot : retiredSlots) {
+		destroyEntry(entries[slot], deferred);
+	}
+
+	for (size_t i = 0; i < diffResults.size(); i++) {
+		const DrawDiff::Result &result = diffResults[i];
+		const RT64_DRAW_DESC &drawDesc = draws[i];
+		Entry &entry = entries[result.slot];
+		switch (result.match) {
+		case DrawDiff::Match::Reused:
+			break;
+		case DrawDiff::Match::Recycled:
+			if (entry.meshFlags != drawDesc.meshFlags) {
+				destroyMesh(entry, deferred);
+				createMesh(entry, drawDesc.meshFlags, deferred);
+			}
+
+			updateMesh(entry, drawDesc, deferred);
+			break;
+		case DrawDiff::Match::Created:
+			createMesh(entry, drawDesc.meshFlags, deferred);
+			createInstance(entry, deferred);
+			updateMesh(entry, drawDesc, deferred);
+			break;
+		}
+
+		RT64_INSTANCE_DESC instanceDesc;
+		instanceDesc.mesh = (RT64_MESH *)(entry.mesh);
+		instanceDesc.transform = drawDesc.transform;
+		instanceDesc.diffuseTexture = drawDesc.diffuseTexture;
+		instanceDesc.normalTexture = drawDesc.normalTexture;
+		instanceDesc.specularTexture = drawDesc.specularTexture;
+		instanceDesc.shader = drawDesc.shader;
+		instanceDesc.material = drawDesc.material;
+		instanceDesc.scissorRect = drawDesc.scissorRect;
+		instanceDesc.viewportRect = drawDesc.viewportRect;
+		instanceDesc.flags = drawDesc.flags;
+
+		// Matched draws are most likely the same object as before, so their last transform is used for motion vectors.
+		if (result.match == DrawDiff::Match::Created) {
+			instanceDesc.previousTransform = drawDesc.transform;
+			updateInstance(entry, instanceDesc, RT64_INSTANCE_FIELD_ALL, deferred);
+		}
+		else {
+			instanceDesc.previousTransform = entry.instanceDesc.transform;
+			unsigned int fieldMask = diffInstanceDescription(entry.instanceDesc, instanceDesc);
+			if (fieldMask != 0) {
+				updateInstance(entry, instanceDesc, fieldMask, deferred);
+			}
+		}
+	}
+
+	// Keep the instances in the scene in the same order the draws were submitted.
+	if (orderChanged) {
+		orderedInstances.clear();
+		for (const DrawDiff::Result &result : diffResults) {
+			orderedInstances.push_back(entries[result.slot].instance);
+		}
+
+		if (deferred) {
+			device->getImmediateBuffer().recordSceneInstanceOrder(scene, orderedInstances);
+		}
+		else {
+			scene->reorderInstances(orderedInstances.data(), orderedInstances.size());
+		}
+	}
+}
+
+const RT64::DrawDiff::Stats &RT64::Immediate::getStats() const {
+	return drawDiff.getStats();
+}
+
+// Public
+
+DLLEXPORT void RT64_BeginFrame(RT64_SCENE *scenePtr) {
+	assert(scenePtr != nullptr);
+	RT64::Scene *scene = (RT64::Scene *)(scenePtr);
+	scene->getImmediate()->beginFrame();
+}
+
+DLLEXPORT void RT64_SubmitDraw(RT64_SCENE *scenePtr, const RT64_DRAW_DESC *drawDesc) {
+	assert(scenePtr != nullptr);
+	assert(drawDesc != nullptr);
+	RT64::Scene *scene = (RT64::Scene *)(scenePtr);
+	scene->getImmediate()->submitDraw(*drawDesc);
+}
+
+DLLEXPORT void RT64_EndFrame(RT64_SCENE *scenePtr) {
+	assert(scenePtr != nullptr);
+
+	try {
+		RT64::Scene *scene = (RT64::Scene *)(scenePtr);
+		scene->getImmediate()->endFrame();
+	}
+	RT64_CATCH_EXCEPTION();
+}
+
+#endif
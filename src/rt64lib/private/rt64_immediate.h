@@ -0,0 +1,51 @@
+//
+// RT64
+//
+
+#pragma once
+
+#include "rt64_common.h"
+#include "rt64_draw_diff.h"
+
+namespace RT64 {
+	class Device;
+	class Instance;
+	class Mesh;
+	class Scene;
+
+	// Turns the draws submitted every frame into retained instances and meshes, reusing the ones from the previous frame when possible.
+	class Immediate {
+	private:
+		struct Entry {
+			Instance *instance;
+			Mesh *mesh;
+			int meshFlags;
+			RT64_INSTANCE_DESC instanceDesc;
+		};
+
+		Scene *scene;
+		DrawDiff drawDiff;
+		std::vector<RT64_DRAW_DESC> draws;
+		std::vector<uint64_t> drawHashes;
+		std::vector<DrawDiff::Result> diffResults;
+		std::vector<uint32_t> retiredSlots;
+		std::vector<Entry> entries;
+		std::vector<uint32_t> previousSlots;
+		std::vector<Instance *> orderedInstances;
+		bool frameActive;
+
+		void createMesh(Entry &entry, int meshFlags, bool deferred);
+		void destroyMesh(Entry &entry, bool deferred);
+		void updateMesh(Entry &entry, const RT64_DRAW_DESC &drawDesc, bool deferred);
+		void createInstance(Entry &entry, bool deferred);
+		void updateInstance(Entry &entry, const RT64_INSTANCE_DESC &instanceDesc, unsigned int fieldMask, bool deferred);
+		void destroyEntry(Entry &entry, bool deferred);
+	public:
+		Immediate(Scene *scene);
+		virtual ~Immediate();
+		void beginFrame();
+		void submitDraw(const RT64_DRAW_DESC &drawDesc);
+		void endFrame();
+		const DrawDiff::Stats &getStats() const;
+	};
+};
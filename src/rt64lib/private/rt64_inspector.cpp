@@ -83,6 +83,7 @@ void RT64::Inspector::render(View *activeView, int cursorX, int cursorY) {
     Im3d::NewFrame();
 
     renderViewParams(activeView);
+    renderFrameStats();
     renderSceneInspector();
     renderMaterialInspector();
     renderLightInspector();
@@ -207,6 +208,35 @@ void RT64::Inspector::renderViewParams(View *view) {
     ImGui::End();
 }
 
+void RT64::Inspector::renderFrameStats() {
+    const char *tlasBuildTypes[] = { "None", "Full", "Update" };
+    RT64_FRAME_STATS frameStats = device->getLastFrameStats();
+    int tlasBuildType = std::clamp(frameStats.tlasBuildType, RT64_TLAS_BUILD_NONE, RT64_TLAS_BUILD_UPDATE);
+
+    ImGui::Begin("Frame Stats");
+    ImGui::Text("RT instances: %d", frameStats.rtInstanceCount);
+    ImGui::Text("Raster BG instances: %d", frameStats.rasterBgInstanceCount);
+    ImGui::Text("Raster FG instances: %d", frameStats.rasterFgInstanceCount);
+    ImGui::Text("Extracted instances: %d", frameStats.extractedInstanceCount);
+    ImGui::Separator();
+    ImGui::Text("BLAS builds: %d", frameStats.blasBuildCount);
+    ImGui::Text("BLAS refits: %d", frameStats.blasRefitCount);
+    ImGui::Text("TLAS build: %s", tlasBuildTypes[tlasBuildType]);
+    ImGui::Separator();
+    ImGui::Text("Mesh uploads: %.1f KB", frameStats.meshUploadBytes / 1024.0);
+    ImGui::Text("Texture uploads: %.1f KB", frameStats.textureUploadBytes / 1024.0);
+    ImGui::Text("Constant uploads: %.1f KB", frameStats.constantUploadBytes / 1024.0);
+    ImGui::Text("Descriptors written: %d", frameStats.descriptorsWritten);
+    ImGui::Text("SBT builds: %d", frameStats.sbtBuildCount);
+    ImGui::Text("SBT records written: %d", frameStats.sbtRecordsWritten);
+    ImGui::Text("Shaders compiled: %d", frameStats.shadersCompiled);
+    ImGui::Text("Heap allocations: %d", frameStats.heapAllocationCount);
+    ImGui::Text("CPU allocations: %d", frameStats.cpuAllocationCount);
+    ImGui::Separator();
+    ImGui::Text("GPU waits: %d (%.2f ms)", frameStats.gpuWaitCount, frameStats.gpuWaitMs);
+    ImGui::End();
+}
+
 void RT64::Inspector::renderSceneInspector() {
     if (sceneDesc != nullptr) {
         ImGui::Begin("Scene Inspector");
@@ -464,11 +494,16 @@ bool RT64::Inspector::handleMessage(UINT msg, WPARAM wParam, LPARAM lParam) {
     return ImGui_ImplWin32_WndProcHandler(device->getHwnd(), msg, wParam, lParam);
 }
 
+RT64::Device* RT64::Inspector::getDevice() const {
+	return device;
+}
+
 // Public
 
 DLLEXPORT RT64_INSPECTOR* RT64_CreateInspector(RT64_DEVICE* devicePtr) {
     assert(devicePtr != nullptr);
     RT64::Device* device = (RT64::Device*)(devicePtr);
+    device->waitForRenderThread();
     RT64::Inspector* inspector = new RT64::Inspector(device);
     return (RT64_INSPECTOR*)(inspector);
 }
@@ -476,42 +511,50 @@ DLLEXPORT RT64_INSPECTOR* RT64_CreateInspector(RT64_DEVICE* devicePtr) {
 DLLEXPORT bool RT64_HandleMessageInspector(RT64_INSPECTOR* inspectorPtr, UINT msg, WPARAM wParam, LPARAM lParam) {
     assert(inspectorPtr != nullptr);
     RT64::Inspector* inspector = (RT64::Inspector*)(inspectorPtr);
+    inspector->getDevice()->waitForRenderThread();
     return inspector->handleMessage(msg, wParam, lParam);
 }
 
 DLLEXPORT void RT64_SetSceneInspector(RT64_INSPECTOR* inspectorPtr, RT64_SCENE_DESC* sceneDesc) {
     assert(inspectorPtr != nullptr);
     RT64::Inspector* inspector = (RT64::Inspector*)(inspectorPtr);
+    inspector->getDevice()->waitForRenderThread();
     inspector->setSceneDescription(sceneDesc);
 }
 
 DLLEXPORT void RT64_SetMaterialInspector(RT64_INSPECTOR* inspectorPtr, RT64_MATERIAL* material, const char* materialName) {
     assert(inspectorPtr != nullptr);
     RT64::Inspector* inspector = (RT64::Inspector*)(inspectorPtr);
+    inspector->getDevice()->waitForRenderThread();
     inspector->setMaterial(material, std::string(materialName));
 }
 
 DLLEXPORT void RT64_SetLightsInspector(RT64_INSPECTOR* inspectorPtr, RT64_LIGHT* lights, int* lightCount, int maxLightCount) {
     assert(inspectorPtr != nullptr);
     RT64::Inspector* inspector = (RT64::Inspector*)(inspectorPtr);
+    inspector->getDevice()->waitForRenderThread();
     inspector->setLights(lights, lightCount, maxLightCount);
 }
 
 DLLEXPORT void RT64_PrintClearInspector(RT64_INSPECTOR* inspectorPtr) {
     assert(inspectorPtr != nullptr);
     RT64::Inspector* inspector = (RT64::Inspector*)(inspectorPtr);
+    inspector->getDevice()->waitForRenderThread();
     inspector->printClear();
 }
 
 DLLEXPORT void RT64_PrintMessageInspector(RT64_INSPECTOR* inspectorPtr, const char* message) {
     assert(inspectorPtr != nullptr);
     RT64::Inspector* inspector = (RT64::Inspector*)(inspectorPtr);
+    inspector->getDevice()->waitForRenderThread();
     std::string messageStr(message);
     inspector->printMessage(messageStr);
 }
 
 DLLEXPORT void RT64_DestroyInspector(RT64_INSPECTOR* inspectorPtr) {
-    delete (RT64::Inspector*)(inspectorPtr);
+    RT64::Inspector* inspector = (RT64::Inspector*)(inspectorPtr);
+    inspector->getDevice()->waitForRenderThread();
+    delete inspector;
 }
 
 #endif
\ No newline at end of file
@@ -31,6 +31,7 @@ namespace RT64 {
 
 		void setupWithView(View *view, int cursorX, int cursorY);
 		void renderViewParams(View *view);
+		void renderFrameStats();
 		void renderSceneInspector();
 		void renderMaterialInspector();
 		void renderLightInspector();
@@ -47,5 +48,6 @@ namespace RT64 {
 		void printClear();
 		void printMessage(const std::string& message);
 		bool handleMessage(UINT msg, WPARAM wParam, LPARAM lParam);
+		Device* getDevice() const;
 	};
 };
\ No newline at end of file
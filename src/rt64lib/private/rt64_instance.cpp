@@ -5,6 +5,8 @@
 #ifndef RT64_MINIMAL
 
 #include "../public/rt64.h"
+#include "rt64_capture.h"
+#include "rt64_device.h"
 #include "rt64_instance.h"
 #include "rt64_scene.h"
 
@@ -27,16 +29,27 @@ RT64::Instance::Instance(Scene *scene) {
 	scissorRect = { 0, 0, 0, 0 };
 	viewportRect = { 0, 0, 0, 0 };
 	flags = 0;
-
-	scene->addInstance(this);
+	dirtyFields = RT64_INSTANCE_FIELD_ALL;
+	generation = Generation::next();
+	sceneHandle = { 0, 0 };
 }
 
 RT64::Instance::~Instance() {
-	scene->removeInstance(this);
+	scene->removeInstance(sceneHandle);
+}
+
+void RT64::Instance::attach() {
+	sceneHandle = scene->addInstance(this);
+}
+
+void RT64::Instance::markDirty(unsigned int fields) {
+	dirtyFields |= fields;
+	generation = Generation::next();
 }
 
 void RT64::Instance::setMesh(Mesh* mesh) {
 	this->mesh = mesh;
+	markDirty(RT64_INSTANCE_FIELD_MESH);
 }
 
 RT64::Mesh* RT64::Instance::getMesh() const {
@@ -45,6 +58,7 @@ RT64::Mesh* RT64::Instance::getMesh() const {
 
 void RT64::Instance::setMaterial(const RT64_MATERIAL &material) {
 	this->material = material;
+	markDirty(RT64_INSTANCE_FIELD_MATERIAL);
 }
 
 const RT64_MATERIAL &RT64::Instance::getMaterial() const {
@@ -53,6 +67,7 @@ const RT64_MATERIAL &RT64::Instance::getMaterial() const {
 
 void RT64::Instance::setShader(Shader *shader) {
 	this->shader = shader;
+	markDirty(RT64_INSTANCE_FIELD_SHADER);
 }
 
 RT64::Shader *RT64::Instance::getShader() const {
@@ -61,6 +76,7 @@ RT64::Shader *RT64::Instance::getShader() const {
 
 void RT64::Instance::setDiffuseTexture(Texture *texture) {
 	this->diffuseTexture = texture;
+	markDirty(RT64_INSTANCE_FIELD_DIFFUSE_TEXTURE);
 }
 
 RT64::Texture *RT64::Instance::getDiffuseTexture() const {
@@ -69,6 +85,7 @@ RT64::Texture *RT64::Instance::getDiffuseTexture() const {
 
 void RT64::Instance::setNormalTexture(Texture* texture) {
 	this->normalTexture = texture;
+	markDirty(RT64_INSTANCE_FIELD_NORMAL_TEXTURE);
 }
 
 RT64::Texture* RT64::Instance::getNormalTexture() const {
@@ -77,13 +94,14 @@ RT64::Texture* RT64::Instance::getNormalTexture() const {
 
 void RT64::Instance::setSpecularTexture(Texture* texture) {
 	this->specularTexture = texture;
+	markDirty(RT64_INSTANCE_FIELD_SPECULAR_TEXTURE);
 }
 
 RT64::Texture* RT64::Instance::getSpecularTexture() const {
 	return specularTexture;
 }
 
-inline XMMATRIX matrixFromFloats(float m[4][4]) {
+inline XMMATRIX matrixFromFloats(const float m[4][4]) {
 	return XMMATRIX(
 		m[0][0], m[0][1], m[0][2], m[0][3],
 		m[1][0], m[1][1], m[1][2], m[1][3],
@@ -92,16 +110,18 @@ inline XMMATRIX matrixFromFloats(float m[4][4]) {
 	);
 }
 
-void RT64::Instance::setTransform(float m[4][4]) {
+void RT64::Instance::setTransform(const float m[4][4]) {
 	transform = matrixFromFloats(m);
+	markDirty(RT64_INSTANCE_FIELD_TRANSFORM);
 }
 
 XMMATRIX RT64::Instance::getTransform() const {
 	return transform;
 }
 
-void RT64::Instance::setPreviousTransform(float m[4][4]) {
+void RT64::Instance::setPreviousTransform(const float m[4][4]) {
 	previousTransform = matrixFromFloats(m);
+	markDirty(RT64_INSTANCE_FIELD_PREVIOUS_TRANSFORM);
 }
 
 XMMATRIX RT64::Instance::getPreviousTransform() const {
@@ -110,6 +130,7 @@ XMMATRIX RT64::Instance::getPreviousTransform() const {
 
 void RT64::Instance::setScissorRect(const RT64_RECT &rect) {
 	scissorRect = rect;
+	markDirty(RT64_INSTANCE_FIELD_SCISSOR_RECT);
 }
 
 RT64_RECT RT64::Instance::getScissorRect() const {
@@ -122,6 +143,7 @@ bool RT64::Instance::hasScissorRect() const {
 
 void RT64::Instance::setViewportRect(const RT64_RECT &rect) {
 	viewportRect = rect;
+	markDirty(RT64_INSTANCE_FIELD_VIEWPORT_RECT);
 }
 
 RT64_RECT RT64::Instance::getViewportRect() const {
@@ -134,42 +156,199 @@ bool RT64::Instance::hasViewportRect() const {
 
 void RT64::Instance::setFlags(int v) {
 	flags = v;
+	markDirty(RT64_INSTANCE_FIELD_FLAGS);
 }
 
 unsigned int RT64::Instance::getFlags() const {
 	return flags;
 }
 
+unsigned int RT64::Instance::getDirtyFields() const {
+	return dirtyFields;
+}
+
+void RT64::Instance::clearDirtyFields() {
+	dirtyFields = 0;
+}
+
+uint64_t RT64::Instance::getGeneration() const {
+	return generation;
+}
+
+void RT64::Instance::setDescription(const RT64_INSTANCE_DESC &instanceDesc, unsigned int fieldMask) {
+	if (fieldMask & RT64_INSTANCE_FIELD_MESH) {
+		assert(instanceDesc.mesh != nullptr);
+		setMesh((Mesh *)(instanceDesc.mesh));
+	}
+
+	if (fieldMask & RT64_INSTANCE_FIELD_TRANSFORM) {
+		setTransform(instanceDesc.transform.m);
+	}
+
+	if (fieldMask & RT64_INSTANCE_FIELD_PREVIOUS_TRANSFORM) {
+		setPreviousTransform(instanceDesc.previousTransform.m);
+	}
+
+	if (fieldMask & RT64_INSTANCE_FIELD_MATERIAL) {
+		setMaterial(instanceDesc.material);
+	}
+
+	if (fieldMask & RT64_INSTANCE_FIELD_SHADER) {
+		assert(instanceDesc.shader != nullptr);
+		setShader((Shader *)(instanceDesc.shader));
+	}
+
+	if (fieldMask & RT64_INSTANCE_FIELD_DIFFUSE_TEXTURE) {
+		assert(instanceDesc.diffuseTexture != nullptr);
+		setDiffuseTexture((Texture *)(instanceDesc.diffuseTexture));
+	}
+
+	if (fieldMask & RT64_INSTANCE_FIELD_NORMAL_TEXTURE) {
+		setNormalTexture((Texture *)(instanceDesc.normalTexture));
+	}
+
+	if (fieldMask & RT64_INSTANCE_FIELD_SPECULAR_TEXTURE) {
+		setSpecularTexture((Texture *)(instanceDesc.specularTexture));
+	}
+
+	if (fieldMask & RT64_INSTANCE_FIELD_FLAGS) {
+		setFlags(instanceDesc.flags);
+	}
+
+	if (fieldMask & RT64_INSTANCE_FIELD_SCISSOR_RECT) {
+		setScissorRect(instanceDesc.scissorRect);
+	}
+
+	if (fieldMask & RT64_INSTANCE_FIELD_VIEWPORT_RECT) {
+		setViewportRect(instanceDesc.viewportRect);
+	}
+}
+
+RT64::Scene *RT64::Instance::getScene() const {
+	return scene;
+}
+
+RT64::SlotHandle RT64::Instance::getSceneHandle() const {
+	return sceneHandle;
+}
+
 // Public
 
 DLLEXPORT RT64_INSTANCE *RT64_CreateInstance(RT64_SCENE *scenePtr) {
 	RT64::Scene *scene = (RT64::Scene *)(scenePtr);
+	RT64::Device *device = scene->getDevice();
 	RT64::Instance *instance = new RT64::Instance(scene);
+	if (device->isRenderThreadEnabled()) {
+		device->getImmediateBuffer().recordAttachInstance(instance);
+	}
+	else {
+		instance->attach();
+	}
+
+	RT64::Capture *capture = RT64::GlobalCapture;
+	if (capture != nullptr) {
+		capture->beginCall(RT64_CAPTURE_CALL_CREATE_INSTANCE);
+		capture->writeObject(scenePtr);
+		capture->writeObject(instance);
+		capture->endCall();
+	}
+
 	return (RT64_INSTANCE *)(instance);
 }
 
 DLLEXPORT void RT64_SetInstanceDescription(RT64_INSTANCE *instancePtr, RT64_INSTANCE_DESC instanceDesc) {
 	assert(instancePtr != nullptr);
-	assert(instanceDesc.mesh != nullptr);
-	assert(instanceDesc.diffuseTexture != nullptr);
-	assert(instanceDesc.shader != nullptr);
+
+	RT64::Capture *capture = RT64::GlobalCapture;
+	if (capture != nullptr) {
+		capture->beginCall(RT64_CAPTURE_CALL_SET_INSTANCE_DESCRIPTION);
+		capture->writeObject(instancePtr);
+		capture->writeValue((uint32_t)(RT64_INSTANCE_FIELD_ALL));
+		capture->writeInstanceDescription(instanceDesc);
+		capture->endCall();
+	}
+
+	RT64::Instance *instance = (RT64::Instance *)(instancePtr);
+	RT64::Device *device = instance->getScene()->getDevice();
+	if (device->isRenderThreadEnabled()) {
+		device->getImmediateBuffer().recordInstanceDescription(instance, instanceDesc, RT64_INSTANCE_FIELD_ALL);
+	}
+	else {
+		instance->setDescription(instanceDesc, RT64_INSTANCE_FIELD_ALL);
+	}
+}
+
+DLLEXPORT void RT64_SetInstanceDescriptions(RT64_INSTANCE **instancePtrs, const RT64_INSTANCE_DESC *instanceDescs, int instanceCount) {
+	assert((instanceCount == 0) || (instancePtrs != nullptr));
+	assert((instanceCount == 0) || (instanceDescs != nullptr));
+
+	RT64::Capture *capture = RT64::GlobalCapture;
+	if (capture != nullptr) {
+		capture->beginCall(RT64_CAPTURE_CALL_SET_INSTANCE_DESCRIPTIONS);
+		capture->writeValue(instanceCount);
+		for (int i = 0; i < instanceCount; i++) {
+			capture->writeObject(instancePtrs[i]);
+			capture->writeInstanceDescription(instanceDescs[i]);
+		}
+
+		capture->endCall();
+	}
+
+	// Descriptions are passed by pointer so the whole batch crosses the library boundary in a single call.
+	for (int i = 0; i < instanceCount; i++) {
+		RT64::Instance *instance = (RT64::Instance *)(instancePtrs[i]);
+		RT64::Device *device = instance->getScene()->getDevice();
+		if (device->isRenderThreadEnabled()) {
+			device->getImmediateBuffer().recordInstanceDescription(instance, instanceDescs[i], RT64_INSTANCE_FIELD_ALL);
+		}
+		else {
+			instance->setDescription(instanceDescs[i], RT64_INSTANCE_FIELD_ALL);
+		}
+	}
+}
+
+DLLEXPORT void RT64_UpdateInstanceDescription(RT64_INSTANCE *instancePtr, const RT64_INSTANCE_DESC *instanceDesc, unsigned int fieldMask) {
+	assert(instancePtr != nullptr);
+	assert(instanceDesc != nullptr);
+
+	RT64::Capture *capture = RT64::GlobalCapture;
+	if (capture != nullptr) {
+		capture->beginCall(RT64_CAPTURE_CALL_SET_INSTANCE_DESCRIPTION);
+		capture->writeObject(instancePtr);
+		capture->writeValue((uint32_t)(fieldMask));
+		capture->writeInstanceDescription(*instanceDesc);
+		capture->endCall();
+	}
 
 	RT64::Instance *instance = (RT64::Instance *)(instancePtr);
-	instance->setMesh((RT64::Mesh *)(instanceDesc.mesh));
-	instance->setTransform(instanceDesc.transform.m);
-	instance->setPreviousTransform(instanceDesc.previousTransform.m);
-	instance->setMaterial(instanceDesc.material);
-	instance->setShader((RT64::Shader *)(instanceDesc.shader));
-	instance->setDiffuseTexture((RT64::Texture *)(instanceDesc.diffuseTexture));
-	instance->setNormalTexture((RT64::Texture *)(instanceDesc.normalTexture));
-	instance->setSpecularTexture((RT64::Texture *)(instanceDesc.specularTexture));
-	instance->setFlags(instanceDesc.flags);
-	instance->setScissorRect(instanceDesc.scissorRect);
-	instance->setViewportRect(instanceDesc.viewportRect);
+	RT64::Device *device = instance->getScene()->getDevice();
+	if (device->isRenderThreadEnabled()) {
+		device->getImmediateBuffer().recordInstanceDescription(instance, *instanceDesc, fieldMask);
+	}
+	else {
+		instance->setDescription(*instanceDesc, fieldMask);
+	}
 }
 
 DLLEXPORT void RT64_DestroyInstance(RT64_INSTANCE *instancePtr) {
-	delete (RT64::Instance *)(instancePtr);
+	RT64::Instance *instance = (RT64::Instance *)(instancePtr);
+
+	RT64::Capture *capture = RT64::GlobalCapture;
+	if (capture != nullptr) {
+		capture->beginCall(RT64_CAPTURE_CALL_DESTROY_INSTANCE);
+		capture->writeObject(instancePtr);
+		capture->endCall();
+		capture->forgetObject(instancePtr);
+	}
+
+	// The render thread deletes the instance once it has finished the frames that could still use it.
+	RT64::Device *device = instance->getScene()->getDevice();
+	if (device->isRenderThreadEnabled()) {
+		device->getImmediateBuffer().recordDestroyInstance(instance);
+	}
+	else {
+		delete instance;
+	}
 }
 
 #endif
\ No newline at end of file
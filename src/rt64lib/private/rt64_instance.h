@@ -5,6 +5,7 @@
 #pragma once
 
 #include "rt64_common.h"
+#include "rt64_slot_map.h"
 
 namespace RT64 {
 	class Mesh;
@@ -15,6 +16,7 @@ namespace RT64 {
 	class Instance {
 	private:
 		Scene *scene;
+		SlotHandle sceneHandle;
 		Mesh *mesh;
 		Texture *diffuseTexture;
 		Texture* normalTexture;
@@ -26,9 +28,16 @@ namespace RT64 {
 		RT64_RECT scissorRect;
 		RT64_RECT viewportRect;
 		unsigned int flags;
+		unsigned int dirtyFields;
+		uint64_t generation;
+
+		void markDirty(unsigned int fields);
 	public:
 		Instance(Scene *scene);
 		virtual ~Instance();
+
+		// Adds the instance to its scene. It's separate from the constructor so the render thread can do it when it's enabled.
+		void attach();
 		void setMesh(Mesh *mesh);
 		Mesh *getMesh() const;
 		void setMaterial(const RT64_MATERIAL &material);
@@ -41,9 +50,9 @@ namespace RT64 {
 		Texture* getNormalTexture() const;
 		void setSpecularTexture(Texture* texture);
 		Texture* getSpecularTexture() const;
-		void setTransform(float m[4][4]);
+		void setTransform(const float m[4][4]);
 		XMMATRIX getTransform() const;
-		void setPreviousTransform(float m[4][4]);
+		void setPreviousTransform(const float m[4][4]);
 		XMMATRIX getPreviousTransform() const;
 		void setScissorRect(const RT64_RECT &rect);
 		RT64_RECT getScissorRect() const;
@@ -53,5 +62,11 @@ namespace RT64 {
 		bool hasViewportRect() const;
 		void setFlags(int v);
 		unsigned int getFlags() const;
+		unsigned int getDirtyFields() const;
+		void clearDirtyFields();
+		uint64_t getGeneration() const;
+		void setDescription(const RT64_INSTANCE_DESC &instanceDesc, unsigned int fieldMask);
+		Scene *getScene() const;
+		SlotHandle getSceneHandle() const;
 	};
 };
\ No newline at end of file
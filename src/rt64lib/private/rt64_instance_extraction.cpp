@@ -0,0 +1,33 @@
+//
+// RT64
+//
+
+#include "rt64_instance_extraction.h"
+
+#include <assert.h>
+
+// Private
+
+RT64::InstanceExtraction::InstanceExtraction() {
+	memset(listSizes, 0, sizeof(listSizes));
+	instanceCount = 0;
+	chunkCount = 0;
+}
+
+void RT64::InstanceExtraction::computeOffsets() {
+	// Turn the counts into the position each chunk starts writing at, so the lists keep the scene's order.
+	memset(listSizes, 0, sizeof(listSizes));
+	for (size_t c = 0; c < chunkCount; c++) {
+		for (size_t l = 0; l < ListCount; l++) {
+			size_t &chunkOffset = chunkOffsets[c * ListCount + l];
+			size_t chunkListCount = chunkOffset;
+			chunkOffset = listSizes[l];
+			listSizes[l] += chunkListCount;
+		}
+	}
+}
+
+size_t RT64::InstanceExtraction::getListSize(size_t listIndex) const {
+	assert(listIndex < ListCount);
+	return listSizes[listIndex];
+}
@@ -0,0 +1,75 @@
+//
+// RT64
+//
+
+#pragma once
+
+#include <algorithm>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <vector>
+
+#include "rt64_worker_pool.h"
+
+namespace RT64 {
+	// Sorts a view's instances into its lists on a worker pool while every list keeps the order of the scene.
+	// The instances are split into chunks that are classified and counted in parallel. The counts are turned into the
+	// position each chunk starts writing at in every list, so the chunks can fill their ranges in parallel as well.
+	class InstanceExtraction {
+	public:
+		static const size_t ChunkSize = 256;
+		static const size_t ListCount = 3;
+	private:
+		std::vector<uint8_t> listIndices;
+		std::vector<size_t> chunkOffsets;
+		size_t listSizes[ListCount];
+		size_t instanceCount;
+		size_t chunkCount;
+
+		void computeOffsets();
+	public:
+		InstanceExtraction();
+
+		// Calls the function with the index of every instance to get the index of the list it goes in.
+		template<typename T>
+		void classify(WorkerPool &workerPool, size_t count, const T &classifyFunction) {
+			instanceCount = count;
+			chunkCount = (instanceCount + ChunkSize - 1) / ChunkSize;
+			listIndices.resize(instanceCount);
+			chunkOffsets.assign(chunkCount * ListCount, 0);
+			workerPool.run(chunkCount, [&](size_t chunkIndex) {
+				size_t chunkCounts[ListCount] = {};
+				const size_t chunkEnd = std::min((chunkIndex + 1) * ChunkSize, instanceCount);
+				for (size_t i = chunkIndex * ChunkSize; i < chunkEnd; i++) {
+					uint8_t listIndex = (uint8_t)(classifyFunction(i));
+					listIndices[i] = listIndex;
+					chunkCounts[listIndex]++;
+				}
+
+				memcpy(&chunkOffsets[chunkIndex * ListCount], chunkCounts, sizeof(chunkCounts));
+			});
+
+			computeOffsets();
+		}
+
+		// Size of the list after the last classification. The lists must be resized to it before they're filled.
+		size_t getListSize(size_t listIndex) const;
+
+		// Calls the function with the index of every instance, the index of its list and its position in that list.
+		// Instances in the same chunk are visited in order, but the chunks run in any order and on any thread.
+		template<typename T>
+		void fill(WorkerPool &workerPool, const T &fillFunction) const {
+			workerPool.run(chunkCount, [&](size_t chunkIndex) {
+				size_t listOffsets[ListCount];
+				memcpy(listOffsets, &chunkOffsets[chunkIndex * ListCount], sizeof(listOffsets));
+
+				const size_t chunkEnd = std::min((chunkIndex + 1) * ChunkSize, instanceCount);
+				for (size_t i = chunkIndex * ChunkSize; i < chunkEnd; i++) {
+					uint8_t listIndex = listIndices[i];
+					fillFunction(i, listIndex, listOffsets[listIndex]++);
+				}
+			});
+		}
+	};
+};
@@ -0,0 +1,93 @@
+//
+// RT64
+//
+
+#include "rt64_material_table.h"
+
+#include <string.h>
+
+#include "xxhash/xxhash64.h"
+
+// Private
+
+void RT64::MaterialTable::resizeHashBuckets(size_t bucketCount) {
+	hashBuckets.resize(bucketCount);
+	for (HashBucket &bucket : hashBuckets) {
+		bucket.occupied = 0;
+	}
+
+	for (size_t i = 0; i < materials.size(); i++) {
+		HashBucket &bucket = findHashBucket(materialHashes[i], materials[i]);
+		bucket.hash = materialHashes[i];
+		bucket.index = (uint32_t)(i);
+		bucket.occupied = 1;
+	}
+}
+
+RT64::MaterialTable::HashBucket &RT64::MaterialTable::findHashBucket(uint64_t hash, const RT64_MATERIAL &material) {
+	const size_t mask = hashBuckets.size() - 1;
+	size_t index = (size_t)(hash) & mask;
+	while (hashBuckets[index].occupied) {
+		const HashBucket &bucket = hashBuckets[index];
+		if ((bucket.hash == hash) && (memcmp(&materials[bucket.index], &material, sizeof(RT64_MATERIAL)) == 0)) {
+			break;
+		}
+
+		index = (index + 1) & mask;
+	}
+
+	return hashBuckets[index];
+}
+
+void RT64::MaterialTable::begin() {
+	std::swap(materials, previousMaterials);
+	materials.clear();
+	materialHashes.clear();
+
+	// The buckets only grow, so the table doesn't need to allocate again once it's big enough.
+	if (hashBuckets.empty()) {
+		hashBuckets.resize(64);
+	}
+
+	for (HashBucket &bucket : hashBuckets) {
+		bucket.occupied = 0;
+	}
+}
+
+uint32_t RT64::MaterialTable::intern(const RT64_MATERIAL &material) {
+	// The attribute flags are only used when applying the material on the CPU, so they don't make materials different.
+	RT64_MATERIAL key = material;
+	key.enabledAttributes = 0;
+
+	uint64_t hash = XXHash64::hash(&key, sizeof(RT64_MATERIAL), 0);
+	HashBucket &bucket = findHashBucket(hash, key);
+	if (bucket.occupied) {
+		return bucket.index;
+	}
+
+	uint32_t index = (uint32_t)(materials.size());
+	materials.push_back(key);
+	materialHashes.push_back(hash);
+	bucket.hash = hash;
+	bucket.index = index;
+	bucket.occupied = 1;
+
+	// Keep the buckets at most half full.
+	if ((materials.size() * 2) > hashBuckets.size()) {
+		resizeHashBuckets(hashBuckets.size() * 2);
+	}
+
+	return index;
+}
+
+bool RT64::MaterialTable::end() {
+	return (materials.size() != previousMaterials.size()) || (!materials.empty() && (memcmp(materials.data(), previousMaterials.data(), materials.size() * sizeof(RT64_MATERIAL)) != 0));
+}
+
+const RT64_MATERIAL *RT64::MaterialTable::getMaterials() const {
+	return materials.data();
+}
+
+size_t RT64::MaterialTable::size() const {
+	return materials.size();
+}
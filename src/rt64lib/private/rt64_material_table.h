@@ -0,0 +1,41 @@
+//
+// RT64
+//
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+#include "../public/rt64.h"
+
+namespace RT64 {
+	// Deduplicates the materials used by the instances of a view, so every instance only needs to reference the index of
+	// its material. The table is rebuilt on every pass and remembers the previous contents, so the caller can tell if it changed.
+	class MaterialTable {
+	private:
+		struct HashBucket {
+			uint64_t hash;
+			uint32_t index;
+			uint32_t occupied;
+		};
+
+		std::vector<RT64_MATERIAL> materials;
+		std::vector<RT64_MATERIAL> previousMaterials;
+		std::vector<uint64_t> materialHashes;
+		std::vector<HashBucket> hashBuckets;
+
+		void resizeHashBuckets(size_t bucketCount);
+		HashBucket &findHashBucket(uint64_t hash, const RT64_MATERIAL &material);
+	public:
+		void begin();
+		uint32_t intern(const RT64_MATERIAL &material);
+
+		// Returns whether the contents of the table are different from the ones it had after the previous pass.
+		bool end();
+
+		const RT64_MATERIAL *getMaterials() const;
+		size_t size() const;
+	};
+};
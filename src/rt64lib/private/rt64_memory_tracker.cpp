@@ -0,0 +1,106 @@
+//
+// RT64
+//
+
+#include "rt64_memory_tracker.h"
+
+#include <assert.h>
+
+// Private
+
+RT64::MemoryTracker::MemoryTracker() {
+	totals = {};
+	budgetThreshold = 0;
+	budgetCallback = nullptr;
+	budgetUserData = nullptr;
+	budgetExceeded = false;
+}
+
+bool RT64::MemoryTracker::checkBudget(BudgetCallback &callback, void *&userData) {
+	// The callback only fires when the usage crosses the threshold and is armed again once it drops below it.
+	if (budgetExceeded) {
+		budgetExceeded = (totals.totalBytes >= budgetThreshold);
+		return false;
+	}
+
+	if ((budgetCallback == nullptr) || (totals.totalBytes < budgetThreshold)) {
+		return false;
+	}
+
+	budgetExceeded = true;
+	callback = budgetCallback;
+	userData = budgetUserData;
+	return true;
+}
+
+void RT64::MemoryTracker::add(const void *allocation, uint32_t category, uint64_t size) {
+	assert(allocation != nullptr);
+	assert(category < CategoryCount);
+
+	BudgetCallback callback = nullptr;
+	void *userData = nullptr;
+	uint64_t usedBytes = 0;
+	uint64_t thresholdBytes = 0;
+	bool fireCallback = false;
+	{
+		std::scoped_lock lock(trackerMutex);
+		auto insertResult = entries.insert({ allocation, { category, size } });
+		assert(insertResult.second && "The allocation is already being tracked.");
+		totals.categoryBytes[category] += size;
+		totals.categoryAllocationCount[category]++;
+		totals.totalBytes += size;
+		fireCallback = checkBudget(callback, userData);
+		usedBytes = totals.totalBytes;
+		thresholdBytes = budgetThreshold;
+	}
+
+	// Call the host outside of the lock so it can query the totals again.
+	if (fireCallback) {
+		callback(userData, usedBytes, thresholdBytes);
+	}
+}
+
+void RT64::MemoryTracker::remove(const void *allocation) {
+	std::scoped_lock lock(trackerMutex);
+	auto it = entries.find(allocation);
+	if (it == entries.end()) {
+		return;
+	}
+
+	const Entry &entry = it->second;
+	totals.categoryBytes[entry.category] -= entry.size;
+	totals.categoryAllocationCount[entry.category]--;
+	totals.totalBytes -= entry.size;
+	entries.erase(it);
+
+	BudgetCallback callback = nullptr;
+	void *userData = nullptr;
+	checkBudget(callback, userData);
+}
+
+void RT64::MemoryTracker::setBudget(uint64_t thresholdBytes, BudgetCallback callback, void *userData) {
+	BudgetCallback firedCallback = nullptr;
+	void *firedUserData = nullptr;
+	uint64_t usedBytes = 0;
+	bool fireCallback = false;
+	{
+		std::scoped_lock lock(trackerMutex);
+		budgetThreshold = thresholdBytes;
+		budgetCallback = callback;
+		budgetUserData = userData;
+		budgetExceeded = false;
+
+		// Notify the host right away if the usage is already over the new threshold.
+		fireCallback = checkBudget(firedCallback, firedUserData);
+		usedBytes = totals.totalBytes;
+	}
+
+	if (fireCallback) {
+		firedCallback(firedUserData, usedBytes, thresholdBytes);
+	}
+}
+
+RT64::MemoryTracker::Totals RT64::MemoryTracker::getTotals() const {
+	std::scoped_lock lock(trackerMutex);
+	return totals;
+}
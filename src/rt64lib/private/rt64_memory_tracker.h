@@ -0,0 +1,48 @@
+//
+// RT64
+//
+
+#pragma once
+
+#include <mutex>
+#include <stddef.h>
+#include <stdint.h>
+#include <unordered_map>
+
+namespace RT64 {
+	// Keeps track of the size and category of every live allocation made by the device.
+	// Allocations are only identified by their address so it doesn't depend on any D3D12 objects.
+	class MemoryTracker {
+	public:
+		static const uint32_t CategoryCount = 8;
+
+		typedef void (*BudgetCallback)(void *userData, unsigned long long usedBytes, unsigned long long thresholdBytes);
+
+		struct Totals {
+			uint64_t categoryBytes[CategoryCount];
+			uint32_t categoryAllocationCount[CategoryCount];
+			uint64_t totalBytes;
+		};
+	private:
+		struct Entry {
+			uint32_t category;
+			uint64_t size;
+		};
+
+		mutable std::mutex trackerMutex;
+		std::unordered_map<const void *, Entry> entries;
+		Totals totals;
+		uint64_t budgetThreshold;
+		BudgetCallback budgetCallback;
+		void *budgetUserData;
+		bool budgetExceeded;
+
+		bool checkBudget(BudgetCallback &callback, void *&userData);
+	public:
+		MemoryTracker();
+		void add(const void *allocation, uint32_t category, uint64_t size);
+		void remove(const void *allocation);
+		void setBudget(uint64_t thresholdBytes, BudgetCallback callback, void *userData);
+		Totals getTotals() const;
+	};
+};
@@ -5,6 +5,7 @@
 #ifndef RT64_MINIMAL
 
 #include "../public/rt64.h"
+#include "rt64_capture.h"
 #include "rt64_mesh.h"
 #include "rt64_device.h"
 
@@ -17,9 +18,31 @@ RT64::Mesh::Mesh(Device *device, int flags) {
 	vertexCount = 0;
 	indexCount = 0;
 	vertexStride = 0;
+	vertexBufferUploadData = nullptr;
+	indexBufferUploadData = nullptr;
+	vertexBufferMapped = false;
+	indexBufferMapped = false;
+	vertexBufferSlot = UINT32_MAX;
+	indexBufferSlot = UINT32_MAX;
+	generation = Generation::next();
+	bottomLevelASGeneration = generation;
+	hostVertexData = nullptr;
+	hostIndexData = nullptr;
+	hostVertexBlock = 0;
+	hostIndexBlock = 0;
+	hostVertexCount = 0;
+	hostIndexCount = 0;
+	hostVertexStride = 0;
+	hostVerticesMapped = false;
+	hostIndicesMapped = false;
 }
 
 RT64::Mesh::~Mesh() {
+	if (flags & RT64_MESH_RAYTRACE_ENABLED) {
+		device->freeMeshSlot(vertexBufferSlot);
+		device->freeMeshSlot(indexBufferSlot);
+	}
+
 	vertexBuffer.Release();
 	vertexBufferUpload.Release();
 	indexBuffer.Release();
@@ -27,37 +50,88 @@ RT64::Mesh::~Mesh() {
 	d3dBottomLevelASBuffers.Release();
 }
 
+void RT64::Mesh::attach() {
+	// The hit groups read the buffers through the descriptor heaps.
+	if (flags & RT64_MESH_RAYTRACE_ENABLED) {
+		vertexBufferSlot = device->allocateMeshSlot(this);
+		indexBufferSlot = device->allocateMeshSlot(this);
+	}
+}
+
 void RT64::Mesh::updateVertexBuffer(void *vertexArray, int vertexCount, int vertexStride) {
+	void *vertexData = mapVertexBuffer(vertexCount, vertexStride);
+	memcpy(vertexData, vertexArray, vertexCount * vertexStride);
+	unmapVertexBuffer();
+}
+
+void RT64::Mesh::updateVertexBufferRange(void *vertexArray, int vertexStart, int vertexCount) {
+	assert(!vertexBuffer.IsNull());
+	assert(!vertexBufferMapped);
+	assert((vertexStart >= 0) && (vertexCount > 0));
+	assert((vertexStart + vertexCount) <= this->vertexCount);
+	const UINT64 rangeOffset = (UINT64)(vertexStart) * vertexStride;
+	const UINT64 rangeSize = (UINT64)(vertexCount) * vertexStride;
+
+	// Copy only the modified range to the upload heap.
+	memcpy(vertexBufferUploadData + rangeOffset, vertexArray, rangeSize);
+	device->getFrameStats().meshUploadBytes += rangeSize;
+
+	// Copy the same range to the real default resource.
+	CD3DX12_RESOURCE_BARRIER transition = CD3DX12_RESOURCE_BARRIER::Transition(vertexBuffer.Get(), D3D12_RESOURCE_STATE_GENERIC_READ, D3D12_RESOURCE_STATE_COPY_DEST);
+	device->getD3D12CommandList()->ResourceBarrier(1, &transition);
+	device->getD3D12CommandList()->CopyBufferRegion(vertexBuffer.Get(), rangeOffset, vertexBufferUpload.Get(), rangeOffset, rangeSize);
+
+	// Wait for the resource to finish copying before switching back to generic read.
+	transition = CD3DX12_RESOURCE_BARRIER::Transition(vertexBuffer.Get(), D3D12_RESOURCE_STATE_COPY_DEST, D3D12_RESOURCE_STATE_GENERIC_READ);
+	device->getD3D12CommandList()->ResourceBarrier(1, &transition);
+	generation = Generation::next();
+}
+
+void *RT64::Mesh::mapVertexBuffer(int vertexCount, int vertexStride) {
+	assert(!vertexBufferMapped);
 	const UINT vertexBufferSize = vertexCount * vertexStride;
 
 	if (!vertexBuffer.IsNull() && ((this->vertexCount != vertexCount) || (this->vertexStride != vertexStride))) {
 		vertexBuffer.Release();
 		vertexBufferUpload.Release();
+		vertexBufferUploadData = nullptr;
 
 		// Discard the BLAS since it won't be compatible anymore even if it's updatable.
-		d3dBottomLevelASBuffers.Release();
+		releaseBottomLevelAS();
 	}
 
 	if (vertexBuffer.IsNull()) {
 		CD3DX12_RESOURCE_DESC uploadBufferDesc = CD3DX12_RESOURCE_DESC::Buffer(vertexBufferSize);
-		vertexBufferUpload = device->allocateResource(D3D12_HEAP_TYPE_UPLOAD, &uploadBufferDesc, D3D12_RESOURCE_STATE_GENERIC_READ, nullptr);
+		vertexBufferUpload = device->allocateResource(RT64_MEMORY_CATEGORY_UPLOAD, D3D12_HEAP_TYPE_UPLOAD, &uploadBufferDesc, D3D12_RESOURCE_STATE_GENERIC_READ, nullptr);
 
 		CD3DX12_RESOURCE_DESC bufferDesc = CD3DX12_RESOURCE_DESC::Buffer(vertexBufferSize);
-		vertexBuffer = device->allocateResource(D3D12_HEAP_TYPE_DEFAULT, &bufferDesc, D3D12_RESOURCE_STATE_COPY_DEST, nullptr);
+		vertexBuffer = device->allocateResource(RT64_MEMORY_CATEGORY_VERTEX_INDEX, D3D12_HEAP_TYPE_DEFAULT, &bufferDesc, D3D12_RESOURCE_STATE_GENERIC_READ, nullptr);
+
+		// Upload heaps can stay mapped for their whole lifetime.
+		CD3DX12_RANGE readRange(0, 0);
+		D3D12_CHECK(vertexBufferUpload.Get()->Map(0, &readRange, reinterpret_cast<void **>(&vertexBufferUploadData)));
 	}
 
-	// Copy data to upload heap.
-	UINT8 *pDataBegin;
-	CD3DX12_RANGE readRange(0, 0);
-	D3D12_CHECK(vertexBufferUpload.Get()->Map(0, &readRange, reinterpret_cast<void**>(&pDataBegin)));
-	memcpy(pDataBegin, vertexArray, vertexBufferSize);
-	vertexBufferUpload.Get()->Unmap(0, nullptr);
-	
+	// Store the new vertex count and stride.
+	this->vertexCount = vertexCount;
+	this->vertexStride = vertexStride;
+
+	vertexBufferMapped = true;
+	return vertexBufferUploadData;
+}
+
+void RT64::Mesh::unmapVertexBuffer() {
+	assert(vertexBufferMapped);
+	const UINT vertexBufferSize = vertexCount * vertexStride;
+
 	// Copy resource to the real default resource.
+	CD3DX12_RESOURCE_BARRIER transition = CD3DX12_RESOURCE_BARRIER::Transition(vertexBuffer.Get(), D3D12_RESOURCE_STATE_GENERIC_READ, D3D12_RESOURCE_STATE_COPY_DEST);
+	device->getD3D12CommandList()->ResourceBarrier(1, &transition);
 	device->getD3D12CommandList()->CopyResource(vertexBuffer.Get(), vertexBufferUpload.Get());
+	device->getFrameStats().meshUploadBytes += vertexBufferSize;
 
 	// Wait for the resource to finish copying before switching to generic read.
-	CD3DX12_RESOURCE_BARRIER transition = CD3DX12_RESOURCE_BARRIER::Transition(vertexBuffer.Get(), D3D12_RESOURCE_STATE_COPY_DEST, D3D12_RESOURCE_STATE_GENERIC_READ);
+	transition = CD3DX12_RESOURCE_BARRIER::Transition(vertexBuffer.Get(), D3D12_RESOURCE_STATE_COPY_DEST, D3D12_RESOURCE_STATE_GENERIC_READ);
 	device->getD3D12CommandList()->ResourceBarrier(1, &transition);
 
 	// Configure vertex buffer view.
@@ -65,42 +139,59 @@ void RT64::Mesh::updateVertexBuffer(void *vertexArray, int vertexCount, int vert
 	d3dVertexBufferView.StrideInBytes = vertexStride;
 	d3dVertexBufferView.SizeInBytes = vertexBufferSize;
 
-	// Store the new vertex count and stride.
-	this->vertexCount = vertexCount;
-	this->vertexStride = vertexStride;
+	vertexBufferMapped = false;
+	generation = Generation::next();
 }
 
 void RT64::Mesh::updateIndexBuffer(unsigned int *indexArray, int indexCount) {
+	unsigned int *indexData = mapIndexBuffer(indexCount);
+	memcpy(indexData, indexArray, indexCount * sizeof(unsigned int));
+	unmapIndexBuffer();
+}
+
+unsigned int *RT64::Mesh::mapIndexBuffer(int indexCount) {
+	assert(!indexBufferMapped);
 	const UINT indexBufferSize = indexCount * sizeof(unsigned int);
 
 	if (!indexBuffer.IsNull() && (this->indexCount != indexCount)) {
 		indexBuffer.Release();
 		indexBufferUpload.Release();
+		indexBufferUploadData = nullptr;
 
 		// Discard the BLAS since it won't be compatible anymore even if it's updatable.
-		d3dBottomLevelASBuffers.Release();
+		releaseBottomLevelAS();
 	}
 
 	if (indexBuffer.IsNull()) {
 		CD3DX12_RESOURCE_DESC uploadBufferDesc = CD3DX12_RESOURCE_DESC::Buffer(indexBufferSize);
-		indexBufferUpload = device->allocateResource(D3D12_HEAP_TYPE_UPLOAD, &uploadBufferDesc, D3D12_RESOURCE_STATE_GENERIC_READ, nullptr);
+		indexBufferUpload = device->allocateResource(RT64_MEMORY_CATEGORY_UPLOAD, D3D12_HEAP_TYPE_UPLOAD, &uploadBufferDesc, D3D12_RESOURCE_STATE_GENERIC_READ, nullptr);
 
 		CD3DX12_RESOURCE_DESC bufferDesc = CD3DX12_RESOURCE_DESC::Buffer(indexBufferSize);
-		indexBuffer = device->allocateResource(D3D12_HEAP_TYPE_DEFAULT, &bufferDesc, D3D12_RESOURCE_STATE_COPY_DEST, nullptr);
+		indexBuffer = device->allocateResource(RT64_MEMORY_CATEGORY_VERTEX_INDEX, D3D12_HEAP_TYPE_DEFAULT, &bufferDesc, D3D12_RESOURCE_STATE_GENERIC_READ, nullptr);
+
+		// Upload heaps can stay mapped for their whole lifetime.
+		CD3DX12_RANGE readRange(0, 0);
+		D3D12_CHECK(indexBufferUpload.Get()->Map(0, &readRange, reinterpret_cast<void **>(&indexBufferUploadData)));
 	}
 
-	// Copy data to upload heap.
-	UINT8 *pDataBegin;
-	CD3DX12_RANGE readRange(0, 0);
-	D3D12_CHECK(indexBufferUpload.Get()->Map(0, &readRange, reinterpret_cast<void **>(&pDataBegin)));
-	memcpy(pDataBegin, indexArray, indexBufferSize);
-	indexBufferUpload.Get()->Unmap(0, nullptr);
-	
+	this->indexCount = indexCount;
+
+	indexBufferMapped = true;
+	return reinterpret_cast<unsigned int *>(indexBufferUploadData);
+}
+
+void RT64::Mesh::unmapIndexBuffer() {
+	assert(indexBufferMapped);
+	const UINT indexBufferSize = indexCount * sizeof(unsigned int);
+
 	// Copy resource to the real default resource.
+	CD3DX12_RESOURCE_BARRIER transition = CD3DX12_RESOURCE_BARRIER::Transition(indexBuffer.Get(), D3D12_RESOURCE_STATE_GENERIC_READ, D3D12_RESOURCE_STATE_COPY_DEST);
+	device->getD3D12CommandList()->ResourceBarrier(1, &transition);
 	device->getD3D12CommandList()->CopyResource(indexBuffer.Get(), indexBufferUpload.Get());
+	device->getFrameStats().meshUploadBytes += indexBufferSize;
 
 	// Wait for the resource to finish copying before switching to generic read.
-	CD3DX12_RESOURCE_BARRIER transition = CD3DX12_RESOURCE_BARRIER::Transition(indexBuffer.Get(), D3D12_RESOURCE_STATE_COPY_DEST, D3D12_RESOURCE_STATE_GENERIC_READ);
+	transition = CD3DX12_RESOURCE_BARRIER::Transition(indexBuffer.Get(), D3D12_RESOURCE_STATE_COPY_DEST, D3D12_RESOURCE_STATE_GENERIC_READ);
 	device->getD3D12CommandList()->ResourceBarrier(1, &transition);
 
 	// Configure index buffer view.
@@ -108,13 +199,14 @@ void RT64::Mesh::updateIndexBuffer(unsigned int *indexArray, int indexCount) {
 	d3dIndexBufferView.Format = DXGI_FORMAT_R32_UINT;
 	d3dIndexBufferView.SizeInBytes = indexBufferSize;
 
-	this->indexCount = indexCount;
+	indexBufferMapped = false;
+	generation = Generation::next();
 }
 
 void RT64::Mesh::updateBottomLevelAS() {
 	if (flags & RT64_MESH_RAYTRACE_ENABLED) {
 		// Create and store the bottom level AS buffers.
-		createBottomLevelAS({ { getVertexBuffer(), getVertexCount() } }, { { getIndexBuffer(), getIndexCount() } });
+		createBottomLevelAS(getVertexBuffer(), getVertexCount(), getIndexBuffer(), getIndexCount());
 
 		// Submit this result as the last barrier for the command queue.
 		D3D12_RESOURCE_BARRIER barrier;
@@ -122,45 +214,66 @@ void RT64::Mesh::updateBottomLevelAS() {
 		barrier.UAV.pResource = d3dBottomLevelASBuffers.result.Get();
 		barrier.Flags = D3D12_RESOURCE_BARRIER_FLAG_NONE;
 		device->setLastCommandQueueBarrier(barrier);
+		generation = Generation::next();
 	}
 }
 
-void RT64::Mesh::createBottomLevelAS(std::vector<std::pair<ID3D12Resource *, uint32_t>> vVertexBuffers, std::vector<std::pair<ID3D12Resource *, uint32_t>> vIndexBuffers) {
+void RT64::Mesh::createBottomLevelAS(ID3D12Resource *vertexBuffer, uint32_t vertexCount, ID3D12Resource *indexBuffer, uint32_t indexCount) {
 	bool updatable = flags & RT64_MESH_RAYTRACE_UPDATABLE;
 	bool fastTrace = flags & RT64_MESH_RAYTRACE_FAST_TRACE;
 	bool compact = flags & RT64_MESH_RAYTRACE_COMPACT;
 	if (!updatable) {
 		// Release the previously stored AS buffers if there's any.
-		d3dBottomLevelASBuffers.Release();
+		releaseBottomLevelAS();
 	}
 	
-	nv_helpers_dx12::BottomLevelASGenerator bottomLevelAS;
-	for (size_t i = 0; i < vVertexBuffers.size(); i++) {
-		if ((i < vIndexBuffers.size()) && (vIndexBuffers[i].second > 0)) {
-			bottomLevelAS.AddVertexBuffer(vVertexBuffers[i].first, 0, vVertexBuffers[i].second, vertexStride, vIndexBuffers[i].first, 0, vIndexBuffers[i].second, nullptr, 0, true);
-		}
-		else {
-			bottomLevelAS.AddVertexBuffer(vVertexBuffers[i].first, 0, vVertexBuffers[i].second, vertexStride, 0, 0);
-		}
+	// The generator is kept by the mesh so refitting it every frame doesn't allocate.
+	bottomLevelASGenerator.Reset();
+	if (indexCount > 0) {
+		bottomLevelASGenerator.AddVertexBuffer(vertexBuffer, 0, vertexCount, vertexStride, indexBuffer, 0, indexCount, nullptr, 0, true);
+	}
+	else {
+		bottomLevelASGenerator.AddVertexBuffer(vertexBuffer, 0, vertexCount, vertexStride, 0, 0);
 	}
 
 	UINT64 resultSizeInBytes = 0;
 	UINT64 scratchSizeInBytes = 0;
 	ID3D12Resource *previousResult = d3dBottomLevelASBuffers.result.Get();
-	bottomLevelAS.ComputeASBufferSizes(device->getD3D12Device(), updatable, compact, fastTrace, &scratchSizeInBytes, &resultSizeInBytes);
+	bottomLevelASGenerator.ComputeASBufferSizes(device->getD3D12Device(), updatable, compact, fastTrace, &scratchSizeInBytes, &resultSizeInBytes);
 
 	if (d3dBottomLevelASBuffers.result.IsNull()) {
-		d3dBottomLevelASBuffers.scratch = device->allocateBuffer(D3D12_HEAP_TYPE_DEFAULT, scratchSizeInBytes, D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS, D3D12_RESOURCE_STATE_COMMON);
-		d3dBottomLevelASBuffers.result = device->allocateBuffer(D3D12_HEAP_TYPE_DEFAULT, resultSizeInBytes, D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS, D3D12_RESOURCE_STATE_RAYTRACING_ACCELERATION_STRUCTURE);
+		d3dBottomLevelASBuffers.scratch = device->allocateBuffer(RT64_MEMORY_CATEGORY_BLAS, D3D12_HEAP_TYPE_DEFAULT, scratchSizeInBytes, D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS, D3D12_RESOURCE_STATE_COMMON);
+		d3dBottomLevelASBuffers.result = device->allocateBuffer(RT64_MEMORY_CATEGORY_BLAS, D3D12_HEAP_TYPE_DEFAULT, resultSizeInBytes, D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS, D3D12_RESOURCE_STATE_RAYTRACING_ACCELERATION_STRUCTURE);
+		bottomLevelASGeneration = Generation::next();
+	}
+
+	bottomLevelASGenerator.Generate(device->getD3D12CommandList(), d3dBottomLevelASBuffers.scratch.Get(), d3dBottomLevelASBuffers.result.Get(), (previousResult != nullptr), previousResult);
+
+	if (previousResult != nullptr) {
+		device->getFrameStats().blasRefitCount++;
+	}
+	else {
+		device->getFrameStats().blasBuildCount++;
+	}
+}
+
+void RT64::Mesh::releaseBottomLevelAS() {
+	// A new resource could end up at the same address, so the release alone counts as a change.
+	if (!d3dBottomLevelASBuffers.result.IsNull()) {
+		bottomLevelASGeneration = Generation::next();
 	}
 
-	bottomLevelAS.Generate(device->getD3D12CommandList(), d3dBottomLevelASBuffers.scratch.Get(), d3dBottomLevelASBuffers.result.Get(), (previousResult != nullptr), previousResult);
+	d3dBottomLevelASBuffers.Release();
 }
 
 ID3D12Resource *RT64::Mesh::getVertexBuffer() const {
 	return vertexBuffer.Get();
 }
 
+const RT64::AllocatedResource &RT64::Mesh::getVertexBufferResource() const {
+	return vertexBuffer;
+}
+
 const D3D12_VERTEX_BUFFER_VIEW *RT64::Mesh::getVertexBufferView() const {
 	return &d3dVertexBufferView;
 }
@@ -173,6 +286,10 @@ ID3D12Resource *RT64::Mesh::getIndexBuffer() const {
 	return indexBuffer.Get();
 }
 
+const RT64::AllocatedResource &RT64::Mesh::getIndexBufferResource() const {
+	return indexBuffer;
+}
+
 const D3D12_INDEX_BUFFER_VIEW *RT64::Mesh::getIndexBufferView() const {
 	return &d3dIndexBufferView;
 }
@@ -181,15 +298,127 @@ int RT64::Mesh::getIndexCount() const {
 	return indexCount;
 }
 
+int RT64::Mesh::getVertexStride() const {
+	return vertexStride;
+}
+
+const void *RT64::Mesh::getVertexUploadData() const {
+	return vertexBufferUploadData;
+}
+
+const void *RT64::Mesh::getIndexUploadData() const {
+	return indexBufferUploadData;
+}
+
+bool RT64::Mesh::isMapped() const {
+	return vertexBufferMapped || indexBufferMapped;
+}
+
 ID3D12Resource *RT64::Mesh::getBottomLevelASResult() const {
 	return d3dBottomLevelASBuffers.result.Get();
 }
 
+uint64_t RT64::Mesh::getGeneration() const {
+	return generation;
+}
+
+uint64_t RT64::Mesh::getBottomLevelASGeneration() const {
+	return bottomLevelASGeneration;
+}
+
+uint32_t RT64::Mesh::getVertexBufferSlot() const {
+	return vertexBufferSlot;
+}
+
+uint32_t RT64::Mesh::getIndexBufferSlot() const {
+	return indexBufferSlot;
+}
+
+RT64::Device *RT64::Mesh::getDevice() const {
+	return device;
+}
+
+void *RT64::Mesh::mapHostVertices(int vertexCount, int vertexStride) {
+	assert(!hostVerticesMapped);
+	hostVertexData = device->getImmediateBuffer().mapBlock((size_t)(vertexCount) * vertexStride, hostVertexBlock);
+	hostVertexCount = vertexCount;
+	hostVertexStride = vertexStride;
+	hostVerticesMapped = true;
+	return hostVertexData;
+}
+
+void RT64::Mesh::unmapHostVertices() {
+	assert(hostVerticesMapped);
+	hostVerticesMapped = false;
+	device->getImmediateBuffer().recordMeshVertices(this, hostVertexBlock, hostVertexCount, hostVertexStride, !isHostMapped());
+	hostVertexData = nullptr;
+}
+
+const void *RT64::Mesh::getHostVertexData() const {
+	return hostVertexData;
+}
+
+int RT64::Mesh::getHostVertexCount() const {
+	return hostVertexCount;
+}
+
+unsigned int *RT64::Mesh::mapHostIndices(int indexCount) {
+	assert(!hostIndicesMapped);
+	hostIndexData = (unsigned int *)(device->getImmediateBuffer().mapBlock(sizeof(unsigned int) * indexCount, hostIndexBlock));
+	hostIndexCount = indexCount;
+	hostIndicesMapped = true;
+	return hostIndexData;
+}
+
+void RT64::Mesh::unmapHostIndices() {
+	assert(hostIndicesMapped);
+	hostIndicesMapped = false;
+	device->getImmediateBuffer().recordMeshIndices(this, hostIndexBlock, hostIndexCount, !isHostMapped());
+	hostIndexData = nullptr;
+}
+
+const unsigned int *RT64::Mesh::getHostIndexData() const {
+	return hostIndexData;
+}
+
+int RT64::Mesh::getHostIndexCount() const {
+	return hostIndexCount;
+}
+
+bool RT64::Mesh::isHostMapped() const {
+	return hostVerticesMapped || hostIndicesMapped;
+}
+
+void RT64::Mesh::setHostVertexStride(int vertexStride) {
+	hostVertexStride = vertexStride;
+}
+
+int RT64::Mesh::getHostVertexStride() const {
+	return hostVertexStride;
+}
+
 // Public
 
 DLLEXPORT RT64_MESH *RT64_CreateMesh(RT64_DEVICE *devicePtr, int flags) {
 	RT64::Device *device = (RT64::Device *)(devicePtr);
-	return (RT64_MESH *)(new RT64::Mesh(device, flags));
+	RT64::Mesh *mesh = new RT64::Mesh(device, flags);
+	if (device->isRenderThreadEnabled()) {
+		device->getImmediateBuffer().recordAttachMesh(mesh);
+	}
+	else {
+		mesh->attach();
+	}
+
+	RT64::Capture *capture = RT64::GlobalCapture;
+	if (capture != nullptr) {
+		capture->beginCall(RT64_CAPTURE_CALL_CREATE_MESH);
+		capture->writeObject(devicePtr);
+		capture->writeValue(flags);
+		capture->writeObject(mesh);
+		capture->endCall();
+	}
+
+	return (RT64_MESH *)(mesh);
 }
 
 DLLEXPORT void RT64_SetMesh(RT64_MESH *meshPtr, void *vertexArray, int vertexCount, int vertexStride, unsigned int *indexArray, int indexCount) {
@@ -198,14 +427,167 @@ DLLEXPORT void RT64_SetMesh(RT64_MESH *meshPtr, void *vertexArray, int vertexCou
 	assert(vertexCount > 0);
 	assert(indexArray != nullptr);
 	assert(indexCount > 0);
+
+	RT64::Capture *capture = RT64::GlobalCapture;
+	if (capture != nullptr) {
+		capture->beginCall(RT64_CAPTURE_CALL_SET_MESH);
+		capture->writeObject(meshPtr);
+		capture->writeValue(vertexCount);
+		capture->writeValue(vertexStride);
+		capture->writeBlob(vertexArray, vertexCount * vertexStride);
+		capture->writeValue(indexCount);
+		capture->writeBlob(indexArray, indexCount * sizeof(unsigned int));
+		capture->endCall();
+	}
+
 	RT64::Mesh *mesh = (RT64::Mesh *)(meshPtr);
-	mesh->updateVertexBuffer(vertexArray, vertexCount, vertexStride);
-	mesh->updateIndexBuffer(indexArray, indexCount);
-	mesh->updateBottomLevelAS();
+	RT64::Device *device = mesh->getDevice();
+	mesh->setHostVertexStride(vertexStride);
+	if (device->isRenderThreadEnabled()) {
+		device->getImmediateBuffer().recordMesh(mesh, vertexArray, vertexCount, vertexStride, indexArray, indexCount);
+	}
+	else {
+		mesh->updateVertexBuffer(vertexArray, vertexCount, vertexStride);
+		mesh->updateIndexBuffer(indexArray, indexCount);
+		mesh->updateBottomLevelAS();
+	}
+}
+
+DLLEXPORT void RT64_SetMeshRange(RT64_MESH *meshPtr, void *vertexArray, int vertexStart, int vertexCount) {
+	assert(meshPtr != nullptr);
+	assert(vertexArray != nullptr);
+	RT64::Mesh *mesh = (RT64::Mesh *)(meshPtr);
+	RT64::Device *device = mesh->getDevice();
+	int vertexStride = mesh->getHostVertexStride();
+	assert(vertexStride > 0);
+
+	RT64::Capture *capture = RT64::GlobalCapture;
+	if (capture != nullptr) {
+		capture->beginCall(RT64_CAPTURE_CALL_SET_MESH_RANGE);
+		capture->writeObject(meshPtr);
+		capture->writeValue(vertexStart);
+		capture->writeValue(vertexCount);
+		capture->writeBlob(vertexArray, vertexCount * vertexStride);
+		capture->endCall();
+	}
+
+	if (device->isRenderThreadEnabled()) {
+		device->getImmediateBuffer().recordMeshRange(mesh, vertexArray, vertexStart, vertexCount, vertexStride);
+	}
+	else {
+		mesh->updateVertexBufferRange(vertexArray, vertexStart, vertexCount);
+
+		// Updatable meshes will refit the existing BLAS instead of rebuilding it.
+		mesh->updateBottomLevelAS();
+	}
+}
+
+DLLEXPORT void *RT64_MapMeshVertices(RT64_MESH *meshPtr, int vertexCount, int vertexStride) {
+	assert(meshPtr != nullptr);
+	assert(vertexCount > 0);
+	RT64::Mesh *mesh = (RT64::Mesh *)(meshPtr);
+	mesh->setHostVertexStride(vertexStride);
+	if (mesh->getDevice()->isRenderThreadEnabled()) {
+		return mesh->mapHostVertices(vertexCount, vertexStride);
+	}
+	else {
+		return mesh->mapVertexBuffer(vertexCount, vertexStride);
+	}
+}
+
+DLLEXPORT void RT64_UnmapMeshVertices(RT64_MESH *meshPtr) {
+	assert(meshPtr != nullptr);
+	RT64::Mesh *mesh = (RT64::Mesh *)(meshPtr);
+	RT64::Device *device = mesh->getDevice();
+	bool deferred = device->isRenderThreadEnabled();
+	int vertexCount = deferred ? mesh->getHostVertexCount() : mesh->getVertexCount();
+	int vertexStride = mesh->getHostVertexStride();
+	const void *vertexData = deferred ? mesh->getHostVertexData() : mesh->getVertexUploadData();
+
+	RT64::Capture *capture = RT64::GlobalCapture;
+	if (capture != nullptr) {
+		// Store the contents written by the host while the buffer was mapped.
+		capture->beginCall(RT64_CAPTURE_CALL_SET_MESH_VERTICES);
+		capture->writeObject(meshPtr);
+		capture->writeValue(vertexCount);
+		capture->writeValue(vertexStride);
+		capture->writeBlob(vertexData, vertexCount * vertexStride);
+		capture->endCall();
+	}
+
+	// Wait until the indices are unmapped as well if they're being written at the same time.
+	if (deferred) {
+		mesh->unmapHostVertices();
+	}
+	else {
+		mesh->unmapVertexBuffer();
+		if (!mesh->isMapped()) {
+			mesh->updateBottomLevelAS();
+		}
+	}
+}
+
+DLLEXPORT unsigned int *RT64_MapMeshIndices(RT64_MESH *meshPtr, int indexCount) {
+	assert(meshPtr != nullptr);
+	assert(indexCount > 0);
+	RT64::Mesh *mesh = (RT64::Mesh *)(meshPtr);
+	if (mesh->getDevice()->isRenderThreadEnabled()) {
+		return mesh->mapHostIndices(indexCount);
+	}
+	else {
+		return mesh->mapIndexBuffer(indexCount);
+	}
+}
+
+DLLEXPORT void RT64_UnmapMeshIndices(RT64_MESH *meshPtr) {
+	assert(meshPtr != nullptr);
+	RT64::Mesh *mesh = (RT64::Mesh *)(meshPtr);
+	RT64::Device *device = mesh->getDevice();
+	bool deferred = device->isRenderThreadEnabled();
+	int indexCount = deferred ? mesh->getHostIndexCount() : mesh->getIndexCount();
+	const void *indexData = deferred ? mesh->getHostIndexData() : mesh->getIndexUploadData();
+
+	RT64::Capture *capture = RT64::GlobalCapture;
+	if (capture != nullptr) {
+		// Store the contents written by the host while the buffer was mapped.
+		capture->beginCall(RT64_CAPTURE_CALL_SET_MESH_INDICES);
+		capture->writeObject(meshPtr);
+		capture->writeValue(indexCount);
+		capture->writeBlob(indexData, indexCount * sizeof(unsigned int));
+		capture->endCall();
+	}
+
+	// Wait until the vertices are unmapped as well if they're being written at the same time.
+	if (deferred) {
+		mesh->unmapHostIndices();
+	}
+	else {
+		mesh->unmapIndexBuffer();
+		if (!mesh->isMapped()) {
+			mesh->updateBottomLevelAS();
+		}
+	}
 }
 
 DLLEXPORT void RT64_DestroyMesh(RT64_MESH * meshPtr) {
-	delete (RT64::Mesh *)(meshPtr);
+	RT64::Mesh *mesh = (RT64::Mesh *)(meshPtr);
+
+	RT64::Capture *capture = RT64::GlobalCapture;
+	if (capture != nullptr) {
+		capture->beginCall(RT64_CAPTURE_CALL_DESTROY_MESH);
+		capture->writeObject(meshPtr);
+		capture->endCall();
+		capture->forgetObject(meshPtr);
+	}
+
+	// The render thread deletes the mesh once it has finished the frames that could still use it.
+	RT64::Device *device = mesh->getDevice();
+	if (device->isRenderThreadEnabled()) {
+		device->getImmediateBuffer().recordDestroyMesh(mesh);
+	}
+	else {
+		delete mesh;
+	}
 }
 
 #endif
\ No newline at end of file
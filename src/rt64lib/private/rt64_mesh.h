@@ -6,6 +6,8 @@
 
 #include "rt64_common.h"
 
+#include "nv_helpers_dx12/BottomLevelASGenerator.h"
+
 namespace RT64 {
 	class Device;
 
@@ -14,29 +16,87 @@ namespace RT64 {
 		Device *device;
 		AllocatedResource vertexBuffer;
 		AllocatedResource vertexBufferUpload;
+		UINT8 *vertexBufferUploadData;
+		bool vertexBufferMapped;
 		D3D12_VERTEX_BUFFER_VIEW d3dVertexBufferView;
 		AllocatedResource indexBuffer;
 		AllocatedResource indexBufferUpload;
+		UINT8 *indexBufferUploadData;
+		bool indexBufferMapped;
 		D3D12_INDEX_BUFFER_VIEW d3dIndexBufferView;
 		int vertexCount;
 		int vertexStride;
 		int indexCount;
 		RT64::AccelerationStructureBuffers d3dBottomLevelASBuffers;
+		nv_helpers_dx12::BottomLevelASGenerator bottomLevelASGenerator;
 		int flags;
+		uint32_t vertexBufferSlot;
+		uint32_t indexBufferSlot;
+		uint64_t generation;
+		uint64_t bottomLevelASGeneration;
+		void *hostVertexData;
+		unsigned int *hostIndexData;
+		uint32_t hostVertexBlock;
+		uint32_t hostIndexBlock;
+		int hostVertexCount;
+		int hostIndexCount;
+		int hostVertexStride;
+		bool hostVerticesMapped;
+		bool hostIndicesMapped;
 
-		void createBottomLevelAS(std::vector<std::pair<ID3D12Resource *, uint32_t>> vVertexBuffers, std::vector<std::pair<ID3D12Resource *, uint32_t>> vIndexBuffers);
+		void createBottomLevelAS(ID3D12Resource *vertexBuffer, uint32_t vertexCount, ID3D12Resource *indexBuffer, uint32_t indexCount);
+		void releaseBottomLevelAS();
 	public:
 		Mesh(Device *device, int flags);
 		virtual ~Mesh();
+
+		// Gives the mesh its slots in the descriptor heaps. It's separate from the constructor so the render thread can do it when it's enabled.
+		void attach();
 		void updateVertexBuffer(void *vertexArray, int vertexCount, int vertexStride);
+		void updateVertexBufferRange(void *vertexArray, int vertexStart, int vertexCount);
+		void *mapVertexBuffer(int vertexCount, int vertexStride);
+		void unmapVertexBuffer();
 		ID3D12Resource *getVertexBuffer() const;
+		const AllocatedResource &getVertexBufferResource() const;
 		const D3D12_VERTEX_BUFFER_VIEW *getVertexBufferView() const;
 		int getVertexCount() const;
 		void updateIndexBuffer(unsigned int *indexArray, int indexCount);
+		unsigned int *mapIndexBuffer(int indexCount);
+		void unmapIndexBuffer();
 		ID3D12Resource *getIndexBuffer() const;
+		const AllocatedResource &getIndexBufferResource() const;
 		const D3D12_INDEX_BUFFER_VIEW *getIndexBufferView() const;
 		int getIndexCount() const;
+		int getVertexStride() const;
+		const void *getVertexUploadData() const;
+		const void *getIndexUploadData() const;
+		bool isMapped() const;
 		void updateBottomLevelAS();
 		ID3D12Resource *getBottomLevelASResult() const;
+
+		// Slots of the buffers in the bindless range of the descriptor heaps. Only raytraced meshes have them.
+		uint32_t getVertexBufferSlot() const;
+		uint32_t getIndexBufferSlot() const;
+		uint64_t getGeneration() const;
+
+		// Only changes when the bottom level AS is created, released or moved to a different resource. Refits keep it.
+		uint64_t getBottomLevelASGeneration() const;
+		Device *getDevice() const;
+
+		// Blocks of the device's immediate record buffer the API thread writes to instead of the upload heaps while the render
+		// thread is enabled. Unmapping records them as they are, and the render thread copies them to the upload heaps.
+		void *mapHostVertices(int vertexCount, int vertexStride);
+		void unmapHostVertices();
+		const void *getHostVertexData() const;
+		int getHostVertexCount() const;
+		unsigned int *mapHostIndices(int indexCount);
+		void unmapHostIndices();
+		const unsigned int *getHostIndexData() const;
+		int getHostIndexCount() const;
+		bool isHostMapped() const;
+
+		// Stride of the vertices last given through the API. Ranges are sized with it, as the render thread might not have applied those vertices yet.
+		void setHostVertexStride(int vertexStride);
+		int getHostVertexStride() const;
 	};
 };
\ No newline at end of file
@@ -25,7 +25,7 @@ RT64::Mipmaps::Mipmaps(Device *device) {
 
 	this->device = device;
 	auto d3dDevice = device->getD3D12Device();
-	memset(d3dDescriptorHeaps, 0, sizeof(d3dDescriptorHeaps));
+	d3dDescriptorHeapsUsed = 0;
 
 	RT64_LOG_PRINTF("Creating the generate mipmaps root signature");
 	{
@@ -62,7 +62,7 @@ RT64::Mipmaps::Mipmaps(Device *device) {
 	}
 }
 
-void RT64::Mipmaps::generate(ID3D12Resource *resource) {
+void RT64::Mipmaps::record(ID3D12Resource *resource) {
 	assert(resource != nullptr);
 
 	auto d3dDevice = device->getD3D12Device();
@@ -141,7 +141,6 @@ void RT64::Mipmaps::generate(ID3D12Resource *resource) {
 	cb.IsSRGB = false;
 	auto resourceDesc = uavResource->GetDesc();
 
-	uint32_t heapIndex = 0;
 	for (uint32_t srcMip = 0; srcMip < resourceDesc.MipLevels - 1u; ) {
 		uint64_t srcWidth = resourceDesc.Width >> srcMip;
 		uint32_t srcHeight = resourceDesc.Height >> srcMip;
@@ -181,14 +180,16 @@ void RT64::Mipmaps::generate(ID3D12Resource *resource) {
 		cb.TexelSize.x = 1.0f / (float)dstWidth;
 		cb.TexelSize.y = 1.0f / (float)dstHeight;
 
-		// Update the descriptor heap.
-		if (d3dDescriptorHeaps[heapIndex] == nullptr) {
+		// Every pass recorded since the last release needs its own descriptor heap, as the GPU hasn't read them yet.
+		if (d3dDescriptorHeapsUsed == d3dDescriptorHeaps.size()) {
 			uint32_t handleCount = 6;
-			d3dDescriptorHeaps[heapIndex] = nv_helpers_dx12::CreateDescriptorHeap(d3dDevice, handleCount, D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV, true);
+			d3dDescriptorHeaps.push_back(nv_helpers_dx12::CreateDescriptorHeap(d3dDevice, handleCount, D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV, true));
 		}
 
+		ID3D12DescriptorHeap *descriptorHeap = d3dDescriptorHeaps[d3dDescriptorHeapsUsed++];
+
 		// SRV for source mip.
-		D3D12_CPU_DESCRIPTOR_HANDLE handle = d3dDescriptorHeaps[heapIndex]->GetCPUDescriptorHandleForHeapStart();
+		D3D12_CPU_DESCRIPTOR_HANDLE handle = descriptorHeap->GetCPUDescriptorHandleForHeapStart();
 		const UINT handleIncrement = d3dDevice->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
 		D3D12_SHADER_RESOURCE_VIEW_DESC textureSRVDesc = {};
 		textureSRVDesc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURE2D;
@@ -213,9 +214,8 @@ void RT64::Mipmaps::generate(ID3D12Resource *resource) {
 		d3dCommandList->ResourceBarrier(1, &beforeDispatchBarrier);
 
 		d3dCommandList->SetComputeRoot32BitConstants(0, 6, &cb, 0);
-		std::vector<ID3D12DescriptorHeap *> descriptorHeaps = { d3dDescriptorHeaps[heapIndex] };
-		d3dCommandList->SetDescriptorHeaps(static_cast<UINT>(descriptorHeaps.size()), descriptorHeaps.data());
-		d3dCommandList->SetComputeRootDescriptorTable(1, d3dDescriptorHeaps[heapIndex]->GetGPUDescriptorHandleForHeapStart());
+		d3dCommandList->SetDescriptorHeaps(1, &descriptorHeap);
+		d3dCommandList->SetComputeRootDescriptorTable(1, descriptorHeap->GetGPUDescriptorHandleForHeapStart());
 
 		// Dispatch the compute shader.
 		UINT threadXCount = dstWidth / 8 + ((dstWidth % 8) ? 1 : 0);
@@ -231,7 +231,6 @@ void RT64::Mipmaps::generate(ID3D12Resource *resource) {
 		d3dCommandList->ResourceBarrier(_countof(afterDispatchBarriers), afterDispatchBarriers);
 
 		srcMip += mipCount;
-		heapIndex++;
 	}
 	
 	if (aliasResource != nullptr) {
@@ -248,17 +247,29 @@ void RT64::Mipmaps::generate(ID3D12Resource *resource) {
 		d3dCommandList->ResourceBarrier(1, &afterGenerationBarrier);
 	}
 
+	// The resources used to create the alias heap are released once the GPU is done with them.
+	if (aliasResource != nullptr) {
+		recordedObjects.push_back(aliasResource);
+		recordedObjects.push_back(uavResource);
+		recordedObjects.push_back(aliasHeap);
+	}
+}
+
+void RT64::Mipmaps::generate(ID3D12Resource *resource) {
+	record(resource);
 	device->submitCommandList();
 	device->waitForGPU();
 	device->resetCommandList();
+	releaseRecorded();
+}
 
-	// Release all resources that were used to create the alias heap.
-	// TODO: Maybe queue these resources for deletion instead so we don't need to execute the command list instantly.
-	if (aliasResource != nullptr) {
-		aliasResource->Release();
-		uavResource->Release();
-		aliasHeap->Release();
+void RT64::Mipmaps::releaseRecorded() {
+	for (IUnknown *object : recordedObjects) {
+		object->Release();
 	}
+
+	recordedObjects.clear();
+	d3dDescriptorHeapsUsed = 0;
 }
 
 #endif
\ No newline at end of file
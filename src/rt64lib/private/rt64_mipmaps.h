@@ -14,10 +14,21 @@ namespace RT64 {
 		Device *device;
 		ID3D12RootSignature *d3dRootSignature;
 		ID3D12PipelineState *d3dPipelineState;
-		ID3D12DescriptorHeap *d3dDescriptorHeaps[16];
+		std::vector<ID3D12DescriptorHeap *> d3dDescriptorHeaps;
+		size_t d3dDescriptorHeapsUsed;
+		std::vector<IUnknown *> recordedObjects;
 	public:
 		Mipmaps(Device *device);
+
+		// Records the generation on the device's command list without submitting it.
+		// The heaps and staging resources it uses are kept until releaseRecorded is called.
+		void record(ID3D12Resource *sourceTexture);
+
+		// Generates the mipmaps and waits for the GPU to finish.
 		void generate(ID3D12Resource *sourceTexture);
+
+		// Must only be called once the GPU has finished executing every recorded generation.
+		void releaseRecorded();
 	};
 };
 
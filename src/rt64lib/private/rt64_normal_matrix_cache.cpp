@@ -0,0 +1,172 @@
+//
+// RT64
+//
+
+#include "rt64_normal_matrix_cache.h"
+
+#include <assert.h>
+#include <string.h>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE__)
+#	define RT64_NORMAL_MATRIX_SSE
+#	include <xmmintrin.h>
+#endif
+
+namespace {
+	// Minimal set of four-wide operations the batched kernel is written with. Every lane holds a different matrix.
+#if defined(RT64_NORMAL_MATRIX_SSE)
+	typedef __m128 Lanes;
+
+	inline Lanes lanesLoad(const float *src) { return _mm_loadu_ps(src); }
+	inline void lanesStore(float *dst, Lanes v) { _mm_storeu_ps(dst, v); }
+	inline Lanes lanesZero() { return _mm_setzero_ps(); }
+	inline Lanes lanesAdd(Lanes a, Lanes b) { return _mm_add_ps(a, b); }
+	inline Lanes lanesSub(Lanes a, Lanes b) { return _mm_sub_ps(a, b); }
+	inline Lanes lanesMul(Lanes a, Lanes b) { return _mm_mul_ps(a, b); }
+	inline Lanes lanesDiv(Lanes a, Lanes b) { return _mm_div_ps(a, b); }
+	inline Lanes lanesSplat(float v) { return _mm_set1_ps(v); }
+	inline void lanesTranspose(Lanes &a, Lanes &b, Lanes &c, Lanes &d) { _MM_TRANSPOSE4_PS(a, b, c, d); }
+#endif
+
+	const size_t BasisSize = sizeof(float) * 12;
+};
+
+// Private
+
+RT64::NormalMatrixCache::NormalMatrixCache() {
+	validCount = 0;
+	computedCount = 0;
+}
+
+void RT64::NormalMatrixCache::computeNormalMatrix(const float *transform, Matrix &normalMatrix) {
+	// The rows of the inverse transpose are the cross products of the other two rows divided by the determinant.
+	const float *a = &transform[0];
+	const float *b = &transform[4];
+	const float *c = &transform[8];
+	float bc[3] = { b[1] * c[2] - b[2] * c[1], b[2] * c[0] - b[0] * c[2], b[0] * c[1] - b[1] * c[0] };
+	float ca[3] = { c[1] * a[2] - c[2] * a[1], c[2] * a[0] - c[0] * a[2], c[0] * a[1] - c[1] * a[0] };
+	float ab[3] = { a[1] * b[2] - a[2] * b[1], a[2] * b[0] - a[0] * b[2], a[0] * b[1] - a[1] * b[0] };
+	float invDet = 1.0f / (a[0] * bc[0] + a[1] * bc[1] + a[2] * bc[2]);
+	for (int i = 0; i < 3; i++) {
+		normalMatrix.m[0][i] = bc[i] * invDet;
+		normalMatrix.m[1][i] = ca[i] * invDet;
+		normalMatrix.m[2][i] = ab[i] * invDet;
+		normalMatrix.m[3][i] = 0.0f;
+		normalMatrix.m[i][3] = 0.0f;
+	}
+
+	normalMatrix.m[3][3] = 1.0f;
+}
+
+void RT64::NormalMatrixCache::computeNormalMatrices4(const float *const transforms[4], Matrix *const normalMatrices[4]) {
+#if defined(RT64_NORMAL_MATRIX_SSE)
+	// Transpose the rows of the four matrices so each register holds the same element of every matrix.
+	Lanes ax = lanesLoad(&transforms[0][0]), ay = lanesLoad(&transforms[1][0]), az = lanesLoad(&transforms[2][0]), aw = lanesLoad(&transforms[3][0]);
+	Lanes bx = lanesLoad(&transforms[0][4]), by = lanesLoad(&transforms[1][4]), bz = lanesLoad(&transforms[2][4]), bw = lanesLoad(&transforms[3][4]);
+	Lanes cx = lanesLoad(&transforms[0][8]), cy = lanesLoad(&transforms[1][8]), cz = lanesLoad(&transforms[2][8]), cw = lanesLoad(&transforms[3][8]);
+	lanesTranspose(ax, ay, az, aw);
+	lanesTranspose(bx, by, bz, bw);
+	lanesTranspose(cx, cy, cz, cw);
+
+	Lanes bcx = lanesSub(lanesMul(by, cz), lanesMul(bz, cy));
+	Lanes bcy = lanesSub(lanesMul(bz, cx), lanesMul(bx, cz));
+	Lanes bcz = lanesSub(lanesMul(bx, cy), lanesMul(by, cx));
+	Lanes cax = lanesSub(lanesMul(cy, az), lanesMul(cz, ay));
+	Lanes cay = lanesSub(lanesMul(cz, ax), lanesMul(cx, az));
+	Lanes caz = lanesSub(lanesMul(cx, ay), lanesMul(cy, ax));
+	Lanes abx = lanesSub(lanesMul(ay, bz), lanesMul(az, by));
+	Lanes aby = lanesSub(lanesMul(az, bx), lanesMul(ax, bz));
+	Lanes abz = lanesSub(lanesMul(ax, by), lanesMul(ay, bx));
+	Lanes det = lanesAdd(lanesAdd(lanesMul(ax, bcx), lanesMul(ay, bcy)), lanesMul(az, bcz));
+	Lanes invDet = lanesDiv(lanesSplat(1.0f), det);
+
+	// Transpose back into one row per register, using the fourth register to zero the last column.
+	Lanes r0x = lanesMul(bcx, invDet), r0y = lanesMul(bcy, invDet), r0z = lanesMul(bcz, invDet), r0w = lanesZero();
+	Lanes r1x = lanesMul(cax, invDet), r1y = lanesMul(cay, invDet), r1z = lanesMul(caz, invDet), r1w = lanesZero();
+	Lanes r2x = lanesMul(abx, invDet), r2y = lanesMul(aby, invDet), r2z = lanesMul(abz, invDet), r2w = lanesZero();
+	lanesTranspose(r0x, r0y, r0z, r0w);
+	lanesTranspose(r1x, r1y, r1z, r1w);
+	lanesTranspose(r2x, r2y, r2z, r2w);
+
+	const Lanes rows[3][4] = {
+		{ r0x, r0y, r0z, r0w },
+		{ r1x, r1y, r1z, r1w },
+		{ r2x, r2y, r2z, r2w }
+	};
+
+	for (int i = 0; i < 4; i++) {
+		Matrix &normalMatrix = *normalMatrices[i];
+		lanesStore(normalMatrix.m[0], rows[0][i]);
+		lanesStore(normalMatrix.m[1], rows[1][i]);
+		lanesStore(normalMatrix.m[2], rows[2][i]);
+		normalMatrix.m[3][0] = 0.0f;
+		normalMatrix.m[3][1] = 0.0f;
+		normalMatrix.m[3][2] = 0.0f;
+		normalMatrix.m[3][3] = 1.0f;
+	}
+#else
+	for (int i = 0; i < 4; i++) {
+		computeNormalMatrix(transforms[i], *normalMatrices[i]);
+	}
+#endif
+}
+
+void RT64::NormalMatrixCache::computePending() {
+	const size_t pendingCount = pendingIndices.size();
+	size_t i = 0;
+	for (; (i + 4) <= pendingCount; i += 4) {
+		const float *transforms[4];
+		Matrix *results[4];
+		for (int j = 0; j < 4; j++) {
+			uint32_t index = pendingIndices[i + j];
+			transforms[j] = &bases[index].m[0][0];
+			results[j] = &normalMatrices[index];
+		}
+
+		computeNormalMatrices4(transforms, results);
+	}
+
+	for (; i < pendingCount; i++) {
+		uint32_t index = pendingIndices[i];
+		computeNormalMatrix(&bases[index].m[0][0], normalMatrices[index]);
+	}
+
+	computedCount = pendingCount;
+}
+
+void RT64::NormalMatrixCache::update(const void *transforms, size_t transformStride, size_t count) {
+	assert((transforms != nullptr) || (count == 0));
+
+	if (bases.size() < count) {
+		bases.resize(count);
+		normalMatrices.resize(count);
+	}
+
+	// Only the upper 3x3 is used, so transforms that only moved keep their normal matrix.
+	pendingIndices.clear();
+	const uint8_t *transformBytes = reinterpret_cast<const uint8_t *>(transforms);
+	for (size_t i = 0; i < count; i++) {
+		const void *basis = transformBytes + i * transformStride;
+		if ((i >= validCount) || (memcmp(&bases[i], basis, BasisSize) != 0)) {
+			memcpy(&bases[i], basis, BasisSize);
+			pendingIndices.push_back(static_cast<uint32_t>(i));
+		}
+	}
+
+	validCount = count;
+	computePending();
+}
+
+void RT64::NormalMatrixCache::clear() {
+	validCount = 0;
+	computedCount = 0;
+}
+
+const RT64::NormalMatrixCache::Matrix &RT64::NormalMatrixCache::getNormalMatrix(size_t index) const {
+	assert(index < validCount);
+	return normalMatrices[index];
+}
+
+size_t RT64::NormalMatrixCache::getComputedCount() const {
+	return computedCount;
+}
@@ -0,0 +1,49 @@
+//
+// RT64
+//
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+namespace RT64 {
+	// Computes the matrices that transform normals (the inverse transpose of the upper 3x3 of each transform) and keeps
+	// them for the next update. Only the transforms whose upper 3x3 changed since then are inverted again, four at a time.
+	// Matrices are 16 row-major floats with the translation in the last row, the same layout used by XMMATRIX.
+	class NormalMatrixCache {
+	public:
+		struct Matrix {
+			float m[4][4];
+		};
+	private:
+		struct Basis {
+			float m[3][4];
+		};
+
+		std::vector<Basis> bases;
+		std::vector<Matrix> normalMatrices;
+		std::vector<uint32_t> pendingIndices;
+		size_t validCount;
+		size_t computedCount;
+
+		void computePending();
+	public:
+		NormalMatrixCache();
+
+		// Reads count transforms that are transformStride bytes apart.
+		void update(const void *transforms, size_t transformStride, size_t count);
+		void clear();
+		const Matrix &getNormalMatrix(size_t index) const;
+
+		// Number of normal matrices that were computed by the last update instead of being reused.
+		size_t getComputedCount() const;
+
+		// Scalar version of the kernel. It's used for the transforms left after the batches of four.
+		static void computeNormalMatrix(const float *transform, Matrix &normalMatrix);
+
+		// Computes the normal matrices of four transforms at once.
+		static void computeNormalMatrices4(const float *const transforms[4], Matrix *const normalMatrices[4]);
+	};
+};
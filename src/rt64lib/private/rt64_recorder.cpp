@@ -0,0 +1,581 @@
+//
+// RT64
+//
+
+#ifndef RT64_MINIMAL
+
+#include "../public/rt64.h"
+#include "rt64_capture.h"
+#include "rt64_device.h"
+#include "rt64_instance.h"
+#include "rt64_mesh.h"
+#include "rt64_recorder.h"
+#include "rt64_scene.h"
+#include "rt64_shader.h"
+#include "rt64_texture.h"
+#include "rt64_view.h"
+
+RT64::RecordBuffer::RecordBuffer() {
+	blockCount = 0;
+	mappedBlockCount = 0;
+}
+
+// Private
+
+size_t RT64::RecordBuffer::pushData(const void *src, size_t size) {
+	if (size == 0) {
+		return data.size();
+	}
+
+	// Every block is aligned so the structures stored in it can be read in place.
+	size_t offset = ROUND_UP(data.size(), alignof(std::max_align_t));
+	data.resize(offset + size);
+	memcpy(data.data() + offset, src, size);
+	return offset;
+}
+
+void *RT64::RecordBuffer::mapBlock(size_t size, uint32_t &blockIndex) {
+	// Blocks are kept when the buffer is cleared so later frames reuse their memory. Growing the list moves the vectors
+	// but not the memory they own, so blocks that are still mapped stay valid.
+	if (blockCount == blocks.size()) {
+		blocks.emplace_back();
+	}
+
+	blockIndex = blockCount++;
+	blocks[blockIndex].resize(size);
+	mappedBlockCount++;
+	return blocks[blockIndex].data();
+}
+
+const void *RT64::RecordBuffer::getBlockData(uint32_t blockIndex) const {
+	assert(blockIndex < blockCount);
+	return blocks[blockIndex].data();
+}
+
+bool RT64::RecordBuffer::hasMappedBlocks() const {
+	return mappedBlockCount > 0;
+}
+
+void RT64::RecordBuffer::recordInstanceDescription(Instance *instance, const RT64_INSTANCE_DESC &instanceDesc, unsigned int fieldMask) {
+	assert(instance != nullptr);
+
+	Command command = {};
+	command.type = CommandType::InstanceDescription;
+	command.target = instance;
+	command.fieldMask = fieldMask;
+	command.dataOffset = pushData(&instanceDesc, sizeof(RT64_INSTANCE_DESC));
+	commands.push_back(command);
+}
+
+void RT64::RecordBuffer::recordMesh(Mesh *mesh, const void *vertexArray, int vertexCount, int vertexStride, const unsigned int *indexArray, int indexCount) {
+	assert(mesh != nullptr);
+
+	Command command = {};
+	command.type = CommandType::Mesh;
+	command.target = mesh;
+	command.vertexCount = vertexCount;
+	command.vertexStride = vertexStride;
+	command.indexCount = indexCount;
+	command.dataOffset = pushData(vertexArray, (size_t)(vertexCount) * vertexStride);
+	command.secondDataOffset = pushData(indexArray, sizeof(unsigned int) * indexCount);
+	commands.push_back(command);
+}
+
+void RT64::RecordBuffer::recordSceneLights(Scene *scene, const RT64_LIGHT *lightArray, int lightCount) {
+	assert(scene != nullptr);
+
+	Command command = {};
+	command.type = CommandType::SceneLights;
+	command.target = scene;
+	command.vertexCount = lightCount;
+	command.dataOffset = pushData(lightArray, sizeof(RT64_LIGHT) * lightCount);
+	commands.push_back(command);
+}
+
+void RT64::RecordBuffer::recordSceneDescription(Scene *scene, const RT64_SCENE_DESC &sceneDesc) {
+	assert(scene != nullptr);
+
+	Command command = {};
+	command.type = CommandType::SceneDescription;
+	command.target = scene;
+	command.dataOffset = pushData(&sceneDesc, sizeof(RT64_SCENE_DESC));
+	commands.push_back(command);
+}
+
+void RT64::RecordBuffer::recordSceneInterpolation(Scene *scene, bool enabled, float factor) {
+	assert(scene != nullptr);
+
+	Command command = {};
+	command.type = CommandType::SceneInterpolation;
+	command.target = scene;
+	command.fieldMask = enabled ? 1 : 0;
+	command.dataOffset = pushData(&factor, sizeof(float));
+	commands.push_back(command);
+}
+
+void RT64::RecordBuffer::recordViewPerspective(View *view, const RT64_MATRIX4 &viewMatrix, float fovRadians, float nearDist, float farDist, bool canReproject) {
+	assert(view != nullptr);
+
+	Perspective perspective;
+	perspective.viewMatrix = viewMatrix;
+	perspective.fovRadians = fovRadians;
+	perspective.nearDist = nearDist;
+	perspective.farDist = farDist;
+	perspective.canReproject = canReproject;
+
+	Command command = {};
+	command.type = CommandType::ViewPerspective;
+	command.target = view;
+	command.dataOffset = pushData(&perspective, sizeof(Perspective));
+	commands.push_back(command);
+}
+
+void RT64::RecordBuffer::recordViewDescription(View *view, const RT64_VIEW_DESC &viewDesc) {
+	assert(view != nullptr);
+
+	Command command = {};
+	command.type = CommandType::ViewDescription;
+	command.target = view;
+	command.dataOffset = pushData(&viewDesc, sizeof(RT64_VIEW_DESC));
+	commands.push_back(command);
+}
+
+void RT64::RecordBuffer::recordViewSkyPlane(View *view, Texture *texture) {
+	assert(view != nullptr);
+
+	Command command = {};
+	command.type = CommandType::ViewSkyPlane;
+	command.target = view;
+	command.dataOffset = pushData(&texture, sizeof(Texture *));
+	commands.push_back(command);
+}
+
+void RT64::RecordBuffer::recordAttachInstance(Instance *instance) {
+	assert(instance != nullptr);
+
+	Command command = {};
+	command.type = CommandType::AttachInstance;
+	command.target = instance;
+	commands.push_back(command);
+}
+
+void RT64::RecordBuffer::recordDestroyInstance(Instance *instance) {
+	assert(instance != nullptr);
+
+	Command command = {};
+	command.type = CommandType::DestroyInstance;
+	command.target = instance;
+	commands.push_back(command);
+}
+
+void RT64::RecordBuffer::recordAttachMesh(Mesh *mesh) {
+	assert(mesh != nullptr);
+
+	Command command = {};
+	command.type = CommandType::AttachMesh;
+	command.target = mesh;
+	commands.push_back(command);
+}
+
+void RT64::RecordBuffer::recordDestroyMesh(Mesh *mesh) {
+	assert(mesh != nullptr);
+
+	Command command = {};
+	command.type = CommandType::DestroyMesh;
+	command.target = mesh;
+	commands.push_back(command);
+}
+
+void RT64::RecordBuffer::recordMeshVertices(Mesh *mesh, uint32_t blockIndex, int vertexCount, int vertexStride, bool updateBottomLevelAS) {
+	assert(mesh != nullptr);
+	assert(blockIndex < blockCount);
+	assert(mappedBlockCount > 0);
+
+	Command command = {};
+	command.type = CommandType::MeshVertices;
+	command.target = mesh;
+	command.fieldMask = updateBottomLevelAS ? 1 : 0;
+	command.vertexCount = vertexCount;
+	command.vertexStride = vertexStride;
+	command.blockIndex = blockIndex;
+	commands.push_back(command);
+	mappedBlockCount--;
+}
+
+void RT64::RecordBuffer::recordMeshIndices(Mesh *mesh, uint32_t blockIndex, int indexCount, bool updateBottomLevelAS) {
+	assert(mesh != nullptr);
+	assert(blockIndex < blockCount);
+	assert(mappedBlockCount > 0);
+
+	Command command = {};
+	command.type = CommandType::MeshIndices;
+	command.target = mesh;
+	command.fieldMask = updateBottomLevelAS ? 1 : 0;
+	command.indexCount = indexCount;
+	command.blockIndex = blockIndex;
+	commands.push_back(command);
+	mappedBlockCount--;
+}
+
+void RT64::RecordBuffer::recordMeshRange(Mesh *mesh, const void *vertexArray, int vertexStart, int vertexCount, int vertexStride) {
+	assert(mesh != nullptr);
+
+	Command command = {};
+	command.type = CommandType::MeshRange;
+	command.target = mesh;
+	command.vertexStart = vertexStart;
+	command.vertexCount = vertexCount;
+	command.vertexStride = vertexStride;
+	command.dataOffset = pushData(vertexArray, (size_t)(vertexCount) * vertexStride);
+	commands.push_back(command);
+}
+
+void RT64::RecordBuffer::recordAttachTexture(Texture *texture, const RT64_TEXTURE_DESC &textureDesc, bool async) {
+	assert(texture != nullptr);
+
+	// The bytes are stored separately and the pointer is replaced when the command is applied.
+	RT64_TEXTURE_DESC storedDesc = textureDesc;
+	storedDesc.bytes = nullptr;
+
+	Command command = {};
+	command.type = CommandType::AttachTexture;
+	command.target = texture;
+	command.fieldMask = async ? 1 : 0;
+	command.dataOffset = pushData(&storedDesc, sizeof(RT64_TEXTURE_DESC));
+	command.secondDataOffset = pushData(textureDesc.bytes, textureDesc.byteCount);
+	commands.push_back(command);
+}
+
+void RT64::RecordBuffer::recordDestroyTexture(Texture *texture) {
+	assert(texture != nullptr);
+
+	Command command = {};
+	command.type = CommandType::DestroyTexture;
+	command.target = texture;
+	commands.push_back(command);
+}
+
+void RT64::RecordBuffer::recordAttachShader(Shader *shader) {
+	assert(shader != nullptr);
+
+	Command command = {};
+	command.type = CommandType::AttachShader;
+	command.target = shader;
+	commands.push_back(command);
+}
+
+void RT64::RecordBuffer::recordDestroyShader(Shader *shader) {
+	assert(shader != nullptr);
+
+	Command command = {};
+	command.type = CommandType::DestroyShader;
+	command.target = shader;
+	commands.push_back(command);
+}
+
+void RT64::RecordBuffer::recordSceneInstanceOrder(Scene *scene, const std::vector<Instance *> &orderedInstances) {
+	assert(scene != nullptr);
+
+	Command command = {};
+	command.type = CommandType::SceneInstanceOrder;
+	command.target = scene;
+	command.vertexCount = (int)(orderedInstances.size());
+	command.dataOffset = pushData(orderedInstances.data(), sizeof(Instance *) * orderedInstances.size());
+	commands.push_back(command);
+}
+
+void RT64::RecordBuffer::capture() const {
+	RT64::Capture *capture = RT64::GlobalCapture;
+	if (capture == nullptr) {
+		return;
+	}
+
+	for (const Command &command : commands) {
+		const uint8_t *commandData = data.data() + command.dataOffset;
+		switch (command.type) {
+		case CommandType::InstanceDescription:
+			capture->beginCall(RT64_CAPTURE_CALL_SET_INSTANCE_DESCRIPTION);
+			capture->writeObject(command.target);
+			capture->writeValue((uint32_t)(command.fieldMask));
+			capture->writeInstanceDescription(*(const RT64_INSTANCE_DESC *)(commandData));
+			capture->endCall();
+			break;
+		case CommandType::Mesh:
+			capture->beginCall(RT64_CAPTURE_CALL_SET_MESH);
+			capture->writeObject(command.target);
+			capture->writeValue(command.vertexCount);
+			capture->writeValue(command.vertexStride);
+			capture->writeBlob(commandData, (size_t)(command.vertexCount) * command.vertexStride);
+			capture->writeValue(command.indexCount);
+			capture->writeBlob(data.data() + command.secondDataOffset, sizeof(unsigned int) * command.indexCount);
+			capture->endCall();
+			break;
+		case CommandType::SceneLights:
+			capture->beginCall(RT64_CAPTURE_CALL_SET_SCENE_LIGHTS);
+			capture->writeObject(command.target);
+			capture->writeValue(command.vertexCount);
+			capture->writeBlob(commandData, sizeof(RT64_LIGHT) * command.vertexCount);
+			capture->endCall();
+			break;
+		case CommandType::SceneDescription:
+			capture->beginCall(RT64_CAPTURE_CALL_SET_SCENE_DESCRIPTION);
+			capture->writeObject(command.target);
+			capture->writeValue(*(const RT64_SCENE_DESC *)(commandData));
+			capture->endCall();
+			break;
+		case CommandType::SceneInterpolation:
+			capture->beginCall(RT64_CAPTURE_CALL_SET_SCENE_INTERPOLATION);
+			capture->writeObject(command.target);
+			capture->writeValue((uint8_t)(command.fieldMask));
+			capture->writeValue(*(const float *)(commandData));
+			capture->endCall();
+			break;
+		case CommandType::ViewPerspective: {
+			const Perspective *perspective = (const Perspective *)(commandData);
+			capture->beginCall(RT64_CAPTURE_CALL_SET_VIEW_PERSPECTIVE);
+			capture->writeObject(command.target);
+			capture->writeValue(perspective->viewMatrix);
+			capture->writeValue(perspective->fovRadians);
+			capture->writeValue(perspective->nearDist);
+			capture->writeValue(perspective->farDist);
+			capture->writeValue((uint8_t)(perspective->canReproject));
+			capture->endCall();
+			break;
+		}
+		case CommandType::ViewDescription:
+			capture->beginCall(RT64_CAPTURE_CALL_SET_VIEW_DESCRIPTION);
+			capture->writeObject(command.target);
+			capture->writeValue(*(const RT64_VIEW_DESC *)(commandData));
+			capture->endCall();
+			break;
+		default:
+			// Recorders can't record the other commands. The API thread captures them when they're made instead.
+			break;
+		}
+	}
+}
+
+void RT64::RecordBuffer::apply() const {
+	// Commands are applied in the order they were recorded.
+	for (const Command &command : commands) {
+		const uint8_t *commandData = data.data() + command.dataOffset;
+		switch (command.type) {
+		case CommandType::InstanceDescription: {
+			Instance *instance = (Instance *)(command.target);
+			instance->setDescription(*(const RT64_INSTANCE_DESC *)(commandData), command.fieldMask);
+			break;
+		}
+		case CommandType::Mesh: {
+			Mesh *mesh = (Mesh *)(command.target);
+			mesh->updateVertexBuffer((void *)(commandData), command.vertexCount, command.vertexStride);
+			mesh->updateIndexBuffer((unsigned int *)(data.data() + command.secondDataOffset), command.indexCount);
+			mesh->updateBottomLevelAS();
+			break;
+		}
+		case CommandType::SceneLights: {
+			Scene *scene = (Scene *)(command.target);
+			scene->setLights((RT64_LIGHT *)(commandData), command.vertexCount);
+			break;
+		}
+		case CommandType::SceneDescription: {
+			Scene *scene = (Scene *)(command.target);
+			scene->setDescription(*(const RT64_SCENE_DESC *)(commandData));
+			break;
+		}
+		case CommandType::SceneInterpolation: {
+			Scene *scene = (Scene *)(command.target);
+			scene->setInterpolation(command.fieldMask != 0, *(const float *)(commandData));
+			break;
+		}
+		case CommandType::ViewPerspective: {
+			const Perspective *perspective = (const Perspective *)(commandData);
+			View *view = (View *)(command.target);
+			view->setPerspective(perspective->viewMatrix, perspective->fovRadians, perspective->nearDist, perspective->farDist);
+			view->setPerspectiveCanReproject(perspective->canReproject);
+			break;
+		}
+		case CommandType::ViewDescription: {
+			View *view = (View *)(command.target);
+			view->setDescription(*(const RT64_VIEW_DESC *)(commandData));
+			break;
+		}
+		case CommandType::ViewSkyPlane: {
+			View *view = (View *)(command.target);
+			view->setSkyPlaneTexture(*(Texture *const *)(commandData));
+			break;
+		}
+		case CommandType::AttachInstance:
+			((Instance *)(command.target))->attach();
+			break;
+		case CommandType::DestroyInstance:
+			delete (Instance *)(command.target);
+			break;
+		case CommandType::AttachMesh:
+			((Mesh *)(command.target))->attach();
+			break;
+		case CommandType::DestroyMesh:
+			delete (Mesh *)(command.target);
+			break;
+		case CommandType::MeshVertices: {
+			Mesh *mesh = (Mesh *)(command.target);
+			mesh->updateVertexBuffer((void *)(blocks[command.blockIndex].data()), command.vertexCount, command.vertexStride);
+			if (command.fieldMask != 0) {
+				mesh->updateBottomLevelAS();
+			}
+
+			break;
+		}
+		case CommandType::MeshIndices: {
+			Mesh *mesh = (Mesh *)(command.target);
+			mesh->updateIndexBuffer((unsigned int *)(blocks[command.blockIndex].data()), command.indexCount);
+			if (command.fieldMask != 0) {
+				mesh->updateBottomLevelAS();
+			}
+
+			break;
+		}
+		case CommandType::MeshRange: {
+			Mesh *mesh = (Mesh *)(command.target);
+			mesh->updateVertexBufferRange((void *)(commandData), command.vertexStart, command.vertexCount);
+			mesh->updateBottomLevelAS();
+			break;
+		}
+		case CommandType::AttachTexture: {
+			Texture *texture = (Texture *)(command.target);
+			RT64_TEXTURE_DESC textureDesc = *(const RT64_TEXTURE_DESC *)(commandData);
+			textureDesc.bytes = (void *)(data.data() + command.secondDataOffset);
+			texture->attach();
+
+			// A texture that fails to load stays attached without data and is never reported as ready.
+			try {
+				texture->setDescription(textureDesc, command.fieldMask != 0);
+			}
+			RT64_CATCH_EXCEPTION();
+			break;
+		}
+		case CommandType::DestroyTexture:
+			delete (Texture *)(command.target);
+			break;
+		case CommandType::AttachShader:
+			((Shader *)(command.target))->attach();
+			break;
+		case CommandType::DestroyShader:
+			delete (Shader *)(command.target);
+			break;
+		case CommandType::SceneInstanceOrder: {
+			Scene *scene = (Scene *)(command.target);
+			scene->reorderInstances((Instance *const *)(commandData), (size_t)(command.vertexCount));
+			break;
+		}
+		}
+	}
+}
+
+void RT64::RecordBuffer::clear() {
+	// Clearing keeps the capacity so steady recording doesn't need to allocate again.
+	commands.clear();
+	data.clear();
+
+	// Blocks that are still mapped must keep their indices, so they're only reclaimed once all of them are recorded.
+	if (!hasMappedBlocks()) {
+		blockCount = 0;
+	}
+}
+
+bool RT64::RecordBuffer::empty() const {
+	return commands.empty();
+}
+
+RT64::Recorder::Recorder(Device *device) {
+	assert(device != nullptr);
+
+	this->device = device;
+
+	device->addRecorder(this);
+}
+
+RT64::Recorder::~Recorder() {
+	device->removeRecorder(this);
+}
+
+void RT64::Recorder::recordInstanceDescription(Instance *instance, const RT64_INSTANCE_DESC &instanceDesc, unsigned int fieldMask) {
+	std::scoped_lock lock(recordMutex);
+	recordBuffer.recordInstanceDescription(instance, instanceDesc, fieldMask);
+}
+
+void RT64::Recorder::recordMesh(Mesh *mesh, const void *vertexArray, int vertexCount, int vertexStride, const unsigned int *indexArray, int indexCount) {
+	std::scoped_lock lock(recordMutex);
+	recordBuffer.recordMesh(mesh, vertexArray, vertexCount, vertexStride, indexArray, indexCount);
+}
+
+void RT64::Recorder::recordSceneLights(Scene *scene, const RT64_LIGHT *lightArray, int lightCount) {
+	std::scoped_lock lock(recordMutex);
+	recordBuffer.recordSceneLights(scene, lightArray, lightCount);
+}
+
+void RT64::Recorder::execute() {
+	// Swap the buffers so the worker can keep recording while the commands are applied.
+	flush(executeBuffer);
+	executeBuffer.capture();
+	executeBuffer.apply();
+	executeBuffer.clear();
+}
+
+void RT64::Recorder::flush(RecordBuffer &dstBuffer) {
+	assert(dstBuffer.empty());
+
+	std::scoped_lock lock(recordMutex);
+	std::swap(recordBuffer, dstBuffer);
+}
+
+RT64::Device *RT64::Recorder::getDevice() const {
+	return device;
+}
+
+// Public
+
+DLLEXPORT RT64_RECORDER *RT64_CreateRecorder(RT64_DEVICE *devicePtr) {
+	assert(devicePtr != nullptr);
+	RT64::Device *device = (RT64::Device *)(devicePtr);
+	RT64::Recorder *recorder = new RT64::Recorder(device);
+	return (RT64_RECORDER *)(recorder);
+}
+
+DLLEXPORT void RT64_RecordInstanceDescription(RT64_RECORDER *recorderPtr, RT64_INSTANCE *instancePtr, const RT64_INSTANCE_DESC *instanceDesc, unsigned int fieldMask) {
+	assert(recorderPtr != nullptr);
+	assert(instancePtr != nullptr);
+	assert(instanceDesc != nullptr);
+	RT64::Recorder *recorder = (RT64::Recorder *)(recorderPtr);
+	recorder->recordInstanceDescription((RT64::Instance *)(instancePtr), *instanceDesc, fieldMask);
+}
+
+DLLEXPORT void RT64_RecordMesh(RT64_RECORDER *recorderPtr, RT64_MESH *meshPtr, void *vertexArray, int vertexCount, int vertexStride, unsigned int *indexArray, int indexCount) {
+	assert(recorderPtr != nullptr);
+	assert(meshPtr != nullptr);
+	assert(vertexArray != nullptr);
+	assert(vertexCount > 0);
+	assert(indexArray != nullptr);
+	assert(indexCount > 0);
+	RT64::Recorder *recorder = (RT64::Recorder *)(recorderPtr);
+	RT64::Mesh *mesh = (RT64::Mesh *)(meshPtr);
+
+	// Ranges set later on by the host are sized with this stride.
+	mesh->setHostVertexStride(vertexStride);
+	recorder->recordMesh(mesh, vertexArray, vertexCount, vertexStride, indexArray, indexCount);
+}
+
+DLLEXPORT void RT64_RecordSceneLights(RT64_RECORDER *recorderPtr, RT64_SCENE *scenePtr, RT64_LIGHT *lightArray, int lightCount) {
+	assert(recorderPtr != nullptr);
+	assert(scenePtr != nullptr);
+	assert((lightCount == 0) || (lightArray != nullptr));
+	RT64::Recorder *recorder = (RT64::Recorder *)(recorderPtr);
+	recorder->recordSceneLights((RT64::Scene *)(scenePtr), lightArray, lightCount);
+}
+
+DLLEXPORT void RT64_DestroyRecorder(RT64_RECORDER *recorderPtr) {
+	// Recorders are only flushed on the API thread when the frame is published, so the render thread never sees them.
+	RT64::Recorder *recorder = (RT64::Recorder *)(recorderPtr);
+	delete recorder;
+}
+
+#endif
@@ -0,0 +1,131 @@
+//
+// RT64
+//
+
+#pragma once
+
+#include "rt64_common.h"
+
+#include <cstddef>
+#include <mutex>
+
+namespace RT64 {
+	class Device;
+	class Instance;
+	class Mesh;
+	class Scene;
+	class Shader;
+	class Texture;
+	class View;
+
+	// Stores API updates so they can be applied later on the thread that renders the frame.
+	// Objects created while the render thread is enabled are only attached to their owners once their
+	// attach command is applied, and destroyed objects are deleted once their destroy command is applied.
+	class RecordBuffer {
+	private:
+		enum class CommandType {
+			InstanceDescription,
+			Mesh,
+			SceneLights,
+			SceneDescription,
+			SceneInterpolation,
+			ViewPerspective,
+			ViewDescription,
+			ViewSkyPlane,
+			AttachInstance,
+			DestroyInstance,
+			AttachMesh,
+			DestroyMesh,
+			MeshVertices,
+			MeshIndices,
+			MeshRange,
+			AttachTexture,
+			DestroyTexture,
+			AttachShader,
+			DestroyShader,
+			SceneInstanceOrder
+		};
+
+		struct Command {
+			CommandType type;
+			void *target;
+			unsigned int fieldMask;
+			int vertexStart;
+			int vertexCount;
+			int vertexStride;
+			int indexCount;
+			size_t dataOffset;
+			size_t secondDataOffset;
+			uint32_t blockIndex;
+		};
+
+		struct Perspective {
+			RT64_MATRIX4 viewMatrix;
+			float fovRadians;
+			float nearDist;
+			float farDist;
+			bool canReproject;
+		};
+
+		std::vector<Command> commands;
+		std::vector<uint8_t> data;
+		std::vector<std::vector<uint8_t>> blocks;
+		uint32_t blockCount;
+		uint32_t mappedBlockCount;
+
+		size_t pushData(const void *src, size_t size);
+	public:
+		RecordBuffer();
+
+		// Returns memory the host can write to directly, like a mapped buffer. Unlike the data of the other commands, it
+		// stays in place until the buffer is cleared, so it's handed to the command that records it instead of being copied.
+		// Every block must be recorded before the buffer is published to the render thread.
+		void *mapBlock(size_t size, uint32_t &blockIndex);
+		const void *getBlockData(uint32_t blockIndex) const;
+		bool hasMappedBlocks() const;
+
+		void recordInstanceDescription(Instance *instance, const RT64_INSTANCE_DESC &instanceDesc, unsigned int fieldMask);
+		void recordMesh(Mesh *mesh, const void *vertexArray, int vertexCount, int vertexStride, const unsigned int *indexArray, int indexCount);
+		void recordSceneLights(Scene *scene, const RT64_LIGHT *lightArray, int lightCount);
+		void recordSceneDescription(Scene *scene, const RT64_SCENE_DESC &sceneDesc);
+		void recordSceneInterpolation(Scene *scene, bool enabled, float factor);
+		void recordViewPerspective(View *view, const RT64_MATRIX4 &viewMatrix, float fovRadians, float nearDist, float farDist, bool canReproject);
+		void recordViewDescription(View *view, const RT64_VIEW_DESC &viewDesc);
+		void recordViewSkyPlane(View *view, Texture *texture);
+		void recordAttachInstance(Instance *instance);
+		void recordDestroyInstance(Instance *instance);
+		void recordAttachMesh(Mesh *mesh);
+		void recordDestroyMesh(Mesh *mesh);
+		void recordMeshVertices(Mesh *mesh, uint32_t blockIndex, int vertexCount, int vertexStride, bool updateBottomLevelAS);
+		void recordMeshIndices(Mesh *mesh, uint32_t blockIndex, int indexCount, bool updateBottomLevelAS);
+		void recordMeshRange(Mesh *mesh, const void *vertexArray, int vertexStart, int vertexCount, int vertexStride);
+		void recordAttachTexture(Texture *texture, const RT64_TEXTURE_DESC &textureDesc, bool async);
+		void recordDestroyTexture(Texture *texture);
+		void recordAttachShader(Shader *shader);
+		void recordDestroyShader(Shader *shader);
+		void recordSceneInstanceOrder(Scene *scene, const std::vector<Instance *> &orderedInstances);
+		void capture() const;
+		void apply() const;
+		void clear();
+		bool empty() const;
+	};
+
+	// Records instance, mesh and light updates from a worker thread so they can be applied by the device on the next draw.
+	// Objects referenced by the recorded commands must stay alive until that draw.
+	class Recorder {
+	private:
+		Device *device;
+		std::mutex recordMutex;
+		RecordBuffer recordBuffer;
+		RecordBuffer executeBuffer;
+	public:
+		Recorder(Device *device);
+		virtual ~Recorder();
+		void recordInstanceDescription(Instance *instance, const RT64_INSTANCE_DESC &instanceDesc, unsigned int fieldMask);
+		void recordMesh(Mesh *mesh, const void *vertexArray, int vertexCount, int vertexStride, const unsigned int *indexArray, int indexCount);
+		void recordSceneLights(Scene *scene, const RT64_LIGHT *lightArray, int lightCount);
+		void execute();
+		void flush(RecordBuffer &dstBuffer);
+		Device *getDevice() const;
+	};
+};
@@ -6,13 +6,16 @@
 
 #include "../public/rt64.h"
 
+#include <algorithm>
 #include <map>
 #include <random>
 #include <set>
 
 #include "rt64_scene.h"
 
+#include "rt64_capture.h"
 #include "rt64_device.h"
+#include "rt64_immediate.h"
 #include "rt64_instance.h"
 #include "rt64_view.h"
 
@@ -31,6 +34,11 @@ RT64::Scene::Scene(Device *device) {
 	description.giSkyStrength = 0.35f;
 	lightsBufferSize = 0;
 	lightsCount = 0;
+	interpolationEnabled = false;
+	interpolationFactor = 1.0f;
+	renderedInterpolationFactor = 1.0f;
+	immediate = nullptr;
+	generation = Generation::next();
 
 	device->addScene(this);
 }
@@ -38,6 +46,9 @@ RT64::Scene::Scene(Device *device) {
 RT64::Scene::~Scene() {
 	device->removeScene(this);
 
+	// Instances owned by immediate mode must be destroyed by it.
+	delete immediate;
+
 	lightsBuffer.Release();
 
 	auto viewsCopy = views;
@@ -45,7 +56,8 @@ RT64::Scene::~Scene() {
 		delete view;
 	}
 
-	auto instancesCopy = instances;
+	instances.compact();
+	auto instancesCopy = instances.getValues();
 	for (Instance *instance : instancesCopy) {
 		delete instance;
 	}
@@ -54,10 +66,20 @@ RT64::Scene::~Scene() {
 void RT64::Scene::update() {
 	RT64_LOG_PRINTF("Started scene update");
 
+	// Close the holes left by the instances destroyed since the last update.
+	instances.compact();
+
 	for (View *view : views) {
 		view->update();
 	}
 
+	// All views have consumed the changes made to the instances since the last update.
+	for (Instance *instance : instances.getValues()) {
+		instance->clearDirtyFields();
+	}
+
+	renderedInterpolationFactor = interpolationFactor;
+
 	RT64_LOG_PRINTF("Finished scene update");
 }
 
@@ -85,18 +107,56 @@ RT64_SCENE_DESC RT64::Scene::getDescription() const {
 	return description;
 }
 
-void RT64::Scene::addInstance(Instance *instance) {
-	assert(instance != nullptr);
-	instances.push_back(instance);
+void RT64::Scene::setInterpolation(bool enabled, float factor) {
+	// Start from a static frame when interpolation is turned on so no motion is reported against stale snapshots.
+	if (enabled && !interpolationEnabled) {
+		renderedInterpolationFactor = factor;
+	}
+
+	interpolationEnabled = enabled;
+	interpolationFactor = factor;
+}
+
+bool RT64::Scene::isInterpolationEnabled() const {
+	return interpolationEnabled;
+}
+
+float RT64::Scene::getInterpolationFactor() const {
+	return interpolationFactor;
 }
 
-void RT64::Scene::removeInstance(Instance *instance) {
+float RT64::Scene::getPreviousInterpolationFactor() const {
+	// The factor is expected to wrap around when the host advances to a new pair of simulation snapshots.
+	// The frame that was displayed last then lies one simulation step behind the previous snapshot.
+	if (interpolationFactor < renderedInterpolationFactor) {
+		return renderedInterpolationFactor - 1.0f;
+	}
+	else {
+		return renderedInterpolationFactor;
+	}
+}
+
+RT64::SlotHandle RT64::Scene::addInstance(Instance *instance) {
 	assert(instance != nullptr);
+	generation = Generation::next();
+	return instances.insert(instance);
+}
+
+void RT64::Scene::removeInstance(SlotHandle handle) {
+	bool removed = instances.remove(handle);
+	assert(removed && "The instance was already removed from the scene.");
+	generation = Generation::next();
+}
 
-	auto it = std::find(instances.begin(), instances.end(), instance);
-	if (it != instances.end()) {
-		instances.erase(it);
+void RT64::Scene::reorderInstances(Instance *const *orderedInstances, size_t instanceCount) {
+	// Move the instances to the back of the list in the order they were provided.
+	reorderHandles.clear();
+	for (size_t i = 0; i < instanceCount; i++) {
+		reorderHandles.push_back(orderedInstances[i]->getSceneHandle());
 	}
+
+	instances.moveToBack(reorderHandles);
+	generation = Generation::next();
 }
 
 void RT64::Scene::addView(View *view) {
@@ -119,7 +179,7 @@ void RT64::Scene::setLights(RT64_LIGHT *lightArray, int lightCount) {
 	size_t newSize = ROUND_UP(sizeof(RT64_LIGHT) * lightCount, D3D12_CONSTANT_BUFFER_DATA_PLACEMENT_ALIGNMENT);
 	if (newSize != lightsBufferSize) {
 		lightsBuffer.Release();
-		lightsBuffer = getDevice()->allocateBuffer(D3D12_HEAP_TYPE_UPLOAD, newSize, D3D12_RESOURCE_FLAG_NONE, D3D12_RESOURCE_STATE_GENERIC_READ);
+		lightsBuffer = getDevice()->allocateBuffer(RT64_MEMORY_CATEGORY_UPLOAD, D3D12_HEAP_TYPE_UPLOAD, newSize, D3D12_RESOURCE_FLAG_NONE, D3D12_RESOURCE_STATE_GENERIC_READ);
 		lightsBufferSize = newSize;
 	}
 
@@ -149,8 +209,8 @@ void RT64::Scene::setLights(RT64_LIGHT *lightArray, int lightCount) {
 	lightsCount = lightCount;
 }
 
-ID3D12Resource *RT64::Scene::getLightsBuffer() const {
-	return lightsBuffer.Get();
+const RT64::AllocatedResource &RT64::Scene::getLightsBuffer() const {
+	return lightsBuffer;
 }
 
 int RT64::Scene::getLightsCount() const {
@@ -158,7 +218,19 @@ int RT64::Scene::getLightsCount() const {
 }
 
 const std::vector<RT64::Instance *> &RT64::Scene::getInstances() const {
-	return instances;
+	return instances.getValues();
+}
+
+uint64_t RT64::Scene::getGeneration() const {
+	return generation;
+}
+
+RT64::Immediate *RT64::Scene::getImmediate() {
+	if (immediate == nullptr) {
+		immediate = new Immediate(this);
+	}
+
+	return immediate;
 }
 
 RT64::Device *RT64::Scene::getDevice() const {
@@ -169,21 +241,95 @@ RT64::Device *RT64::Scene::getDevice() const {
 
 DLLEXPORT RT64_SCENE *RT64_CreateScene(RT64_DEVICE *devicePtr) {
 	RT64::Device *device = (RT64::Device *)(devicePtr);
-	return (RT64_SCENE *)(new RT64::Scene(device));
+	device->waitForRenderThread();
+
+	RT64::Scene *scene = new RT64::Scene(device);
+
+	RT64::Capture *capture = RT64::GlobalCapture;
+	if (capture != nullptr) {
+		capture->beginCall(RT64_CAPTURE_CALL_CREATE_SCENE);
+		capture->writeObject(devicePtr);
+		capture->writeObject(scene);
+		capture->endCall();
+	}
+
+	return (RT64_SCENE *)(scene);
 }
 
 DLLEXPORT void RT64_SetSceneDescription(RT64_SCENE *scenePtr, RT64_SCENE_DESC sceneDesc) {
+	RT64::Capture *capture = RT64::GlobalCapture;
+	if (capture != nullptr) {
+		capture->beginCall(RT64_CAPTURE_CALL_SET_SCENE_DESCRIPTION);
+		capture->writeObject(scenePtr);
+		capture->writeValue(sceneDesc);
+		capture->endCall();
+	}
+
 	RT64::Scene *scene = (RT64::Scene *)(scenePtr);
-	scene->setDescription(sceneDesc);
+	RT64::Device *device = scene->getDevice();
+	if (device->isRenderThreadEnabled()) {
+		device->getImmediateBuffer().recordSceneDescription(scene, sceneDesc);
+	}
+	else {
+		scene->setDescription(sceneDesc);
+	}
 }
 
 DLLEXPORT void RT64_SetSceneLights(RT64_SCENE *scenePtr, RT64_LIGHT *lightArray, int lightCount) {
+	RT64::Capture *capture = RT64::GlobalCapture;
+	if (capture != nullptr) {
+		capture->beginCall(RT64_CAPTURE_CALL_SET_SCENE_LIGHTS);
+		capture->writeObject(scenePtr);
+		capture->writeValue(lightCount);
+		capture->writeBlob(lightArray, sizeof(RT64_LIGHT) * lightCount);
+		capture->endCall();
+	}
+
 	RT64::Scene *scene = (RT64::Scene *)(scenePtr);
-	scene->setLights(lightArray, lightCount);
+	RT64::Device *device = scene->getDevice();
+	if (device->isRenderThreadEnabled()) {
+		device->getImmediateBuffer().recordSceneLights(scene, lightArray, lightCount);
+	}
+	else {
+		scene->setLights(lightArray, lightCount);
+	}
+}
+
+// While enabled, the transform and previous transform of every instance are treated as the two latest simulation
+// snapshots and the frame is rendered at the factor between them, so they only need to be updated once per tick.
+DLLEXPORT void RT64_SetSceneInterpolation(RT64_SCENE *scenePtr, bool enabled, float factor) {
+	RT64::Capture *capture = RT64::GlobalCapture;
+	if (capture != nullptr) {
+		capture->beginCall(RT64_CAPTURE_CALL_SET_SCENE_INTERPOLATION);
+		capture->writeObject(scenePtr);
+		capture->writeValue((uint8_t)(enabled));
+		capture->writeValue(factor);
+		capture->endCall();
+	}
+
+	RT64::Scene *scene = (RT64::Scene *)(scenePtr);
+	RT64::Device *device = scene->getDevice();
+	if (device->isRenderThreadEnabled()) {
+		device->getImmediateBuffer().recordSceneInterpolation(scene, enabled, factor);
+	}
+	else {
+		scene->setInterpolation(enabled, factor);
+	}
 }
 
 DLLEXPORT void RT64_DestroyScene(RT64_SCENE *scenePtr) {
-	delete (RT64::Scene *)(scenePtr);
+	RT64::Scene *scene = (RT64::Scene *)(scenePtr);
+	scene->getDevice()->waitForRenderThread();
+
+	RT64::Capture *capture = RT64::GlobalCapture;
+	if (capture != nullptr) {
+		capture->beginCall(RT64_CAPTURE_CALL_DESTROY_SCENE);
+		capture->writeObject(scenePtr);
+		capture->endCall();
+		capture->forgetObject(scenePtr);
+	}
+
+	delete scene;
 }
 
 #endif
\ No newline at end of file
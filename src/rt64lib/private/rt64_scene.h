@@ -5,9 +5,11 @@
 #pragma once
 
 #include "rt64_common.h"
+#include "rt64_slot_map.h"
 
 namespace RT64 {
 	class Device;
+	class Immediate;
 	class Inspector;
 	class Instance;
 	class View;
@@ -15,12 +17,18 @@ namespace RT64 {
 	class Scene {
 	private:
 		Device *device;
-		std::vector<Instance *> instances;
+		SlotMap<Instance *> instances;
+		std::vector<SlotHandle> reorderHandles;
 		std::vector<View *> views;
 		AllocatedResource lightsBuffer;
 		size_t lightsBufferSize;
 		int lightsCount;
 		RT64_SCENE_DESC description;
+		bool interpolationEnabled;
+		float interpolationFactor;
+		float renderedInterpolationFactor;
+		Immediate *immediate;
+		uint64_t generation;
 	public:
 		Scene(Device *device);
 		virtual ~Scene();
@@ -29,15 +37,22 @@ namespace RT64 {
 		void resize();
 		void setDescription(RT64_SCENE_DESC v);
 		RT64_SCENE_DESC getDescription() const;
+		void setInterpolation(bool enabled, float factor);
+		bool isInterpolationEnabled() const;
+		float getInterpolationFactor() const;
+		float getPreviousInterpolationFactor() const;
 		void setLights(RT64_LIGHT *lightArray, int lightCount);
 		int getLightsCount() const;
-		ID3D12Resource *getLightsBuffer() const;
-		void addInstance(Instance *instance);
-		void removeInstance(Instance *instance);
+		const AllocatedResource &getLightsBuffer() const;
+		SlotHandle addInstance(Instance *instance);
+		void removeInstance(SlotHandle handle);
+		void reorderInstances(Instance *const *orderedInstances, size_t instanceCount);
 		void addView(View *view);
 		void removeView(View *view);
 		const std::vector<View *> &getViews() const;
 		const std::vector<Instance *> &getInstances() const;
+		uint64_t getGeneration() const;
+		Immediate *getImmediate();
 		Device *getDevice() const;
 	};
 };
\ No newline at end of file
@@ -5,6 +5,7 @@
 
 #include "rt64_shader.h"
 
+#include "rt64_capture.h"
 #include "rt64_device.h"
 #include "rt64_shader_hlsli.h"
 
@@ -98,6 +99,8 @@ struct VertexLayout {
 RT64::Shader::Shader(Device *device, unsigned int shaderId, Filter filter, AddressingMode hAddr, AddressingMode vAddr, int flags) {
 	assert(device != nullptr);
 	this->device = device;
+	generation = Generation::next();
+	compiledCount = 0;
 
 	bool normalMapEnabled = flags & RT64_SHADER_NORMAL_MAP_ENABLED;
 	bool specularMapEnabled = flags & RT64_SHADER_SPECULAR_MAP_ENABLED;
@@ -124,8 +127,6 @@ RT64::Shader::Shader(Device *device, unsigned int shaderId, Filter filter, Addre
 		generateSurfaceHitGroup(shaderId, filter, hAddr, vAddr, normalMapEnabled, specularMapEnabled, hitGroup, closestHit, anyHit);
 		generateShadowHitGroup(shaderId, filter, hAddr, vAddr, shadowHitGroup, shadowClosestHit, shadowAnyHit);
 	}
-
-	device->addShader(this);
 }
 
 RT64::Shader::~Shader() {
@@ -137,6 +138,11 @@ RT64::Shader::~Shader() {
 	shadowHitGroup.blob->Release();
 }
 
+void RT64::Shader::attach() {
+	device->addShader(this);
+	device->getFrameStats().shadersCompiled += compiledCount;
+}
+
 #define SS(x) ss << x << std::endl;
 
 unsigned int RT64::Shader::uniqueSamplerRegisterIndex(Filter filter, AddressingMode hAddr, AddressingMode vAddr) {
@@ -149,13 +155,21 @@ unsigned int RT64::Shader::uniqueSamplerRegisterIndex(Filter filter, AddressingM
 }
 
 void incMeshBuffers(std::stringstream &ss) {
-	SS("ByteAddressBuffer vertexBuffer : register(t2);");
-	SS("ByteAddressBuffer indexBuffer : register(t3);");
+	SS("struct InstanceGeometry {");
+	SS("    uint vertexBufferIndex;");
+	SS("    uint indexBufferIndex;");
+	SS("};");
+	SS("StructuredBuffer<InstanceGeometry> instanceGeometry : register(t" + std::to_string(SRV_INDEX(instanceGeometry)) + ");");
+	SS("ByteAddressBuffer gGeometryBuffers[] : register(t0, space" + std::to_string(SRV_GEOMETRY_BUFFERS_SPACE) + ");");
 }
 
 void getVertexData(std::stringstream &ss, bool vertexPosition, bool vertexNormal, bool vertexUV, int inputCount, bool useAlpha, bool vertexBinormalAndTangent) {
 	VertexLayout vl(vertexPosition, vertexNormal, vertexUV, inputCount, useAlpha);
 
+	// The mesh buffers are looked up through the geometry table, as the hit group records are shared by every instance using the shader.
+	SS("InstanceGeometry geometry = instanceGeometry[instanceId];");
+	SS("ByteAddressBuffer vertexBuffer = gGeometryBuffers[NonUniformResourceIndex(geometry.vertexBufferIndex)];");
+	SS("ByteAddressBuffer indexBuffer = gGeometryBuffers[NonUniformResourceIndex(geometry.indexBufferIndex)];");
 	SS("uint3 index3 = indexBuffer.Load3((triangleIndex * 3) * 4);");
 
 	if (vertexPosition) {
@@ -369,7 +383,7 @@ void RT64::Shader::generateRasterGroup(unsigned int shaderId, Filter filter, Add
 	SS(") {");
 
 	if (cc.useTextures[0]) {
-		SS("    int diffuseTexIndex = instanceMaterials[instanceId].diffuseTexIndex;");
+		SS("    int diffuseTexIndex = GetInstanceMaterial(instanceId).diffuseTexIndex;");
 		SS("    float4 texVal0 = gTextures[NonUniformResourceIndex(diffuseTexIndex)].Sample(gTextureSampler, vertexUV);");
 	}
 
@@ -462,10 +476,10 @@ void RT64::Shader::generateSurfaceHitGroup(unsigned int shaderId, Filter filter,
 
 	SS("[shader(\"anyhit\")]");
 	SS("void " << anyHitName << "(inout HitInfo payload, Attributes attrib) {");
-	SS("    uint instanceId = InstanceIndex();");
+	SS("    uint instanceId = InstanceID();");
 	SS("    uint triangleIndex = PrimitiveIndex();");
 	SS("    float3 barycentrics = float3((1.0f - attrib.bary.x - attrib.bary.y), attrib.bary.x, attrib.bary.y);");
-	SS("    float4 diffuseColorMix = instanceMaterials[instanceId].diffuseColorMix;");
+	SS("    float4 diffuseColorMix = GetInstanceMaterial(instanceId).diffuseColorMix;");
 
 	bool vertexUV = cc.useTextures[0] || cc.useTextures[1];
 	getVertexData(ss, true, true, vertexUV, cc.inputCount, cc.opt_alpha, vertexUV && normalMapEnabled);
@@ -476,7 +490,7 @@ void RT64::Shader::generateSurfaceHitGroup(unsigned int shaderId, Filter filter,
 		SS("	float2 dBarydx, dBarydy;");
 		SS("	computeBarycentricDifferentials(propRayDiff, WorldRayDirection(), posW1 - posW0, posW2 - posW0, triangleNormal, dBarydx, dBarydy);");
 		SS("	computeTextureDifferentials(dBarydx, dBarydy, uv0, uv1, uv2, ddx, ddy);");
-		SS("    int diffuseTexIndex = instanceMaterials[instanceId].diffuseTexIndex;");
+		SS("    int diffuseTexIndex = GetInstanceMaterial(instanceId).diffuseTexIndex;");
 		SS("    float4 texVal0 = gTextures[NonUniformResourceIndex(diffuseTexIndex)].SampleGrad(gTextureSampler, vertexUV, ddx, ddy);");
 		SS("    texVal0.rgb = lerp(texVal0.rgb, diffuseColorMix.rgb, max(-diffuseColorMix.a, 0.0f));");
 	}
@@ -497,7 +511,7 @@ void RT64::Shader::generateSurfaceHitGroup(unsigned int shaderId, Filter filter,
 	SS("    resultColor.rgb = lerp(resultColor.rgb, diffuseColorMix.rgb, max(diffuseColorMix.a, 0.0f));");
 
 	// Apply the solid alpha multiplier.
-	SS("    resultColor.a = clamp(instanceMaterials[instanceId].solidAlphaMultiplier * resultColor.a, 0.0f, 1.0f);");
+	SS("    resultColor.a = clamp(GetInstanceMaterial(instanceId).solidAlphaMultiplier * resultColor.a, 0.0f, 1.0f);");
 
 #ifdef TEXTURE_EDGE_ENABLED
 	if (cc.opt_texture_edge) {
@@ -522,9 +536,9 @@ void RT64::Shader::generateSurfaceHitGroup(unsigned int shaderId, Filter filter,
 	if (vertexUV && normalMapEnabled) {
 		SS("    vertexTangent = normalize(mul(instanceTransforms[instanceId].objectToWorldNormal, float4(vertexTangent, 0.f)).xyz) * normalSign;");
 		SS("    vertexBinormal = normalize(mul(instanceTransforms[instanceId].objectToWorldNormal, float4(vertexBinormal, 0.f)).xyz) * normalSign;");
-		SS("    int normalTexIndex = instanceMaterials[instanceId].normalTexIndex;");
+		SS("    int normalTexIndex = GetInstanceMaterial(instanceId).normalTexIndex;");
 		SS("    if (normalTexIndex >= 0) {");
-		SS("        float uvDetailScale = instanceMaterials[instanceId].uvDetailScale;");
+		SS("        float uvDetailScale = GetInstanceMaterial(instanceId).uvDetailScale;");
 		SS("        float3 normalColor = gTextures[NonUniformResourceIndex(normalTexIndex)].SampleGrad(gTextureSampler, vertexUV * uvDetailScale, ddx * uvDetailScale, ddy * uvDetailScale).xyz;");
 		SS("        normalColor = (normalColor * 2.0f) - 1.0f;");
 		SS("        float3 newNormal = normalize(vertexNormal * normalColor.z + vertexTangent * normalColor.x + vertexBinormal * normalColor.y);");
@@ -537,9 +551,9 @@ void RT64::Shader::generateSurfaceHitGroup(unsigned int shaderId, Filter filter,
 	SS("	float3 vertexFlow = curWorldPos - prevWorldPos;");
 	SS("    float3 vertexSpecular = float3(1.0f, 1.0f, 1.0f);");
 	if (vertexUV && specularMapEnabled) {
-		SS("    int specularTexIndex = instanceMaterials[instanceId].specularTexIndex;");
+		SS("    int specularTexIndex = GetInstanceMaterial(instanceId).specularTexIndex;");
 		SS("    if (specularTexIndex >= 0) {");
-		SS("        float uvDetailScale = instanceMaterials[instanceId].uvDetailScale;");
+		SS("        float uvDetailScale = GetInstanceMaterial(instanceId).uvDetailScale;");
 		SS("        vertexSpecular = gTextures[NonUniformResourceIndex(specularTexIndex)].SampleGrad(gTextureSampler, vertexUV * uvDetailScale, ddx * uvDetailScale, ddy * uvDetailScale).rgb;");
 		SS("    }");
 	}
@@ -611,14 +625,14 @@ void RT64::Shader::generateShadowHitGroup(unsigned int shaderId, Filter filter,
 	SS("[shader(\"anyhit\")]");
 	SS("void " << anyHitName << "(inout ShadowHitInfo payload, Attributes attrib) {");
 	if (cc.opt_alpha) {
-		SS("    uint instanceId = InstanceIndex();");
+		SS("    uint instanceId = InstanceID();");
 		SS("    uint triangleIndex = PrimitiveIndex();");
 		SS("    float3 barycentrics = float3((1.0f - attrib.bary.x - attrib.bary.y), attrib.bary.x, attrib.bary.y);");
 
 		getVertexData(ss, true, true, cc.useTextures[0] || cc.useTextures[1], cc.inputCount, cc.opt_alpha, false);
 
 		if (cc.useTextures[0]) {
-			SS("    int diffuseTexIndex = instanceMaterials[instanceId].diffuseTexIndex;");
+			SS("    int diffuseTexIndex = GetInstanceMaterial(instanceId).diffuseTexIndex;");
 			SS("    float4 texVal0 = gTextures[NonUniformResourceIndex(diffuseTexIndex)].SampleLevel(gTextureSampler, vertexUV, 0);");
 		}
 
@@ -634,7 +648,7 @@ void RT64::Shader::generateShadowHitGroup(unsigned int shaderId, Filter filter,
 			SS("    float resultAlpha = (" + colorFormula(cc.c, cc.do_single[0], cc.do_multiply[0], cc.do_mix[0], cc.opt_alpha, cc.opt_alpha) + ").a;");
 		}
 
-		SS("    resultAlpha = clamp(resultAlpha * instanceMaterials[instanceId].shadowAlphaMultiplier, 0.0f, 1.0f);");
+		SS("    resultAlpha = clamp(resultAlpha * GetInstanceMaterial(instanceId).shadowAlphaMultiplier, 0.0f, 1.0f);");
 
 #ifdef TEXTURE_EDGE_ENABLED
 		if (cc.opt_texture_edge) {
@@ -681,7 +695,8 @@ ID3D12RootSignature *RT64::Shader::generateRasterRootSignature(Filter filter, Ad
 		nv_helpers_dx12::RootSignatureGenerator::HeapRanges heapRanges;
 		heapRanges.push_back({ SRV_INDEX(instanceTransforms), 1, 0, D3D12_DESCRIPTOR_RANGE_TYPE_SRV, HEAP_INDEX(instanceTransforms) });
 		heapRanges.push_back({ SRV_INDEX(instanceMaterials), 1, 0, D3D12_DESCRIPTOR_RANGE_TYPE_SRV, HEAP_INDEX(instanceMaterials) });
-		heapRanges.push_back({ SRV_INDEX(gTextures), SRV_TEXTURES_MAX, 0, D3D12_DESCRIPTOR_RANGE_TYPE_SRV, HEAP_INDEX(gTextures) });
+		heapRanges.push_back({ SRV_INDEX(instanceMaterialIndices), 1, 0, D3D12_DESCRIPTOR_RANGE_TYPE_SRV, HEAP_INDEX(instanceMaterialIndices) });
+		heapRanges.push_back({ SRV_INDEX(gTextures), SRV_BINDLESS_UNBOUNDED, 0, D3D12_DESCRIPTOR_RANGE_TYPE_SRV, HEAP_INDEX(gTextures) });
 		rsc.AddHeapRangesParameter(heapRanges);
 	}
 
@@ -697,8 +712,6 @@ ID3D12RootSignature *RT64::Shader::generateRasterRootSignature(Filter filter, Ad
 
 ID3D12RootSignature *RT64::Shader::generateHitRootSignature(Filter filter, AddressingMode hAddr, AddressingMode vAddr, unsigned int samplerRegisterIndex, bool hitBuffers) {
 	nv_helpers_dx12::RootSignatureGenerator rsc;
-	rsc.AddRootParameter(D3D12_ROOT_PARAMETER_TYPE_SRV, SRV_INDEX(vertexBuffer));
-	rsc.AddRootParameter(D3D12_ROOT_PARAMETER_TYPE_SRV, SRV_INDEX(indexBuffer));
 
 	{
 		nv_helpers_dx12::RootSignatureGenerator::HeapRanges heapRanges;
@@ -713,8 +726,11 @@ ID3D12RootSignature *RT64::Shader::generateHitRootSignature(Filter filter, Addre
 
 		heapRanges.push_back({ SRV_INDEX(instanceTransforms), 1, 0, D3D12_DESCRIPTOR_RANGE_TYPE_SRV, HEAP_INDEX(instanceTransforms) });
 		heapRanges.push_back({ SRV_INDEX(instanceMaterials), 1, 0, D3D12_DESCRIPTOR_RANGE_TYPE_SRV, HEAP_INDEX(instanceMaterials) });
-		heapRanges.push_back({ SRV_INDEX(gTextures), SRV_TEXTURES_MAX, 0, D3D12_DESCRIPTOR_RANGE_TYPE_SRV, HEAP_INDEX(gTextures) });
+		heapRanges.push_back({ SRV_INDEX(instanceMaterialIndices), 1, 0, D3D12_DESCRIPTOR_RANGE_TYPE_SRV, HEAP_INDEX(instanceMaterialIndices) });
+		heapRanges.push_back({ SRV_INDEX(instanceGeometry), 1, 0, D3D12_DESCRIPTOR_RANGE_TYPE_SRV, HEAP_INDEX(instanceGeometry) });
 		heapRanges.push_back({ CBV_INDEX(gParams), 1, 0, D3D12_DESCRIPTOR_RANGE_TYPE_CBV, HEAP_INDEX(gParams) });
+		heapRanges.push_back({ SRV_INDEX(gTextures), SRV_BINDLESS_UNBOUNDED, 0, D3D12_DESCRIPTOR_RANGE_TYPE_SRV, HEAP_INDEX(gTextures) });
+		heapRanges.push_back({ 0, SRV_BINDLESS_UNBOUNDED, SRV_GEOMETRY_BUFFERS_SPACE, D3D12_DESCRIPTOR_RANGE_TYPE_SRV, HEAP_INDEX(gTextures) });
 		rsc.AddHeapRangesParameter(heapRanges);
 	}
 
@@ -761,6 +777,7 @@ void RT64::Shader::compileShaderCode(const std::string &shaderCode, const std::w
     }
 
     D3D12_CHECK(result->GetResult(shaderBlob));
+    compiledCount++;
 }
 
 const RT64::Shader::RasterGroup &RT64::Shader::getRasterGroup() const {
@@ -783,6 +800,18 @@ bool RT64::Shader::hasHitGroups() const {
 	return (surfaceHitGroup.blob != nullptr) || (shadowHitGroup.blob != nullptr);
 }
 
+void RT64::Shader::markDirty() {
+	generation = Generation::next();
+}
+
+uint64_t RT64::Shader::getGeneration() const {
+	return generation;
+}
+
+RT64::Device *RT64::Shader::getDevice() const {
+	return device;
+}
+
 // Public
 
 RT64::Shader::Filter convertFilter(unsigned int filter) {
@@ -813,14 +842,52 @@ DLLEXPORT RT64_SHADER *RT64_CreateShader(RT64_DEVICE *devicePtr, unsigned int sh
 		RT64::Shader::Filter sFilter = convertFilter(filter);
 		RT64::Shader::AddressingMode sHAddr = convertAddressingMode(hAddr);
 		RT64::Shader::AddressingMode sVAddr = convertAddressingMode(vAddr);
-        return (RT64_SHADER *)(new RT64::Shader(device, shaderId, sFilter, sHAddr, sVAddr, flags));
+		RT64::Shader *shader = new RT64::Shader(device, shaderId, sFilter, sHAddr, sVAddr, flags);
+		if (device->isRenderThreadEnabled()) {
+			device->getImmediateBuffer().recordAttachShader(shader);
+		}
+		else {
+			shader->attach();
+		}
+
+		RT64::Capture *capture = RT64::GlobalCapture;
+		if (capture != nullptr) {
+			capture->beginCall(RT64_CAPTURE_CALL_CREATE_SHADER);
+			capture->writeObject(devicePtr);
+			capture->writeValue(shaderId);
+			capture->writeValue(filter);
+			capture->writeValue(hAddr);
+			capture->writeValue(vAddr);
+			capture->writeValue(flags);
+			capture->writeObject(shader);
+			capture->endCall();
+		}
+
+		return (RT64_SHADER *)(shader);
     }
     RT64_CATCH_EXCEPTION();
     return nullptr;
 }
 
 DLLEXPORT void RT64_DestroyShader(RT64_SHADER *shaderPtr) {
-	delete (RT64::Shader *)(shaderPtr);
+	RT64::Shader *shader = (RT64::Shader *)(shaderPtr);
+
+	RT64::Capture *capture = RT64::GlobalCapture;
+	if (capture != nullptr) {
+		capture->beginCall(RT64_CAPTURE_CALL_DESTROY_SHADER);
+		capture->writeObject(shaderPtr);
+		capture->endCall();
+		capture->forgetObject(shaderPtr);
+	}
+
+	// The render thread deletes the shader once it has finished the frames that could still use it.
+	RT64::Device *device = shader->getDevice();
+	if (device->isRenderThreadEnabled()) {
+		device->getImmediateBuffer().recordDestroyShader(shader);
+	}
+	else {
+		delete shader;
+	}
 }
 
 #endif
\ No newline at end of file
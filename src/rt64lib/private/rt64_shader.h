@@ -44,6 +44,8 @@ namespace RT64 {
 		RasterGroup rasterGroup;
 		HitGroup surfaceHitGroup;
 		HitGroup shadowHitGroup;
+		uint64_t generation;
+		unsigned int compiledCount;
 
 		unsigned int uniqueSamplerRegisterIndex(Filter filter, AddressingMode hAddr, AddressingMode vAddr);
 		void generateRasterGroup(unsigned int shaderId, Filter filter, AddressingMode hAddr, AddressingMode vAddr, const std::string &vertexShaderName, const std::string &pixelShaderName);
@@ -56,10 +58,17 @@ namespace RT64 {
 	public:
 		Shader(Device *device, unsigned int shaderId, Filter filter, AddressingMode hAddr, AddressingMode vAddr, int flags);
 		~Shader();
+
+		// Adds the shader to the device. It's separate from the constructor so the shader can be compiled on the
+		// host's thread while the render thread adds it when it's enabled.
+		void attach();
 		const RasterGroup &getRasterGroup() const;
 		HitGroup &getSurfaceHitGroup();
 		HitGroup &getShadowHitGroup();
 		bool hasRasterGroup() const;
 		bool hasHitGroups() const;
+		void markDirty();
+		uint64_t getGeneration() const;
+		Device *getDevice() const;
 	};
 };
\ No newline at end of file
@@ -0,0 +1,115 @@
+//
+// RT64
+//
+
+#include "rt64_shader_binding_table.h"
+
+#include <assert.h>
+#include <string.h>
+
+namespace {
+	uint32_t roundUp(uint32_t value, uint32_t alignment) {
+		return (value + alignment - 1) & ~(alignment - 1);
+	}
+};
+
+// Private
+
+RT64::ShaderBindingTable::ShaderBindingTable() {
+	memset(sections, 0, sizeof(sections));
+	allDirty = true;
+}
+
+void RT64::ShaderBindingTable::setLayout(uint32_t rayGenCount, uint32_t rayGenArgumentCount, uint32_t missCount, uint32_t missArgumentCount, uint32_t hitGroupCount, uint32_t hitGroupArgumentCount) {
+	assert((rayGenArgumentCount <= MaxArgumentCount) && (missArgumentCount <= MaxArgumentCount) && (hitGroupArgumentCount <= MaxArgumentCount));
+
+	const uint32_t counts[] = { rayGenCount, missCount, hitGroupCount };
+	const uint32_t argumentCounts[] = { rayGenArgumentCount, missArgumentCount, hitGroupArgumentCount };
+	SectionLayout newSections[(int)(Section::Count)];
+	uint32_t offset = 0;
+	for (int i = 0; i < (int)(Section::Count); i++) {
+		newSections[i].recordCount = counts[i];
+		newSections[i].argumentCount = argumentCounts[i];
+		newSections[i].recordSize = roundUp(IdentifierSize + argumentCounts[i] * sizeof(uint64_t), RecordAlignment);
+		newSections[i].offset = offset;
+		offset += newSections[i].recordCount * newSections[i].recordSize;
+	}
+
+	// Only the amount of hit groups can change without moving any of the existing records.
+	const SectionLayout &hitGroups = sections[(int)(Section::HitGroup)];
+	const SectionLayout &newHitGroups = newSections[(int)(Section::HitGroup)];
+	const size_t fixedSectionsSize = sizeof(SectionLayout) * (int)(Section::HitGroup);
+	if ((memcmp(sections, newSections, fixedSectionsSize) != 0) || (hitGroups.recordSize != newHitGroups.recordSize) || (hitGroups.argumentCount != newHitGroups.argumentCount)) {
+		data.clear();
+		allDirty = true;
+	}
+
+	memcpy(sections, newSections, sizeof(sections));
+
+	// The data never shrinks, so it keeps matching what was copied to the GPU for the hit groups that aren't used anymore.
+	const uint32_t size = getSize();
+	if (data.size() < size) {
+		data.resize(size, 0);
+	}
+}
+
+void RT64::ShaderBindingTable::setRecord(Section section, uint32_t index, const void *identifier, const uint64_t *arguments, uint32_t argumentCount) {
+	const SectionLayout &layout = sections[(int)(section)];
+	assert(index < layout.recordCount);
+	assert(argumentCount <= layout.argumentCount);
+	assert(identifier != nullptr);
+
+	// Build the record first so it can be compared with the one that's already in the table.
+	uint8_t record[MaxRecordSize] = {};
+	memcpy(record, identifier, IdentifierSize);
+	if (argumentCount > 0) {
+		memcpy(record + IdentifierSize, arguments, argumentCount * sizeof(uint64_t));
+	}
+
+	const uint32_t recordOffset = layout.offset + index * layout.recordSize;
+	uint8_t *recordData = &data[recordOffset];
+	if (memcmp(recordData, record, layout.recordSize) != 0) {
+		memcpy(recordData, record, layout.recordSize);
+		if (!allDirty) {
+			dirtyRecords.push_back({ recordOffset, layout.recordSize });
+		}
+	}
+}
+
+uint32_t RT64::ShaderBindingTable::getSize() const {
+	const SectionLayout &hitGroups = sections[(int)(Section::HitGroup)];
+	return roundUp(hitGroups.offset + hitGroups.recordCount * hitGroups.recordSize, SizeAlignment);
+}
+
+uint32_t RT64::ShaderBindingTable::getDataSize() const {
+	return static_cast<uint32_t>(data.size());
+}
+
+const uint8_t *RT64::ShaderBindingTable::getData() const {
+	return data.data();
+}
+
+uint32_t RT64::ShaderBindingTable::getSectionOffset(Section section) const {
+	return sections[(int)(section)].offset;
+}
+
+uint32_t RT64::ShaderBindingTable::getSectionSize(Section section) const {
+	return sections[(int)(section)].recordCount * sections[(int)(section)].recordSize;
+}
+
+uint32_t RT64::ShaderBindingTable::getRecordSize(Section section) const {
+	return sections[(int)(section)].recordSize;
+}
+
+bool RT64::ShaderBindingTable::isAllDirty() const {
+	return allDirty;
+}
+
+const std::vector<RT64::ShaderBindingTable::DirtyRecord> &RT64::ShaderBindingTable::getDirtyRecords() const {
+	return dirtyRecords;
+}
+
+void RT64::ShaderBindingTable::clearDirty() {
+	dirtyRecords.clear();
+	allDirty = false;
+}
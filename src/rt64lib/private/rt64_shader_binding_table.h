@@ -0,0 +1,70 @@
+//
+// RT64
+//
+
+#pragma once
+
+#include <stdint.h>
+#include <vector>
+
+namespace RT64 {
+	// CPU copy of the shader binding table, laid out the same way nv_helpers_dx12::ShaderBindingTableGenerator does it: the
+	// ray generation, miss and hit group sections one after another, with every record being the shader identifier followed
+	// by its 8-byte arguments and padded to the biggest record of its section. Records are only marked dirty when their bytes
+	// change, so those are the only ones that must be copied to the GPU. The hit groups go last, so their records keep the
+	// same offset when the amount of them changes.
+	class ShaderBindingTable {
+	public:
+		struct DirtyRecord {
+			uint32_t offset;
+			uint32_t size;
+		};
+
+		enum class Section {
+			RayGeneration,
+			Miss,
+			HitGroup,
+			Count
+		};
+
+		static const uint32_t IdentifierSize = 32;
+		static const uint32_t RecordAlignment = 64;
+		static const uint32_t SizeAlignment = 256;
+		static const uint32_t MaxArgumentCount = 8;
+	private:
+		static const uint32_t MaxRecordSize = ((IdentifierSize + MaxArgumentCount * sizeof(uint64_t) + RecordAlignment - 1) / RecordAlignment) * RecordAlignment;
+
+		struct SectionLayout {
+			uint32_t recordCount;
+			uint32_t argumentCount;
+			uint32_t recordSize;
+			uint32_t offset;
+		};
+
+		SectionLayout sections[(int)(Section::Count)];
+		std::vector<uint8_t> data;
+		std::vector<DirtyRecord> dirtyRecords;
+		bool allDirty;
+	public:
+		ShaderBindingTable();
+
+		// Every record must be set again after changing the layout, but only the ones that end up different are marked dirty.
+		// Changing anything other than the amount of hit groups moves the records around and marks the whole table as dirty.
+		void setLayout(uint32_t rayGenCount, uint32_t rayGenArgumentCount, uint32_t missCount, uint32_t missArgumentCount, uint32_t hitGroupCount, uint32_t hitGroupArgumentCount);
+		void setRecord(Section section, uint32_t index, const void *identifier, const uint64_t *arguments, uint32_t argumentCount);
+
+		uint32_t getSize() const;
+
+		// The data can be bigger than the size of the table, as it keeps the records of hit groups that aren't used anymore.
+		uint32_t getDataSize() const;
+		const uint8_t *getData() const;
+		uint32_t getSectionOffset(Section section) const;
+		uint32_t getSectionSize(Section section) const;
+		uint32_t getRecordSize(Section section) const;
+
+		// Records that changed since the dirty state was last cleared. They're only tracked if the whole table isn't dirty.
+		bool isAllDirty() const;
+		const std::vector<DirtyRecord> &getDirtyRecords() const;
+		void clearDirty();
+	};
+};
@@ -0,0 +1,161 @@
+//
+// RT64
+//
+
+#pragma once
+
+#include <assert.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+namespace RT64 {
+	// Identifies a value stored in a SlotMap. The generation detects handles to values that were already removed.
+	struct SlotHandle {
+		uint32_t index;
+		uint32_t generation;
+	};
+
+	// Stores values behind stable handles with constant time insertion and removal.
+	// Values are kept densely in insertion order. Removing a value leaves a hole that is closed
+	// by the next compaction, so the order is preserved without shifting the values every time.
+	template<typename T>
+	class SlotMap {
+	public:
+		static constexpr uint32_t InvalidIndex = 0xFFFFFFFF;
+	private:
+		struct Slot {
+			uint32_t denseIndex;
+			uint32_t generation;
+		};
+
+		std::vector<T> values;
+		std::vector<uint32_t> valueSlots;
+		std::vector<Slot> slots;
+		std::vector<uint32_t> freeSlots;
+		std::vector<T> reorderValues;
+		std::vector<uint32_t> reorderSlots;
+		std::vector<bool> reorderMarks;
+		size_t holeCount;
+	public:
+		SlotMap() {
+			holeCount = 0;
+		}
+
+		SlotHandle insert(const T &value) {
+			uint32_t slotIndex;
+			if (!freeSlots.empty()) {
+				slotIndex = freeSlots.back();
+				freeSlots.pop_back();
+			}
+			else {
+				slotIndex = static_cast<uint32_t>(slots.size());
+				slots.push_back({ InvalidIndex, 0 });
+			}
+
+			Slot &slot = slots[slotIndex];
+			slot.denseIndex = static_cast<uint32_t>(values.size());
+			values.push_back(value);
+			valueSlots.push_back(slotIndex);
+			return { slotIndex, slot.generation };
+		}
+
+		bool contains(SlotHandle handle) const {
+			return (handle.index < slots.size()) && (slots[handle.index].generation == handle.generation) && (slots[handle.index].denseIndex != InvalidIndex);
+		}
+
+		// Returns false if the handle was already removed.
+		bool remove(SlotHandle handle) {
+			if (!contains(handle)) {
+				return false;
+			}
+
+			Slot &slot = slots[handle.index];
+			values[slot.denseIndex] = T();
+			valueSlots[slot.denseIndex] = InvalidIndex;
+			slot.denseIndex = InvalidIndex;
+			slot.generation++;
+			freeSlots.push_back(handle.index);
+			holeCount++;
+			return true;
+		}
+
+		T *get(SlotHandle handle) {
+			return contains(handle) ? &values[slots[handle.index].denseIndex] : nullptr;
+		}
+
+		// Closes the holes left by removed values while keeping the order of the rest.
+		void compact() {
+			if (holeCount == 0) {
+				return;
+			}
+
+			size_t writeIndex = 0;
+			for (size_t readIndex = 0; readIndex < values.size(); readIndex++) {
+				uint32_t slotIndex = valueSlots[readIndex];
+				if (slotIndex == InvalidIndex) {
+					continue;
+				}
+
+				if (writeIndex != readIndex) {
+					values[writeIndex] = values[readIndex];
+					valueSlots[writeIndex] = slotIndex;
+				}
+
+				slots[slotIndex].denseIndex = static_cast<uint32_t>(writeIndex);
+				writeIndex++;
+			}
+
+			values.resize(writeIndex);
+			valueSlots.resize(writeIndex);
+			holeCount = 0;
+		}
+
+		// Moves the values to the back in the order they're provided while keeping the order of the rest.
+		void moveToBack(const std::vector<SlotHandle> &handles) {
+			compact();
+
+			reorderMarks.assign(values.size(), false);
+			for (const SlotHandle &handle : handles) {
+				assert(contains(handle));
+				assert(!reorderMarks[slots[handle.index].denseIndex] && "Handles must be unique.");
+				reorderMarks[slots[handle.index].denseIndex] = true;
+			}
+
+			reorderValues.clear();
+			reorderSlots.clear();
+			for (size_t i = 0; i < values.size(); i++) {
+				if (!reorderMarks[i]) {
+					reorderValues.push_back(values[i]);
+					reorderSlots.push_back(valueSlots[i]);
+				}
+			}
+
+			for (const SlotHandle &handle : handles) {
+				uint32_t denseIndex = slots[handle.index].denseIndex;
+				reorderValues.push_back(values[denseIndex]);
+				reorderSlots.push_back(valueSlots[denseIndex]);
+			}
+
+			values.swap(reorderValues);
+			valueSlots.swap(reorderSlots);
+			for (size_t i = 0; i < valueSlots.size(); i++) {
+				slots[valueSlots[i]].denseIndex = static_cast<uint32_t>(i);
+			}
+		}
+
+		// The values can only be iterated densely after a compaction.
+		const std::vector<T> &getValues() const {
+			assert(holeCount == 0);
+			return values;
+		}
+
+		size_t size() const {
+			return values.size() - holeCount;
+		}
+
+		bool empty() const {
+			return size() == 0;
+		}
+	};
+};
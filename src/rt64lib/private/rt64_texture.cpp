@@ -10,6 +10,7 @@
 
 #include "DDSTextureLoader/DDSTextureLoader12.h"
 
+#include "rt64_capture.h"
 #include "rt64_device.h"
 #include "rt64_mipmaps.h"
 
@@ -18,18 +19,48 @@
 RT64::Texture::Texture(Device *device) {
 	this->device = device;
 	format = DXGI_FORMAT_UNKNOWN;
-	currentIndex = -1;
+	pending = false;
+	pendingMipmaps = false;
+	ready = false;
+	generation = Generation::next();
+	slot = UINT32_MAX;
 }
 
 RT64::Texture::~Texture() {
+	// The upload might still be in flight if the texture is destroyed before the device retired it.
+	if (pending) {
+		device->dequeueTexture(this);
+	}
+
+	textureUpload.Release();
 	texture.Release();
+
+	if (slot != UINT32_MAX) {
+		device->freeTextureSlot(slot);
+	}
+}
+
+void RT64::Texture::attach() {
+	assert(slot == UINT32_MAX);
+	slot = device->allocateTextureSlot(this);
+}
+
+void RT64::Texture::setDescription(const RT64_TEXTURE_DESC &textureDesc, bool async) {
+	switch (textureDesc.format) {
+	case RT64_TEXTURE_FORMAT_RGBA8:
+		setRGBA8(textureDesc.bytes, textureDesc.byteCount, textureDesc.width, textureDesc.height, textureDesc.rowPitch, true, async);
+		break;
+	case RT64_TEXTURE_FORMAT_DDS:
+		setDDS(textureDesc.bytes, textureDesc.byteCount, async);
+		break;
+	}
 }
 
-void RT64::Texture::setRawWithFormat(DXGI_FORMAT format, const void *bytes, int byteCount, int width, int height, int rowPitch, bool generateMipmaps) {
+void RT64::Texture::setRawWithFormat(DXGI_FORMAT format, const void *bytes, int byteCount, int width, int height, int rowPitch, bool generateMipmaps, bool async) {
 	assert(bytes != nullptr);
+	assert(!pending);
 	this->format = format;
 
-	AllocatedResource textureUpload;
 	Mipmaps *mipmaps = device->getMipmaps();
 	if (mipmaps == nullptr) {
 		generateMipmaps = false;
@@ -53,7 +84,7 @@ void RT64::Texture::setRawWithFormat(DXGI_FORMAT format, const void *bytes, int
 		textureDesc.Dimension = D3D12_RESOURCE_DIMENSION_TEXTURE2D;
 
 		// Create the texture resource
-		texture = device->allocateResource(D3D12_HEAP_TYPE_DEFAULT, &textureDesc, D3D12_RESOURCE_STATE_COPY_DEST, nullptr);
+		texture = device->allocateResource(RT64_MEMORY_CATEGORY_TEXTURE, D3D12_HEAP_TYPE_DEFAULT, &textureDesc, D3D12_RESOURCE_STATE_COPY_DEST, nullptr);
 
 		// Describe the resource
 		D3D12_RESOURCE_DESC resourceDesc = {};
@@ -67,7 +98,7 @@ void RT64::Texture::setRawWithFormat(DXGI_FORMAT format, const void *bytes, int
 		resourceDesc.Dimension = D3D12_RESOURCE_DIMENSION_BUFFER;
 
 		// Create the upload heap
-		textureUpload = device->allocateResource(D3D12_HEAP_TYPE_UPLOAD, &resourceDesc, D3D12_RESOURCE_STATE_GENERIC_READ, nullptr);
+		textureUpload = device->allocateResource(RT64_MEMORY_CATEGORY_UPLOAD, D3D12_HEAP_TYPE_UPLOAD, &resourceDesc, D3D12_RESOURCE_STATE_GENERIC_READ, nullptr);
 	}
 
 	// Upload texture.
@@ -91,6 +122,7 @@ void RT64::Texture::setRawWithFormat(DXGI_FORMAT format, const void *bytes, int
 		}
 
 		textureUpload.Get()->Unmap(0, nullptr);
+		device->getFrameStats().textureUploadBytes += (UINT64)(rowWidth) * height;
 
 		// Describe the upload heap resource location for the copy
 		D3D12_SUBRESOURCE_FOOTPRINT subresource = {};
@@ -127,29 +159,69 @@ void RT64::Texture::setRawWithFormat(DXGI_FORMAT format, const void *bytes, int
 		d3dCommandList->DiscardResource(textureUpload.Get(), nullptr);
 	}
 
+	finishUpload(generateMipmaps, async);
+}
+
+void RT64::Texture::finishUpload(bool generateMipmaps, bool async) {
+	// The texture's resource was replaced.
+	generation = Generation::next();
+
+	if (async) {
+		// Keep the upload heap alive until the device retires the texture.
+		pending = true;
+		pendingMipmaps = generateMipmaps;
+		device->queueTexture(this);
+		return;
+	}
+
 	if (generateMipmaps) {
-		mipmaps->generate(texture.Get());
+		device->getMipmaps()->generate(texture.Get());
 	}
 	else {
+		// Execute the commands before releasing the upload heap.
 		device->submitCommandList();
 		device->waitForGPU();
 		device->resetCommandList();
 	}
 
 	textureUpload.Release();
+	ready = true;
+}
+
+void RT64::Texture::retireUpload() {
+	assert(pending);
+
+	// The copy has finished at this point. The mipmaps are recorded on the frame's command list, so every texture
+	// retired in the same frame is generated by the same submission.
+	if (pendingMipmaps) {
+		device->getMipmaps()->record(texture.Get());
+		pendingMipmaps = false;
+	}
+
+	textureUpload.Release();
+	pending = false;
+	generation = Generation::next();
+	ready = true;
+}
+
+bool RT64::Texture::isReady() const {
+	// Read by the host while the render thread retires the upload.
+	return ready;
 }
 
-void RT64::Texture::setRGBA8(const void *bytes, int byteCount, int width, int height, int rowPitch, bool generateMipmaps) {
-	setRawWithFormat(DXGI_FORMAT_R8G8B8A8_UNORM, bytes, byteCount, width, height, rowPitch, generateMipmaps);
+void RT64::Texture::setRGBA8(const void *bytes, int byteCount, int width, int height, int rowPitch, bool generateMipmaps, bool async) {
+	setRawWithFormat(DXGI_FORMAT_R8G8B8A8_UNORM, bytes, byteCount, width, height, rowPitch, generateMipmaps, async);
 }
 
-void RT64::Texture::setDDS(const void *bytes, int byteCount) {
+void RT64::Texture::setDDS(const void *bytes, int byteCount, bool async) {
+	assert(!pending);
+
 	// Create the resource with the DDS data.
 	std::vector<D3D12_SUBRESOURCE_DATA> subresourceData;
 	D3D12MA::Allocation *textureAllocation = nullptr;
 	D3D12_CHECK(LoadDDSTextureFromMemory(device->getD3D12Device(), (const uint8_t *)(bytes), byteCount, device->getD3D12Allocator(), &textureAllocation, subresourceData));
 
-	texture = AllocatedResource(textureAllocation);
+	texture = device->trackAllocation(RT64_MEMORY_CATEGORY_TEXTURE, textureAllocation);
 	D3D12_RESOURCE_DESC textureDesc = texture.Get()->GetDesc();
 	format = textureDesc.Format;
 
@@ -167,23 +239,19 @@ void RT64::Texture::setDDS(const void *bytes, int byteCount) {
 	resourceDesc.Dimension = D3D12_RESOURCE_DIMENSION_BUFFER;
 
 	// Create the upload heap.
-	AllocatedResource textureUpload = device->allocateResource(D3D12_HEAP_TYPE_UPLOAD, &resourceDesc, D3D12_RESOURCE_STATE_GENERIC_READ, nullptr);
+	textureUpload = device->allocateResource(RT64_MEMORY_CATEGORY_UPLOAD, D3D12_HEAP_TYPE_UPLOAD, &resourceDesc, D3D12_RESOURCE_STATE_GENERIC_READ, nullptr);
 
 	// Update the subresources with the data from the DDS.
 	auto d3dCommandList = device->getD3D12CommandList();
 	UpdateSubresources(d3dCommandList, texture.Get(), textureUpload.Get(), 0, 0, subresouceSize, &subresourceData[0]);
+	device->getFrameStats().textureUploadBytes += uploadBufferSize;
 
 	// Transition the texture to a shader resource.
 	CD3DX12_RESOURCE_BARRIER uploadBarrier = CD3DX12_RESOURCE_BARRIER::Transition(texture.Get(), D3D12_RESOURCE_STATE_COPY_DEST, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
 	d3dCommandList->ResourceBarrier(1, &uploadBarrier);
 	d3dCommandList->DiscardResource(textureUpload.Get(), nullptr);
 
-	// Execute the commands before releasing the upload heap.
-	device->submitCommandList();
-	device->waitForGPU();
-	device->resetCommandList();
-
-	textureUpload.Release();
+	finishUpload(false, async);
 }
 
 ID3D12Resource *RT64::Texture::getTexture() const {
@@ -194,30 +262,48 @@ DXGI_FORMAT RT64::Texture::getFormat() const {
 	return format;
 }
 
-void RT64::Texture::setCurrentIndex(int v) {
-	currentIndex = v;
+uint32_t RT64::Texture::getSlot() const {
+	return slot;
 }
 
-int RT64::Texture::getCurrentIndex() const {
-	return currentIndex;
+uint64_t RT64::Texture::getGeneration() const {
+	return generation;
+}
+
+RT64::Device *RT64::Texture::getDevice() const {
+	return device;
 }
 
 // Public
 
-DLLEXPORT RT64_TEXTURE *RT64_CreateTexture(RT64_DEVICE *devicePtr, RT64_TEXTURE_DESC textureDesc) {
+static RT64_TEXTURE *createTexture(RT64_DEVICE *devicePtr, const RT64_TEXTURE_DESC &textureDesc, bool async) {
 	assert(devicePtr != nullptr);
 	RT64::Device *device = (RT64::Device *)(devicePtr);
 	RT64::Texture *texture = new RT64::Texture(device);
 
 	// Try to load the texture data.
 	try {
-		switch (textureDesc.format) {
-		case RT64_TEXTURE_FORMAT_RGBA8:
-			texture->setRGBA8(textureDesc.bytes, textureDesc.byteCount, textureDesc.width, textureDesc.height, textureDesc.rowPitch, true);
-			break;
-		case RT64_TEXTURE_FORMAT_DDS:
-			texture->setDDS(textureDesc.bytes, textureDesc.byteCount);
-			break;
+		// The render thread loads the data from a copy stored in the record, so errors are reported
+		// through the last error once it gets to it instead of failing the creation.
+		if (device->isRenderThreadEnabled()) {
+			device->getImmediateBuffer().recordAttachTexture(texture, textureDesc, async);
+		}
+		else {
+			texture->attach();
+			texture->setDescription(textureDesc, async);
+		}
+
+		RT64::Capture *capture = RT64::GlobalCapture;
+		if (capture != nullptr) {
+			RT64_TEXTURE_DESC storedDesc = textureDesc;
+			storedDesc.bytes = nullptr;
+			capture->beginCall(RT64_CAPTURE_CALL_CREATE_TEXTURE);
+			capture->writeObject(devicePtr);
+			capture->writeValue((uint8_t)(async));
+			capture->writeValue(storedDesc);
+			capture->writeBlob(textureDesc.bytes, textureDesc.byteCount);
+			capture->writeObject(texture);
+			capture->endCall();
 		}
 
 		return (RT64_TEXTURE *)(texture);
@@ -228,8 +314,39 @@ DLLEXPORT RT64_TEXTURE *RT64_CreateTexture(RT64_DEVICE *devicePtr, RT64_TEXTURE_
 	return nullptr;
 }
 
+DLLEXPORT RT64_TEXTURE *RT64_CreateTexture(RT64_DEVICE *devicePtr, RT64_TEXTURE_DESC textureDesc) {
+	return createTexture(devicePtr, textureDesc, false);
+}
+
+DLLEXPORT RT64_TEXTURE *RT64_CreateTextureAsync(RT64_DEVICE *devicePtr, RT64_TEXTURE_DESC textureDesc) {
+	return createTexture(devicePtr, textureDesc, true);
+}
+
+DLLEXPORT bool RT64_IsTextureReady(RT64_TEXTURE *texturePtr) {
+	assert(texturePtr != nullptr);
+	RT64::Texture *texture = (RT64::Texture *)(texturePtr);
+	return texture->isReady();
+}
+
 DLLEXPORT void RT64_DestroyTexture(RT64_TEXTURE *texturePtr) {
-	delete (RT64::Texture *)(texturePtr);
+	RT64::Texture *texture = (RT64::Texture *)(texturePtr);
+
+	RT64::Capture *capture = RT64::GlobalCapture;
+	if (capture != nullptr) {
+		capture->beginCall(RT64_CAPTURE_CALL_DESTROY_TEXTURE);
+		capture->writeObject(texturePtr);
+		capture->endCall();
+		capture->forgetObject(texturePtr);
+	}
+
+	// The render thread deletes the texture once it has finished the frames that could still use it.
+	RT64::Device *device = texture->getDevice();
+	if (device->isRenderThreadEnabled()) {
+		device->getImmediateBuffer().recordDestroyTexture(texture);
+	}
+	else {
+		delete texture;
+	}
 }
 
 #endif
\ No newline at end of file
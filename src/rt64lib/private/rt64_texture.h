@@ -6,6 +6,8 @@
 
 #include "rt64_common.h"
 
+#include <atomic>
+
 namespace RT64 {
 	class Device;
 
@@ -13,18 +15,33 @@ namespace RT64 {
 	private:
 		Device *device;
 		AllocatedResource texture;
+		AllocatedResource textureUpload;
 		DXGI_FORMAT format;
-		int currentIndex;
+		uint32_t slot;
+		bool pending;
+		bool pendingMipmaps;
+		std::atomic<bool> ready;
+		uint64_t generation;
 
-		void setRawWithFormat(DXGI_FORMAT format, const void *bytes, int byteCount, int width, int height, int rowPitch, bool generateMipmaps);
+		void setRawWithFormat(DXGI_FORMAT format, const void *bytes, int byteCount, int width, int height, int rowPitch, bool generateMipmaps, bool async);
+		void finishUpload(bool generateMipmaps, bool async);
 	public:
 		Texture(Device *device);
 		virtual ~Texture();
-		void setRGBA8(const void *bytes, int byteCount, int width, int height, int rowPitch, bool generateMipmaps);
-		void setDDS(const void *bytes, int byteCount);
+
+		// Allocates the texture's slot. It's separate from the constructor so the render thread can do it when it's enabled.
+		void attach();
+		void setDescription(const RT64_TEXTURE_DESC &textureDesc, bool async);
+		void setRGBA8(const void *bytes, int byteCount, int width, int height, int rowPitch, bool generateMipmaps, bool async = false);
+		void setDDS(const void *bytes, int byteCount, bool async = false);
+		void retireUpload();
+		bool isReady() const;
 		ID3D12Resource *getTexture() const;
 		DXGI_FORMAT getFormat() const;
-		void setCurrentIndex(int v);
-		int getCurrentIndex() const;
+
+		// Slot of the texture in the texture range of the descriptor heaps. It stays the same while the texture exists.
+		uint32_t getSlot() const;
+		uint64_t getGeneration() const;
+		Device *getDevice() const;
 	};
 };
\ No newline at end of file
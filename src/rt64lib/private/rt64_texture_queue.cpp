@@ -0,0 +1,56 @@
+//
+// RT64
+//
+
+#ifndef RT64_MINIMAL
+
+#include "rt64_texture_queue.h"
+
+#include <assert.h>
+
+void RT64::TextureQueue::push(Texture *texture, uint64_t fenceValue) {
+	assert(texture != nullptr);
+	assert(!contains(texture));
+	assert(entries.empty() || (entries.back().fenceValue <= fenceValue));
+	entries.push_back({ texture, fenceValue });
+}
+
+bool RT64::TextureQueue::remove(Texture *texture) {
+	for (size_t i = 0; i < entries.size(); i++) {
+		if (entries[i].texture == texture) {
+			entries.erase(entries.begin() + i);
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void RT64::TextureQueue::retire(uint64_t completedFenceValue, std::vector<Texture *> &retiredTextures) {
+	retiredTextures.clear();
+
+	// Fence values are pushed in increasing order, so all the retired entries are at the front of the queue.
+	size_t retiredCount = 0;
+	while ((retiredCount < entries.size()) && (entries[retiredCount].fenceValue <= completedFenceValue)) {
+		retiredTextures.push_back(entries[retiredCount].texture);
+		retiredCount++;
+	}
+
+	entries.erase(entries.begin(), entries.begin() + retiredCount);
+}
+
+bool RT64::TextureQueue::contains(const Texture *texture) const {
+	for (const Entry &entry : entries) {
+		if (entry.texture == texture) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
+size_t RT64::TextureQueue::size() const {
+	return entries.size();
+}
+
+#endif
@@ -0,0 +1,31 @@
+//
+// RT64
+//
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+namespace RT64 {
+	class Texture;
+
+	// Keeps track of textures whose uploads were recorded without waiting for the GPU.
+	// The queue only deals with fence values so it doesn't depend on any D3D12 objects.
+	class TextureQueue {
+	private:
+		struct Entry {
+			Texture *texture;
+			uint64_t fenceValue;
+		};
+
+		std::vector<Entry> entries;
+	public:
+		void push(Texture *texture, uint64_t fenceValue);
+		bool remove(Texture *texture);
+		void retire(uint64_t completedFenceValue, std::vector<Texture *> &retiredTextures);
+		bool contains(const Texture *texture) const;
+		size_t size() const;
+	};
+};
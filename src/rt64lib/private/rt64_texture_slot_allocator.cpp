@@ -0,0 +1,62 @@
+//
+// RT64
+//
+
+#include "rt64_texture_slot_allocator.h"
+
+#include <algorithm>
+#include <assert.h>
+#include <functional>
+
+// Private
+
+RT64::TextureSlotAllocator::TextureSlotAllocator() {
+	capacity = 0;
+	usedCount = 0;
+}
+
+uint32_t RT64::TextureSlotAllocator::allocate() {
+	uint32_t slot;
+	if (!freeSlots.empty()) {
+		// The free slots are kept as a min-heap.
+		std::pop_heap(freeSlots.begin(), freeSlots.end(), std::greater<uint32_t>());
+		slot = freeSlots.back();
+		freeSlots.pop_back();
+	}
+	else {
+		slot = static_cast<uint32_t>(slotsUsed.size());
+		slotsUsed.push_back(0);
+		if (slotsUsed.size() > capacity) {
+			capacity = (capacity > 0) ? (capacity * 2) : PageSize;
+		}
+	}
+
+	assert(!slotsUsed[slot]);
+	slotsUsed[slot] = 1;
+	usedCount++;
+	return slot;
+}
+
+void RT64::TextureSlotAllocator::free(uint32_t slot) {
+	assert(isUsed(slot) && "The slot was already freed.");
+	slotsUsed[slot] = 0;
+	usedCount--;
+	freeSlots.push_back(slot);
+	std::push_heap(freeSlots.begin(), freeSlots.end(), std::greater<uint32_t>());
+}
+
+bool RT64::TextureSlotAllocator::isUsed(uint32_t slot) const {
+	return (slot < slotsUsed.size()) && slotsUsed[slot];
+}
+
+uint32_t RT64::TextureSlotAllocator::getCapacity() const {
+	return capacity;
+}
+
+uint32_t RT64::TextureSlotAllocator::getSlotCount() const {
+	return static_cast<uint32_t>(slotsUsed.size());
+}
+
+uint32_t RT64::TextureSlotAllocator::getUsedCount() const {
+	return usedCount;
+}
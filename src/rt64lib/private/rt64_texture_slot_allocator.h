@@ -0,0 +1,36 @@
+//
+// RT64
+//
+
+#pragma once
+
+#include <stdint.h>
+#include <vector>
+
+namespace RT64 {
+	// Hands out the slots that textures occupy in the texture range of the descriptor heaps. The buffers of raytraced meshes
+	// take their slots out of the same range. A slot is kept for as long as its owner exists, and freed slots are handed out
+	// again lowest first so the used range stays compact.
+	// The capacity only grows when every slot is taken, doubling from a single page each time.
+	class TextureSlotAllocator {
+	public:
+		static const uint32_t PageSize = 512;
+	private:
+		std::vector<uint32_t> freeSlots;
+		std::vector<uint8_t> slotsUsed;
+		uint32_t capacity;
+		uint32_t usedCount;
+	public:
+		TextureSlotAllocator();
+		uint32_t allocate();
+		void free(uint32_t slot);
+		bool isUsed(uint32_t slot) const;
+
+		// Amount of slots the descriptor heaps must have room for. It's always a multiple of the page size.
+		uint32_t getCapacity() const;
+
+		// Highest slot that was ever handed out plus one.
+		uint32_t getSlotCount() const;
+		uint32_t getUsedCount() const;
+	};
+};
@@ -0,0 +1,110 @@
+//
+// RT64
+//
+
+#include "rt64_tlas_instance_table.h"
+
+#include <assert.h>
+#include <string.h>
+
+static_assert(sizeof(RT64::TopLevelASInstanceTable::Desc) == 64, "The descriptor must match D3D12_RAYTRACING_INSTANCE_DESC.");
+
+// Private
+
+RT64::TopLevelASInstanceTable::TopLevelASInstanceTable() {
+	count = 0;
+	uploadedCount = 0;
+	allDirty = true;
+}
+
+void RT64::TopLevelASInstanceTable::resize(size_t count) {
+	// The descriptors never shrink, so the ones past the end keep matching the buffer if the instances come back.
+	if (descs.size() < count) {
+		descs.resize(count);
+	}
+
+	this->count = count;
+}
+
+void RT64::TopLevelASInstanceTable::setInstance(size_t index, const float *transform, uint32_t instanceID, uint32_t mask, uint32_t hitGroupIndex, uint32_t flags, uint64_t accelerationStructure) {
+	assert(index < count);
+	assert(transform != nullptr);
+	assert(instanceID < (1U << 24));
+	assert(hitGroupIndex < (1U << 24));
+
+	// The descriptor stores the transposed upper 3x4 of the transform.
+	Desc desc;
+	for (int r = 0; r < 3; r++) {
+		for (int c = 0; c < 4; c++) {
+			desc.transform[r][c] = transform[c * 4 + r];
+		}
+	}
+
+	desc.instanceIDAndMask = (instanceID & 0xFFFFFF) | ((mask & 0xFF) << 24);
+	desc.hitGroupIndexAndFlags = (hitGroupIndex & 0xFFFFFF) | ((flags & 0xFF) << 24);
+	desc.accelerationStructure = accelerationStructure;
+
+	// Descriptors that were never uploaded are always written, as the buffer could have anything in there.
+	Desc &stored = descs[index];
+	if ((index >= uploadedCount) || (memcmp(&stored, &desc, sizeof(Desc)) != 0)) {
+		stored = desc;
+		if (!allDirty) {
+			dirtyIndices.push_back(static_cast<uint32_t>(index));
+		}
+	}
+}
+
+size_t RT64::TopLevelASInstanceTable::upload(void *dst) {
+	assert(dst != nullptr);
+
+	Desc *dstDescs = reinterpret_cast<Desc *>(dst);
+	size_t bytesWritten = 0;
+	if (allDirty) {
+		bytesWritten = count * sizeof(Desc);
+		if (bytesWritten > 0) {
+			memcpy(dstDescs, descs.data(), bytesWritten);
+		}
+		dirtyIndices.clear();
+		allDirty = false;
+		uploadedCount = count;
+		return bytesWritten;
+	}
+
+	// Runs of consecutive descriptors are copied together.
+	size_t i = 0;
+	while (i < dirtyIndices.size()) {
+		const uint32_t first = dirtyIndices[i];
+		uint32_t last = first;
+		i++;
+
+		while ((i < dirtyIndices.size()) && (dirtyIndices[i] == (last + 1))) {
+			last = dirtyIndices[i];
+			i++;
+		}
+
+		const size_t runSize = (last - first + 1) * sizeof(Desc);
+		memcpy(&dstDescs[first], &descs[first], runSize);
+		bytesWritten += runSize;
+	}
+
+	dirtyIndices.clear();
+	if (uploadedCount < count) {
+		uploadedCount = count;
+	}
+
+	return bytesWritten;
+}
+
+void RT64::TopLevelASInstanceTable::invalidate() {
+	uploadedCount = 0;
+	allDirty = true;
+	dirtyIndices.clear();
+}
+
+const RT64::TopLevelASInstanceTable::Desc *RT64::TopLevelASInstanceTable::getDescs() const {
+	return descs.data();
+}
+
+size_t RT64::TopLevelASInstanceTable::size() const {
+	return count;
+}
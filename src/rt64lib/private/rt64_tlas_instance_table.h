@@ -0,0 +1,47 @@
+//
+// RT64
+//
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+namespace RT64 {
+	// CPU copy of the instance descriptors the top level AS is built from. It mirrors what was last copied to the GPU
+	// buffer, so only the descriptors that changed since then need to be written again. Transforms are 16 row-major
+	// floats with the translation in the last row, the same layout used by XMMATRIX.
+	class TopLevelASInstanceTable {
+	public:
+		// Same layout as D3D12_RAYTRACING_INSTANCE_DESC.
+		struct Desc {
+			float transform[3][4];
+			uint32_t instanceIDAndMask;
+			uint32_t hitGroupIndexAndFlags;
+			uint64_t accelerationStructure;
+		};
+	private:
+		std::vector<Desc> descs;
+		std::vector<uint32_t> dirtyIndices;
+		size_t count;
+		size_t uploadedCount;
+		bool allDirty;
+	public:
+		TopLevelASInstanceTable();
+
+		// Every instance must be set again after resizing, but only the ones that end up different are marked dirty.
+		void resize(size_t count);
+		void setInstance(size_t index, const float *transform, uint32_t instanceID, uint32_t mask, uint32_t hitGroupIndex, uint32_t flags, uint64_t accelerationStructure);
+
+		// Copies the dirty descriptors to the buffer and returns the amount of bytes that were written.
+		size_t upload(void *dst);
+
+		// Forgets what the buffer contains, like when it's recreated, so every descriptor is written by the next upload.
+		// Can be called before or after setting the instances.
+		void invalidate();
+
+		const Desc *getDescs() const;
+		size_t size() const;
+	};
+};
@@ -0,0 +1,106 @@
+//
+// RT64
+//
+
+#include "rt64_tlas_update_policy.h"
+
+#include <algorithm>
+#include <assert.h>
+#include <math.h>
+#include <string.h>
+
+namespace {
+	const float *getTranslation(const void *transforms, size_t transformStride, size_t index) {
+		const float *transform = reinterpret_cast<const float *>(reinterpret_cast<const uint8_t *>(transforms) + transformStride * index);
+		return &transform[12];
+	}
+};
+
+// Private
+
+RT64::TopLevelASUpdatePolicy::TopLevelASUpdatePolicy() {
+	buildExtent = 0.0f;
+	refitCount = 0;
+	maxRefitCount = DefaultMaxRefitCount;
+	maxDisplacementRatio = DefaultMaxDisplacementRatio;
+	valid = false;
+}
+
+void RT64::TopLevelASUpdatePolicy::setLimits(uint32_t maxRefitCount, float maxDisplacementRatio) {
+	assert(maxDisplacementRatio >= 0.0f);
+	this->maxRefitCount = maxRefitCount;
+	this->maxDisplacementRatio = maxDisplacementRatio;
+}
+
+bool RT64::TopLevelASUpdatePolicy::exceedsDisplacement(const void *transforms, size_t transformStride, size_t count) const {
+	// Distances are compared squared. A structure built with every instance in the same spot has no size to compare
+	// against, so any movement at all is too much for it.
+	const float maxDisplacement = maxDisplacementRatio * buildExtent;
+	const float maxDisplacementSq = maxDisplacement * maxDisplacement;
+	for (size_t i = 0; i < count; i++) {
+		const float *translation = getTranslation(transforms, transformStride, i);
+		const float *buildPosition = &buildPositions[i * 3];
+		const float dx = translation[0] - buildPosition[0];
+		const float dy = translation[1] - buildPosition[1];
+		const float dz = translation[2] - buildPosition[2];
+		if ((dx * dx + dy * dy + dz * dz) > maxDisplacementSq) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void RT64::TopLevelASUpdatePolicy::storeBuild(const void *const *bottomLevelAS, const void *transforms, size_t transformStride, size_t count) {
+	this->bottomLevelAS.assign(bottomLevelAS, bottomLevelAS + count);
+	buildPositions.resize(count * 3);
+
+	// The size of the area is the diagonal of the box around the positions of the instances.
+	float boundsMin[3] = { 0.0f, 0.0f, 0.0f };
+	float boundsMax[3] = { 0.0f, 0.0f, 0.0f };
+	for (size_t i = 0; i < count; i++) {
+		const float *translation = getTranslation(transforms, transformStride, i);
+		for (int c = 0; c < 3; c++) {
+			buildPositions[i * 3 + c] = translation[c];
+			boundsMin[c] = (i == 0) ? translation[c] : std::min(boundsMin[c], translation[c]);
+			boundsMax[c] = (i == 0) ? translation[c] : std::max(boundsMax[c], translation[c]);
+		}
+	}
+
+	const float sx = boundsMax[0] - boundsMin[0];
+	const float sy = boundsMax[1] - boundsMin[1];
+	const float sz = boundsMax[2] - boundsMin[2];
+	buildExtent = sqrtf(sx * sx + sy * sy + sz * sz);
+	refitCount = 0;
+	valid = true;
+}
+
+RT64::TopLevelASUpdatePolicy::Decision RT64::TopLevelASUpdatePolicy::decide(const void *const *bottomLevelAS, const void *transforms, size_t transformStride, size_t count) {
+	assert((count == 0) || ((bottomLevelAS != nullptr) && (transforms != nullptr)));
+
+	bool refit = valid && (count == this->bottomLevelAS.size()) && (refitCount < maxRefitCount);
+	if (refit && (count > 0)) {
+		refit = (memcmp(this->bottomLevelAS.data(), bottomLevelAS, count * sizeof(const void *)) == 0);
+	}
+
+	if (refit) {
+		refit = !exceedsDisplacement(transforms, transformStride, count);
+	}
+
+	if (refit) {
+		refitCount++;
+		return Decision::Refit;
+	}
+	else {
+		storeBuild(bottomLevelAS, transforms, transformStride, count);
+		return Decision::Build;
+	}
+}
+
+void RT64::TopLevelASUpdatePolicy::invalidate() {
+	valid = false;
+}
+
+uint32_t RT64::TopLevelASUpdatePolicy::getRefitCount() const {
+	return refitCount;
+}
@@ -0,0 +1,52 @@
+//
+// RT64
+//
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+namespace RT64 {
+	// Decides whether the top level AS can be refitted from the previous one or must be built from scratch. Refitting is
+	// only possible when the instances reference the same bottom level AS in the same order as the last build. Refitted
+	// structures keep the hierarchy of the build they started from, so their quality drops as the instances move away from
+	// where they were. A build is forced after too many refits in a row, or once any instance moved further than a fraction
+	// of the size of the area the instances covered when the structure was built.
+	// Transforms are 16 row-major floats with the translation in the last row, the same layout used by XMMATRIX.
+	class TopLevelASUpdatePolicy {
+	public:
+		enum class Decision {
+			Build,
+			Refit
+		};
+
+		static const uint32_t DefaultMaxRefitCount = 60;
+		static constexpr float DefaultMaxDisplacementRatio = 0.1f;
+	private:
+		std::vector<const void *> bottomLevelAS;
+		std::vector<float> buildPositions;
+		float buildExtent;
+		uint32_t refitCount;
+		uint32_t maxRefitCount;
+		float maxDisplacementRatio;
+		bool valid;
+
+		bool exceedsDisplacement(const void *transforms, size_t transformStride, size_t count) const;
+		void storeBuild(const void *const *bottomLevelAS, const void *transforms, size_t transformStride, size_t count);
+	public:
+		TopLevelASUpdatePolicy();
+		void setLimits(uint32_t maxRefitCount, float maxDisplacementRatio);
+
+		// Reads count transforms that are transformStride bytes apart. The bottom level AS are only compared by their address.
+		// The decision is assumed to be carried out, so a build becomes the starting point of the refits that follow it.
+		Decision decide(const void *const *bottomLevelAS, const void *transforms, size_t transformStride, size_t count);
+
+		// Forces the next decision to be a build, like when the storage of the structure is recreated.
+		void invalidate();
+
+		// Refits done since the last build.
+		uint32_t getRefitCount() const;
+	};
+};
@@ -6,9 +6,11 @@
 
 #include "../public/rt64.h"
 
+#include <algorithm>
 #include <map>
 #include <set>
 
+#include "rt64_capture.h"
 #include "rt64_device.h"
 #include "rt64_dlss.h"
 #include "rt64_instance.h"
@@ -17,16 +19,149 @@
 #include "rt64_shader.h"
 #include "rt64_texture.h"
 #include "rt64_view.h"
+#include "rt64_view_update_flags.h"
 
 #include "im3d/im3d.h"
 #include "xxhash/xxhash32.h"
 
 namespace {
 	const int MaxQueries = 16 + 1;
+
+	bool isAffineTransform(const XMMATRIX &m) {
+		return (XMVectorGetW(m.r[0]) == 0.0f) && (XMVectorGetW(m.r[1]) == 0.0f) && (XMVectorGetW(m.r[2]) == 0.0f) && (XMVectorGetW(m.r[3]) == 1.0f);
+	}
+
+	// Blends two simulation snapshots of a transform. Affine transforms are decomposed so rotations stay rigid
+	// instead of shearing, and factors outside of [0, 1] extrapolate along the same path.
+	XMMATRIX interpolateTransform(const XMMATRIX &previous, const XMMATRIX &current, float factor) {
+		// Most instances don't move between snapshots.
+		if (XMVector4Equal(previous.r[0], current.r[0]) && XMVector4Equal(previous.r[1], current.r[1]) && XMVector4Equal(previous.r[2], current.r[2]) && XMVector4Equal(previous.r[3], current.r[3])) {
+			return current;
+		}
+
+		XMVECTOR previousScale, previousRotation, previousTranslation;
+		XMVECTOR currentScale, currentRotation, currentTranslation;
+		if (isAffineTransform(previous) && isAffineTransform(current) &&
+			XMMatrixDecompose(&previousScale, &previousRotation, &previousTranslation, previous) &&
+			XMMatrixDecompose(&currentScale, &currentRotation, &currentTranslation, current))
+		{
+			XMVECTOR scale = XMVectorLerp(previousScale, currentScale, factor);
+			XMVECTOR rotation = XMQuaternionSlerp(previousRotation, currentRotation, factor);
+			XMVECTOR translation = XMVectorLerp(previousTranslation, currentTranslation, factor);
+			return XMMatrixAffineTransformation(scale, XMVectorZero(), rotation, translation);
+		}
+
+		// Degenerate or projective transforms can't be decomposed, so blend their rows directly instead.
+		XMMATRIX result;
+		for (int i = 0; i < 4; i++) {
+			result.r[i] = XMVectorLerp(previous.r[i], current.r[i], factor);
+		}
+
+		return result;
+	}
+
+	// Writes the descriptors to a heap, skipping the ones that the cache of that heap already knows to be there.
+	class CachedHeapWriter : public RT64::DescriptorWriter {
+	private:
+		ID3D12Device8 *d3dDevice;
+		D3D12_CPU_DESCRIPTOR_HANDLE heapStart;
+		UINT handleIncrement;
+		RT64::DescriptorCache *descriptorCache;
+		int writeCount;
+	public:
+		CachedHeapWriter(ID3D12Device8 *d3dDevice, ID3D12DescriptorHeap *heap, UINT handleIncrement, RT64::DescriptorCache &descriptorCache) {
+			this->d3dDevice = d3dDevice;
+			this->heapStart = heap->GetCPUDescriptorHandleForHeapStart();
+			this->handleIncrement = handleIncrement;
+			this->descriptorCache = &descriptorCache;
+			writeCount = 0;
+		}
+
+		virtual void write(Type type, uint32_t slot, void *resource, const void *desc) override {
+			D3D12_CPU_DESCRIPTOR_HANDLE handle = heapStart;
+			handle.ptr += slot * handleIncrement;
+			switch (type) {
+			case Type::ShaderResource:
+				d3dDevice->CreateShaderResourceView(static_cast<ID3D12Resource *>(resource), static_cast<const D3D12_SHADER_RESOURCE_VIEW_DESC *>(desc), handle);
+				break;
+			case Type::UnorderedAccess:
+				d3dDevice->CreateUnorderedAccessView(static_cast<ID3D12Resource *>(resource), nullptr, static_cast<const D3D12_UNORDERED_ACCESS_VIEW_DESC *>(desc), handle);
+				break;
+			case Type::ConstantBuffer:
+				d3dDevice->CreateConstantBufferView(static_cast<const D3D12_CONSTANT_BUFFER_VIEW_DESC *>(desc), handle);
+				break;
+			}
+
+			writeCount++;
+		}
+
+		void writeSRV(uint32_t slot, ID3D12Resource *resource, uint64_t generation, const D3D12_SHADER_RESOURCE_VIEW_DESC &desc) {
+			descriptorCache->write(this, Type::ShaderResource, slot, resource, generation, desc);
+		}
+
+		void writeSRV(uint32_t slot, const RT64::AllocatedResource &resource, const D3D12_SHADER_RESOURCE_VIEW_DESC &desc) {
+			writeSRV(slot, resource.Get(), resource.GetGeneration(), desc);
+		}
+
+		void writeUAV(uint32_t slot, const RT64::AllocatedResource &resource, const D3D12_UNORDERED_ACCESS_VIEW_DESC &desc) {
+			descriptorCache->write(this, Type::UnorderedAccess, slot, resource.Get(), resource.GetGeneration(), desc);
+		}
+
+		// The resource is only used to tell if the buffer was recreated, as the view only stores its address.
+		void writeCBV(uint32_t slot, const RT64::AllocatedResource &resource, const D3D12_CONSTANT_BUFFER_VIEW_DESC &desc) {
+			descriptorCache->write(this, Type::ConstantBuffer, slot, resource.Get(), resource.GetGeneration(), desc);
+		}
+
+		int getWriteCount() const {
+			return writeCount;
+		}
+	};
 };
 
 // Private
 
+void RT64::View::RenderInstances::resize(size_t count) {
+	transforms.resize(count);
+	previousTransforms.resize(count);
+	materialIndices.resize(count);
+	geometry.resize(count);
+	hitGroupIndices.resize(count);
+	bottomLevelAS.resize(count);
+	flags.resize(count);
+	shaders.resize(count);
+	vertexBufferViews.resize(count);
+	indexBufferViews.resize(count);
+	indexCounts.resize(count);
+	scissorRects.resize(count);
+	viewports.resize(count);
+	instances.resize(count);
+}
+
+void RT64::View::RenderInstances::clear() {
+	transforms.clear();
+	previousTransforms.clear();
+	materialIndices.clear();
+	geometry.clear();
+	hitGroupIndices.clear();
+	bottomLevelAS.clear();
+	flags.clear();
+	shaders.clear();
+	vertexBufferViews.clear();
+	indexBufferViews.clear();
+	indexCounts.clear();
+	scissorRects.clear();
+	viewports.clear();
+	instances.clear();
+}
+
+size_t RT64::View::RenderInstances::size() const {
+	return instances.size();
+}
+
+bool RT64::View::RenderInstances::empty() const {
+	return instances.empty();
+}
+
 RT64::View::View(Scene *scene) {
 	RT64_LOG_PRINTF("Starting view creation");
 
@@ -44,6 +179,8 @@ RT64::View::View(Scene *scene) {
 	sbtStorageSize = 0;
 	activeInstancesBufferTransformsSize = 0;
 	activeInstancesBufferMaterialsSize = 0;
+	activeInstancesBufferMaterialIndicesSize = 0;
+	activeInstancesBufferGeometrySize = 0;
 	globalParamsBufferData.motionBlurStrength = 0.0f;
 	globalParamsBufferData.skyPlaneTexIndex = -1;
 	globalParamsBufferData.randomSeed = 0;
@@ -54,6 +191,11 @@ RT64::View::View(Scene *scene) {
 	globalParamsBufferData.visualizationMode = 0;
 	globalParamsBufferData.frameCount = 0;
 	globalParamsBufferSize = 0;
+	updateGeneration = Generation::None;
+	forcedUpdateFlags = UpdateAll;
+	updateInterpolation = false;
+	updateInterpolationFactor = 0.0f;
+	updatePreviousInterpolationFactor = 0.0f;
 	rtSwap = false;
 	rtWidth = 0;
 	rtHeight = 0;
@@ -72,6 +214,7 @@ RT64::View::View(Scene *scene) {
 	skyPlaneTexture = nullptr;
 	scissorApplied = false;
 	viewportApplied = false;
+	frameStats = {};
 
 	// Try to initialize upscalers. They won't be initialized if the hardware doesn't support it.
 	dlss = new DLSS(scene->getDevice());
@@ -168,77 +311,77 @@ void RT64::View::createOutputBuffers() {
 
 	// Create buffers for raster output.
 	resDesc.Flags = D3D12_RESOURCE_FLAG_ALLOW_RENDER_TARGET;
-	rasterBg = scene->getDevice()->allocateResource(D3D12_HEAP_TYPE_DEFAULT, &resDesc, D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE, &clearValue);
+	rasterBg = scene->getDevice()->allocateResource(RT64_MEMORY_CATEGORY_RENDER_TARGET, D3D12_HEAP_TYPE_DEFAULT, &resDesc, D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE, &clearValue);
 
 	// Create buffers for raytracing output.
 	resDesc.Width = rtWidth;
 	resDesc.Height = rtHeight;
 	resDesc.Format = DXGI_FORMAT_R32G32B32A32_FLOAT;
 	resDesc.Flags = D3D12_RESOURCE_FLAG_ALLOW_RENDER_TARGET;
-	rtOutput[0] = scene->getDevice()->allocateResource(D3D12_HEAP_TYPE_DEFAULT, &resDesc, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE, nullptr);
-	rtOutput[1] = scene->getDevice()->allocateResource(D3D12_HEAP_TYPE_DEFAULT, &resDesc, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE, nullptr);
+	rtOutput[0] = scene->getDevice()->allocateResource(RT64_MEMORY_CATEGORY_RENDER_TARGET, D3D12_HEAP_TYPE_DEFAULT, &resDesc, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE, nullptr);
+	rtOutput[1] = scene->getDevice()->allocateResource(RT64_MEMORY_CATEGORY_RENDER_TARGET, D3D12_HEAP_TYPE_DEFAULT, &resDesc, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE, nullptr);
 
 	resDesc.Flags = D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS;
-	rtShadingPosition = scene->getDevice()->allocateResource(D3D12_HEAP_TYPE_DEFAULT, &resDesc, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE, nullptr);
+	rtShadingPosition = scene->getDevice()->allocateResource(RT64_MEMORY_CATEGORY_RENDER_TARGET, D3D12_HEAP_TYPE_DEFAULT, &resDesc, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE, nullptr);
 
 	resDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
-	rtDiffuse = scene->getDevice()->allocateResource(D3D12_HEAP_TYPE_DEFAULT, &resDesc, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE, nullptr);
+	rtDiffuse = scene->getDevice()->allocateResource(RT64_MEMORY_CATEGORY_RENDER_TARGET, D3D12_HEAP_TYPE_DEFAULT, &resDesc, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE, nullptr);
 
 	resDesc.Format = DXGI_FORMAT_R16G16B16A16_FLOAT;
-	rtNormal[0] = scene->getDevice()->allocateResource(D3D12_HEAP_TYPE_DEFAULT, &resDesc, D3D12_RESOURCE_STATE_UNORDERED_ACCESS, nullptr);
-	rtNormal[1] = scene->getDevice()->allocateResource(D3D12_HEAP_TYPE_DEFAULT, &resDesc, D3D12_RESOURCE_STATE_UNORDERED_ACCESS, nullptr);
-	rtShadingNormal = scene->getDevice()->allocateResource(D3D12_HEAP_TYPE_DEFAULT, &resDesc, D3D12_RESOURCE_STATE_UNORDERED_ACCESS, nullptr);
+	rtNormal[0] = scene->getDevice()->allocateResource(RT64_MEMORY_CATEGORY_RENDER_TARGET, D3D12_HEAP_TYPE_DEFAULT, &resDesc, D3D12_RESOURCE_STATE_UNORDERED_ACCESS, nullptr);
+	rtNormal[1] = scene->getDevice()->allocateResource(RT64_MEMORY_CATEGORY_RENDER_TARGET, D3D12_HEAP_TYPE_DEFAULT, &resDesc, D3D12_RESOURCE_STATE_UNORDERED_ACCESS, nullptr);
+	rtShadingNormal = scene->getDevice()->allocateResource(RT64_MEMORY_CATEGORY_RENDER_TARGET, D3D12_HEAP_TYPE_DEFAULT, &resDesc, D3D12_RESOURCE_STATE_UNORDERED_ACCESS, nullptr);
 
 	resDesc.Format = DXGI_FORMAT_R16G16_FLOAT;
-	rtFlow = scene->getDevice()->allocateResource(D3D12_HEAP_TYPE_DEFAULT, &resDesc, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE, nullptr);
+	rtFlow = scene->getDevice()->allocateResource(RT64_MEMORY_CATEGORY_RENDER_TARGET, D3D12_HEAP_TYPE_DEFAULT, &resDesc, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE, nullptr);
 
 	resDesc.Format = DXGI_FORMAT_R8_UNORM;
-	rtReactiveMask = scene->getDevice()->allocateResource(D3D12_HEAP_TYPE_DEFAULT, &resDesc, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE, nullptr);
-	rtLockMask = scene->getDevice()->allocateResource(D3D12_HEAP_TYPE_DEFAULT, &resDesc, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE, nullptr);
+	rtReactiveMask = scene->getDevice()->allocateResource(RT64_MEMORY_CATEGORY_UPSCALER, D3D12_HEAP_TYPE_DEFAULT, &resDesc, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE, nullptr);
+	rtLockMask = scene->getDevice()->allocateResource(RT64_MEMORY_CATEGORY_UPSCALER, D3D12_HEAP_TYPE_DEFAULT, &resDesc, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE, nullptr);
 
 	resDesc.Format = DXGI_FORMAT_R32_FLOAT;
-	rtDepth[0] = scene->getDevice()->allocateResource(D3D12_HEAP_TYPE_DEFAULT, &resDesc, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE, nullptr);
-	rtDepth[1] = scene->getDevice()->allocateResource(D3D12_HEAP_TYPE_DEFAULT, &resDesc, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE, nullptr);
+	rtDepth[0] = scene->getDevice()->allocateResource(RT64_MEMORY_CATEGORY_RENDER_TARGET, D3D12_HEAP_TYPE_DEFAULT, &resDesc, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE, nullptr);
+	rtDepth[1] = scene->getDevice()->allocateResource(RT64_MEMORY_CATEGORY_RENDER_TARGET, D3D12_HEAP_TYPE_DEFAULT, &resDesc, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE, nullptr);
 
 	resDesc.Format = DXGI_FORMAT_R16G16B16A16_FLOAT;
-	rtViewDirection = scene->getDevice()->allocateResource(D3D12_HEAP_TYPE_DEFAULT, &resDesc, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE, nullptr);
-	rtShadingSpecular = scene->getDevice()->allocateResource(D3D12_HEAP_TYPE_DEFAULT, &resDesc, D3D12_RESOURCE_STATE_UNORDERED_ACCESS, nullptr);
-	rtDirectLightAccum[0] = scene->getDevice()->allocateResource(D3D12_HEAP_TYPE_DEFAULT, &resDesc, D3D12_RESOURCE_STATE_UNORDERED_ACCESS, nullptr);
-	rtDirectLightAccum[1] = scene->getDevice()->allocateResource(D3D12_HEAP_TYPE_DEFAULT, &resDesc, D3D12_RESOURCE_STATE_UNORDERED_ACCESS, nullptr);
-	rtIndirectLightAccum[0] = scene->getDevice()->allocateResource(D3D12_HEAP_TYPE_DEFAULT, &resDesc, D3D12_RESOURCE_STATE_UNORDERED_ACCESS, nullptr);
-	rtIndirectLightAccum[1] = scene->getDevice()->allocateResource(D3D12_HEAP_TYPE_DEFAULT, &resDesc, D3D12_RESOURCE_STATE_UNORDERED_ACCESS, nullptr);
-	rtFilteredDirectLight[0] = scene->getDevice()->allocateResource(D3D12_HEAP_TYPE_DEFAULT, &resDesc, D3D12_RESOURCE_STATE_UNORDERED_ACCESS, nullptr);
-	rtFilteredDirectLight[1] = scene->getDevice()->allocateResource(D3D12_HEAP_TYPE_DEFAULT, &resDesc, D3D12_RESOURCE_STATE_UNORDERED_ACCESS, nullptr);
-	rtFilteredIndirectLight[0] = scene->getDevice()->allocateResource(D3D12_HEAP_TYPE_DEFAULT, &resDesc, D3D12_RESOURCE_STATE_UNORDERED_ACCESS, nullptr);
-	rtFilteredIndirectLight[1] = scene->getDevice()->allocateResource(D3D12_HEAP_TYPE_DEFAULT, &resDesc, D3D12_RESOURCE_STATE_UNORDERED_ACCESS, nullptr);
-	rtReflection = scene->getDevice()->allocateResource(D3D12_HEAP_TYPE_DEFAULT, &resDesc, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE, nullptr);
-	rtRefraction = scene->getDevice()->allocateResource(D3D12_HEAP_TYPE_DEFAULT, &resDesc, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE, nullptr);
-	rtTransparent = scene->getDevice()->allocateResource(D3D12_HEAP_TYPE_DEFAULT, &resDesc, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE, nullptr);
+	rtViewDirection = scene->getDevice()->allocateResource(RT64_MEMORY_CATEGORY_RENDER_TARGET, D3D12_HEAP_TYPE_DEFAULT, &resDesc, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE, nullptr);
+	rtShadingSpecular = scene->getDevice()->allocateResource(RT64_MEMORY_CATEGORY_RENDER_TARGET, D3D12_HEAP_TYPE_DEFAULT, &resDesc, D3D12_RESOURCE_STATE_UNORDERED_ACCESS, nullptr);
+	rtDirectLightAccum[0] = scene->getDevice()->allocateResource(RT64_MEMORY_CATEGORY_RENDER_TARGET, D3D12_HEAP_TYPE_DEFAULT, &resDesc, D3D12_RESOURCE_STATE_UNORDERED_ACCESS, nullptr);
+	rtDirectLightAccum[1] = scene->getDevice()->allocateResource(RT64_MEMORY_CATEGORY_RENDER_TARGET, D3D12_HEAP_TYPE_DEFAULT, &resDesc, D3D12_RESOURCE_STATE_UNORDERED_ACCESS, nullptr);
+	rtIndirectLightAccum[0] = scene->getDevice()->allocateResource(RT64_MEMORY_CATEGORY_RENDER_TARGET, D3D12_HEAP_TYPE_DEFAULT, &resDesc, D3D12_RESOURCE_STATE_UNORDERED_ACCESS, nullptr);
+	rtIndirectLightAccum[1] = scene->getDevice()->allocateResource(RT64_MEMORY_CATEGORY_RENDER_TARGET, D3D12_HEAP_TYPE_DEFAULT, &resDesc, D3D12_RESOURCE_STATE_UNORDERED_ACCESS, nullptr);
+	rtFilteredDirectLight[0] = scene->getDevice()->allocateResource(RT64_MEMORY_CATEGORY_RENDER_TARGET, D3D12_HEAP_TYPE_DEFAULT, &resDesc, D3D12_RESOURCE_STATE_UNORDERED_ACCESS, nullptr);
+	rtFilteredDirectLight[1] = scene->getDevice()->allocateResource(RT64_MEMORY_CATEGORY_RENDER_TARGET, D3D12_HEAP_TYPE_DEFAULT, &resDesc, D3D12_RESOURCE_STATE_UNORDERED_ACCESS, nullptr);
+	rtFilteredIndirectLight[0] = scene->getDevice()->allocateResource(RT64_MEMORY_CATEGORY_RENDER_TARGET, D3D12_HEAP_TYPE_DEFAULT, &resDesc, D3D12_RESOURCE_STATE_UNORDERED_ACCESS, nullptr);
+	rtFilteredIndirectLight[1] = scene->getDevice()->allocateResource(RT64_MEMORY_CATEGORY_RENDER_TARGET, D3D12_HEAP_TYPE_DEFAULT, &resDesc, D3D12_RESOURCE_STATE_UNORDERED_ACCESS, nullptr);
+	rtReflection = scene->getDevice()->allocateResource(RT64_MEMORY_CATEGORY_RENDER_TARGET, D3D12_HEAP_TYPE_DEFAULT, &resDesc, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE, nullptr);
+	rtRefraction = scene->getDevice()->allocateResource(RT64_MEMORY_CATEGORY_RENDER_TARGET, D3D12_HEAP_TYPE_DEFAULT, &resDesc, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE, nullptr);
+	rtTransparent = scene->getDevice()->allocateResource(RT64_MEMORY_CATEGORY_RENDER_TARGET, D3D12_HEAP_TYPE_DEFAULT, &resDesc, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE, nullptr);
 
 	resDesc.Format = DXGI_FORMAT_R32_SINT; // TODO: To optimize to UINT, we need to insert an empty instance at the start and use 0 as the invalid value instead of -1.
-	rtInstanceId = scene->getDevice()->allocateResource(D3D12_HEAP_TYPE_DEFAULT, &resDesc, D3D12_RESOURCE_STATE_UNORDERED_ACCESS, nullptr);
-	rtFirstInstanceId = scene->getDevice()->allocateResource(D3D12_HEAP_TYPE_DEFAULT, &resDesc, D3D12_RESOURCE_STATE_COPY_DEST, nullptr);
+	rtInstanceId = scene->getDevice()->allocateResource(RT64_MEMORY_CATEGORY_RENDER_TARGET, D3D12_HEAP_TYPE_DEFAULT, &resDesc, D3D12_RESOURCE_STATE_UNORDERED_ACCESS, nullptr);
+	rtFirstInstanceId = scene->getDevice()->allocateResource(RT64_MEMORY_CATEGORY_RENDER_TARGET, D3D12_HEAP_TYPE_DEFAULT, &resDesc, D3D12_RESOURCE_STATE_COPY_DEST, nullptr);
 
 	// Create a buffer big enough to read the resource back.
 	UINT rowPadding;
 	CalculateTextureRowWidthPadding((UINT)(resDesc.Width * 4), rtFirstInstanceIdRowWidth, rowPadding);
-	rtFirstInstanceIdReadback = scene->getDevice()->allocateBuffer(D3D12_HEAP_TYPE_READBACK, rtFirstInstanceIdRowWidth * resDesc.Height, D3D12_RESOURCE_FLAG_NONE, D3D12_RESOURCE_STATE_COPY_DEST);
+	rtFirstInstanceIdReadback = scene->getDevice()->allocateBuffer(RT64_MEMORY_CATEGORY_UPLOAD, D3D12_HEAP_TYPE_READBACK, rtFirstInstanceIdRowWidth * resDesc.Height, D3D12_RESOURCE_FLAG_NONE, D3D12_RESOURCE_STATE_COPY_DEST);
 
 	resDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
 	if (rtUpscaleActive) {
 		resDesc.Width = screenWidth;
 		resDesc.Height = screenHeight;
-		rtOutputUpscaled = scene->getDevice()->allocateResource(D3D12_HEAP_TYPE_DEFAULT, &resDesc, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE, nullptr);
+		rtOutputUpscaled = scene->getDevice()->allocateResource(RT64_MEMORY_CATEGORY_UPSCALER, D3D12_HEAP_TYPE_DEFAULT, &resDesc, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE, nullptr);
 	}
 
 	// Create hit result buffers.
 	UINT64 hitCountBufferSizeOne = rtWidth * rtHeight;
 	UINT64 hitCountBufferSizeAll = hitCountBufferSizeOne * MaxQueries;
-	rtHitDistAndFlow = scene->getDevice()->allocateBuffer(D3D12_HEAP_TYPE_DEFAULT, hitCountBufferSizeAll * 16, D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS, D3D12_RESOURCE_STATE_UNORDERED_ACCESS);
-	rtHitColor = scene->getDevice()->allocateBuffer(D3D12_HEAP_TYPE_DEFAULT, hitCountBufferSizeAll * 4, D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS, D3D12_RESOURCE_STATE_UNORDERED_ACCESS);
-	rtHitNormal = scene->getDevice()->allocateBuffer(D3D12_HEAP_TYPE_DEFAULT, hitCountBufferSizeAll * 8, D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS, D3D12_RESOURCE_STATE_UNORDERED_ACCESS);
-	rtHitSpecular = scene->getDevice()->allocateBuffer(D3D12_HEAP_TYPE_DEFAULT, hitCountBufferSizeAll * 4, D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS, D3D12_RESOURCE_STATE_UNORDERED_ACCESS);
-	rtHitInstanceId = scene->getDevice()->allocateBuffer(D3D12_HEAP_TYPE_DEFAULT, hitCountBufferSizeAll * 2, D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS, D3D12_RESOURCE_STATE_UNORDERED_ACCESS);
+	rtHitDistAndFlow = scene->getDevice()->allocateBuffer(RT64_MEMORY_CATEGORY_HIT_BUFFER, D3D12_HEAP_TYPE_DEFAULT, hitCountBufferSizeAll * 16, D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS, D3D12_RESOURCE_STATE_UNORDERED_ACCESS);
+	rtHitColor = scene->getDevice()->allocateBuffer(RT64_MEMORY_CATEGORY_HIT_BUFFER, D3D12_HEAP_TYPE_DEFAULT, hitCountBufferSizeAll * 4, D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS, D3D12_RESOURCE_STATE_UNORDERED_ACCESS);
+	rtHitNormal = scene->getDevice()->allocateBuffer(RT64_MEMORY_CATEGORY_HIT_BUFFER, D3D12_HEAP_TYPE_DEFAULT, hitCountBufferSizeAll * 8, D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS, D3D12_RESOURCE_STATE_UNORDERED_ACCESS);
+	rtHitSpecular = scene->getDevice()->allocateBuffer(RT64_MEMORY_CATEGORY_HIT_BUFFER, D3D12_HEAP_TYPE_DEFAULT, hitCountBufferSizeAll * 4, D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS, D3D12_RESOURCE_STATE_UNORDERED_ACCESS);
+	rtHitInstanceId = scene->getDevice()->allocateBuffer(RT64_MEMORY_CATEGORY_HIT_BUFFER, D3D12_HEAP_TYPE_DEFAULT, hitCountBufferSizeAll * 2, D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS, D3D12_RESOURCE_STATE_UNORDERED_ACCESS);
 
 #ifndef NDEBUG
 	rasterBg.SetName(L"rasterBg");
@@ -335,14 +478,17 @@ void RT64::View::releaseOutputBuffers() {
 	rtOutputUpscaled.Release();
 }
 
-void RT64::View::createInstanceTransformsBuffer() {
+bool RT64::View::createInstanceTransformsBuffer() {
 	uint32_t totalInstances = static_cast<uint32_t>(rtInstances.size() + rasterBgInstances.size() + rasterFgInstances.size());
 	uint32_t newBufferSize = ROUND_UP(totalInstances * sizeof(InstanceTransforms), D3D12_CONSTANT_BUFFER_DATA_PLACEMENT_ALIGNMENT);
 	if (activeInstancesBufferTransformsSize != newBufferSize) {
 		activeInstancesBufferTransforms.Release();
-		activeInstancesBufferTransforms = scene->getDevice()->allocateBuffer(D3D12_HEAP_TYPE_UPLOAD, newBufferSize, D3D12_RESOURCE_FLAG_NONE, D3D12_RESOURCE_STATE_GENERIC_READ);
+		activeInstancesBufferTransforms = scene->getDevice()->allocateBuffer(RT64_MEMORY_CATEGORY_UPLOAD, D3D12_HEAP_TYPE_UPLOAD, newBufferSize, D3D12_RESOURCE_FLAG_NONE, D3D12_RESOURCE_STATE_GENERIC_READ);
 		activeInstancesBufferTransformsSize = newBufferSize;
+		return true;
 	}
+
+	return false;
 }
 
 void RT64::View::updateInstanceTransformsBuffer() {
@@ -351,38 +497,33 @@ void RT64::View::updateInstanceTransformsBuffer() {
 
 	D3D12_CHECK(activeInstancesBufferTransforms.Get()->Map(0, &readRange, reinterpret_cast<void **>(&current)));
 
-	for (const RenderInstance &inst : rtInstances) {
-		// Store world transform.
-		current->objectToWorld = inst.transform;
-		current->objectToWorldPrevious = inst.transformPrevious;
-
-		// Store matrix to transform normal.
-		XMMATRIX upper3x3 = current->objectToWorld;
-		upper3x3.r[0].m128_f32[3] = 0.f;
-		upper3x3.r[1].m128_f32[3] = 0.f;
-		upper3x3.r[2].m128_f32[3] = 0.f;
-		upper3x3.r[3].m128_f32[0] = 0.f;
-		upper3x3.r[3].m128_f32[1] = 0.f;
-		upper3x3.r[3].m128_f32[2] = 0.f;
-		upper3x3.r[3].m128_f32[3] = 1.f;
-
-		XMVECTOR det;
-		current->objectToWorldNormal = XMMatrixTranspose(XMMatrixInverse(&det, upper3x3));
+	// Only the normal matrices of the transforms that changed since the last update are computed again.
+	static_assert(sizeof(NormalMatrixCache::Matrix) == sizeof(XMMATRIX), "Normal matrices must match the layout of XMMATRIX.");
+	const size_t rtInstanceCount = rtInstances.size();
+	normalMatrixCache.update(rtInstances.transforms.data(), sizeof(XMMATRIX), rtInstanceCount);
 
+	// The upload heap is write-combined, so every instance is written in order and nothing is read back from it.
+	for (size_t i = 0; i < rtInstanceCount; i++) {
+		current->objectToWorld = rtInstances.transforms[i];
+		memcpy(&current->objectToWorldNormal, &normalMatrixCache.getNormalMatrix(i), sizeof(XMMATRIX));
+		current->objectToWorldPrevious = rtInstances.previousTransforms[i];
 		current++;
 	}
 
 	activeInstancesBufferTransforms.Get()->Unmap(0, nullptr);
+	frameStats.constantUploadBytes += rtInstances.size() * sizeof(InstanceTransforms);
 }
 
-void RT64::View::createInstanceMaterialsBuffer() {
-	uint32_t totalInstances = static_cast<uint32_t>(rtInstances.size() + rasterBgInstances.size() + rasterFgInstances.size());
-	uint32_t newBufferSize = ROUND_UP(totalInstances * sizeof(RT64_MATERIAL), D3D12_CONSTANT_BUFFER_DATA_PLACEMENT_ALIGNMENT);
-	if (activeInstancesBufferMaterialsSize != newBufferSize) {
+bool RT64::View::createInstanceMaterialsBuffer() {
+	uint32_t newBufferSize = ROUND_UP(static_cast<uint32_t>(materialTable.size() * sizeof(RT64_MATERIAL)), D3D12_CONSTANT_BUFFER_DATA_PLACEMENT_ALIGNMENT);
+	if (activeInstancesBufferMaterialsSize < newBufferSize) {
 		activeInstancesBufferMaterials.Release();
-		activeInstancesBufferMaterials = scene->getDevice()->allocateBuffer(D3D12_HEAP_TYPE_UPLOAD, newBufferSize, D3D12_RESOURCE_FLAG_NONE, D3D12_RESOURCE_STATE_GENERIC_READ);
+		activeInstancesBufferMaterials = scene->getDevice()->allocateBuffer(RT64_MEMORY_CATEGORY_UPLOAD, D3D12_HEAP_TYPE_UPLOAD, newBufferSize, D3D12_RESOURCE_FLAG_NONE, D3D12_RESOURCE_STATE_GENERIC_READ);
 		activeInstancesBufferMaterialsSize = newBufferSize;
+		return true;
 	}
+
+	return false;
 }
 
 void RT64::View::updateInstanceMaterialsBuffer() {
@@ -390,32 +531,73 @@ void RT64::View::updateInstanceMaterialsBuffer() {
 	CD3DX12_RANGE readRange(0, 0);
 
 	D3D12_CHECK(activeInstancesBufferMaterials.Get()->Map(0, &readRange, reinterpret_cast<void **>(&current)));
+	memcpy(current, materialTable.getMaterials(), materialTable.size() * sizeof(RT64_MATERIAL));
+	activeInstancesBufferMaterials.Get()->Unmap(0, nullptr);
+	frameStats.constantUploadBytes += materialTable.size() * sizeof(RT64_MATERIAL);
+}
 
-	for (const RenderInstance &inst : rtInstances) {
-		*current = inst.material;
-		current++;
+bool RT64::View::createInstanceMaterialIndicesBuffer() {
+	uint32_t totalInstances = static_cast<uint32_t>(rtInstances.size() + rasterBgInstances.size() + rasterFgInstances.size());
+	uint32_t newBufferSize = ROUND_UP(totalInstances * sizeof(uint32_t), D3D12_CONSTANT_BUFFER_DATA_PLACEMENT_ALIGNMENT);
+	if (activeInstancesBufferMaterialIndicesSize != newBufferSize) {
+		activeInstancesBufferMaterialIndices.Release();
+		activeInstancesBufferMaterialIndices = scene->getDevice()->allocateBuffer(RT64_MEMORY_CATEGORY_UPLOAD, D3D12_HEAP_TYPE_UPLOAD, newBufferSize, D3D12_RESOURCE_FLAG_NONE, D3D12_RESOURCE_STATE_GENERIC_READ);
+		activeInstancesBufferMaterialIndicesSize = newBufferSize;
+		return true;
 	}
 
-	for (const RenderInstance &inst : rasterBgInstances) {
-		*current = inst.material;
-		current++;
+	return false;
+}
+
+void RT64::View::updateInstanceMaterialIndicesBuffer() {
+	uint32_t *current = nullptr;
+	CD3DX12_RANGE readRange(0, 0);
+
+	D3D12_CHECK(activeInstancesBufferMaterialIndices.Get()->Map(0, &readRange, reinterpret_cast<void **>(&current)));
+
+	// The indices of each list are contiguous, so they can be copied in the same order they're indexed by the shaders.
+	for (const RenderInstances *renderInstances : { &rtInstances, &rasterBgInstances, &rasterFgInstances }) {
+		memcpy(current, renderInstances->materialIndices.data(), renderInstances->materialIndices.size() * sizeof(uint32_t));
+		current += renderInstances->materialIndices.size();
 	}
 
-	for (const RenderInstance& inst : rasterFgInstances) {
-		*current = inst.material;
-		current++;
+	activeInstancesBufferMaterialIndices.Get()->Unmap(0, nullptr);
+	frameStats.constantUploadBytes += (rtInstances.size() + rasterBgInstances.size() + rasterFgInstances.size()) * sizeof(uint32_t);
+}
+
+bool RT64::View::createInstanceGeometryBuffer() {
+	// Only the raytraced instances are hit by rays, so they're the only ones that need their geometry in the table.
+	uint32_t newBufferSize = ROUND_UP(static_cast<uint32_t>(rtInstances.size()) * sizeof(InstanceGeometry), D3D12_CONSTANT_BUFFER_DATA_PLACEMENT_ALIGNMENT);
+	if ((activeInstancesBufferGeometrySize != newBufferSize) && (newBufferSize > 0)) {
+		activeInstancesBufferGeometry.Release();
+		activeInstancesBufferGeometry = scene->getDevice()->allocateBuffer(RT64_MEMORY_CATEGORY_UPLOAD, D3D12_HEAP_TYPE_UPLOAD, newBufferSize, D3D12_RESOURCE_FLAG_NONE, D3D12_RESOURCE_STATE_GENERIC_READ);
+		activeInstancesBufferGeometrySize = newBufferSize;
+		return true;
 	}
 
-	activeInstancesBufferMaterials.Get()->Unmap(0, nullptr);
+	return false;
+}
+
+void RT64::View::updateInstanceGeometryBuffer() {
+	InstanceGeometry *current = nullptr;
+	CD3DX12_RANGE readRange(0, 0);
+
+	D3D12_CHECK(activeInstancesBufferGeometry.Get()->Map(0, &readRange, reinterpret_cast<void **>(&current)));
+	memcpy(current, rtInstances.geometry.data(), rtInstances.size() * sizeof(InstanceGeometry));
+	activeInstancesBufferGeometry.Get()->Unmap(0, nullptr);
+	frameStats.constantUploadBytes += rtInstances.size() * sizeof(InstanceGeometry);
 }
 
-void RT64::View::createTopLevelAS(const std::vector<RenderInstance>& rtInstances) {
-	// Reset the generator.
-	topLevelASGenerator.Reset();
+void RT64::View::createTopLevelAS(const RenderInstances &rtInstances) {
+	static_assert(sizeof(TopLevelASInstanceTable::Desc) == sizeof(D3D12_RAYTRACING_INSTANCE_DESC), "The instance table must use the same layout as D3D12.");
 
-	// Gather all the instances into the builder helper
-	for (size_t i = 0; i < rtInstances.size(); i++) {
-		topLevelASGenerator.AddInstance(rtInstances[i].bottomLevelAS, rtInstances[i].transform, static_cast<UINT>(i), static_cast<UINT>(2 * i), rtInstances[i].flags);
+	// Gather all the instances into the table. Only the descriptors that are different from the ones in the buffer are
+	// marked to be written again.
+	const UINT instanceCount = static_cast<UINT>(rtInstances.size());
+	topLevelASInstanceTable.resize(instanceCount);
+	for (UINT i = 0; i < instanceCount; i++) {
+		const float *transform = reinterpret_cast<const float *>(&rtInstances.transforms[i]);
+		topLevelASInstanceTable.setInstance(i, transform, i, 0xFF, 2 * rtInstances.hitGroupIndices[i], rtInstances.flags[i], rtInstances.bottomLevelAS[i]->GetGPUVirtualAddress());
 	}
 
 	// As for the bottom-level AS, the building the AS requires some scratch
@@ -425,174 +607,170 @@ void RT64::View::createTopLevelAS(const std::vector<RenderInstance>& rtInstances
 	// results, instance descriptors) so that the application can allocate the
 	// corresponding memory
 	UINT64 scratchSize, resultSize, instanceDescsSize;
-	topLevelASGenerator.ComputeASBufferSizes(scene->getDevice()->getD3D12Device(), true, &scratchSize, &resultSize, &instanceDescsSize);
+	topLevelASGenerator.ComputeASBufferSizes(scene->getDevice()->getD3D12Device(), true, instanceCount, &scratchSize, &resultSize, &instanceDescsSize);
 	
 	// Release the previous buffers and reallocate them if they're not big enough.
 	if ((topLevelASBuffers.scratchSize < scratchSize) || (topLevelASBuffers.resultSize < resultSize) || (topLevelASBuffers.instanceDescSize < instanceDescsSize)) {
 		topLevelASBuffers.Release();
 
+		// There's no previous structure to refit anymore, and the new descriptor buffer must be filled from scratch.
+		topLevelASUpdatePolicy.invalidate();
+		topLevelASInstanceTable.invalidate();
+
 		// Create the scratch and result buffers. Since the build is all done on
 		// GPU, those can be allocated on the default heap
-		topLevelASBuffers.scratch = scene->getDevice()->allocateBuffer(D3D12_HEAP_TYPE_DEFAULT, scratchSize, D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS, D3D12_RESOURCE_STATE_UNORDERED_ACCESS);
-		topLevelASBuffers.result = scene->getDevice()->allocateBuffer(D3D12_HEAP_TYPE_DEFAULT, resultSize, D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS, D3D12_RESOURCE_STATE_RAYTRACING_ACCELERATION_STRUCTURE);
+		topLevelASBuffers.scratch = scene->getDevice()->allocateBuffer(RT64_MEMORY_CATEGORY_TLAS, D3D12_HEAP_TYPE_DEFAULT, scratchSize, D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS, D3D12_RESOURCE_STATE_UNORDERED_ACCESS);
+		topLevelASBuffers.result = scene->getDevice()->allocateBuffer(RT64_MEMORY_CATEGORY_TLAS, D3D12_HEAP_TYPE_DEFAULT, resultSize, D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS, D3D12_RESOURCE_STATE_RAYTRACING_ACCELERATION_STRUCTURE);
 
 		// The buffer describing the instances: ID, shader binding information,
-		// matrices ... Those will be copied into the buffer by the helper through
-		// mapping, so the buffer has to be allocated on the upload heap.
-		topLevelASBuffers.instanceDesc = scene->getDevice()->allocateBuffer(D3D12_HEAP_TYPE_UPLOAD, instanceDescsSize, D3D12_RESOURCE_FLAG_NONE, D3D12_RESOURCE_STATE_GENERIC_READ);
+		// matrices ... Those will be copied into the buffer through mapping, so
+		// the buffer has to be allocated on the upload heap. The buffer is kept
+		// between frames and only the descriptors that changed are written.
+		topLevelASBuffers.instanceDesc = scene->getDevice()->allocateBuffer(RT64_MEMORY_CATEGORY_TLAS, D3D12_HEAP_TYPE_UPLOAD, instanceDescsSize, D3D12_RESOURCE_FLAG_NONE, D3D12_RESOURCE_STATE_GENERIC_READ);
 
 		topLevelASBuffers.scratchSize = scratchSize;
 		topLevelASBuffers.resultSize = resultSize;
 		topLevelASBuffers.instanceDescSize = instanceDescsSize;
 	}
 
-	// After all the buffers are allocated, or if only an update is required, we can build the acceleration structure. 
-	// Note that in the case of the update we also pass the existing AS as the 'previous' AS, so that it can be refitted in place.
-	topLevelASGenerator.Generate(scene->getDevice()->getD3D12CommandList(), topLevelASBuffers.scratch.Get(), topLevelASBuffers.result.Get(), topLevelASBuffers.instanceDesc.Get(), false, topLevelASBuffers.result.Get());
+	// The structure is refitted while the instances keep using the same bottom level AS, until the policy decides its
+	// quality dropped too much. In the case of the update we also pass the existing AS as the 'previous' AS, so that it
+	// can be refitted in place.
+	const void *const *bottomLevelAS = reinterpret_cast<const void *const *>(rtInstances.bottomLevelAS.data());
+	TopLevelASUpdatePolicy::Decision decision = topLevelASUpdatePolicy.decide(bottomLevelAS, rtInstances.transforms.data(), sizeof(XMMATRIX), rtInstances.size());
+	bool updateOnly = (decision == TopLevelASUpdatePolicy::Decision::Refit);
+
+	// The device waits for the GPU at the end of every frame, so the descriptors can be patched in place.
+	void *instanceDescs = nullptr;
+	CD3DX12_RANGE readRange(0, 0);
+	D3D12_CHECK(topLevelASBuffers.instanceDesc.Get()->Map(0, &readRange, &instanceDescs));
+	size_t instanceDescBytes = topLevelASInstanceTable.upload(instanceDescs);
+	topLevelASBuffers.instanceDesc.Get()->Unmap(0, nullptr);
+	frameStats.constantUploadBytes += instanceDescBytes;
+
+	topLevelASGenerator.Build(scene->getDevice()->getD3D12CommandList(), topLevelASBuffers.scratch.Get(), topLevelASBuffers.result.Get(), topLevelASBuffers.instanceDesc.Get(), instanceCount, updateOnly, topLevelASBuffers.result.Get());
+	frameStats.tlasBuildType = updateOnly ? RT64_TLAS_BUILD_UPDATE : RT64_TLAS_BUILD_FULL;
 }
 
-void RT64::View::createShaderResourceHeap() {
-	assert(usedTextures.size() <= SRV_TEXTURES_MAX);
+bool RT64::View::createShaderResourceHeap(bool writeTextures) {
+	Device *device = scene->getDevice();
+	ID3D12Device8 *d3dDevice = device->getD3D12Device();
+	const UINT handleIncrement = d3dDevice->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
 
-	const UINT handleIncrement = scene->getDevice()->getD3D12Device()->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
+	// The shader binding table stores the start of the heaps, so it must be rebuilt when they're recreated.
+	bool heapsRecreated = false;
 
 	{
-		uint32_t entryCount = ((uint32_t)(HeapIndices::MAX)-1) + SRV_TEXTURES_MAX;
-
-		// Recreate descriptor heap to be bigger if necessary.
-		bool fillWithNull = false;
+		// The bindless range grows along with the texture and mesh slots in use, so the heap is recreated bigger when it runs out of space.
+		const uint32_t bindlessSlotCapacity = device->getBindlessSlotCapacity();
+		uint32_t entryCount = ((uint32_t)(HeapIndices::MAX)-1) + bindlessSlotCapacity;
 		if (descriptorHeapEntryCount < entryCount) {
 			if (descriptorHeap != nullptr) {
 				descriptorHeap->Release();
 				descriptorHeap = nullptr;
 			}
 
-			descriptorHeap = nv_helpers_dx12::CreateDescriptorHeap(scene->getDevice()->getD3D12Device(), entryCount, D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV, true);
+			descriptorHeap = nv_helpers_dx12::CreateDescriptorHeap(d3dDevice, entryCount, D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV, true);
 			descriptorHeapEntryCount = entryCount;
-			fillWithNull = true;
+			descriptorCache.resize(entryCount);
+			writeTextures = true;
+			heapsRecreated = true;
 		}
 
-		// Get a handle to the heap memory on the CPU side, to be able to write the
-		// descriptors directly
-		D3D12_CPU_DESCRIPTOR_HANDLE handle = descriptorHeap->GetCPUDescriptorHandleForHeapStart();
+		// The descriptors are only written to the heap if they're different from the ones it already has.
+		CachedHeapWriter writer(d3dDevice, descriptorHeap, handleIncrement, descriptorCache);
+		uint32_t slot = 0;
 		D3D12_UNORDERED_ACCESS_VIEW_DESC uavDesc = {};
 		uavDesc.ViewDimension = D3D12_UAV_DIMENSION_TEXTURE2D;
 
 		// UAV for view direction buffer.
-		scene->getDevice()->getD3D12Device()->CreateUnorderedAccessView(rtViewDirection.Get(), nullptr, &uavDesc, handle);
-		handle.ptr += handleIncrement;
+		writer.writeUAV(slot++, rtViewDirection, uavDesc);
 
 		// UAV for shading position buffer.
-		scene->getDevice()->getD3D12Device()->CreateUnorderedAccessView(rtShadingPosition.Get(), nullptr, &uavDesc, handle);
-		handle.ptr += handleIncrement;
+		writer.writeUAV(slot++, rtShadingPosition, uavDesc);
 
 		// UAV for shading normal buffer.
-		scene->getDevice()->getD3D12Device()->CreateUnorderedAccessView(rtShadingNormal.Get(), nullptr, &uavDesc, handle);
-		handle.ptr += handleIncrement;
+		writer.writeUAV(slot++, rtShadingNormal, uavDesc);
 
 		// UAV for shading specular buffer.
-		scene->getDevice()->getD3D12Device()->CreateUnorderedAccessView(rtShadingSpecular.Get(), nullptr, &uavDesc, handle);
-		handle.ptr += handleIncrement;
+		writer.writeUAV(slot++, rtShadingSpecular, uavDesc);
 
 		// UAV for diffuse buffer.
-		scene->getDevice()->getD3D12Device()->CreateUnorderedAccessView(rtDiffuse.Get(), nullptr, &uavDesc, handle);
-		handle.ptr += handleIncrement;
+		writer.writeUAV(slot++, rtDiffuse, uavDesc);
 
 		// UAV for instance ID buffer.
-		scene->getDevice()->getD3D12Device()->CreateUnorderedAccessView(rtInstanceId.Get(), nullptr, &uavDesc, handle);
-		handle.ptr += handleIncrement;
+		writer.writeUAV(slot++, rtInstanceId, uavDesc);
 
 		// UAV for direct light buffer.
-		scene->getDevice()->getD3D12Device()->CreateUnorderedAccessView(rtDirectLightAccum[rtSwap ? 1 : 0].Get(), nullptr, &uavDesc, handle);
-		handle.ptr += handleIncrement;
+		writer.writeUAV(slot++, rtDirectLightAccum[rtSwap ? 1 : 0], uavDesc);
 
 		// UAV for indirect light buffer.
-		scene->getDevice()->getD3D12Device()->CreateUnorderedAccessView(rtIndirectLightAccum[rtSwap ? 1 : 0].Get(), nullptr, &uavDesc, handle);
-		handle.ptr += handleIncrement;
+		writer.writeUAV(slot++, rtIndirectLightAccum[rtSwap ? 1 : 0], uavDesc);
 
 		// UAV for reflection buffer.
-		scene->getDevice()->getD3D12Device()->CreateUnorderedAccessView(rtReflection.Get(), nullptr, &uavDesc, handle);
-		handle.ptr += handleIncrement;
+		writer.writeUAV(slot++, rtReflection, uavDesc);
 
 		// UAV for refraction buffer.
-		scene->getDevice()->getD3D12Device()->CreateUnorderedAccessView(rtRefraction.Get(), nullptr, &uavDesc, handle);
-		handle.ptr += handleIncrement;
+		writer.writeUAV(slot++, rtRefraction, uavDesc);
 
 		// UAV for transparent buffer.
-		scene->getDevice()->getD3D12Device()->CreateUnorderedAccessView(rtTransparent.Get(), nullptr, &uavDesc, handle);
-		handle.ptr += handleIncrement;
+		writer.writeUAV(slot++, rtTransparent, uavDesc);
 		
 		// UAV for flow buffer.
-		scene->getDevice()->getD3D12Device()->CreateUnorderedAccessView(rtFlow.Get(), nullptr, &uavDesc, handle);
-		handle.ptr += handleIncrement;
+		writer.writeUAV(slot++, rtFlow, uavDesc);
 
 		// UAV for reactive mask buffer.
-		scene->getDevice()->getD3D12Device()->CreateUnorderedAccessView(rtReactiveMask.Get(), nullptr, &uavDesc, handle);
-		handle.ptr += handleIncrement;
+		writer.writeUAV(slot++, rtReactiveMask, uavDesc);
 
 		// UAV for lock mask buffer.
-		scene->getDevice()->getD3D12Device()->CreateUnorderedAccessView(rtLockMask.Get(), nullptr, &uavDesc, handle);
-		handle.ptr += handleIncrement;
+		writer.writeUAV(slot++, rtLockMask, uavDesc);
 
 		// UAV for first hit normal buffer.
-		scene->getDevice()->getD3D12Device()->CreateUnorderedAccessView(rtNormal[rtSwap ? 1 : 0].Get(), nullptr, &uavDesc, handle);
-		handle.ptr += handleIncrement;
+		writer.writeUAV(slot++, rtNormal[rtSwap ? 1 : 0], uavDesc);
 
 		// UAV for depth buffer.
-		scene->getDevice()->getD3D12Device()->CreateUnorderedAccessView(rtDepth[rtSwap ? 1 : 0].Get(), nullptr, &uavDesc, handle);
-		handle.ptr += handleIncrement;
+		writer.writeUAV(slot++, rtDepth[rtSwap ? 1 : 0], uavDesc);
 
 		// UAV for previous first hit normal buffer.
-		scene->getDevice()->getD3D12Device()->CreateUnorderedAccessView(rtNormal[rtSwap ? 0 : 1].Get(), nullptr, &uavDesc, handle);
-		handle.ptr += handleIncrement;
+		writer.writeUAV(slot++, rtNormal[rtSwap ? 0 : 1], uavDesc);
 
 		// UAV for previous depth buffer.
-		scene->getDevice()->getD3D12Device()->CreateUnorderedAccessView(rtDepth[rtSwap ? 0 : 1].Get(), nullptr, &uavDesc, handle);
-		handle.ptr += handleIncrement;
+		writer.writeUAV(slot++, rtDepth[rtSwap ? 0 : 1], uavDesc);
 
 		// UAV for previous direct light buffer.
-		scene->getDevice()->getD3D12Device()->CreateUnorderedAccessView(rtDirectLightAccum[rtSwap ? 0 : 1].Get(), nullptr, &uavDesc, handle);
-		handle.ptr += handleIncrement;
+		writer.writeUAV(slot++, rtDirectLightAccum[rtSwap ? 0 : 1], uavDesc);
 
 		// UAV for previous indirect light buffer.
-		scene->getDevice()->getD3D12Device()->CreateUnorderedAccessView(rtIndirectLightAccum[rtSwap ? 0 : 1].Get(), nullptr, &uavDesc, handle);
-		handle.ptr += handleIncrement;
+		writer.writeUAV(slot++, rtIndirectLightAccum[rtSwap ? 0 : 1], uavDesc);
 
 		// UAV for filtered direct light buffer.
-		scene->getDevice()->getD3D12Device()->CreateUnorderedAccessView(rtFilteredDirectLight[1].Get(), nullptr, &uavDesc, handle);
-		handle.ptr += handleIncrement;
+		writer.writeUAV(slot++, rtFilteredDirectLight[1], uavDesc);
 
 		// UAV for filtered indirect light buffer.
-		scene->getDevice()->getD3D12Device()->CreateUnorderedAccessView(rtFilteredIndirectLight[1].Get(), nullptr, &uavDesc, handle);
-		handle.ptr += handleIncrement;
+		writer.writeUAV(slot++, rtFilteredIndirectLight[1], uavDesc);
 
 		// UAV for hit distance and world flow buffer.
 		uavDesc.ViewDimension = D3D12_UAV_DIMENSION_BUFFER;
 		uavDesc.Buffer.FirstElement = 0;
 		uavDesc.Buffer.NumElements = rtWidth * rtHeight * MaxQueries;
 		uavDesc.Format = DXGI_FORMAT_R32G32B32A32_FLOAT;
-		scene->getDevice()->getD3D12Device()->CreateUnorderedAccessView(rtHitDistAndFlow.Get(), nullptr, &uavDesc, handle);
-		handle.ptr += handleIncrement;
+		writer.writeUAV(slot++, rtHitDistAndFlow, uavDesc);
 
 		// UAV for hit color buffer.
 		uavDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
-		scene->getDevice()->getD3D12Device()->CreateUnorderedAccessView(rtHitColor.Get(), nullptr, &uavDesc, handle);
-		handle.ptr += handleIncrement;
+		writer.writeUAV(slot++, rtHitColor, uavDesc);
 
 		// UAV for hit normal buffer.
 		uavDesc.Format = DXGI_FORMAT_R16G16B16A16_SNORM;
-		scene->getDevice()->getD3D12Device()->CreateUnorderedAccessView(rtHitNormal.Get(), nullptr, &uavDesc, handle);
-		handle.ptr += handleIncrement;
+		writer.writeUAV(slot++, rtHitNormal, uavDesc);
 
 		// UAV for hit specular buffer.
 		uavDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
-		scene->getDevice()->getD3D12Device()->CreateUnorderedAccessView(rtHitSpecular.Get(), nullptr, &uavDesc, handle);
-		handle.ptr += handleIncrement;
+		writer.writeUAV(slot++, rtHitSpecular, uavDesc);
 
 		// UAV for hit shading buffer.
 		uavDesc.Format = DXGI_FORMAT_R16_UINT;
-		scene->getDevice()->getD3D12Device()->CreateUnorderedAccessView(rtHitInstanceId.Get(), nullptr, &uavDesc, handle);
-		handle.ptr += handleIncrement;
+		writer.writeUAV(slot++, rtHitInstanceId, uavDesc);
 
 		// SRV for background texture.
 		D3D12_SHADER_RESOURCE_VIEW_DESC textureSRVDesc = {};
@@ -601,29 +779,28 @@ void RT64::View::createShaderResourceHeap() {
 		textureSRVDesc.Texture2D.MostDetailedMip = 0;
 		textureSRVDesc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
 		textureSRVDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
-		scene->getDevice()->getD3D12Device()->CreateShaderResourceView(rasterBg.Get(), &textureSRVDesc, handle);
-		handle.ptr += handleIncrement;
+		writer.writeSRV(slot++, rasterBg, textureSRVDesc);
 
 		// Describe and create a constant buffer view for the global parameters.
 		D3D12_CONSTANT_BUFFER_VIEW_DESC cbvDesc = {};
 		cbvDesc.BufferLocation = globalParamBufferResource.Get()->GetGPUVirtualAddress();
 		cbvDesc.SizeInBytes = globalParamsBufferSize;
-		scene->getDevice()->getD3D12Device()->CreateConstantBufferView(&cbvDesc, handle);
-		handle.ptr += handleIncrement;
+		writer.writeCBV(slot++, globalParamBufferResource, cbvDesc);
 
 		// Add the Top Level AS SRV.
-		D3D12_SHADER_RESOURCE_VIEW_DESC srvDesc;
+		D3D12_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
 		if (!topLevelASBuffers.result.IsNull()) {
 			srvDesc.Format = DXGI_FORMAT_UNKNOWN;
 			srvDesc.ViewDimension = D3D12_SRV_DIMENSION_RAYTRACING_ACCELERATION_STRUCTURE;
 			srvDesc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
 			srvDesc.RaytracingAccelerationStructure.Location = topLevelASBuffers.result.Get()->GetGPUVirtualAddress();
-			scene->getDevice()->getD3D12Device()->CreateShaderResourceView(nullptr, &srvDesc, handle);
+			writer.writeSRV(slot, nullptr, topLevelASBuffers.result.GetGeneration(), srvDesc);
 		}
 
-		handle.ptr += handleIncrement;
+		slot++;
 
 		// Describe and create a constant buffer view for the lights.
+		srvDesc = {};
 		if (scene->getLightsCount() > 0) {
 			srvDesc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
 			srvDesc.Format = DXGI_FORMAT_UNKNOWN;
@@ -632,10 +809,10 @@ void RT64::View::createShaderResourceHeap() {
 			srvDesc.Buffer.NumElements = scene->getLightsCount();
 			srvDesc.Buffer.StructureByteStride = sizeof(RT64_LIGHT);
 			srvDesc.Buffer.Flags = D3D12_BUFFER_SRV_FLAG_NONE;
-			scene->getDevice()->getD3D12Device()->CreateShaderResourceView(scene->getLightsBuffer(), &srvDesc, handle);
+			writer.writeSRV(slot, scene->getLightsBuffer(), srvDesc);
 		}
 
-		handle.ptr += handleIncrement;
+		slot++;
 
 		// Describe the transforms buffer per instance.
 		srvDesc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
@@ -645,43 +822,75 @@ void RT64::View::createShaderResourceHeap() {
 		srvDesc.Buffer.NumElements = static_cast<UINT>(rtInstances.size() + rasterBgInstances.size() + rasterFgInstances.size());
 		srvDesc.Buffer.StructureByteStride = sizeof(InstanceTransforms);
 		srvDesc.Buffer.Flags = D3D12_BUFFER_SRV_FLAG_NONE;
-		scene->getDevice()->getD3D12Device()->CreateShaderResourceView(activeInstancesBufferTransforms.Get(), &srvDesc, handle);
-		handle.ptr += handleIncrement;
+		writer.writeSRV(slot++, activeInstancesBufferTransforms, srvDesc);
 
-		// Describe the properties buffer per instance.
+		// Describe the buffer with the unique materials used by the instances.
 		srvDesc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
 		srvDesc.Format = DXGI_FORMAT_UNKNOWN;
 		srvDesc.ViewDimension = D3D12_SRV_DIMENSION_BUFFER;
 		srvDesc.Buffer.FirstElement = 0;
-		srvDesc.Buffer.NumElements = static_cast<UINT>(rtInstances.size() + rasterBgInstances.size() + rasterFgInstances.size());
+		srvDesc.Buffer.NumElements = static_cast<UINT>(materialTable.size());
 		srvDesc.Buffer.StructureByteStride = sizeof(RT64_MATERIAL);
 		srvDesc.Buffer.Flags = D3D12_BUFFER_SRV_FLAG_NONE;
-		scene->getDevice()->getD3D12Device()->CreateShaderResourceView(activeInstancesBufferMaterials.Get(), &srvDesc, handle);
-		handle.ptr += handleIncrement;
+		writer.writeSRV(slot++, activeInstancesBufferMaterials, srvDesc);
+
+		// Describe the material index buffer per instance.
+		srvDesc.Buffer.NumElements = static_cast<UINT>(rtInstances.size() + rasterBgInstances.size() + rasterFgInstances.size());
+		srvDesc.Buffer.StructureByteStride = sizeof(uint32_t);
+		writer.writeSRV(slot++, activeInstancesBufferMaterialIndices, srvDesc);
+
+		// Describe the geometry table of the raytraced instances.
+		if (!rtInstances.empty()) {
+			srvDesc.Buffer.NumElements = static_cast<UINT>(rtInstances.size());
+			srvDesc.Buffer.StructureByteStride = sizeof(InstanceGeometry);
+			writer.writeSRV(slot, activeInstancesBufferGeometry, srvDesc);
+		}
+
+		slot++;
 
 		// Add the blue noise SRV.
-		Texture *blueNoiseTexture = scene->getDevice()->getBlueNoiseTexture();
+		Texture *blueNoiseTexture = device->getBlueNoiseTexture();
 		textureSRVDesc.Texture2D.MostDetailedMip = 0;
 		textureSRVDesc.Texture2D.MipLevels = -1;
 		textureSRVDesc.Format = blueNoiseTexture->getFormat();
-		scene->getDevice()->getD3D12Device()->CreateShaderResourceView(blueNoiseTexture->getTexture(), &textureSRVDesc, handle);
-		handle.ptr += handleIncrement;
-
-		// Add the texture SRVs.
-		for (size_t i = 0; i < usedTextures.size(); i++) {
-			textureSRVDesc.Format = usedTextures[i]->getFormat();
-			scene->getDevice()->getD3D12Device()->CreateShaderResourceView(usedTextures[i]->getTexture(), &textureSRVDesc, handle);
-			usedTextures[i]->setCurrentIndex(-1);
-			handle.ptr += handleIncrement;
-		}
-
-		// Fill with null SRVs if the heap was just created.
-		if (fillWithNull) {
-			for (size_t i = usedTextures.size(); i < SRV_TEXTURES_MAX; i++) {
-				scene->getDevice()->getD3D12Device()->CreateShaderResourceView(nullptr, &textureSRVDesc, handle);
-				handle.ptr += handleIncrement;
+		writer.writeSRV(slot++, blueNoiseTexture->getTexture(), blueNoiseTexture->getGeneration(), textureSRVDesc);
+
+		// Add the texture SRVs. A texture that changes only matters to the view if its instances use it, and that already
+		// causes them to be updated, so the slots only need to be checked then. Slots without a texture get a null SRV, so
+		// a slot is only unbound once the texture that used it is destroyed. The buffers of raytraced meshes share the same
+		// range and follow the same rules, as updating a mesh also updates the instances.
+		assert(slot == HEAP_INDEX(gTextures));
+		if (writeTextures) {
+			D3D12_SHADER_RESOURCE_VIEW_DESC nullSRVDesc = textureSRVDesc;
+			nullSRVDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+
+			D3D12_SHADER_RESOURCE_VIEW_DESC bufferSRVDesc = {};
+			bufferSRVDesc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
+			bufferSRVDesc.Format = DXGI_FORMAT_R32_TYPELESS;
+			bufferSRVDesc.ViewDimension = D3D12_SRV_DIMENSION_BUFFER;
+			bufferSRVDesc.Buffer.Flags = D3D12_BUFFER_SRV_FLAG_RAW;
+			for (uint32_t i = 0; i < bindlessSlotCapacity; i++) {
+				Texture *texture = device->getSlotTexture(i);
+				Mesh *mesh = (texture == nullptr) ? device->getSlotMesh(i) : nullptr;
+				if ((texture != nullptr) && (texture->getTexture() != nullptr)) {
+					textureSRVDesc.Format = texture->getFormat();
+					writer.writeSRV(slot + i, texture->getTexture(), texture->getGeneration(), textureSRVDesc);
+				}
+				else if ((mesh != nullptr) && (i == mesh->getVertexBufferSlot()) && (mesh->getVertexBuffer() != nullptr)) {
+					bufferSRVDesc.Buffer.NumElements = (mesh->getVertexCount() * mesh->getVertexStride()) / sizeof(uint32_t);
+					writer.writeSRV(slot + i, mesh->getVertexBufferResource(), bufferSRVDesc);
+				}
+				else if ((mesh != nullptr) && (i == mesh->getIndexBufferSlot()) && (mesh->getIndexBuffer() != nullptr)) {
+					bufferSRVDesc.Buffer.NumElements = mesh->getIndexCount();
+					writer.writeSRV(slot + i, mesh->getIndexBufferResource(), bufferSRVDesc);
+				}
+				else {
+					writer.writeSRV(slot + i, nullptr, Generation::None, nullSRVDesc);
+				}
 			}
 		}
+
+		frameStats.descriptorsWritten += writer.getWriteCount();
 	}
 
 	{
@@ -692,6 +901,7 @@ void RT64::View::createShaderResourceHeap() {
 			const UINT samplerHandleIncrement = scene->getDevice()->getD3D12Device()->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_SAMPLER);
 			uint32_t handleCount = 18;
 			samplerHeap = nv_helpers_dx12::CreateDescriptorHeap(scene->getDevice()->getD3D12Device(), handleCount, D3D12_DESCRIPTOR_HEAP_TYPE_SAMPLER, true);
+			heapsRecreated = true;
 
 			D3D12_CPU_DESCRIPTOR_HANDLE handle = samplerHeap->GetCPUDescriptorHandleForHeapStart();
 
@@ -719,6 +929,8 @@ void RT64::View::createShaderResourceHeap() {
 					}
 				}
 			}
+
+			frameStats.descriptorsWritten += handleCount;
 		}
 	}
 
@@ -726,11 +938,12 @@ void RT64::View::createShaderResourceHeap() {
 		// Create the heap for the compose shader.
 		if (composeHeap == nullptr) {
 			uint32_t handleCount = 8;
-			composeHeap = nv_helpers_dx12::CreateDescriptorHeap(scene->getDevice()->getD3D12Device(), handleCount, D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV, true);
+			composeHeap = nv_helpers_dx12::CreateDescriptorHeap(d3dDevice, handleCount, D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV, true);
+			composeDescriptorCache.resize(handleCount);
 		}
 
-		D3D12_CPU_DESCRIPTOR_HANDLE handle = composeHeap->GetCPUDescriptorHandleForHeapStart();
-
+		CachedHeapWriter writer(d3dDevice, composeHeap, handleIncrement, composeDescriptorCache);
+		uint32_t slot = 0;
 		D3D12_SHADER_RESOURCE_VIEW_DESC textureSRVDesc = {};
 		textureSRVDesc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURE2D;
 		textureSRVDesc.Texture2D.MipLevels = 1;
@@ -739,56 +952,50 @@ void RT64::View::createShaderResourceHeap() {
 
 		// SRV for motion vector texture.
 		textureSRVDesc.Format = DXGI_FORMAT_R16G16_FLOAT;
-		scene->getDevice()->getD3D12Device()->CreateShaderResourceView(rtFlow.Get(), &textureSRVDesc, handle);
-		handle.ptr += handleIncrement;
+		writer.writeSRV(slot++, rtFlow, textureSRVDesc);
 
 		// SRV for diffuse buffer.
 		textureSRVDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
-		scene->getDevice()->getD3D12Device()->CreateShaderResourceView(rtDiffuse.Get(), &textureSRVDesc, handle);
-		handle.ptr += handleIncrement;
+		writer.writeSRV(slot++, rtDiffuse, textureSRVDesc);
 
 		// SRV for direct light buffer.
 		textureSRVDesc.Format = DXGI_FORMAT_R16G16B16A16_FLOAT;
-		scene->getDevice()->getD3D12Device()->CreateShaderResourceView(rtFilteredDirectLight[1].Get(), &textureSRVDesc, handle);
-		handle.ptr += handleIncrement;
+		writer.writeSRV(slot++, rtFilteredDirectLight[1], textureSRVDesc);
 
 		// SRV for filtered indirect light buffer.
 		textureSRVDesc.Format = DXGI_FORMAT_R16G16B16A16_FLOAT;
-		scene->getDevice()->getD3D12Device()->CreateShaderResourceView(rtFilteredIndirectLight[1].Get(), &textureSRVDesc, handle);
-		handle.ptr += handleIncrement;
+		writer.writeSRV(slot++, rtFilteredIndirectLight[1], textureSRVDesc);
 
 		// SRV for reflection buffer.
 		textureSRVDesc.Format = DXGI_FORMAT_R16G16B16A16_FLOAT;
-		scene->getDevice()->getD3D12Device()->CreateShaderResourceView(rtReflection.Get(), &textureSRVDesc, handle);
-		handle.ptr += handleIncrement;
+		writer.writeSRV(slot++, rtReflection, textureSRVDesc);
 
 		// SRV for refraction buffer.
 		textureSRVDesc.Format = DXGI_FORMAT_R16G16B16A16_FLOAT;
-		scene->getDevice()->getD3D12Device()->CreateShaderResourceView(rtRefraction.Get(), &textureSRVDesc, handle);
-		handle.ptr += handleIncrement;
+		writer.writeSRV(slot++, rtRefraction, textureSRVDesc);
 
 		// SRV for transparent buffer.
 		textureSRVDesc.Format = DXGI_FORMAT_R16G16B16A16_FLOAT;
-		scene->getDevice()->getD3D12Device()->CreateShaderResourceView(rtTransparent.Get(), &textureSRVDesc, handle);
-		handle.ptr += handleIncrement;
+		writer.writeSRV(slot++, rtTransparent, textureSRVDesc);
 
 		// CBV for global parameters.
 		D3D12_CONSTANT_BUFFER_VIEW_DESC cbvDesc = {};
 		cbvDesc.BufferLocation = globalParamBufferResource.Get()->GetGPUVirtualAddress();
 		cbvDesc.SizeInBytes = globalParamsBufferSize;
-		scene->getDevice()->getD3D12Device()->CreateConstantBufferView(&cbvDesc, handle);
-		handle.ptr += handleIncrement;
+		writer.writeCBV(slot++, globalParamBufferResource, cbvDesc);
+		frameStats.descriptorsWritten += writer.getWriteCount();
 	}
 
 	{
 		// Create the heap for the post process shader.
 		if (postProcessHeap == nullptr) {
 			uint32_t handleCount = 3;
-			postProcessHeap = nv_helpers_dx12::CreateDescriptorHeap(scene->getDevice()->getD3D12Device(), handleCount, D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV, true);
+			postProcessHeap = nv_helpers_dx12::CreateDescriptorHeap(d3dDevice, handleCount, D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV, true);
+			postProcessDescriptorCache.resize(handleCount);
 		}
 
-		D3D12_CPU_DESCRIPTOR_HANDLE handle = postProcessHeap->GetCPUDescriptorHandleForHeapStart();
-
+		CachedHeapWriter writer(d3dDevice, postProcessHeap, handleIncrement, postProcessDescriptorCache);
+		uint32_t slot = 0;
 		D3D12_SHADER_RESOURCE_VIEW_DESC textureSRVDesc = {};
 		textureSRVDesc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURE2D;
 		textureSRVDesc.Texture2D.MipLevels = 1;
@@ -796,30 +1003,25 @@ void RT64::View::createShaderResourceHeap() {
 		textureSRVDesc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
 
 		// SRV for input image.
-		ID3D12Resource *inputResource = nullptr;
 		if (rtUpscaleActive) {
-			inputResource = rtOutputUpscaled.Get();
 			textureSRVDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+			writer.writeSRV(slot++, rtOutputUpscaled, textureSRVDesc);
 		}
 		else {
-			inputResource = rtOutput[rtSwap ? 1 : 0].Get();
 			textureSRVDesc.Format = DXGI_FORMAT_R32G32B32A32_FLOAT;
+			writer.writeSRV(slot++, rtOutput[rtSwap ? 1 : 0], textureSRVDesc);
 		}
 
-		scene->getDevice()->getD3D12Device()->CreateShaderResourceView(inputResource, &textureSRVDesc, handle);
-		handle.ptr += handleIncrement;
-
 		// SRV for flow buffer.
 		textureSRVDesc.Format = DXGI_FORMAT_R16G16_FLOAT;
-		scene->getDevice()->getD3D12Device()->CreateShaderResourceView(rtFlow.Get(), &textureSRVDesc, handle);
-		handle.ptr += handleIncrement;
+		writer.writeSRV(slot++, rtFlow, textureSRVDesc);
 
 		// CBV for global parameters.
 		D3D12_CONSTANT_BUFFER_VIEW_DESC cbvDesc = {};
 		cbvDesc.BufferLocation = globalParamBufferResource.Get()->GetGPUVirtualAddress();
 		cbvDesc.SizeInBytes = globalParamsBufferSize;
-		scene->getDevice()->getD3D12Device()->CreateConstantBufferView(&cbvDesc, handle);
-		handle.ptr += handleIncrement;
+		writer.writeCBV(slot++, globalParamBufferResource, cbvDesc);
+		frameStats.descriptorsWritten += writer.getWriteCount();
 	}
 
 	{
@@ -827,10 +1029,12 @@ void RT64::View::createShaderResourceHeap() {
 		for (int i = 0; i < 2; i++) {
 			if (directFilterHeaps[i] == nullptr) {
 				uint32_t handleCount = 3;
-				directFilterHeaps[i] = nv_helpers_dx12::CreateDescriptorHeap(scene->getDevice()->getD3D12Device(), handleCount, D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV, true);
+				directFilterHeaps[i] = nv_helpers_dx12::CreateDescriptorHeap(d3dDevice, handleCount, D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV, true);
+				directFilterDescriptorCaches[i].resize(handleCount);
 			}
 
-			D3D12_CPU_DESCRIPTOR_HANDLE handle = directFilterHeaps[i]->GetCPUDescriptorHandleForHeapStart();
+			CachedHeapWriter writer(d3dDevice, directFilterHeaps[i], handleIncrement, directFilterDescriptorCaches[i]);
+			uint32_t slot = 0;
 
 			// SRV for input image.
 			D3D12_SHADER_RESOURCE_VIEW_DESC textureSRVDesc = {};
@@ -839,21 +1043,19 @@ void RT64::View::createShaderResourceHeap() {
 			textureSRVDesc.Texture2D.MostDetailedMip = 0;
 			textureSRVDesc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
 			textureSRVDesc.Format = DXGI_FORMAT_R16G16B16A16_FLOAT;
-			scene->getDevice()->getD3D12Device()->CreateShaderResourceView(rtFilteredDirectLight[i ? 1 : 0].Get(), &textureSRVDesc, handle);
-			handle.ptr += handleIncrement;
+			writer.writeSRV(slot++, rtFilteredDirectLight[i ? 1 : 0], textureSRVDesc);
 
 			// UAV for output image.
 			D3D12_UNORDERED_ACCESS_VIEW_DESC uavDesc = {};
 			uavDesc.ViewDimension = D3D12_UAV_DIMENSION_TEXTURE2D;
-			scene->getDevice()->getD3D12Device()->CreateUnorderedAccessView(rtFilteredDirectLight[i ? 0 : 1].Get(), nullptr, &uavDesc, handle);
-			handle.ptr += handleIncrement;
+			writer.writeUAV(slot++, rtFilteredDirectLight[i ? 0 : 1], uavDesc);
 
 			// CBV for sharpen parameters.
 			D3D12_CONSTANT_BUFFER_VIEW_DESC cbvDesc = {};
 			cbvDesc.BufferLocation = filterParamBufferResource.Get()->GetGPUVirtualAddress();
 			cbvDesc.SizeInBytes = filterParamBufferSize;
-			scene->getDevice()->getD3D12Device()->CreateConstantBufferView(&cbvDesc, handle);
-			handle.ptr += handleIncrement;
+			writer.writeCBV(slot++, filterParamBufferResource, cbvDesc);
+			frameStats.descriptorsWritten += writer.getWriteCount();
 		}
 	}
 
@@ -862,10 +1064,12 @@ void RT64::View::createShaderResourceHeap() {
 		for (int i = 0; i < 2; i++) {
 			if (indirectFilterHeaps[i] == nullptr) {
 				uint32_t handleCount = 3;
-				indirectFilterHeaps[i] = nv_helpers_dx12::CreateDescriptorHeap(scene->getDevice()->getD3D12Device(), handleCount, D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV, true);
+				indirectFilterHeaps[i] = nv_helpers_dx12::CreateDescriptorHeap(d3dDevice, handleCount, D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV, true);
+				indirectFilterDescriptorCaches[i].resize(handleCount);
 			}
 
-			D3D12_CPU_DESCRIPTOR_HANDLE handle = indirectFilterHeaps[i]->GetCPUDescriptorHandleForHeapStart();
+			CachedHeapWriter writer(d3dDevice, indirectFilterHeaps[i], handleIncrement, indirectFilterDescriptorCaches[i]);
+			uint32_t slot = 0;
 
 			// SRV for input image.
 			D3D12_SHADER_RESOURCE_VIEW_DESC textureSRVDesc = {};
@@ -874,88 +1078,107 @@ void RT64::View::createShaderResourceHeap() {
 			textureSRVDesc.Texture2D.MostDetailedMip = 0;
 			textureSRVDesc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
 			textureSRVDesc.Format = DXGI_FORMAT_R16G16B16A16_FLOAT;
-			scene->getDevice()->getD3D12Device()->CreateShaderResourceView(rtFilteredIndirectLight[i ? 1 : 0].Get(), &textureSRVDesc, handle);
-			handle.ptr += handleIncrement;
+			writer.writeSRV(slot++, rtFilteredIndirectLight[i ? 1 : 0], textureSRVDesc);
 
 			// UAV for output image.
 			D3D12_UNORDERED_ACCESS_VIEW_DESC uavDesc = {};
 			uavDesc.ViewDimension = D3D12_UAV_DIMENSION_TEXTURE2D;
-			scene->getDevice()->getD3D12Device()->CreateUnorderedAccessView(rtFilteredIndirectLight[i ? 0 : 1].Get(), nullptr, &uavDesc, handle);
-			handle.ptr += handleIncrement;
+			writer.writeUAV(slot++, rtFilteredIndirectLight[i ? 0 : 1], uavDesc);
 
 			// CBV for sharpen parameters.
 			D3D12_CONSTANT_BUFFER_VIEW_DESC cbvDesc = {};
 			cbvDesc.BufferLocation = filterParamBufferResource.Get()->GetGPUVirtualAddress();
 			cbvDesc.SizeInBytes = filterParamBufferSize;
-			scene->getDevice()->getD3D12Device()->CreateConstantBufferView(&cbvDesc, handle);
-			handle.ptr += handleIncrement;
+			writer.writeCBV(slot++, filterParamBufferResource, cbvDesc);
+			frameStats.descriptorsWritten += writer.getWriteCount();
 		}
 	}
+
+	return heapsRecreated;
 }
 
 void RT64::View::createShaderBindingTable() {
-	// The SBT helper class collects calls to Add*Program. If called several times, the helper must be emptied before re-adding shaders.
-	sbtHelper.Reset();
+	Device *device = scene->getDevice();
 
-	// The pointer to the beginning of the heap is the only parameter required by shaders without root parameters
-	D3D12_GPU_DESCRIPTOR_HANDLE srvUavHeapHandle = descriptorHeap->GetGPUDescriptorHandleForHeapStart();
-	D3D12_GPU_DESCRIPTOR_HANDLE samplerHeapHandle = samplerHeap->GetGPUDescriptorHandleForHeapStart();
-	
-	// The helper treats both root parameter pointers and heap pointers as void*, while DX12 uses the D3D12_GPU_DESCRIPTOR_HANDLE 
-	// to define heap pointers. The pointer in this struct is a UINT64, which then has to be reinterpreted as a pointer.
-	auto srvUavPointer = reinterpret_cast<UINT64 *>(srvUavHeapHandle.ptr);
-	auto samplerPointer = reinterpret_cast<UINT64 *>(samplerHeapHandle.ptr);
+	// The pointer to the beginning of the heap is the only parameter required by shaders without root parameters.
+	const uint64_t srvUavPointer = descriptorHeap->GetGPUDescriptorHandleForHeapStart().ptr;
+	const uint64_t samplerPointer = samplerHeap->GetGPUDescriptorHandleForHeapStart().ptr;
+
+	// Every shader used by the instances has a surface and a shadow hit group. The instances pick theirs through the
+	// top level AS and find their geometry through the instance ID, so the table only changes along with the shaders.
+	// Only the records that end up different to the ones from the previous frame are marked as dirty by the table.
+	const std::vector<Shader *> &hitGroupShaders = hitGroupTable.getShaders();
+	const uint32_t hitGroupCount = static_cast<uint32_t>(hitGroupShaders.size() * 2);
+	shaderBindingTable.setLayout(5, 1, 2, 0, hitGroupCount, 2);
 
 	// The ray generation only uses heap data.
-	sbtHelper.AddRayGenerationProgram(scene->getDevice()->getPrimaryRayGenID(), { srvUavPointer });
-	sbtHelper.AddRayGenerationProgram(scene->getDevice()->getDirectRayGenID(), { srvUavPointer });
-	sbtHelper.AddRayGenerationProgram(scene->getDevice()->getIndirectRayGenID(), { srvUavPointer });
-	sbtHelper.AddRayGenerationProgram(scene->getDevice()->getReflectionRayGenID(), { srvUavPointer });
-	sbtHelper.AddRayGenerationProgram(scene->getDevice()->getRefractionRayGenID(), { srvUavPointer });
-	
+	void *rayGenIDs[] = {
+		device->getPrimaryRayGenID(),
+		device->getDirectRayGenID(),
+		device->getIndirectRayGenID(),
+		device->getReflectionRayGenID(),
+		device->getRefractionRayGenID()
+	};
+
+	for (uint32_t i = 0; i < _countof(rayGenIDs); i++) {
+		shaderBindingTable.setRecord(ShaderBindingTable::Section::RayGeneration, i, rayGenIDs[i], &srvUavPointer, 1);
+	}
+
 	// Miss shaders don't use any external data.
-	sbtHelper.AddMissProgram(scene->getDevice()->getSurfaceMissID(), {});
-	sbtHelper.AddMissProgram(scene->getDevice()->getShadowMissID(), {});
-
-	// Add the vertex buffers from all the meshes used by the instances to the hit group.
-	for (const RenderInstance &rtInstance : rtInstances) {
-		const auto &surfaceHitGroup = rtInstance.shader->getSurfaceHitGroup();
-		sbtHelper.AddHitGroup(surfaceHitGroup.id, {
-			(void *)(rtInstance.vertexBufferView->BufferLocation),
-			(void *)(rtInstance.indexBufferView->BufferLocation),
-			srvUavPointer,
-			samplerPointer
-		});
-		
-		const auto &shadowHitGroup = rtInstance.shader->getShadowHitGroup();
-		sbtHelper.AddHitGroup(shadowHitGroup.id, {
-			(void*)(rtInstance.vertexBufferView->BufferLocation),
-			(void*)(rtInstance.indexBufferView->BufferLocation),
-			srvUavPointer,
-			samplerPointer
-		});
+	shaderBindingTable.setRecord(ShaderBindingTable::Section::Miss, 0, device->getSurfaceMissID(), nullptr, 0);
+	shaderBindingTable.setRecord(ShaderBindingTable::Section::Miss, 1, device->getShadowMissID(), nullptr, 0);
+
+	// The hit groups only use heap data.
+	const uint64_t hitGroupArguments[] = { srvUavPointer, samplerPointer };
+	for (size_t i = 0; i < hitGroupShaders.size(); i++) {
+		Shader *shader = hitGroupShaders[i];
+		const uint32_t hitGroupIndex = static_cast<uint32_t>(i * 2);
+		shaderBindingTable.setRecord(ShaderBindingTable::Section::HitGroup, hitGroupIndex, shader->getSurfaceHitGroup().id, hitGroupArguments, _countof(hitGroupArguments));
+		shaderBindingTable.setRecord(ShaderBindingTable::Section::HitGroup, hitGroupIndex + 1, shader->getShadowHitGroup().id, hitGroupArguments, _countof(hitGroupArguments));
 	}
-	
-	// Compute the size of the SBT given the number of shaders and their parameters.
-	uint32_t sbtSize = sbtHelper.ComputeSBTSize();
+
+	// The storage is only reallocated when the shaders outgrow it. It at least doubles in size every time so a
+	// steadily growing scene doesn't reallocate it every frame.
+	const uint32_t sbtSize = shaderBindingTable.getSize();
+	bool uploadAll = shaderBindingTable.isAllDirty();
 	if (sbtStorageSize < sbtSize) {
-		// Release previously allocated SBT storage.
 		sbtStorage.Release();
+		sbtStorageSize = std::max<UINT64>(sbtSize, sbtStorageSize * 2);
+		sbtStorage = device->allocateBuffer(RT64_MEMORY_CATEGORY_UPLOAD, D3D12_HEAP_TYPE_UPLOAD, sbtStorageSize, D3D12_RESOURCE_FLAG_NONE, D3D12_RESOURCE_STATE_GENERIC_READ);
+		uploadAll = true;
+	}
+
+	const std::vector<ShaderBindingTable::DirtyRecord> &dirtyRecords = shaderBindingTable.getDirtyRecords();
+	if (uploadAll || !dirtyRecords.empty()) {
+		uint8_t *pData;
+		CD3DX12_RANGE readRange(0, 0);
+		D3D12_CHECK(sbtStorage.Get()->Map(0, &readRange, reinterpret_cast<void **>(&pData)));
+
+		const uint8_t *sbtData = shaderBindingTable.getData();
+		if (uploadAll) {
+			// The table's data can be bigger than its current size if there used to be more hit groups. It's copied as well
+			// so the storage keeps matching the data the table will compare against if those records are used again.
+			memcpy(pData, sbtData, shaderBindingTable.getDataSize());
+			frameStats.sbtRecordsWritten += _countof(rayGenIDs) + 2 + hitGroupCount;
+			frameStats.sbtBuildCount++;
+		}
+		else {
+			for (const ShaderBindingTable::DirtyRecord &record : dirtyRecords) {
+				memcpy(pData + record.offset, sbtData + record.offset, record.size);
+			}
 
-		// Create the SBT on the upload heap. This is required as the helper will use
-		// mapping to write the SBT contents. After the SBT compilation it could be
-		// copied to the default heap for performance.
-		sbtStorage = scene->getDevice()->allocateBuffer(D3D12_HEAP_TYPE_UPLOAD, sbtSize, D3D12_RESOURCE_FLAG_NONE, D3D12_RESOURCE_STATE_GENERIC_READ);
-		sbtStorageSize = sbtSize;
+			frameStats.sbtRecordsWritten += static_cast<int>(dirtyRecords.size());
+		}
+
+		sbtStorage.Get()->Unmap(0, nullptr);
 	}
 
-	// Compile the SBT from the shader and parameters info
-	sbtHelper.Generate(sbtStorage.Get(), scene->getDevice()->getD3D12RtStateObjectProperties());
+	shaderBindingTable.clearDirty();
 }
 
 void RT64::View::createGlobalParamsBuffer() {
 	globalParamsBufferSize = ROUND_UP(sizeof(GlobalParamsBuffer), D3D12_CONSTANT_BUFFER_DATA_PLACEMENT_ALIGNMENT);
-	globalParamBufferResource = scene->getDevice()->allocateBuffer(D3D12_HEAP_TYPE_UPLOAD, globalParamsBufferSize, D3D12_RESOURCE_FLAG_NONE, D3D12_RESOURCE_STATE_GENERIC_READ);
+	globalParamBufferResource = scene->getDevice()->allocateBuffer(RT64_MEMORY_CATEGORY_UPLOAD, D3D12_HEAP_TYPE_UPLOAD, globalParamsBufferSize, D3D12_RESOURCE_FLAG_NONE, D3D12_RESOURCE_STATE_GENERIC_READ);
 }
 
 void RT64::View::updateGlobalParamsBuffer() {
@@ -1025,6 +1248,7 @@ void RT64::View::updateGlobalParamsBuffer() {
 	D3D12_CHECK(globalParamBufferResource.Get()->Map(0, nullptr, (void **)&pData));
 	memcpy(pData, &globalParamsBufferData, sizeof(GlobalParamsBuffer));
 	globalParamBufferResource.Get()->Unmap(0, nullptr);
+	frameStats.constantUploadBytes += sizeof(GlobalParamsBuffer);
 }
 
 struct alignas(16) FilterCB {
@@ -1034,7 +1258,7 @@ struct alignas(16) FilterCB {
 
 void RT64::View::createFilterParamsBuffer() {
 	filterParamBufferSize = ROUND_UP(sizeof(FilterCB), D3D12_CONSTANT_BUFFER_DATA_PLACEMENT_ALIGNMENT);
-	filterParamBufferResource = scene->getDevice()->allocateBuffer(D3D12_HEAP_TYPE_UPLOAD, filterParamBufferSize, D3D12_RESOURCE_FLAG_NONE, D3D12_RESOURCE_STATE_GENERIC_READ);
+	filterParamBufferResource = scene->getDevice()->allocateBuffer(RT64_MEMORY_CATEGORY_UPLOAD, D3D12_HEAP_TYPE_UPLOAD, filterParamBufferSize, D3D12_RESOURCE_FLAG_NONE, D3D12_RESOURCE_STATE_GENERIC_READ);
 }
 
 void RT64::View::updateFilterParamsBuffer() {
@@ -1048,83 +1272,163 @@ void RT64::View::updateFilterParamsBuffer() {
 	D3D12_CHECK(filterParamBufferResource.Get()->Map(0, nullptr, (void **)&pData));
 	memcpy(pData, &cb, sizeof(FilterCB));
 	filterParamBufferResource.Get()->Unmap(0, nullptr);
+	frameStats.constantUploadBytes += sizeof(FilterCB);
+}
+
+unsigned int RT64::View::getUpdateFlags() const {
+	unsigned int updateFlags = forcedUpdateFlags;
+
+	// Instances were created, destroyed or reordered.
+	if (scene->getGeneration() > updateGeneration) {
+		updateFlags |= UpdateAll;
+	}
+
+	// The sky plane's texture slot is stored in the global parameters, which are filled in along with the instances.
+	if ((skyPlaneTexture != nullptr) && (skyPlaneTexture->getGeneration() > updateGeneration)) {
+		updateFlags |= UpdateInstances;
+	}
+
+	// Interpolated transforms change whenever the factors used to compute them do.
+	bool interpolation = scene->isInterpolationEnabled();
+	if ((interpolation != updateInterpolation) || (interpolation && ((scene->getInterpolationFactor() != updateInterpolationFactor) || (scene->getPreviousInterpolationFactor() != updatePreviousInterpolationFactor)))) {
+		updateFlags |= UpdateInstances | UpdateTopLevelAS | UpdateTransforms;
+	}
+
+	const auto textureChanged = [this](Texture *texture) {
+		return (texture != nullptr) && (texture->getGeneration() > updateGeneration);
+	};
+
+	for (Instance *instance : scene->getInstances()) {
+		if (updateFlags == UpdateAll) {
+			break;
+		}
+
+		if (instance->getGeneration() > updateGeneration) {
+			updateFlags |= updateFlagsFromDirtyFields(instance->getDirtyFields());
+		}
+
+		Mesh *mesh = instance->getMesh();
+		if (mesh->getGeneration() > updateGeneration) {
+			updateFlags |= updateFlagsFromMeshChange(mesh->getBottomLevelASGeneration() > updateGeneration);
+		}
+
+		Shader *shader = instance->getShader();
+		if ((shader != nullptr) && (shader->getGeneration() > updateGeneration)) {
+			updateFlags |= UpdateShaderBindingTable;
+		}
+
+		if (textureChanged(instance->getDiffuseTexture()) || textureChanged(instance->getNormalTexture()) || textureChanged(instance->getSpecularTexture())) {
+			updateFlags |= UpdateInstances | UpdateMaterials;
+		}
+	}
+
+	return updateFlags;
 }
 
 void RT64::View::update() {
 	RT64_LOG_PRINTF("Started view update");
 
+	// The counters cover everything the view does from its update until the device presents the frame.
+	frameStats = {};
+
 	// Recreate buffers if necessary for next frame.
 	if (rtRecreateBuffers) {
 		createOutputBuffers();
 		rtRecreateBuffers = false;
+
+		// Scissors and viewports depend on the size of the view.
+		forcedUpdateFlags |= UpdateAll;
 	}
 
-	auto getTextureIndex = [this](Texture *texture) {
-		if (texture == nullptr) {
-			return -1;
+	// Anything that changes while the view is updating will be picked up by the next update.
+	uint64_t currentGeneration = Generation::current();
+	unsigned int updateFlags = getUpdateFlags();
+	bool interpolation = scene->isInterpolationEnabled();
+	float interpolationFactor = scene->getInterpolationFactor();
+	float previousInterpolationFactor = scene->getPreviousInterpolationFactor();
+
+	// Textures that are still being uploaded use the placeholder instead.
+	auto resolveTexture = [](Texture *texture, Texture *placeholder) {
+		if ((texture != nullptr) && !texture->isReady()) {
+			return placeholder;
 		}
 
-		int currentIndex = texture->getCurrentIndex();
-		if (currentIndex < 0) {
-			currentIndex = (int)(usedTextures.size());
-			texture->setCurrentIndex(currentIndex);
-			usedTextures.push_back(texture);
-		}
+		return texture;
+	};
 
-		return currentIndex;
+	// Textures keep the same slot in the heap for as long as they exist.
+	auto getTextureIndex = [](Texture *texture) {
+		return (texture != nullptr) ? (int)(texture->getSlot()) : -1;
 	};
 
-	usedTextures.clear();
-	usedTextures.reserve(SRV_TEXTURES_MAX);
-	globalParamsBufferData.skyPlaneTexIndex = getTextureIndex(skyPlaneTexture);
-
-	if (!scene->getInstances().empty()) {
-		// Create the active instance vectors.
-		RenderInstance renderInstance;
-		Mesh* usedMesh = nullptr;
-		Texture *usedDiffuse = nullptr;
-		size_t totalInstances = scene->getInstances().size();
-		unsigned int instFlags = 0;
+	// The instance lists and the textures they use are kept as they are if nothing they depend on changed.
+	RenderInstances *renderInstanceLists[InstanceExtraction::ListCount] = { &rtInstances, &rasterBgInstances, &rasterFgInstances };
+	bool materialTableChanged = false;
+	if (updateFlags & UpdateInstances) {
+		globalParamsBufferData.skyPlaneTexIndex = getTextureIndex(resolveTexture(skyPlaneTexture, nullptr));
+
+		const std::vector<Instance *> &sceneInstances = scene->getInstances();
+		const size_t totalInstances = sceneInstances.size();
+		WorkerPool *workerPool = scene->getDevice()->getWorkerPool();
+
+		// Instances with an acceleration structure are raytraced, while the rest are rasterized before or after them.
+		instanceExtraction.classify(*workerPool, totalInstances, [&](size_t i) {
+			const Instance *instance = sceneInstances[i];
+			if (instance->getMesh()->getBottomLevelASResult() != nullptr) {
+				return 0;
+			}
+			else if (instance->getFlags() & RT64_INSTANCE_RASTER_BACKGROUND) {
+				return 1;
+			}
+			else {
+				return 2;
+			}
+		});
+
+		for (size_t l = 0; l < InstanceExtraction::ListCount; l++) {
+			renderInstanceLists[l]->resize(instanceExtraction.getListSize(l));
+		}
+
+		// Fill in the instances. Every chunk writes to its own range of each list.
 		unsigned int screenHeight = getHeight();
-		rtInstances.clear();
-		rasterBgInstances.clear();
-		rasterFgInstances.clear();
-
-		rtInstances.reserve(totalInstances);
-		rasterBgInstances.reserve(totalInstances);
-		rasterFgInstances.reserve(totalInstances);
-
-		for (Instance *instance : scene->getInstances()) {
-			instFlags = instance->getFlags();
-			usedMesh = instance->getMesh();
-			renderInstance.instance = instance;
-			renderInstance.bottomLevelAS = usedMesh->getBottomLevelASResult();
-			renderInstance.transform = instance->getTransform();
-			renderInstance.transformPrevious = instance->getPreviousTransform();
-			renderInstance.material = instance->getMaterial();
-			renderInstance.shader = instance->getShader();
-			renderInstance.indexCount = usedMesh->getIndexCount();
-			renderInstance.indexBufferView = usedMesh->getIndexBufferView();
-			renderInstance.vertexBufferView = usedMesh->getVertexBufferView();
-			renderInstance.flags = (instFlags & RT64_INSTANCE_DISABLE_BACKFACE_CULLING) ? D3D12_RAYTRACING_INSTANCE_FLAG_TRIANGLE_CULL_DISABLE : D3D12_RAYTRACING_INSTANCE_FLAG_NONE;
-			renderInstance.material.diffuseTexIndex = getTextureIndex(instance->getDiffuseTexture());
-			renderInstance.material.normalTexIndex = getTextureIndex(instance->getNormalTexture());
-			renderInstance.material.specularTexIndex = getTextureIndex(instance->getSpecularTexture());
+		instanceExtraction.fill(*workerPool, [&](size_t i, size_t listIndex, size_t j) {
+			Instance *instance = sceneInstances[i];
+			Mesh *usedMesh = instance->getMesh();
+			unsigned int instFlags = instance->getFlags();
+			RenderInstances &renderInstances = *renderInstanceLists[listIndex];
+			renderInstances.instances[j] = instance;
+			renderInstances.bottomLevelAS[j] = usedMesh->getBottomLevelASResult();
+			if (interpolation) {
+				// The instance's transforms are the last two simulation snapshots. The previous transform used for
+				// motion vectors is evaluated at the factor that was used to display the last frame.
+				XMMATRIX previousSnapshot = instance->getPreviousTransform();
+				XMMATRIX currentSnapshot = instance->getTransform();
+				renderInstances.transforms[j] = interpolateTransform(previousSnapshot, currentSnapshot, interpolationFactor);
+				renderInstances.previousTransforms[j] = interpolateTransform(previousSnapshot, currentSnapshot, previousInterpolationFactor);
+			}
+			else {
+				renderInstances.transforms[j] = instance->getTransform();
+				renderInstances.previousTransforms[j] = instance->getPreviousTransform();
+			}
+
+			renderInstances.shaders[j] = instance->getShader();
+			renderInstances.indexCounts[j] = usedMesh->getIndexCount();
+			renderInstances.indexBufferViews[j] = usedMesh->getIndexBufferView();
+			renderInstances.vertexBufferViews[j] = usedMesh->getVertexBufferView();
+			renderInstances.geometry[j] = { usedMesh->getVertexBufferSlot(), usedMesh->getIndexBufferSlot() };
+			renderInstances.flags[j] = (instFlags & RT64_INSTANCE_DISABLE_BACKFACE_CULLING) ? D3D12_RAYTRACING_INSTANCE_FLAG_TRIANGLE_CULL_DISABLE : D3D12_RAYTRACING_INSTANCE_FLAG_NONE;
 
 			if (instance->hasScissorRect()) {
 				RT64_RECT rect = instance->getScissorRect();
-				renderInstance.scissorRect.left = rect.x;
-				renderInstance.scissorRect.top = screenHeight - rect.y - rect.h;
-				renderInstance.scissorRect.right = rect.x + rect.w;
-				renderInstance.scissorRect.bottom = screenHeight - rect.y;
+				renderInstances.scissorRects[j] = CD3DX12_RECT(rect.x, screenHeight - rect.y - rect.h, rect.x + rect.w, screenHeight - rect.y);
 			}
 			else {
-				renderInstance.scissorRect = CD3DX12_RECT(0, 0, 0, 0);
+				renderInstances.scissorRects[j] = CD3DX12_RECT(0, 0, 0, 0);
 			}
 
 			if (instance->hasViewportRect()) {
 				RT64_RECT rect = instance->getViewportRect();
-				renderInstance.viewport = CD3DX12_VIEWPORT(
+				renderInstances.viewports[j] = CD3DX12_VIEWPORT(
 					static_cast<float>(rect.x),
 					static_cast<float>(screenHeight - rect.y - rect.h),
 					static_cast<float>(rect.w),
@@ -1132,48 +1436,124 @@ void RT64::View::update() {
 				);
 			}
 			else {
-				renderInstance.viewport = CD3DX12_VIEWPORT(0.0f, 0.0f, 0.0f, 0.0f);
+				renderInstances.viewports[j] = CD3DX12_VIEWPORT(0.0f, 0.0f, 0.0f, 0.0f);
 			}
+		});
 
-			if (renderInstance.bottomLevelAS != nullptr) {
-				rtInstances.push_back(renderInstance);
+		// Intern the materials in list order on a single thread so the table is the same regardless of how the work was split.
+		// Unless the materials changed, the lists keep the same instances in the same order, so the material indices left from
+		// the last pass are still valid, and the materials aren't read from the instances at all.
+		if (updateFlags & UpdateMaterials) {
+			Texture *placeholderTexture = scene->getDevice()->getPlaceholderTexture();
+			materialTable.begin();
+			for (RenderInstances *renderInstances : renderInstanceLists) {
+				const size_t listSize = renderInstances->size();
+				for (size_t j = 0; j < listSize; j++) {
+					const Instance *instance = renderInstances->instances[j];
+					RT64_MATERIAL material = instance->getMaterial();
+					material.diffuseTexIndex = getTextureIndex(resolveTexture(instance->getDiffuseTexture(), placeholderTexture));
+					material.normalTexIndex = getTextureIndex(resolveTexture(instance->getNormalTexture(), nullptr));
+					material.specularTexIndex = getTextureIndex(resolveTexture(instance->getSpecularTexture(), nullptr));
+					renderInstances->materialIndices[j] = materialTable.intern(material);
+				}
 			}
-			else if (instFlags & RT64_INSTANCE_RASTER_BACKGROUND) {
-				rasterBgInstances.push_back(renderInstance);
+
+			materialTableChanged = materialTable.end();
+		}
+
+		// Instances that use the same shader share its hit groups in the shader binding table. The shaders can only change
+		// along with the geometry, so the indices left from the last pass are still valid otherwise.
+		if (updateFlags & UpdateGeometry) {
+			hitGroupTable.begin();
+			const size_t rtInstanceCount = rtInstances.size();
+			for (size_t j = 0; j < rtInstanceCount; j++) {
+				rtInstances.hitGroupIndices[j] = hitGroupTable.intern(rtInstances.shaders[j]);
 			}
-			else {
-				rasterFgInstances.push_back(renderInstance);
+		}
+
+		frameStats.extractedInstanceCount = (int)(totalInstances);
+	}
+	else if (updateFlags & UpdateGeometry) {
+		// The meshes kept their bottom level AS, so the instances stay in the same lists, but the buffers might've been
+		// recreated with a different size.
+		for (RenderInstances *renderInstances : renderInstanceLists) {
+			const size_t listSize = renderInstances->size();
+			for (size_t j = 0; j < listSize; j++) {
+				const Mesh *usedMesh = renderInstances->instances[j]->getMesh();
+				renderInstances->indexCounts[j] = usedMesh->getIndexCount();
+				renderInstances->indexBufferViews[j] = usedMesh->getIndexBufferView();
+				renderInstances->vertexBufferViews[j] = usedMesh->getVertexBufferView();
+				renderInstances->geometry[j] = { usedMesh->getVertexBufferSlot(), usedMesh->getIndexBufferSlot() };
 			}
 		}
+	}
+
+	frameStats.rtInstanceCount = (int)(rtInstances.size());
+	frameStats.rasterBgInstanceCount = (int)(rasterBgInstances.size());
+	frameStats.rasterFgInstanceCount = (int)(rasterFgInstances.size());
 
+	if (!rtInstances.empty() || !rasterBgInstances.empty() || !rasterFgInstances.empty()) {
 		// Create the acceleration structures used by the raytracer.
-		if (!rtInstances.empty()) {
+		if (!rtInstances.empty() && (updateFlags & UpdateTopLevelAS)) {
 			createTopLevelAS(rtInstances);
 		}
 
 		// Create the instance buffers for the active instances (if necessary).
-		createInstanceTransformsBuffer();
-		createInstanceMaterialsBuffer();
+		if (createInstanceTransformsBuffer()) {
+			updateFlags |= UpdateTransforms;
+		}
+
+		if (createInstanceMaterialsBuffer()) {
+			materialTableChanged = true;
+		}
+
+		if (createInstanceMaterialIndicesBuffer()) {
+			updateFlags |= UpdateMaterials;
+		}
+
+		if (createInstanceGeometryBuffer()) {
+			updateFlags |= UpdateGeometry;
+		}
 		
 		// Create the buffer containing the raytracing result (always output in a
 		// UAV), and create the heap referencing the resources used by the raytracing,
 		// such as the acceleration structure
-		createShaderResourceHeap();
+		// The bindless range also holds the mesh buffers, which might've been recreated along with the geometry.
+		if (createShaderResourceHeap((updateFlags & (UpdateInstances | UpdateGeometry)) != 0)) {
+			updateFlags |= UpdateShaderBindingTable;
+		}
 		
 		// Create the shader binding table and indicating which shaders
 		// are invoked for each instance in the AS.
-		createShaderBindingTable();
+		if (updateFlags & UpdateShaderBindingTable) {
+			createShaderBindingTable();
+		}
 
 		// Update the instance buffers for the active instances.
-		updateInstanceTransformsBuffer();
-		updateInstanceMaterialsBuffer();
-	}
-	else {
-		rtInstances.clear();
-		rasterBgInstances.clear();
-		rasterFgInstances.clear();
+		if (updateFlags & UpdateTransforms) {
+			updateInstanceTransformsBuffer();
+		}
+
+		// The material table is only uploaded when its contents change. Instances only upload the index of their material.
+		if (materialTableChanged) {
+			updateInstanceMaterialsBuffer();
+		}
+
+		if (updateFlags & UpdateMaterials) {
+			updateInstanceMaterialIndicesBuffer();
+		}
+
+		if (!rtInstances.empty() && (updateFlags & UpdateGeometry)) {
+			updateInstanceGeometryBuffer();
+		}
 	}
 
+	updateGeneration = currentGeneration;
+	forcedUpdateFlags = 0;
+	updateInterpolation = interpolation;
+	updateInterpolationFactor = interpolationFactor;
+	updatePreviousInterpolationFactor = previousInterpolationFactor;
+
 	RT64_LOG_PRINTF("Finished view update");
 }
 
@@ -1189,7 +1569,7 @@ void RT64::View::render(float deltaTimeMs) {
 	auto d3dCommandList = scene->getDevice()->getD3D12CommandList();
 	auto d3d12RenderTarget = scene->getDevice()->getD3D12RenderTarget();
 	Upscaler *upscaler = getUpscaler(rtUpscaleMode);
-	std::vector<ID3D12DescriptorHeap *> heaps = { descriptorHeap, samplerHeap };
+	ID3D12DescriptorHeap *heaps[] = { descriptorHeap, samplerHeap };
 
 	// Configure the current viewport.
 	auto resetScissor = [this, d3dCommandList, &scissorRect]() {
@@ -1222,34 +1602,34 @@ void RT64::View::render(float deltaTimeMs) {
 		}
 	};
 
-	auto drawInstances = [d3dCommandList, &scissorRect, &heaps, applyScissor, applyViewport, this](const std::vector<RT64::View::RenderInstance> &rasterInstances, UINT baseInstanceIndex, bool applyScissorsAndViewports) {
+	auto drawInstances = [d3dCommandList, &scissorRect, &heaps, applyScissor, applyViewport, this](const RT64::View::RenderInstances &rasterInstances, UINT baseInstanceIndex, bool applyScissorsAndViewports) {
 		d3dCommandList->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
 		UINT rasterSz = (UINT)(rasterInstances.size());
 		Shader *previousShader = nullptr;
 		for (UINT j = 0; j < rasterSz; j++) {
-			const RenderInstance &renderInstance = rasterInstances[j];
 			if (applyScissorsAndViewports) {
-				applyScissor(renderInstance.scissorRect);
-				applyViewport(renderInstance.viewport);
+				applyScissor(rasterInstances.scissorRects[j]);
+				applyViewport(rasterInstances.viewports[j]);
 			}
 
-			if (previousShader != renderInstance.shader) {
-				const auto &rasterGroup = renderInstance.shader->getRasterGroup();
+			Shader *shader = rasterInstances.shaders[j];
+			if (previousShader != shader) {
+				const auto &rasterGroup = shader->getRasterGroup();
 				d3dCommandList->SetPipelineState(rasterGroup.pipelineState);
 				d3dCommandList->SetGraphicsRootSignature(rasterGroup.rootSignature);
-				previousShader = renderInstance.shader;
+				previousShader = shader;
 			}
 
 			if (j == 0) {
-				d3dCommandList->SetDescriptorHeaps(static_cast<UINT>(heaps.size()), heaps.data());
+				d3dCommandList->SetDescriptorHeaps(_countof(heaps), heaps);
 				d3dCommandList->SetGraphicsRootDescriptorTable(1, descriptorHeap->GetGPUDescriptorHandleForHeapStart());
 				d3dCommandList->SetGraphicsRootDescriptorTable(2, samplerHeap->GetGPUDescriptorHandleForHeapStart());
 			}
 
 			d3dCommandList->SetGraphicsRoot32BitConstant(0, baseInstanceIndex + j, 0);
-			d3dCommandList->IASetVertexBuffers(0, 1, renderInstance.vertexBufferView);
-			d3dCommandList->IASetIndexBuffer(renderInstance.indexBufferView);
-			d3dCommandList->DrawIndexedInstanced(renderInstance.indexCount, 1, 0, 0, 0);
+			d3dCommandList->IASetVertexBuffers(0, 1, rasterInstances.vertexBufferViews[j]);
+			d3dCommandList->IASetIndexBuffer(rasterInstances.indexBufferViews[j]);
+			d3dCommandList->DrawIndexedInstanced(rasterInstances.indexCounts[j], 1, 0, 0, 0);
 		}
 	};
 
@@ -1260,8 +1640,8 @@ void RT64::View::render(float deltaTimeMs) {
 	CD3DX12_RECT rtScissorRect = scissorRect;
 	CD3DX12_VIEWPORT rtViewport = viewport;
 	if (!rtInstances.empty()) {
-		rtScissorRect = rtInstances[0].scissorRect;
-		rtViewport = rtInstances[0].viewport;
+		rtScissorRect = rtInstances.scissorRects[0];
+		rtViewport = rtInstances.viewports[0];
 		if ((rtScissorRect.right <= rtScissorRect.left)) {
 			rtScissorRect = scissorRect;
 		}
@@ -1324,21 +1704,21 @@ void RT64::View::render(float deltaTimeMs) {
 
 		// Ray generation.
 		D3D12_DISPATCH_RAYS_DESC desc = {};
-		uint32_t rayGenerationSectionSizeInBytes = sbtHelper.GetRayGenSectionSize();
+		uint32_t rayGenerationSectionSizeInBytes = shaderBindingTable.getSectionSize(ShaderBindingTable::Section::RayGeneration);
 		desc.RayGenerationShaderRecord.StartAddress = sbtStorage.Get()->GetGPUVirtualAddress();
-		desc.RayGenerationShaderRecord.SizeInBytes = sbtHelper.GetRayGenEntrySize();
+		desc.RayGenerationShaderRecord.SizeInBytes = shaderBindingTable.getRecordSize(ShaderBindingTable::Section::RayGeneration);
 
 		// Miss shader table.
-		uint32_t missSectionSizeInBytes = sbtHelper.GetMissSectionSize();
+		uint32_t missSectionSizeInBytes = shaderBindingTable.getSectionSize(ShaderBindingTable::Section::Miss);
 		desc.MissShaderTable.StartAddress = sbtStorage.Get()->GetGPUVirtualAddress() + rayGenerationSectionSizeInBytes;
 		desc.MissShaderTable.SizeInBytes = missSectionSizeInBytes;
-		desc.MissShaderTable.StrideInBytes = sbtHelper.GetMissEntrySize();
+		desc.MissShaderTable.StrideInBytes = shaderBindingTable.getRecordSize(ShaderBindingTable::Section::Miss);
 
 		// Hit group table.
-		uint32_t hitGroupsSectionSize = sbtHelper.GetHitGroupSectionSize();
+		uint32_t hitGroupsSectionSize = shaderBindingTable.getSectionSize(ShaderBindingTable::Section::HitGroup);
 		desc.HitGroupTable.StartAddress = sbtStorage.Get()->GetGPUVirtualAddress() + rayGenerationSectionSizeInBytes + missSectionSizeInBytes;
 		desc.HitGroupTable.SizeInBytes = hitGroupsSectionSize;
-		desc.HitGroupTable.StrideInBytes = sbtHelper.GetHitGroupEntrySize();
+		desc.HitGroupTable.StrideInBytes = shaderBindingTable.getRecordSize(ShaderBindingTable::Section::HitGroup);
 		
 		// Dimensions.
 		desc.Width = rtWidth;
@@ -1362,7 +1742,7 @@ void RT64::View::render(float deltaTimeMs) {
 		// Bind pipeline and dispatch primary rays.
 		RT64_LOG_PRINTF("Dispatching primary rays");
 		d3dCommandList->SetPipelineState1(scene->getDevice()->getD3D12RtStateObject());
-		d3dCommandList->SetDescriptorHeaps(static_cast<UINT>(heaps.size()), heaps.data());
+		d3dCommandList->SetDescriptorHeaps(_countof(heaps), heaps);
 		d3dCommandList->DispatchRays(&desc);
 
 		// Barriers for shading buffers before dispatching secondary rays.
@@ -1384,12 +1764,12 @@ void RT64::View::render(float deltaTimeMs) {
 
 		// Dispatch rays for direct light.
 		RT64_LOG_PRINTF("Dispatching direct light rays");
-		desc.RayGenerationShaderRecord.StartAddress = sbtStorage.Get()->GetGPUVirtualAddress() + sbtHelper.GetRayGenEntrySize();
+		desc.RayGenerationShaderRecord.StartAddress = sbtStorage.Get()->GetGPUVirtualAddress() + shaderBindingTable.getRecordSize(ShaderBindingTable::Section::RayGeneration);
 		d3dCommandList->DispatchRays(&desc);
 
 		// Dispatch rays for indirect light.
 		RT64_LOG_PRINTF("Dispatching indirect light rays");
-		desc.RayGenerationShaderRecord.StartAddress = sbtStorage.Get()->GetGPUVirtualAddress() + sbtHelper.GetRayGenEntrySize() * 2;
+		desc.RayGenerationShaderRecord.StartAddress = sbtStorage.Get()->GetGPUVirtualAddress() + shaderBindingTable.getRecordSize(ShaderBindingTable::Section::RayGeneration) * 2;
 		d3dCommandList->DispatchRays(&desc);
 
 		// Wait until indirect light is done before dispatching reflection or refraction rays.
@@ -1404,7 +1784,7 @@ void RT64::View::render(float deltaTimeMs) {
 
 		// Dispatch rays for refraction.
 		RT64_LOG_PRINTF("Dispatching refraction rays");
-		desc.RayGenerationShaderRecord.StartAddress = sbtStorage.Get()->GetGPUVirtualAddress() + sbtHelper.GetRayGenEntrySize() * 4;
+		desc.RayGenerationShaderRecord.StartAddress = sbtStorage.Get()->GetGPUVirtualAddress() + shaderBindingTable.getRecordSize(ShaderBindingTable::Section::RayGeneration) * 4;
 		d3dCommandList->DispatchRays(&desc);
 
 		// Wait until refraction is done before dispatching reflection rays.
@@ -1418,7 +1798,7 @@ void RT64::View::render(float deltaTimeMs) {
 		while (reflections > 0) {
 			// Dispatch rays for reflection.
 			RT64_LOG_PRINTF("Dispatching reflection rays");
-			desc.RayGenerationShaderRecord.StartAddress = sbtStorage.Get()->GetGPUVirtualAddress() + sbtHelper.GetRayGenEntrySize() * 3;
+			desc.RayGenerationShaderRecord.StartAddress = sbtStorage.Get()->GetGPUVirtualAddress() + shaderBindingTable.getRecordSize(ShaderBindingTable::Section::RayGeneration) * 3;
 			d3dCommandList->DispatchRays(&desc);
 			reflections--;
 
@@ -1553,8 +1933,8 @@ void RT64::View::render(float deltaTimeMs) {
 
 		// Draw the raytracing output.
 		RT64_LOG_PRINTF("Composing the raytracing output");
-		std::vector<ID3D12DescriptorHeap *> composeHeaps = { composeHeap };
-		d3dCommandList->SetDescriptorHeaps(static_cast<UINT>(composeHeaps.size()), composeHeaps.data());
+		ID3D12DescriptorHeap *composeHeaps[] = { composeHeap };
+		d3dCommandList->SetDescriptorHeaps(_countof(composeHeaps), composeHeaps);
 		d3dCommandList->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
 		d3dCommandList->IASetVertexBuffers(0, 0, nullptr);
 		d3dCommandList->SetPipelineState(scene->getDevice()->getComposePipelineState());
@@ -1582,19 +1962,22 @@ void RT64::View::render(float deltaTimeMs) {
 		d3dCommandList->ResourceBarrier(_countof(beforeFiltersBarriers), beforeFiltersBarriers);
 
 		if (rtUpscaleActive && (upscaler != nullptr)) {
-			std::vector<CD3DX12_RESOURCE_BARRIER> beforeBarriers, afterBarriers;
-			beforeBarriers.push_back(CD3DX12_RESOURCE_BARRIER::Transition(rtOutputUpscaled.Get(), D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE, D3D12_RESOURCE_STATE_UNORDERED_ACCESS));
-			afterBarriers.push_back(CD3DX12_RESOURCE_BARRIER::Transition(rtOutputUpscaled.Get(), D3D12_RESOURCE_STATE_UNORDERED_ACCESS, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE));
+			// The upscaled output and up to five inputs are transitioned around the upscaler.
+			CD3DX12_RESOURCE_BARRIER beforeBarriers[6];
+			CD3DX12_RESOURCE_BARRIER afterBarriers[6];
+			UINT barrierCount = 0;
+			beforeBarriers[barrierCount] = CD3DX12_RESOURCE_BARRIER::Transition(rtOutputUpscaled.Get(), D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE, D3D12_RESOURCE_STATE_UNORDERED_ACCESS);
+			afterBarriers[barrierCount++] = CD3DX12_RESOURCE_BARRIER::Transition(rtOutputUpscaled.Get(), D3D12_RESOURCE_STATE_UNORDERED_ACCESS, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
 
 			ID3D12Resource *rtDepthCur = rtDepth[rtSwap ? 1 : 0].Get();
 			if (upscaler->requiresNonShaderResourceInputs()) {
 				for (ID3D12Resource *res : { rtOutputCur, rtFlow.Get(), rtReactiveMask.Get(), rtLockMask.Get(), rtDepthCur }) {
-					beforeBarriers.push_back(CD3DX12_RESOURCE_BARRIER::Transition(res, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE, D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE));
-					afterBarriers.push_back(CD3DX12_RESOURCE_BARRIER::Transition(res, D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE));
+					beforeBarriers[barrierCount] = CD3DX12_RESOURCE_BARRIER::Transition(res, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE, D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE);
+					afterBarriers[barrierCount++] = CD3DX12_RESOURCE_BARRIER::Transition(res, D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
 				}
 			}
 
-			d3dCommandList->ResourceBarrier(static_cast<UINT>(beforeBarriers.size()), beforeBarriers.data());
+			d3dCommandList->ResourceBarrier(barrierCount, beforeBarriers);
 
 			Upscaler::UpscaleParameters params;
 			params.inRect = { 0, 0, rtWidth, rtHeight };
@@ -1614,7 +1997,7 @@ void RT64::View::render(float deltaTimeMs) {
 			params.resetAccumulation = false; // TODO: Make this configurable via the API.
 			upscaler->upscale(params);
 
-			d3dCommandList->ResourceBarrier(static_cast<UINT>(afterBarriers.size()), afterBarriers.data());
+			d3dCommandList->ResourceBarrier(barrierCount, afterBarriers);
 		}
 
 		// Set the final render target.
@@ -1628,10 +2011,10 @@ void RT64::View::render(float deltaTimeMs) {
 		// Draw the output to the screen.
 		if (globalParamsBufferData.visualizationMode == VisualizationModeFinal) {
 			RT64_LOG_PRINTF("Drawing final output");
-			std::vector<ID3D12DescriptorHeap *> postProcessHeaps = { postProcessHeap };
+			ID3D12DescriptorHeap *postProcessHeaps[] = { postProcessHeap };
 			d3dCommandList->SetPipelineState(scene->getDevice()->getPostProcessPipelineState());
 			d3dCommandList->SetGraphicsRootSignature(scene->getDevice()->getPostProcessRootSignature());
-			d3dCommandList->SetDescriptorHeaps(static_cast<UINT>(postProcessHeaps.size()), postProcessHeaps.data());
+			d3dCommandList->SetDescriptorHeaps(_countof(postProcessHeaps), postProcessHeaps);
 			d3dCommandList->SetGraphicsRootDescriptorTable(0, postProcessHeap->GetGPUDescriptorHandleForHeapStart());
 			d3dCommandList->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
 			d3dCommandList->IASetVertexBuffers(0, 0, nullptr);
@@ -1642,7 +2025,7 @@ void RT64::View::render(float deltaTimeMs) {
 			RT64_LOG_PRINTF("Drawing debug view");
 			d3dCommandList->SetPipelineState(scene->getDevice()->getDebugPipelineState());
 			d3dCommandList->SetGraphicsRootSignature(scene->getDevice()->getDebugRootSignature());
-			d3dCommandList->SetDescriptorHeaps(static_cast<UINT>(heaps.size()), heaps.data());
+			d3dCommandList->SetDescriptorHeaps(_countof(heaps), heaps);
 			d3dCommandList->SetGraphicsRootDescriptorTable(0, descriptorHeap->GetGPUDescriptorHandleForHeapStart());
 			d3dCommandList->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
 			d3dCommandList->IASetVertexBuffers(0, 0, nullptr);
@@ -1676,8 +2059,8 @@ void RT64::View::renderInspector(Inspector *inspector) {
 		auto scissorRect = scene->getDevice()->getD3D12ScissorRect();
 		d3dCommandList->SetGraphicsRootSignature(scene->getDevice()->getIm3dRootSignature());
 
-		std::vector<ID3D12DescriptorHeap *> heaps = { descriptorHeap };
-		d3dCommandList->SetDescriptorHeaps(static_cast<UINT>(heaps.size()), heaps.data());
+		ID3D12DescriptorHeap *heaps[] = { descriptorHeap };
+		d3dCommandList->SetDescriptorHeaps(_countof(heaps), heaps);
 		d3dCommandList->SetGraphicsRootDescriptorTable(0, descriptorHeap->GetGPUDescriptorHandleForHeapStart());
 
 		d3dCommandList->RSSetViewports(1, &viewport);
@@ -1699,7 +2082,7 @@ void RT64::View::renderInspector(Inspector *inspector) {
 			const UINT vertexBufferSize = totalVertexCount * sizeof(Im3d::VertexData);
 			if (im3dVertexBuffer.IsNull()) {
 				CD3DX12_RESOURCE_DESC uploadBufferDesc = CD3DX12_RESOURCE_DESC::Buffer(vertexBufferSize);
-				im3dVertexBuffer = scene->getDevice()->allocateResource(D3D12_HEAP_TYPE_UPLOAD, &uploadBufferDesc, D3D12_RESOURCE_STATE_GENERIC_READ, nullptr);
+				im3dVertexBuffer = scene->getDevice()->allocateResource(RT64_MEMORY_CATEGORY_UPLOAD, D3D12_HEAP_TYPE_UPLOAD, &uploadBufferDesc, D3D12_RESOURCE_STATE_GENERIC_READ, nullptr);
 				im3dVertexCount = totalVertexCount;
 				im3dVertexBufferView.BufferLocation = im3dVertexBuffer.Get()->GetGPUVirtualAddress();
 				im3dVertexBufferView.StrideInBytes = sizeof(Im3d::VertexData);
@@ -1918,6 +2301,7 @@ RT64::Upscaler *RT64::View::getUpscaler(UpscaleMode v) const {
 
 void RT64::View::setSkyPlaneTexture(Texture *texture) {
 	skyPlaneTexture = texture;
+	forcedUpdateFlags |= UpdateInstances | UpdateMaterials;
 }
 
 RT64_VECTOR3 RT64::View::getRayDirectionAt(int px, int py) {
@@ -1990,7 +2374,7 @@ RT64_INSTANCE *RT64::View::getRaytracedInstanceAt(int x, int y) {
 
 	// Check the matching instance.
 	if ((instanceId >= 0) && (instanceId < rtInstances.size())) {
-		return (RT64_INSTANCE *)(rtInstances[instanceId].instance);
+		return (RT64_INSTANCE *)(rtInstances.instances[instanceId]);
 	}
 	else {
 		return nullptr;
@@ -2081,102 +2465,176 @@ bool RT64::View::getUpscalerAccelerated(UpscaleMode mode) const {
 	}
 }
 
-// Public
-
-DLLEXPORT RT64_VIEW *RT64_CreateView(RT64_SCENE *scenePtr) {
-	assert(scenePtr != nullptr);
-	RT64::Scene *scene = (RT64::Scene *)(scenePtr);
-	return (RT64_VIEW *)(new RT64::View(scene));
-}
-
-DLLEXPORT void RT64_SetViewPerspective(RT64_VIEW* viewPtr, RT64_MATRIX4 viewMatrix, float fovRadians, float nearDist, float farDist, bool canReproject) {
-	assert(viewPtr != nullptr);
-	RT64::View *view = (RT64::View *)(viewPtr);
-	view->setPerspective(viewMatrix, fovRadians, nearDist, farDist);
-	view->setPerspectiveCanReproject(canReproject);
-}
-
-DLLEXPORT void RT64_SetViewDescription(RT64_VIEW *viewPtr, RT64_VIEW_DESC viewDesc) {
-	assert(viewPtr != nullptr);
-	RT64::View *view = (RT64::View *)(viewPtr);
-	view->setResolutionScale(viewDesc.resolutionScale);
-	view->setMotionBlurStrength(viewDesc.motionBlurStrength);
-	view->setMaxLights(viewDesc.maxLights);
-	view->setDISamples(viewDesc.diSamples);
-	view->setGISamples(viewDesc.giSamples);
-	view->setDenoiserEnabled(viewDesc.denoiserEnabled);
+void RT64::View::setDescription(const RT64_VIEW_DESC &viewDesc) {
+	setResolutionScale(viewDesc.resolutionScale);
+	setMotionBlurStrength(viewDesc.motionBlurStrength);
+	setMaxLights(viewDesc.maxLights);
+	setDISamples(viewDesc.diSamples);
+	setGISamples(viewDesc.giSamples);
+	setDenoiserEnabled(viewDesc.denoiserEnabled);
 	
 	switch (viewDesc.upscaler) {
 	case RT64_UPSCALER_AUTO:
 		// Prefer using DLSS if it's supported on NVIDIA hardware.
-		if (view->getUpscalerInitialized(RT64::UpscaleMode::DLSS)) {
-			view->setUpscaleMode(RT64::UpscaleMode::DLSS);
+		if (getUpscalerInitialized(UpscaleMode::DLSS)) {
+			setUpscaleMode(UpscaleMode::DLSS);
 		}
 		// Prefer using XeSS if it's reported to be on Intel hardware. Initialization is not enough to check for
 		// this because XeSS can run on non-native platforms.
-		else if (view->getUpscalerInitialized(RT64::UpscaleMode::XeSS) && view->getUpscalerAccelerated(RT64::UpscaleMode::XeSS)) {
-			view->setUpscaleMode(RT64::UpscaleMode::XeSS);
+		else if (getUpscalerInitialized(UpscaleMode::XeSS) && getUpscalerAccelerated(UpscaleMode::XeSS)) {
+			setUpscaleMode(UpscaleMode::XeSS);
 		}
-		else if (view->getUpscalerInitialized(RT64::UpscaleMode::FSR)) {
-			view->setUpscaleMode(RT64::UpscaleMode::FSR);
+		else if (getUpscalerInitialized(UpscaleMode::FSR)) {
+			setUpscaleMode(UpscaleMode::FSR);
 		}
 		else {
-			view->setUpscaleMode(RT64::UpscaleMode::Bilinear);
+			setUpscaleMode(UpscaleMode::Bilinear);
 		}
 
 		break;
 	case RT64_UPSCALER_DLSS:
-		view->setUpscaleMode(RT64::UpscaleMode::DLSS);
+		setUpscaleMode(UpscaleMode::DLSS);
 		break;
 	case RT64_UPSCALER_FSR:
-		view->setUpscaleMode(RT64::UpscaleMode::FSR);
+		setUpscaleMode(UpscaleMode::FSR);
 		break;
 	case RT64_UPSCALER_XESS:
-		view->setUpscaleMode(RT64::UpscaleMode::XeSS);
+		setUpscaleMode(UpscaleMode::XeSS);
 		break;
 	case RT64_UPSCALER_OFF:
 	default:
-		view->setUpscaleMode(RT64::UpscaleMode::Bilinear);
+		setUpscaleMode(UpscaleMode::Bilinear);
 		break;
 	}
 
 	switch (viewDesc.upscalerMode) {
 	case RT64_UPSCALER_MODE_AUTO:
-		view->setUpscalerQualityMode(RT64::Upscaler::QualityMode::Auto);
+		setUpscalerQualityMode(Upscaler::QualityMode::Auto);
 		break;
 	case RT64_UPSCALER_MODE_ULTRA_PERFORMANCE:
-		view->setUpscalerQualityMode(RT64::Upscaler::QualityMode::UltraPerformance);
+		setUpscalerQualityMode(Upscaler::QualityMode::UltraPerformance);
 		break;
 	case RT64_UPSCALER_MODE_PERFORMANCE:
-		view->setUpscalerQualityMode(RT64::Upscaler::QualityMode::Performance);
+		setUpscalerQualityMode(Upscaler::QualityMode::Performance);
 		break;
 	case RT64_UPSCALER_MODE_BALANCED:
-		view->setUpscalerQualityMode(RT64::Upscaler::QualityMode::Balanced);
+		setUpscalerQualityMode(Upscaler::QualityMode::Balanced);
 		break;
 	case RT64_UPSCALER_MODE_QUALITY:
-		view->setUpscalerQualityMode(RT64::Upscaler::QualityMode::Quality);
+		setUpscalerQualityMode(Upscaler::QualityMode::Quality);
 		break;
 	case RT64_UPSCALER_MODE_ULTRA_QUALITY:
-		view->setUpscalerQualityMode(RT64::Upscaler::QualityMode::UltraQuality);
+		setUpscalerQualityMode(Upscaler::QualityMode::UltraQuality);
 		break;
 	case RT64_UPSCALER_MODE_NATIVE:
-		view->setUpscalerQualityMode(RT64::Upscaler::QualityMode::Native);
+		setUpscalerQualityMode(Upscaler::QualityMode::Native);
 		break;
 	}
 
-	view->setUpscalerSharpness(viewDesc.upscalerSharpness);
+	setUpscalerSharpness(viewDesc.upscalerSharpness);
+}
+
+RT64::Scene *RT64::View::getScene() const {
+	return scene;
+}
+
+const RT64_FRAME_STATS &RT64::View::getFrameStats() const {
+	return frameStats;
+}
+
+// Public
+
+DLLEXPORT RT64_VIEW *RT64_CreateView(RT64_SCENE *scenePtr) {
+	assert(scenePtr != nullptr);
+	RT64::Scene *scene = (RT64::Scene *)(scenePtr);
+	scene->getDevice()->waitForRenderThread();
+
+	RT64::View *view = new RT64::View(scene);
+
+	RT64::Capture *capture = RT64::GlobalCapture;
+	if (capture != nullptr) {
+		capture->beginCall(RT64_CAPTURE_CALL_CREATE_VIEW);
+		capture->writeObject(scenePtr);
+		capture->writeObject(view);
+		capture->endCall();
+	}
+
+	return (RT64_VIEW *)(view);
+}
+
+DLLEXPORT void RT64_SetViewPerspective(RT64_VIEW* viewPtr, RT64_MATRIX4 viewMatrix, float fovRadians, float nearDist, float farDist, bool canReproject) {
+	assert(viewPtr != nullptr);
+
+	RT64::Capture *capture = RT64::GlobalCapture;
+	if (capture != nullptr) {
+		capture->beginCall(RT64_CAPTURE_CALL_SET_VIEW_PERSPECTIVE);
+		capture->writeObject(viewPtr);
+		capture->writeValue(viewMatrix);
+		capture->writeValue(fovRadians);
+		capture->writeValue(nearDist);
+		capture->writeValue(farDist);
+		capture->writeValue((uint8_t)(canReproject));
+		capture->endCall();
+	}
+
+	RT64::View *view = (RT64::View *)(viewPtr);
+	RT64::Device *device = view->getScene()->getDevice();
+	if (device->isRenderThreadEnabled()) {
+		device->getImmediateBuffer().recordViewPerspective(view, viewMatrix, fovRadians, nearDist, farDist, canReproject);
+	}
+	else {
+		view->setPerspective(viewMatrix, fovRadians, nearDist, farDist);
+		view->setPerspectiveCanReproject(canReproject);
+	}
+}
+
+DLLEXPORT void RT64_SetViewDescription(RT64_VIEW *viewPtr, RT64_VIEW_DESC viewDesc) {
+	assert(viewPtr != nullptr);
+
+	RT64::Capture *capture = RT64::GlobalCapture;
+	if (capture != nullptr) {
+		capture->beginCall(RT64_CAPTURE_CALL_SET_VIEW_DESCRIPTION);
+		capture->writeObject(viewPtr);
+		capture->writeValue(viewDesc);
+		capture->endCall();
+	}
+
+	RT64::View *view = (RT64::View *)(viewPtr);
+	RT64::Device *device = view->getScene()->getDevice();
+	if (device->isRenderThreadEnabled()) {
+		device->getImmediateBuffer().recordViewDescription(view, viewDesc);
+	}
+	else {
+		view->setDescription(viewDesc);
+	}
 }
 
 DLLEXPORT void RT64_SetViewSkyPlane(RT64_VIEW *viewPtr, RT64_TEXTURE *texturePtr) {
 	assert(viewPtr != nullptr);
+
+	RT64::Capture *capture = RT64::GlobalCapture;
+	if (capture != nullptr) {
+		capture->beginCall(RT64_CAPTURE_CALL_SET_VIEW_SKY_PLANE);
+		capture->writeObject(viewPtr);
+		capture->writeObject(texturePtr);
+		capture->endCall();
+	}
+
 	RT64::View *view = (RT64::View *)(viewPtr);
 	RT64::Texture *texture = (RT64::Texture *)(texturePtr);
-	view->setSkyPlaneTexture(texture);
+	RT64::Device *device = view->getScene()->getDevice();
+	if (device->isRenderThreadEnabled()) {
+		device->getImmediateBuffer().recordViewSkyPlane(view, texture);
+	}
+	else {
+		view->setSkyPlaneTexture(texture);
+	}
 }
 
 DLLEXPORT RT64_INSTANCE *RT64_GetViewRaytracedInstanceAt(RT64_VIEW *viewPtr, int x, int y) {
 	assert(viewPtr != nullptr);
 	RT64::View *view = (RT64::View *)(viewPtr);
+	view->getScene()->getDevice()->waitForRenderThread();
 	return view->getRaytracedInstanceAt(x, y);
 }
 
@@ -2197,7 +2655,18 @@ DLLEXPORT bool RT64_GetViewUpscalerSupport(RT64_VIEW *viewPtr, int upscaler) {
 }
 
 DLLEXPORT void RT64_DestroyView(RT64_VIEW *viewPtr) {
-	delete (RT64::View *)(viewPtr);
+	RT64::View *view = (RT64::View *)(viewPtr);
+	view->getScene()->getDevice()->waitForRenderThread();
+
+	RT64::Capture *capture = RT64::GlobalCapture;
+	if (capture != nullptr) {
+		capture->beginCall(RT64_CAPTURE_CALL_DESTROY_VIEW);
+		capture->writeObject(viewPtr);
+		capture->endCall();
+		capture->forgetObject(viewPtr);
+	}
+
+	delete view;
 }
 
 #endif
@@ -9,10 +9,17 @@
 #include <map>
 
 #include "nv_helpers_dx12/TopLevelASGenerator.h"
-#include "nv_helpers_dx12/ShaderBindingTableGenerator.h"
 
+#include "rt64_descriptor_cache.h"
 #include "rt64_dlss.h"
 #include "rt64_fsr.h"
+#include "rt64_hit_group_table.h"
+#include "rt64_instance_extraction.h"
+#include "rt64_material_table.h"
+#include "rt64_normal_matrix_cache.h"
+#include "rt64_shader_binding_table.h"
+#include "rt64_tlas_instance_table.h"
+#include "rt64_tlas_update_policy.h"
 #include "rt64_xess.h"
 
 namespace RT64 {
@@ -24,19 +31,29 @@ namespace RT64 {
 
 	class View {
 	private:
-		struct RenderInstance {
-			Instance *instance;
-			const D3D12_VERTEX_BUFFER_VIEW* vertexBufferView;
-			const D3D12_INDEX_BUFFER_VIEW* indexBufferView;
-			int indexCount;
-			ID3D12Resource* bottomLevelAS;
-			DirectX::XMMATRIX transform;
-			DirectX::XMMATRIX transformPrevious;
-			RT64_MATERIAL material;
-			Shader *shader;
-			CD3DX12_RECT scissorRect;
-			CD3DX12_VIEWPORT viewport;
-			UINT flags;
+		// Instances rendered by the view, stored as one array per field so every pass only streams the data it reads.
+		struct RenderInstances {
+			std::vector<XMMATRIX> transforms;
+			std::vector<XMMATRIX> previousTransforms;
+			std::vector<uint32_t> materialIndices;
+			std::vector<InstanceGeometry> geometry;
+			std::vector<uint32_t> hitGroupIndices;
+			std::vector<ID3D12Resource *> bottomLevelAS;
+			std::vector<UINT> flags;
+			std::vector<Shader *> shaders;
+			std::vector<const D3D12_VERTEX_BUFFER_VIEW *> vertexBufferViews;
+			std::vector<const D3D12_INDEX_BUFFER_VIEW *> indexBufferViews;
+			std::vector<int> indexCounts;
+
+			// Only read when drawing rasterized instances or looking up instances.
+			std::vector<CD3DX12_RECT> scissorRects;
+			std::vector<CD3DX12_VIEWPORT> viewports;
+			std::vector<Instance *> instances;
+
+			void resize(size_t count);
+			void clear();
+			size_t size() const;
+			bool empty() const;
 		};
 
 		struct GlobalParamsBuffer {
@@ -84,6 +101,8 @@ namespace RT64 {
 		bool perspectiveCanReproject;
 		AccelerationStructureBuffers topLevelASBuffers;
 		nv_helpers_dx12::TopLevelASGenerator topLevelASGenerator;
+		TopLevelASUpdatePolicy topLevelASUpdatePolicy;
+		TopLevelASInstanceTable topLevelASInstanceTable;
 		AllocatedResource rasterBg;
 		ID3D12DescriptorHeap *rasterBgHeap;
 		ID3D12DescriptorHeap *outputBgHeap[2];
@@ -135,7 +154,12 @@ namespace RT64 {
 		ID3D12DescriptorHeap *postProcessHeap;
 		ID3D12DescriptorHeap *directFilterHeaps[2];
 		ID3D12DescriptorHeap *indirectFilterHeaps[2];
-		nv_helpers_dx12::ShaderBindingTableGenerator sbtHelper;
+		DescriptorCache descriptorCache;
+		DescriptorCache composeDescriptorCache;
+		DescriptorCache postProcessDescriptorCache;
+		DescriptorCache directFilterDescriptorCaches[2];
+		DescriptorCache indirectFilterDescriptorCaches[2];
+		ShaderBindingTable shaderBindingTable;
 		AllocatedResource sbtStorage;
 		UINT64 sbtStorageSize;
 		AllocatedResource globalParamBufferResource;
@@ -147,13 +171,26 @@ namespace RT64 {
 		uint32_t activeInstancesBufferTransformsSize;
 		AllocatedResource activeInstancesBufferMaterials;
 		uint32_t activeInstancesBufferMaterialsSize;
-		std::vector<RenderInstance> rasterBgInstances;
-		std::vector<RenderInstance> rasterFgInstances;
-		std::vector<RenderInstance> rtInstances;
-		std::vector<Texture *> usedTextures;
+		AllocatedResource activeInstancesBufferMaterialIndices;
+		uint32_t activeInstancesBufferMaterialIndicesSize;
+		AllocatedResource activeInstancesBufferGeometry;
+		uint32_t activeInstancesBufferGeometrySize;
+		MaterialTable materialTable;
+		HitGroupTable hitGroupTable;
+		RenderInstances rasterBgInstances;
+		RenderInstances rasterFgInstances;
+		RenderInstances rtInstances;
+		NormalMatrixCache normalMatrixCache;
+		InstanceExtraction instanceExtraction;
 		Texture *skyPlaneTexture;
 		bool scissorApplied;
 		bool viewportApplied;
+		RT64_FRAME_STATS frameStats;
+		uint64_t updateGeneration;
+		unsigned int forcedUpdateFlags;
+		bool updateInterpolation;
+		float updateInterpolationFactor;
+		float updatePreviousInterpolationFactor;
 
 		// Im3D
 		AllocatedResource im3dVertexBuffer;
@@ -172,17 +209,22 @@ namespace RT64 {
 
 		void createOutputBuffers();
 		void releaseOutputBuffers();
-		void createInstanceTransformsBuffer();
+		bool createInstanceTransformsBuffer();
 		void updateInstanceTransformsBuffer();
-		void createInstanceMaterialsBuffer();
+		bool createInstanceMaterialsBuffer();
 		void updateInstanceMaterialsBuffer();
-		void createTopLevelAS(const std::vector<RenderInstance> &rtInstances);
-		void createShaderResourceHeap();
+		bool createInstanceMaterialIndicesBuffer();
+		void updateInstanceMaterialIndicesBuffer();
+		bool createInstanceGeometryBuffer();
+		void updateInstanceGeometryBuffer();
+		void createTopLevelAS(const RenderInstances &rtInstances);
+		bool createShaderResourceHeap(bool writeTextures);
 		void createShaderBindingTable();
 		void createGlobalParamsBuffer();
 		void updateGlobalParamsBuffer();
 		void createFilterParamsBuffer();
 		void updateFilterParamsBuffer();
+		unsigned int getUpdateFlags() const;
 	public:
 		View(Scene *scene);
 		virtual ~View();
@@ -238,5 +280,8 @@ namespace RT64 {
 		bool getUpscalerLockMask() const;
 		bool getUpscalerInitialized(UpscaleMode mode) const;
 		bool getUpscalerAccelerated(UpscaleMode mode) const;
+		void setDescription(const RT64_VIEW_DESC &viewDesc);
+		Scene *getScene() const;
+		const RT64_FRAME_STATS &getFrameStats() const;
 	};
 };
\ No newline at end of file
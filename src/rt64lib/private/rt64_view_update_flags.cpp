@@ -0,0 +1,50 @@
+//
+// RT64
+//
+
+#include "../public/rt64.h"
+
+#include "rt64_view_update_flags.h"
+
+// Private
+
+unsigned int RT64::updateFlagsFromDirtyFields(unsigned int dirtyFields) {
+	// Instances that changed without any dirty fields left can't be classified.
+	if (dirtyFields == 0) {
+		return UpdateAll;
+	}
+
+	// These fields change which list the instance is sorted into and what the shader binding table points to.
+	unsigned int updateFlags = 0;
+	if (dirtyFields & (RT64_INSTANCE_FIELD_MESH | RT64_INSTANCE_FIELD_SHADER | RT64_INSTANCE_FIELD_FLAGS)) {
+		updateFlags |= UpdateAll;
+	}
+
+	if (dirtyFields & RT64_INSTANCE_FIELD_TRANSFORM) {
+		updateFlags |= UpdateInstances | UpdateTopLevelAS | UpdateTransforms;
+	}
+
+	if (dirtyFields & RT64_INSTANCE_FIELD_PREVIOUS_TRANSFORM) {
+		updateFlags |= UpdateInstances | UpdateTransforms;
+	}
+
+	if (dirtyFields & (RT64_INSTANCE_FIELD_MATERIAL | RT64_INSTANCE_FIELD_DIFFUSE_TEXTURE | RT64_INSTANCE_FIELD_NORMAL_TEXTURE | RT64_INSTANCE_FIELD_SPECULAR_TEXTURE)) {
+		updateFlags |= UpdateInstances | UpdateMaterials;
+	}
+
+	if (dirtyFields & (RT64_INSTANCE_FIELD_SCISSOR_RECT | RT64_INSTANCE_FIELD_VIEWPORT_RECT)) {
+		updateFlags |= UpdateInstances;
+	}
+
+	return updateFlags;
+}
+
+unsigned int RT64::updateFlagsFromMeshChange(bool bottomLevelASChanged) {
+	if (bottomLevelASChanged) {
+		return UpdateAll;
+	}
+
+	// The buffers were updated in place or the bottom level AS was refitted, so only the top level AS and the geometry
+	// the hit groups read must be updated.
+	return UpdateTopLevelAS | UpdateGeometry;
+}
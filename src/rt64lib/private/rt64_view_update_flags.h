@@ -0,0 +1,25 @@
+//
+// RT64
+//
+
+#pragma once
+
+namespace RT64 {
+	// Parts of the view's state that must be rebuilt during an update.
+	enum ViewUpdateFlags : unsigned int {
+		UpdateInstances = 0x1,
+		UpdateTopLevelAS = 0x2,
+		UpdateTransforms = 0x4,
+		UpdateMaterials = 0x8,
+		UpdateShaderBindingTable = 0x10,
+		UpdateGeometry = 0x20,
+		UpdateAll = 0x3F
+	};
+
+	// Flags needed by an instance that changed the fields in the mask since the last update.
+	unsigned int updateFlagsFromDirtyFields(unsigned int dirtyFields);
+
+	// Flags needed by an instance whose mesh changed since the last update. Only a mesh that gained, lost or replaced its
+	// bottom level AS can move the instance to a different list.
+	unsigned int updateFlagsFromMeshChange(bool bottomLevelASChanged);
+};
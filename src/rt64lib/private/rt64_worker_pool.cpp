@@ -0,0 +1,103 @@
+//
+// RT64
+//
+
+#include "rt64_worker_pool.h"
+
+#include <assert.h>
+
+// Private
+
+RT64::WorkerPool::WorkerPool(unsigned int workerCount) {
+	taskFunction = nullptr;
+	taskUserData = nullptr;
+	taskCount = 0;
+	nextTask = 0;
+	activeWorkers = 0;
+	batchIndex = 0;
+	stopWorkers = false;
+
+	for (unsigned int i = 0; i < workerCount; i++) {
+		threads.emplace_back(&WorkerPool::workerLoop, this);
+	}
+}
+
+RT64::WorkerPool::~WorkerPool() {
+	{
+		std::scoped_lock lock(batchMutex);
+		stopWorkers = true;
+	}
+
+	batchStarted.notify_all();
+
+	for (std::thread &thread : threads) {
+		thread.join();
+	}
+}
+
+void RT64::WorkerPool::workerLoop() {
+	uint64_t lastBatchIndex = 0;
+	while (true) {
+		{
+			std::unique_lock<std::mutex> lock(batchMutex);
+			batchStarted.wait(lock, [&]() { return stopWorkers || (batchIndex != lastBatchIndex); });
+			if (stopWorkers) {
+				return;
+			}
+
+			lastBatchIndex = batchIndex;
+		}
+
+		runTasks();
+
+		// The batch can only be reused once every worker has stopped reading from it.
+		{
+			std::scoped_lock lock(batchMutex);
+			activeWorkers--;
+			if (activeWorkers == 0) {
+				batchFinished.notify_one();
+			}
+		}
+	}
+}
+
+void RT64::WorkerPool::runTasks() {
+	size_t taskIndex = nextTask.fetch_add(1);
+	while (taskIndex < taskCount) {
+		taskFunction(taskUserData, taskIndex);
+		taskIndex = nextTask.fetch_add(1);
+	}
+}
+
+void RT64::WorkerPool::run(size_t taskCount, TaskFunction function, void *userData) {
+	assert(function != nullptr);
+
+	// Waking up the workers isn't worth it if there's only one task to run.
+	if (threads.empty() || (taskCount <= 1)) {
+		for (size_t i = 0; i < taskCount; i++) {
+			function(userData, i);
+		}
+
+		return;
+	}
+
+	{
+		std::scoped_lock lock(batchMutex);
+		this->taskFunction = function;
+		this->taskUserData = userData;
+		this->taskCount = taskCount;
+		nextTask = 0;
+		activeWorkers = threads.size();
+		batchIndex++;
+	}
+
+	batchStarted.notify_all();
+	runTasks();
+
+	std::unique_lock<std::mutex> lock(batchMutex);
+	batchFinished.wait(lock, [this]() { return activeWorkers == 0; });
+}
+
+unsigned int RT64::WorkerPool::getThreadCount() const {
+	return (unsigned int)(threads.size()) + 1;
+}
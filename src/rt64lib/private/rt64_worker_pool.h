@@ -0,0 +1,54 @@
+//
+// RT64
+//
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <stddef.h>
+#include <stdint.h>
+#include <thread>
+#include <vector>
+
+namespace RT64 {
+	// Runs batches of tasks on a fixed set of threads. The thread that starts a batch works on it as well and only
+	// returns once every task is done, so tasks can safely reference data that lives on the caller's stack.
+	class WorkerPool {
+	public:
+		typedef void (*TaskFunction)(void *userData, size_t taskIndex);
+	private:
+		std::vector<std::thread> threads;
+		std::mutex batchMutex;
+		std::condition_variable batchStarted;
+		std::condition_variable batchFinished;
+		TaskFunction taskFunction;
+		void *taskUserData;
+		size_t taskCount;
+		std::atomic<size_t> nextTask;
+		size_t activeWorkers;
+		uint64_t batchIndex;
+		bool stopWorkers;
+
+		void workerLoop();
+		void runTasks();
+	public:
+		WorkerPool(unsigned int workerCount);
+		~WorkerPool();
+
+		// Calls the function once for every task index in [0, taskCount). Tasks can run in any order and on any thread.
+		void run(size_t taskCount, TaskFunction function, void *userData);
+
+		// Same as above for lambdas and other callables, without allocating any memory to store them.
+		template<typename T>
+		void run(size_t taskCount, const T &function) {
+			run(taskCount, [](void *userData, size_t taskIndex) {
+				(*(const T *)(userData))(taskIndex);
+			}, (void *)(&function));
+		}
+
+		// Number of threads that work on a batch, including the one that starts it.
+		unsigned int getThreadCount() const;
+	};
+};
@@ -5,7 +5,17 @@
 #ifndef RT64_H_INCLUDED
 #define RT64_H_INCLUDED
 
+#ifdef _WIN32
 #include <Windows.h>
+#else
+// Only the declarations are available outside of Windows, so tools like the replay can build against them headless.
+typedef void *HWND;
+typedef void *HMODULE;
+typedef unsigned int UINT;
+typedef unsigned long long WPARAM;
+typedef long long LPARAM;
+#endif
+
 #include <stdio.h>
 
 // Material constants.
@@ -62,6 +72,20 @@
 #define RT64_INSTANCE_RASTER_BACKGROUND			0x1
 #define RT64_INSTANCE_DISABLE_BACKFACE_CULLING	0x2
 
+// Instance description fields.
+#define RT64_INSTANCE_FIELD_MESH				0x0001
+#define RT64_INSTANCE_FIELD_TRANSFORM			0x0002
+#define RT64_INSTANCE_FIELD_PREVIOUS_TRANSFORM	0x0004
+#define RT64_INSTANCE_FIELD_DIFFUSE_TEXTURE		0x0008
+#define RT64_INSTANCE_FIELD_NORMAL_TEXTURE		0x0010
+#define RT64_INSTANCE_FIELD_SPECULAR_TEXTURE	0x0020
+#define RT64_INSTANCE_FIELD_SHADER				0x0040
+#define RT64_INSTANCE_FIELD_MATERIAL			0x0080
+#define RT64_INSTANCE_FIELD_SCISSOR_RECT		0x0100
+#define RT64_INSTANCE_FIELD_VIEWPORT_RECT		0x0200
+#define RT64_INSTANCE_FIELD_FLAGS				0x0400
+#define RT64_INSTANCE_FIELD_ALL					0x07FF
+
 // Light flags.
 #define RT64_LIGHT_GROUP_MASK_ALL				0xFFFFFFFF
 #define RT64_LIGHT_GROUP_DEFAULT				0x1
@@ -85,6 +109,22 @@
 #define RT64_TEXTURE_FORMAT_RGBA8				0x1
 #define RT64_TEXTURE_FORMAT_DDS					0x2
 
+// Memory categories.
+#define RT64_MEMORY_CATEGORY_TEXTURE			0
+#define RT64_MEMORY_CATEGORY_VERTEX_INDEX		1
+#define RT64_MEMORY_CATEGORY_BLAS				2
+#define RT64_MEMORY_CATEGORY_TLAS				3
+#define RT64_MEMORY_CATEGORY_HIT_BUFFER			4
+#define RT64_MEMORY_CATEGORY_RENDER_TARGET		5
+#define RT64_MEMORY_CATEGORY_UPSCALER			6
+#define RT64_MEMORY_CATEGORY_UPLOAD				7
+#define RT64_MEMORY_CATEGORY_COUNT				8
+
+// Top level AS build types.
+#define RT64_TLAS_BUILD_NONE					0x0
+#define RT64_TLAS_BUILD_FULL					0x1
+#define RT64_TLAS_BUILD_UPDATE					0x2
+
 // Forward declaration of types.
 typedef struct RT64_DEVICE RT64_DEVICE;
 typedef struct RT64_VIEW RT64_VIEW;
@@ -94,6 +134,7 @@ typedef struct RT64_MESH RT64_MESH;
 typedef struct RT64_TEXTURE RT64_TEXTURE;
 typedef struct RT64_SHADER RT64_SHADER;
 typedef struct RT64_INSPECTOR RT64_INSPECTOR;
+typedef struct RT64_RECORDER RT64_RECORDER;
 
 typedef struct {
 	float x, y;
@@ -195,6 +236,60 @@ typedef struct {
 	unsigned int flags;
 } RT64_INSTANCE_DESC;
 
+// Draw submitted in immediate mode. The vertex and index arrays must stay valid until the frame ends.
+typedef struct {
+	void *vertexArray;
+	int vertexCount;
+	int vertexStride;
+	unsigned int *indexArray;
+	int indexCount;
+	int meshFlags;
+	RT64_MATRIX4 transform;
+	RT64_TEXTURE *diffuseTexture;
+	RT64_TEXTURE *normalTexture;
+	RT64_TEXTURE *specularTexture;
+	RT64_SHADER *shader;
+	RT64_MATERIAL material;
+	RT64_RECT scissorRect;
+	RT64_RECT viewportRect;
+	unsigned int flags;
+} RT64_DRAW_DESC;
+
+// Counters for the work done by the device during the last frame it finished drawing.
+// The CPU allocations are only counted when the library is built with RT64_COUNT_ALLOCATIONS and are -1 otherwise.
+typedef struct {
+	int rtInstanceCount;
+	int rasterBgInstanceCount;
+	int rasterFgInstanceCount;
+	int extractedInstanceCount;
+	int blasBuildCount;
+	int blasRefitCount;
+	int tlasBuildType;
+	unsigned long long meshUploadBytes;
+	unsigned long long textureUploadBytes;
+	unsigned long long constantUploadBytes;
+	int descriptorsWritten;
+	int sbtBuildCount;
+	int sbtRecordsWritten;
+	int shadersCompiled;
+	int gpuWaitCount;
+	float gpuWaitMs;
+	int heapAllocationCount;
+	int cpuAllocationCount;
+} RT64_FRAME_STATS;
+
+// Memory allocated by the device for each category. The GPU usage and budget are reported by the allocator for the local heap.
+typedef struct {
+	unsigned long long categoryBytes[RT64_MEMORY_CATEGORY_COUNT];
+	unsigned int categoryAllocationCount[RT64_MEMORY_CATEGORY_COUNT];
+	unsigned long long totalBytes;
+	unsigned long long gpuUsageBytes;
+	unsigned long long gpuBudgetBytes;
+} RT64_MEMORY_STATS;
+
+// Called when the memory allocated by the device goes over the threshold. It can be called from the render thread.
+typedef void (*RT64_MEMORY_BUDGET_CALLBACK)(void *userData, unsigned long long usedBytes, unsigned long long thresholdBytes);
+
 typedef struct {
 	void *bytes;
 	int byteCount;
@@ -271,6 +366,10 @@ typedef const char *(*GetLastErrorPtr)();
 typedef RT64_DEVICE* (*CreateDevicePtr)(void *hwnd);
 typedef void (*DestroyDevicePtr)(RT64_DEVICE* device);
 typedef void (*DrawDevicePtr)(RT64_DEVICE *device, int vsyncInterval, float deltaTimeMs);
+typedef void (*SetDeviceRenderThreadPtr)(RT64_DEVICE *device, bool enabled);
+typedef void (*GetFrameStatsPtr)(RT64_DEVICE *device, RT64_FRAME_STATS *frameStats);
+typedef void (*GetMemoryStatsPtr)(RT64_DEVICE *device, RT64_MEMORY_STATS *memoryStats);
+typedef void (*SetMemoryBudgetCallbackPtr)(RT64_DEVICE *device, unsigned long long thresholdBytes, RT64_MEMORY_BUDGET_CALLBACK callback, void *userData);
 typedef RT64_VIEW* (*CreateViewPtr)(RT64_SCENE* scenePtr);
 typedef void (*SetViewPerspectivePtr)(RT64_VIEW *viewPtr, RT64_MATRIX4 viewMatrix, float fovRadians, float nearDist, float farDist, bool canReproject);
 typedef void (*SetViewDescriptionPtr)(RT64_VIEW *viewPtr, RT64_VIEW_DESC viewDesc);
@@ -281,16 +380,29 @@ typedef void (*DestroyViewPtr)(RT64_VIEW* viewPtr);
 typedef RT64_SCENE* (*CreateScenePtr)(RT64_DEVICE* devicePtr);
 typedef void (*SetSceneDescriptionPtr)(RT64_SCENE* scenePtr, RT64_SCENE_DESC sceneDesc);
 typedef void (*SetSceneLightsPtr)(RT64_SCENE* scenePtr, RT64_LIGHT* lightArray, int lightCount);
+typedef void (*SetSceneInterpolationPtr)(RT64_SCENE *scenePtr, bool enabled, float factor);
 typedef void (*DestroyScenePtr)(RT64_SCENE* scenePtr);
 typedef RT64_MESH* (*CreateMeshPtr)(RT64_DEVICE* devicePtr, int flags);
 typedef void (*SetMeshPtr)(RT64_MESH* meshPtr, void* vertexArray, int vertexCount, int vertexStride, unsigned int* indexArray, int indexCount);
+typedef void (*SetMeshRangePtr)(RT64_MESH* meshPtr, void* vertexArray, int vertexStart, int vertexCount);
+typedef void* (*MapMeshVerticesPtr)(RT64_MESH* meshPtr, int vertexCount, int vertexStride);
+typedef void (*UnmapMeshVerticesPtr)(RT64_MESH* meshPtr);
+typedef unsigned int* (*MapMeshIndicesPtr)(RT64_MESH* meshPtr, int indexCount);
+typedef void (*UnmapMeshIndicesPtr)(RT64_MESH* meshPtr);
 typedef void (*DestroyMeshPtr)(RT64_MESH* meshPtr);
 typedef RT64_SHADER *(*CreateShaderPtr)(RT64_DEVICE *devicePtr, unsigned int shaderId, unsigned int filter, unsigned int hAddr, unsigned int vAddr, int flags);
 typedef void (*DestroyShaderPtr)(RT64_SHADER *shaderPtr);
 typedef RT64_INSTANCE* (*CreateInstancePtr)(RT64_SCENE* scenePtr);
 typedef void (*SetInstanceDescriptionPtr)(RT64_INSTANCE* instancePtr, RT64_INSTANCE_DESC instanceDesc);
+typedef void (*SetInstanceDescriptionsPtr)(RT64_INSTANCE** instancePtrs, const RT64_INSTANCE_DESC* instanceDescs, int instanceCount);
+typedef void (*UpdateInstanceDescriptionPtr)(RT64_INSTANCE* instancePtr, const RT64_INSTANCE_DESC* instanceDesc, unsigned int fieldMask);
 typedef void (*DestroyInstancePtr)(RT64_INSTANCE* instancePtr);
+typedef void (*BeginFramePtr)(RT64_SCENE* scenePtr);
+typedef void (*SubmitDrawPtr)(RT64_SCENE* scenePtr, const RT64_DRAW_DESC* drawDesc);
+typedef void (*EndFramePtr)(RT64_SCENE* scenePtr);
 typedef RT64_TEXTURE* (*CreateTexturePtr)(RT64_DEVICE* devicePtr, RT64_TEXTURE_DESC textureDesc);
+typedef RT64_TEXTURE* (*CreateTextureAsyncPtr)(RT64_DEVICE* devicePtr, RT64_TEXTURE_DESC textureDesc);
+typedef bool (*IsTextureReadyPtr)(RT64_TEXTURE* texture);
 typedef void (*DestroyTexturePtr)(RT64_TEXTURE* texture);
 typedef RT64_INSPECTOR* (*CreateInspectorPtr)(RT64_DEVICE* devicePtr);
 typedef bool (*HandleMessageInspectorPtr)(RT64_INSPECTOR* inspectorPtr, UINT msg, WPARAM wParam, LPARAM lParam);
@@ -300,6 +412,13 @@ typedef void (*SetLightsInspectorPtr)(RT64_INSPECTOR* inspectorPtr, RT64_LIGHT*
 typedef void (*PrintClearInspectorPtr)(RT64_INSPECTOR *inspectorPtr);
 typedef void (*PrintMessageInspectorPtr)(RT64_INSPECTOR* inspectorPtr, const char* message);
 typedef void (*DestroyInspectorPtr)(RT64_INSPECTOR* inspectorPtr);
+typedef RT64_RECORDER* (*CreateRecorderPtr)(RT64_DEVICE* devicePtr);
+typedef void (*RecordInstanceDescriptionPtr)(RT64_RECORDER* recorderPtr, RT64_INSTANCE* instancePtr, const RT64_INSTANCE_DESC* instanceDesc, unsigned int fieldMask);
+typedef void (*RecordMeshPtr)(RT64_RECORDER* recorderPtr, RT64_MESH* meshPtr, void* vertexArray, int vertexCount, int vertexStride, unsigned int* indexArray, int indexCount);
+typedef void (*RecordSceneLightsPtr)(RT64_RECORDER* recorderPtr, RT64_SCENE* scenePtr, RT64_LIGHT* lightArray, int lightCount);
+typedef void (*DestroyRecorderPtr)(RT64_RECORDER* recorderPtr);
+typedef bool (*StartCapturePtr)(const char* path);
+typedef void (*StopCapturePtr)();
 
 // Stores all the function pointers used in the RT64 library.
 typedef struct {
@@ -309,6 +428,10 @@ typedef struct {
 	DestroyDevicePtr DestroyDevice;
 #ifndef RT64_MINIMAL
 	DrawDevicePtr DrawDevice;
+	SetDeviceRenderThreadPtr SetDeviceRenderThread;
+	GetFrameStatsPtr GetFrameStats;
+	GetMemoryStatsPtr GetMemoryStats;
+	SetMemoryBudgetCallbackPtr SetMemoryBudgetCallback;
 	CreateViewPtr CreateView;
 	SetViewPerspectivePtr SetViewPerspective;
 	SetViewDescriptionPtr SetViewDescription;
@@ -319,16 +442,29 @@ typedef struct {
 	CreateScenePtr CreateScene;
 	SetSceneDescriptionPtr SetSceneDescription;
 	SetSceneLightsPtr SetSceneLights;
+	SetSceneInterpolationPtr SetSceneInterpolation;
 	DestroyScenePtr DestroyScene;
 	CreateMeshPtr CreateMesh;
 	SetMeshPtr SetMesh;
+	SetMeshRangePtr SetMeshRange;
+	MapMeshVerticesPtr MapMeshVertices;
+	UnmapMeshVerticesPtr UnmapMeshVertices;
+	MapMeshIndicesPtr MapMeshIndices;
+	UnmapMeshIndicesPtr UnmapMeshIndices;
 	DestroyMeshPtr DestroyMesh;
 	CreateShaderPtr CreateShader;
 	DestroyShaderPtr DestroyShader;
 	CreateInstancePtr CreateInstance;
 	SetInstanceDescriptionPtr SetInstanceDescription;
+	SetInstanceDescriptionsPtr SetInstanceDescriptions;
+	UpdateInstanceDescriptionPtr UpdateInstanceDescription;
 	DestroyInstancePtr DestroyInstance;
+	BeginFramePtr BeginFrame;
+	SubmitDrawPtr SubmitDraw;
+	EndFramePtr EndFrame;
 	CreateTexturePtr CreateTexture;
+	CreateTextureAsyncPtr CreateTextureAsync;
+	IsTextureReadyPtr IsTextureReady;
 	DestroyTexturePtr DestroyTexture;
 	CreateInspectorPtr CreateInspector;
 	HandleMessageInspectorPtr HandleMessageInspector;
@@ -338,9 +474,17 @@ typedef struct {
 	SetMaterialInspectorPtr SetMaterialInspector;
 	SetLightsInspectorPtr SetLightsInspector;
 	DestroyInspectorPtr DestroyInspector;
+	CreateRecorderPtr CreateRecorder;
+	RecordInstanceDescriptionPtr RecordInstanceDescription;
+	RecordMeshPtr RecordMesh;
+	RecordSceneLightsPtr RecordSceneLights;
+	DestroyRecorderPtr DestroyRecorder;
+	StartCapturePtr StartCapture;
+	StopCapturePtr StopCapture;
 #endif
 } RT64_LIBRARY;
 
+#ifdef _WIN32
 
 // Define RT64_DEBUG for loading the debug DLL.
 inline RT64_LIBRARY RT64_LoadLibrary() {
@@ -361,6 +505,10 @@ inline RT64_LIBRARY RT64_LoadLibrary() {
 
 #ifndef RT64_MINIMAL
 		lib.DrawDevice = (DrawDevicePtr)(GetProcAddress(lib.handle, "RT64_DrawDevice"));
+		lib.SetDeviceRenderThread = (SetDeviceRenderThreadPtr)(GetProcAddress(lib.handle, "RT64_SetDeviceRenderThread"));
+		lib.GetFrameStats = (GetFrameStatsPtr)(GetProcAddress(lib.handle, "RT64_GetFrameStats"));
+		lib.GetMemoryStats = (GetMemoryStatsPtr)(GetProcAddress(lib.handle, "RT64_GetMemoryStats"));
+		lib.SetMemoryBudgetCallback = (SetMemoryBudgetCallbackPtr)(GetProcAddress(lib.handle, "RT64_SetMemoryBudgetCallback"));
 		lib.CreateView = (CreateViewPtr)(GetProcAddress(lib.handle, "RT64_CreateView"));
 		lib.SetViewPerspective = (SetViewPerspectivePtr)(GetProcAddress(lib.handle, "RT64_SetViewPerspective"));
 		lib.SetViewDescription = (SetViewDescriptionPtr)(GetProcAddress(lib.handle, "RT64_SetViewDescription"));
@@ -371,16 +519,29 @@ inline RT64_LIBRARY RT64_LoadLibrary() {
 		lib.CreateScene = (CreateScenePtr)(GetProcAddress(lib.handle, "RT64_CreateScene"));
 		lib.SetSceneDescription = (SetSceneDescriptionPtr)(GetProcAddress(lib.handle, "RT64_SetSceneDescription"));
 		lib.SetSceneLights = (SetSceneLightsPtr)(GetProcAddress(lib.handle, "RT64_SetSceneLights"));
+		lib.SetSceneInterpolation = (SetSceneInterpolationPtr)(GetProcAddress(lib.handle, "RT64_SetSceneInterpolation"));
 		lib.DestroyScene = (DestroyScenePtr)(GetProcAddress(lib.handle, "RT64_DestroyScene"));
 		lib.CreateMesh = (CreateMeshPtr)(GetProcAddress(lib.handle, "RT64_CreateMesh"));
 		lib.SetMesh = (SetMeshPtr)(GetProcAddress(lib.handle, "RT64_SetMesh"));
+		lib.SetMeshRange = (SetMeshRangePtr)(GetProcAddress(lib.handle, "RT64_SetMeshRange"));
+		lib.MapMeshVertices = (MapMeshVerticesPtr)(GetProcAddress(lib.handle, "RT64_MapMeshVertices"));
+		lib.UnmapMeshVertices = (UnmapMeshVerticesPtr)(GetProcAddress(lib.handle, "RT64_UnmapMeshVertices"));
+		lib.MapMeshIndices = (MapMeshIndicesPtr)(GetProcAddress(lib.handle, "RT64_MapMeshIndices"));
+		lib.UnmapMeshIndices = (UnmapMeshIndicesPtr)(GetProcAddress(lib.handle, "RT64_UnmapMeshIndices"));
 		lib.DestroyMesh = (DestroyMeshPtr)(GetProcAddress(lib.handle, "RT64_DestroyMesh"));
 		lib.CreateShader = (CreateShaderPtr)(GetProcAddress(lib.handle, "RT64_CreateShader"));
 		lib.DestroyShader = (DestroyShaderPtr)(GetProcAddress(lib.handle, "RT64_DestroyShader"));
 		lib.CreateInstance = (CreateInstancePtr)(GetProcAddress(lib.handle, "RT64_CreateInstance"));
 		lib.SetInstanceDescription = (SetInstanceDescriptionPtr)(GetProcAddress(lib.handle, "RT64_SetInstanceDescription"));
+		lib.SetInstanceDescriptions = (SetInstanceDescriptionsPtr)(GetProcAddress(lib.handle, "RT64_SetInstanceDescriptions"));
+		lib.UpdateInstanceDescription = (UpdateInstanceDescriptionPtr)(GetProcAddress(lib.handle, "RT64_UpdateInstanceDescription"));
 		lib.DestroyInstance = (DestroyInstancePtr)(GetProcAddress(lib.handle, "RT64_DestroyInstance"));
+		lib.BeginFrame = (BeginFramePtr)(GetProcAddress(lib.handle, "RT64_BeginFrame"));
+		lib.SubmitDraw = (SubmitDrawPtr)(GetProcAddress(lib.handle, "RT64_SubmitDraw"));
+		lib.EndFrame = (EndFramePtr)(GetProcAddress(lib.handle, "RT64_EndFrame"));
 		lib.CreateTexture = (CreateTexturePtr)(GetProcAddress(lib.handle, "RT64_CreateTexture"));
+		lib.CreateTextureAsync = (CreateTextureAsyncPtr)(GetProcAddress(lib.handle, "RT64_CreateTextureAsync"));
+		lib.IsTextureReady = (IsTextureReadyPtr)(GetProcAddress(lib.handle, "RT64_IsTextureReady"));
 		lib.DestroyTexture = (DestroyTexturePtr)(GetProcAddress(lib.handle, "RT64_DestroyTexture"));
 		lib.CreateInspector = (CreateInspectorPtr)(GetProcAddress(lib.handle, "RT64_CreateInspector"));
 		lib.HandleMessageInspector = (HandleMessageInspectorPtr)(GetProcAddress(lib.handle, "RT64_HandleMessageInspector"));
@@ -390,6 +551,13 @@ inline RT64_LIBRARY RT64_LoadLibrary() {
 		lib.PrintClearInspector = (PrintClearInspectorPtr)(GetProcAddress(lib.handle, "RT64_PrintClearInspector"));
 		lib.PrintMessageInspector = (PrintMessageInspectorPtr)(GetProcAddress(lib.handle, "RT64_PrintMessageInspector"));
 		lib.DestroyInspector = (DestroyInspectorPtr)(GetProcAddress(lib.handle, "RT64_DestroyInspector"));
+		lib.CreateRecorder = (CreateRecorderPtr)(GetProcAddress(lib.handle, "RT64_CreateRecorder"));
+		lib.RecordInstanceDescription = (RecordInstanceDescriptionPtr)(GetProcAddress(lib.handle, "RT64_RecordInstanceDescription"));
+		lib.RecordMesh = (RecordMeshPtr)(GetProcAddress(lib.handle, "RT64_RecordMesh"));
+		lib.RecordSceneLights = (RecordSceneLightsPtr)(GetProcAddress(lib.handle, "RT64_RecordSceneLights"));
+		lib.DestroyRecorder = (DestroyRecorderPtr)(GetProcAddress(lib.handle, "RT64_DestroyRecorder"));
+		lib.StartCapture = (StartCapturePtr)(GetProcAddress(lib.handle, "RT64_StartCapture"));
+		lib.StopCapture = (StopCapturePtr)(GetProcAddress(lib.handle, "RT64_StopCapture"));
 #endif
 	}
 	else {
@@ -405,4 +573,6 @@ inline void RT64_UnloadLibrary(RT64_LIBRARY lib) {
 	FreeLibrary(lib.handle);
 }
 
+#endif
+
 #endif
\ No newline at end of file
@@ -0,0 +1,80 @@
+//
+// RT64
+//
+
+#pragma once
+
+// Binary format of the API capture stream, shared by the library and the replay tool.
+//
+// The stream begins with a header made of the magic and the version, followed by records.
+// Every record is a 32-bit call identifier, a 32-bit payload size and the payload itself.
+// Objects are referenced by 32-bit identifiers assigned in creation order, zero means null.
+// Data arrays are stored once as blob records and referenced by their 64-bit XXHash afterwards.
+// The stream has no record of the state that existed before it, so RT64_StartCapture fails if any device is alive.
+
+#define RT64_CAPTURE_MAGIC							0x50414336
+#define RT64_CAPTURE_VERSION						1
+
+// Capture calls.
+#define RT64_CAPTURE_CALL_BLOB						0x00
+#define RT64_CAPTURE_CALL_CREATE_DEVICE				0x01
+#define RT64_CAPTURE_CALL_DESTROY_DEVICE			0x02
+#define RT64_CAPTURE_CALL_DRAW_DEVICE				0x03
+#define RT64_CAPTURE_CALL_CREATE_SCENE				0x10
+#define RT64_CAPTURE_CALL_SET_SCENE_DESCRIPTION		0x11
+#define RT64_CAPTURE_CALL_SET_SCENE_LIGHTS			0x12
+#define RT64_CAPTURE_CALL_DESTROY_SCENE				0x13
+#define RT64_CAPTURE_CALL_SET_SCENE_INTERPOLATION	0x14
+#define RT64_CAPTURE_CALL_CREATE_VIEW				0x20
+#define RT64_CAPTURE_CALL_SET_VIEW_PERSPECTIVE		0x21
+#define RT64_CAPTURE_CALL_SET_VIEW_DESCRIPTION		0x22
+#define RT64_CAPTURE_CALL_SET_VIEW_SKY_PLANE		0x23
+#define RT64_CAPTURE_CALL_DESTROY_VIEW				0x24
+#define RT64_CAPTURE_CALL_CREATE_MESH				0x30
+#define RT64_CAPTURE_CALL_SET_MESH					0x31
+#define RT64_CAPTURE_CALL_SET_MESH_RANGE			0x32
+#define RT64_CAPTURE_CALL_SET_MESH_VERTICES			0x33
+#define RT64_CAPTURE_CALL_SET_MESH_INDICES			0x34
+#define RT64_CAPTURE_CALL_DESTROY_MESH				0x35
+#define RT64_CAPTURE_CALL_CREATE_TEXTURE			0x40
+#define RT64_CAPTURE_CALL_DESTROY_TEXTURE			0x41
+#define RT64_CAPTURE_CALL_CREATE_SHADER				0x50
+#define RT64_CAPTURE_CALL_DESTROY_SHADER			0x51
+#define RT64_CAPTURE_CALL_CREATE_INSTANCE			0x60
+#define RT64_CAPTURE_CALL_SET_INSTANCE_DESCRIPTION	0x61
+#define RT64_CAPTURE_CALL_SET_INSTANCE_DESCRIPTIONS	0x62
+#define RT64_CAPTURE_CALL_DESTROY_INSTANCE			0x63
+#define RT64_CAPTURE_CALL_MAX						0x64
+
+// Payloads, in the order they're written. Blobs are referenced by hash.
+//
+// BLOB:						uint64 hash, bytes
+// CREATE_DEVICE:				uint32 device
+// DESTROY_DEVICE:				uint32 device
+// DRAW_DEVICE:					uint32 device, int vsyncInterval, float deltaTimeMs
+// CREATE_SCENE:				uint32 device, uint32 scene
+// SET_SCENE_DESCRIPTION:		uint32 scene, RT64_SCENE_DESC
+// SET_SCENE_LIGHTS:			uint32 scene, int lightCount, uint64 lights
+// DESTROY_SCENE:				uint32 scene
+// SET_SCENE_INTERPOLATION:		uint32 scene, uint8 enabled, float factor
+// CREATE_VIEW:					uint32 scene, uint32 view
+// SET_VIEW_PERSPECTIVE:		uint32 view, RT64_MATRIX4 viewMatrix, float fovRadians, float nearDist, float farDist, uint8 canReproject
+// SET_VIEW_DESCRIPTION:		uint32 view, RT64_VIEW_DESC
+// SET_VIEW_SKY_PLANE:			uint32 view, uint32 texture
+// DESTROY_VIEW:				uint32 view
+// CREATE_MESH:					uint32 device, int flags, uint32 mesh
+// SET_MESH:					uint32 mesh, int vertexCount, int vertexStride, uint64 vertices, int indexCount, uint64 indices
+// SET_MESH_RANGE:				uint32 mesh, int vertexStart, int vertexCount, uint64 vertices
+// SET_MESH_VERTICES:			uint32 mesh, int vertexCount, int vertexStride, uint64 vertices
+// SET_MESH_INDICES:			uint32 mesh, int indexCount, uint64 indices
+// DESTROY_MESH:				uint32 mesh
+// CREATE_TEXTURE:				uint32 device, uint8 async, RT64_TEXTURE_DESC, uint64 bytes, uint32 texture
+// DESTROY_TEXTURE:				uint32 texture
+// CREATE_SHADER:				uint32 device, uint32 shaderId, uint32 filter, uint32 hAddr, uint32 vAddr, int flags, uint32 shader
+// DESTROY_SHADER:				uint32 shader
+// CREATE_INSTANCE:				uint32 scene, uint32 instance
+// SET_INSTANCE_DESCRIPTION:	uint32 instance, uint32 fieldMask, RT64_INSTANCE_DESC, uint32 mesh, uint32 diffuse, uint32 normal, uint32 specular, uint32 shader
+// SET_INSTANCE_DESCRIPTIONS:	int instanceCount, followed by every instance as in SET_INSTANCE_DESCRIPTION without the field mask
+// DESTROY_INSTANCE:			uint32 instance
+//
+// Pointers stored inside of the description structures are always zeroed.
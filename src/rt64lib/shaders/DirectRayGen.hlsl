@@ -48,10 +48,10 @@ void DirectRayGen() {
 	}
 
 	float3 resDirect = ComputeLightsRandom(launchIndex, rayDirection, instanceId, position.xyz, normal.xyz, specular.xyz, maxLights, true);
-	resDirect += instanceMaterials[instanceId].selfLight;
+	resDirect += GetInstanceMaterial(instanceId).selfLight;
 
 	// Add the eye light.
-	float specularExponent = instanceMaterials[instanceId].specularExponent;
+	float specularExponent = GetInstanceMaterial(instanceId).specularExponent;
 	float eyeLightLambertFactor = max(dot(normal.xyz, -rayDirection), 0.0f);
 	float3 eyeLightReflected = reflect(rayDirection, normal.xyz);
 	float3 eyeLightSpecularFactor = specular.rgb * pow(max(saturate(dot(eyeLightReflected, -rayDirection)), 0.0f), specularExponent);
@@ -3,9 +3,9 @@
 //
 
 float4 ComputeFogFromCamera(uint instanceId, float3 position) {
-	float4 fogColor = float4(instanceMaterials[instanceId].fogColor, 0.0f);
-	float fogMul = instanceMaterials[instanceId].fogMul;
-	float fogOffset = instanceMaterials[instanceId].fogOffset;
+	float4 fogColor = float4(GetInstanceMaterial(instanceId).fogColor, 0.0f);
+	float fogMul = GetInstanceMaterial(instanceId).fogMul;
+	float fogOffset = GetInstanceMaterial(instanceId).fogOffset;
 	float4 clipPos = mul(mul(projection, view), float4(position.xyz, 1.0f));
 
 	// Values from the game are designed around -1 to 1 space.
@@ -18,9 +18,9 @@ float4 ComputeFogFromCamera(uint instanceId, float3 position) {
 }
 
 float4 ComputeFogFromOrigin(uint instanceId, float3 position, float3 origin) {
-	float4 fogColor = float4(instanceMaterials[instanceId].fogColor, 0.0f);
-	float fogMul = instanceMaterials[instanceId].fogMul;
-	float fogOffset = instanceMaterials[instanceId].fogOffset;
+	float4 fogColor = float4(GetInstanceMaterial(instanceId).fogColor, 0.0f);
+	float fogMul = GetInstanceMaterial(instanceId).fogMul;
+	float fogOffset = GetInstanceMaterial(instanceId).fogOffset;
 	float distance = length(position - origin);
 	fogColor.a = clamp(((distance + fogOffset) / fogMul) * 0.5f, 0.0f, 1.0f);
 	return fogColor;
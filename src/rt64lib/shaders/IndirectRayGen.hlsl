@@ -98,7 +98,7 @@ void IndirectRayGen() {
 					float3 vertexPosition = rayOrigin + rayDirection * WithoutDistanceBias(gHitDistAndFlow[hitBufferIndex].x, instanceId);
 					float3 vertexNormal = gHitNormal[hitBufferIndex].xyz;
 					float3 vertexSpecular = gHitSpecular[hitBufferIndex].rgb;
-					float3 specular = instanceMaterials[instanceId].specularColor * vertexSpecular.rgb;
+					float3 specular = GetInstanceMaterial(instanceId).specularColor * vertexSpecular.rgb;
 					resColor.rgb += hitColor.rgb * alphaContrib;
 					resColor.a *= (1.0 - hitColor.a);
 					resPosition = vertexPosition;
@@ -115,7 +115,7 @@ void IndirectRayGen() {
 			// Add diffuse bounce as indirect light.
 			float3 resIndirect = ambientBaseColor.rgb;
 			if (resInstanceId >= 0) {
-				float3 directLight = ComputeLightsRandom(launchIndex, rayDirection, resInstanceId, resPosition, resNormal, resSpecular, 1, true) + instanceMaterials[resInstanceId].selfLight;
+				float3 directLight = ComputeLightsRandom(launchIndex, rayDirection, resInstanceId, resPosition, resNormal, resSpecular, 1, true) + GetInstanceMaterial(resInstanceId).selfLight;
 				float3 indirectLight = resColor.rgb * (1.0f - resColor.a) * (ambientBaseColor.rgb + ambientNoGIColor.rgb + directLight) * giDiffuseStrength;
 				resIndirect += indirectLight;
 			}
@@ -11,15 +11,21 @@ struct InstanceTransforms {
 	float4x4 objectToWorldPrevious;
 };
 
-StructuredBuffer<InstanceTransforms> instanceTransforms : register(t5);
-StructuredBuffer<MaterialProperties> instanceMaterials : register(t6);
+StructuredBuffer<InstanceTransforms> instanceTransforms : register(t3);
+StructuredBuffer<MaterialProperties> instanceMaterials : register(t4);
+StructuredBuffer<uint> instanceMaterialIndices : register(t5);
+
+// Instances that use the same material share the same entry in the material buffer.
+MaterialProperties GetInstanceMaterial(uint instanceId) {
+	return instanceMaterials[instanceMaterialIndices[instanceId]];
+}
 
 float WithDistanceBias(float distance, uint instanceId) {
-	return distance - instanceMaterials[instanceId].depthBias;
+	return distance - GetInstanceMaterial(instanceId).depthBias;
 }
 
 float WithoutDistanceBias(float distance, uint instanceId) {
-	return distance + instanceMaterials[instanceId].depthBias;
+	return distance + GetInstanceMaterial(instanceId).depthBias;
 }
 //)raw"
 #endif
\ No newline at end of file
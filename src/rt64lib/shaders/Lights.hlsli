@@ -20,7 +20,7 @@ struct LightInfo {
 
 // Root signature
 
-StructuredBuffer<LightInfo> SceneLights : register(t4);
+StructuredBuffer<LightInfo> SceneLights : register(t2);
 
 #define MAX_LIGHTS 16
 
@@ -65,9 +65,9 @@ float CalculateLightIntensitySimple(uint l, float3 position, float3 normal, floa
 }
 
 float3 ComputeLight(uint2 launchIndex, uint lightIndex, float3 rayDirection, uint instanceId, float3 position, float3 normal, float3 specular, const bool checkShadows) {
-	float ignoreNormalFactor = instanceMaterials[instanceId].ignoreNormalFactor;
-	float specularExponent = instanceMaterials[instanceId].specularExponent;
-	float shadowRayBias = instanceMaterials[instanceId].shadowRayBias;
+	float ignoreNormalFactor = GetInstanceMaterial(instanceId).ignoreNormalFactor;
+	float specularExponent = GetInstanceMaterial(instanceId).specularExponent;
+	float shadowRayBias = GetInstanceMaterial(instanceId).shadowRayBias;
 	float3 lightPosition = SceneLights[lightIndex].position;
 	float3 lightDirection = normalize(lightPosition - position);
 	float lightRadius = SceneLights[lightIndex].attenuationRadius;
@@ -114,8 +114,8 @@ float3 ComputeLight(uint2 launchIndex, uint lightIndex, float3 rayDirection, uin
 
 float3 ComputeLightsRandom(uint2 launchIndex, float3 rayDirection, uint instanceId, float3 position, float3 normal, float3 specular, uint maxLightCount, const bool checkShadows) {
 	float3 resultLight = float3(0.0f, 0.0f, 0.0f);
-	uint lightGroupMaskBits = instanceMaterials[instanceId].lightGroupMaskBits;
-	float ignoreNormalFactor = instanceMaterials[instanceId].ignoreNormalFactor;
+	uint lightGroupMaskBits = GetInstanceMaterial(instanceId).lightGroupMaskBits;
+	float ignoreNormalFactor = GetInstanceMaterial(instanceId).ignoreNormalFactor;
 	if (lightGroupMaskBits > 0) {
 		uint sLightCount = 0;
 		uint gLightCount, gLightStride;
@@ -91,20 +91,20 @@ void PrimaryRayGen() {
 			uint instanceId = gHitInstanceId[hitBufferIndex];
 
 			// Add the material's pixel lock along with its alpha contribution.
-			resLockMask += instanceMaterials[instanceId].lockMask * alphaContrib;
+			resLockMask += GetInstanceMaterial(instanceId).lockMask * alphaContrib;
 
-			bool usesLighting = (instanceMaterials[instanceId].lightGroupMaskBits > 0);
+			bool usesLighting = (GetInstanceMaterial(instanceId).lightGroupMaskBits > 0);
 			bool applyLighting = usesLighting && (hitColor.a > APPLY_LIGHTS_MINIMUM_ALPHA);
 			float3 vertexPosition = rayOrigin + rayDirection * WithoutDistanceBias(gHitDistAndFlow[hitBufferIndex].x, instanceId);
 			float3 vertexNormal = gHitNormal[hitBufferIndex].xyz;
 			float3 vertexSpecular = gHitSpecular[hitBufferIndex].rgb;
-			float3 specular = instanceMaterials[instanceId].specularColor * vertexSpecular.rgb;
-			float reflectionFactor = instanceMaterials[instanceId].reflectionFactor;
-			float refractionFactor = instanceMaterials[instanceId].refractionFactor;
+			float3 specular = GetInstanceMaterial(instanceId).specularColor * vertexSpecular.rgb;
+			float reflectionFactor = GetInstanceMaterial(instanceId).reflectionFactor;
+			float refractionFactor = GetInstanceMaterial(instanceId).refractionFactor;
 
 			// Calculate the fog for the resulting color using the camera data if the option is enabled.
 			bool storeHit = false;
-			if (instanceMaterials[instanceId].fogEnabled) {
+			if (GetInstanceMaterial(instanceId).fogEnabled) {
 				float4 fogColor = ComputeFogFromCamera(instanceId, vertexPosition);
 				resTransparent += fogColor.rgb * fogColor.a * alphaContrib;
 				alphaContrib *= (1.0f - fogColor.a);
@@ -112,7 +112,7 @@ void PrimaryRayGen() {
 
 			// Reflection.
 			if (reflectionFactor > EPSILON) {
-				float reflectionFresnelFactor = instanceMaterials[instanceId].reflectionFresnelFactor;
+				float reflectionFresnelFactor = GetInstanceMaterial(instanceId).reflectionFresnelFactor;
 				float fresnelAmount = FresnelReflectAmount(vertexNormal, rayDirection, reflectionFactor, reflectionFresnelFactor);
 				float reflectAmount = fresnelAmount * alphaContrib;
 				gReflection[launchIndex].a = reflectAmount;
@@ -139,12 +139,12 @@ void PrimaryRayGen() {
 					resTransparentLightComputed = true;
 				}
 
-				resTransparent += resColorAdd * (ambientBaseColor.rgb + ambientNoGIColor.rgb + instanceMaterials[instanceId].selfLight + resTransparentLight);
+				resTransparent += resColorAdd * (ambientBaseColor.rgb + ambientNoGIColor.rgb + GetInstanceMaterial(instanceId).selfLight + resTransparentLight);
 			}
 			// Cheap case: we ignore the geometry entirely from the lighting pass and just add
 			// it to the transparency buffer directly.
 			else {
-				resTransparent += resColorAdd * (ambientBaseColor.rgb + ambientNoGIColor.rgb + instanceMaterials[instanceId].selfLight);
+				resTransparent += resColorAdd * (ambientBaseColor.rgb + ambientNoGIColor.rgb + GetInstanceMaterial(instanceId).selfLight);
 			}
 
 			resColor.a *= (1.0 - hitColor.a);
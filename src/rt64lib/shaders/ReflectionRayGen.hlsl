@@ -75,11 +75,11 @@ void ReflectionRayGen() {
 		float alphaContrib = (resColor.a * hitColor.a);
 		if (alphaContrib >= EPSILON) {
 			uint hitInstanceId = gHitInstanceId[hitBufferIndex];
-			bool usesLighting = (instanceMaterials[hitInstanceId].lightGroupMaskBits > 0);
+			bool usesLighting = (GetInstanceMaterial(hitInstanceId).lightGroupMaskBits > 0);
 			float3 vertexPosition = shadingPosition + rayDirection * WithoutDistanceBias(gHitDistAndFlow[hitBufferIndex].x, hitInstanceId);
 
 			// Calculate the fog for the resulting color using the camera data if the option is enabled.
-			if (instanceMaterials[hitInstanceId].fogEnabled) {
+			if (GetInstanceMaterial(hitInstanceId).fogEnabled) {
 				float4 fogColor = ComputeFogFromOrigin(hitInstanceId, vertexPosition, shadingPosition);
 				resTransparent += fogColor.rgb * fogColor.a * alphaContrib;
 				alphaContrib *= (1.0f - fogColor.a);
@@ -87,10 +87,10 @@ void ReflectionRayGen() {
 
 			float3 vertexNormal = gHitNormal[hitBufferIndex].xyz;
 			float3 vertexSpecular = gHitSpecular[hitBufferIndex].rgb;
-			float3 specular = instanceMaterials[hitInstanceId].specularColor * vertexSpecular.rgb;
-			float reflectionFactor = instanceMaterials[hitInstanceId].reflectionFactor;
+			float3 specular = GetInstanceMaterial(hitInstanceId).specularColor * vertexSpecular.rgb;
+			float reflectionFactor = GetInstanceMaterial(hitInstanceId).reflectionFactor;
 			if (reflectionFactor > EPSILON) {
-				float reflectionFresnelFactor = instanceMaterials[instanceId].reflectionFresnelFactor;
+				float reflectionFresnelFactor = GetInstanceMaterial(instanceId).reflectionFresnelFactor;
 				float fresnelAmount = FresnelReflectAmount(vertexNormal, rayDirection, reflectionFactor, reflectionFresnelFactor);
 				newReflectionAlpha += fresnelAmount * alphaContrib * reflectionAlpha;
 			}
@@ -99,7 +99,7 @@ void ReflectionRayGen() {
 				resColor.rgb += hitColor.rgb * alphaContrib;
 			}
 			else {
-				resTransparent += hitColor.rgb * alphaContrib * (ambientBaseColor.rgb + ambientNoGIColor.rgb + instanceMaterials[hitInstanceId].selfLight);
+				resTransparent += hitColor.rgb * alphaContrib * (ambientBaseColor.rgb + ambientNoGIColor.rgb + GetInstanceMaterial(hitInstanceId).selfLight);
 			}
 
 			resPosition = vertexPosition;
@@ -115,7 +115,7 @@ void ReflectionRayGen() {
 	}
 
 	if (resInstanceId >= 0) {
-		float3 directLight = ComputeLightsRandom(launchIndex, rayDirection, resInstanceId, resPosition, resNormal, resSpecular, 1, false) + instanceMaterials[resInstanceId].selfLight;
+		float3 directLight = ComputeLightsRandom(launchIndex, rayDirection, resInstanceId, resPosition, resNormal, resSpecular, 1, false) + GetInstanceMaterial(resInstanceId).selfLight;
 		resColor.rgb *= (ambientBaseColor.rgb + ambientNoGIColor.rgb + directLight);
 		gShadingPosition[launchIndex] = float4(resPosition, 0.0f);
 		gViewDirection[launchIndex] = float4(rayDirection, 0.0f);
@@ -131,7 +131,7 @@ void ReflectionRayGen() {
 	const float3 HighlightColor = float3(1.0f, 1.05f, 1.2f);
 	const float3 ShadowColor = float3(0.1f, 0.05f, 0.0f);
 	const float BlendingExponent = 3.0f;
-	float reflectionShineFactor = instanceMaterials[instanceId].reflectionShineFactor;
+	float reflectionShineFactor = GetInstanceMaterial(instanceId).reflectionShineFactor;
 	resColor.rgb = lerp(resColor.rgb, HighlightColor, pow(max(rayDirection.y, 0.0f) * reflectionShineFactor, BlendingExponent));
 	resColor.rgb = lerp(resColor.rgb, ShadowColor, pow(max(-rayDirection.y, 0.0f) * reflectionShineFactor, BlendingExponent));
 
@@ -30,7 +30,7 @@ void RefractionRayGen() {
 	float3 rayOrigin = gShadingPosition[launchIndex].xyz;
 	float3 viewDirection = gViewDirection[launchIndex].xyz;
 	float3 shadingNormal = gShadingNormal[launchIndex].xyz;
-	float refractionFactor = instanceMaterials[instanceId].refractionFactor;
+	float refractionFactor = GetInstanceMaterial(instanceId).refractionFactor;
 	float3 rayDirection = refract(viewDirection, shadingNormal, refractionFactor);
 	float newRefractionAlpha = 0.0f;
 
@@ -71,11 +71,11 @@ void RefractionRayGen() {
 		float alphaContrib = (resColor.a * hitColor.a);
 		if (alphaContrib >= EPSILON) {
 			uint hitInstanceId = gHitInstanceId[hitBufferIndex];
-			bool usesLighting = (instanceMaterials[hitInstanceId].lightGroupMaskBits > 0);
+			bool usesLighting = (GetInstanceMaterial(hitInstanceId).lightGroupMaskBits > 0);
 			float3 vertexPosition = rayOrigin + rayDirection * WithoutDistanceBias(gHitDistAndFlow[hitBufferIndex].x, hitInstanceId);
 
 			// Calculate the fog for the resulting color using the camera data if the option is enabled.
-			if (instanceMaterials[hitInstanceId].fogEnabled) {
+			if (GetInstanceMaterial(hitInstanceId).fogEnabled) {
 				float4 fogColor = ComputeFogFromCamera(hitInstanceId, vertexPosition);
 				resTransparent += fogColor.rgb * fogColor.a * alphaContrib;
 				alphaContrib *= (1.0f - fogColor.a);
@@ -84,7 +84,7 @@ void RefractionRayGen() {
 			if (usesLighting) {
 				float3 vertexNormal = gHitNormal[hitBufferIndex].xyz;
 				float3 vertexSpecular = gHitSpecular[hitBufferIndex].rgb;
-				float3 specular = instanceMaterials[hitInstanceId].specularColor * vertexSpecular.rgb;
+				float3 specular = GetInstanceMaterial(hitInstanceId).specularColor * vertexSpecular.rgb;
 				resColor.rgb += hitColor.rgb * alphaContrib;
 				resPosition = vertexPosition;
 				resNormal = vertexNormal;
@@ -92,7 +92,7 @@ void RefractionRayGen() {
 				resInstanceId = hitInstanceId;
 			}
 			else {
-				resTransparent += hitColor.rgb * alphaContrib * (ambientBaseColor.rgb + ambientNoGIColor.rgb + instanceMaterials[hitInstanceId].selfLight);
+				resTransparent += hitColor.rgb * alphaContrib * (ambientBaseColor.rgb + ambientNoGIColor.rgb + GetInstanceMaterial(hitInstanceId).selfLight);
 			}
 
 			resColor.a *= (1.0 - hitColor.a);
@@ -104,7 +104,7 @@ void RefractionRayGen() {
 	}
 
 	if (resInstanceId >= 0) {
-		float3 directLight = ComputeLightsRandom(launchIndex, rayDirection, resInstanceId, resPosition, resNormal, resSpecular, 1, true) + instanceMaterials[resInstanceId].selfLight;
+		float3 directLight = ComputeLightsRandom(launchIndex, rayDirection, resInstanceId, resPosition, resNormal, resSpecular, 1, true) + GetInstanceMaterial(resInstanceId).selfLight;
 		resColor.rgb *= (ambientBaseColor.rgb + ambientNoGIColor.rgb + directLight);
 	}
 
@@ -0,0 +1,62 @@
+//
+// RT64 TESTS
+//
+
+#include "tests.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+// Runs the CPU tests for the library. The name of a test can be passed to only run the ones that contain it.
+// The process returns a non-zero code if any test fails, so the project fails to build when a test breaks.
+
+namespace {
+	struct Test {
+		const char *name;
+		Tests::Function function;
+	};
+
+	std::vector<Test> &tests() {
+		// Registrations run during static initialization, so the list must be created on first use.
+		static std::vector<Test> list;
+		return list;
+	}
+
+	unsigned int failedChecks = 0;
+};
+
+Tests::Registration::Registration(const char *name, Function function) {
+	tests().push_back({ name, function });
+}
+
+void Tests::fail(const char *file, int line, const char *expression) {
+	fprintf(stderr, "%s(%d): check failed: %s\n", file, line, expression);
+	failedChecks++;
+}
+
+int main(int argc, char *argv[]) {
+	const char *filter = (argc > 1) ? argv[1] : nullptr;
+	unsigned int runCount = 0;
+	unsigned int failedCount = 0;
+	for (const Test &test : tests()) {
+		if ((filter != nullptr) && (strstr(test.name, filter) == nullptr)) {
+			continue;
+		}
+
+		failedChecks = 0;
+		test.function();
+		runCount++;
+
+		if (failedChecks > 0) {
+			fprintf(stdout, "[FAIL] %s\n", test.name);
+			failedCount++;
+		}
+		else {
+			fprintf(stdout, "[ OK ] %s\n", test.name);
+		}
+	}
+
+	fprintf(stdout, "%u tests run, %u failed.\n", runCount, failedCount);
+	return (failedCount > 0) ? 1 : 0;
+}
@@ -0,0 +1,115 @@
+//
+// RT64 TESTS
+//
+
+#include "tests.h"
+
+#ifndef RT64_MINIMAL
+
+#include "rt64_descriptor_cache.h"
+
+#include <vector>
+
+namespace {
+	// Records the slots that were written instead of creating any views.
+	class RecordingWriter : public RT64::DescriptorWriter {
+	public:
+		std::vector<uint32_t> writtenSlots;
+
+		void write(Type type, uint32_t slot, void *resource, const void *desc) override {
+			writtenSlots.push_back(slot);
+		}
+	};
+
+	// Stands in for a view description. Only its bytes are compared by the cache.
+	struct FakeDesc {
+		uint32_t format;
+		uint32_t elementCount;
+	};
+
+	// The cache never dereferences the resources, so any distinct addresses work.
+	void *fakeResource(int index) {
+		static char storage[16];
+		return &storage[index];
+	}
+};
+
+TEST(DescriptorCacheSkipsIdenticalWrites) {
+	RT64::DescriptorCache cache;
+	RecordingWriter writer;
+	cache.resize(4);
+	const FakeDesc desc = { 1, 16 };
+	CHECK(cache.write(&writer, RT64::DescriptorWriter::Type::ShaderResource, 2, fakeResource(0), 1, desc));
+	CHECK(!cache.write(&writer, RT64::DescriptorWriter::Type::ShaderResource, 2, fakeResource(0), 1, desc));
+	CHECK((writer.writtenSlots.size() == 1) && (writer.writtenSlots[0] == 2));
+}
+
+TEST(DescriptorCacheWritesChangedDescriptors) {
+	RT64::DescriptorCache cache;
+	RecordingWriter writer;
+	cache.resize(4);
+	const FakeDesc desc = { 1, 16 };
+	cache.write(&writer, RT64::DescriptorWriter::Type::ShaderResource, 0, fakeResource(0), 1, desc);
+
+	const FakeDesc biggerDesc = { 1, 32 };
+	CHECK(cache.write(&writer, RT64::DescriptorWriter::Type::ShaderResource, 0, fakeResource(0), 1, biggerDesc));
+	CHECK(cache.write(&writer, RT64::DescriptorWriter::Type::ShaderResource, 0, fakeResource(1), 1, biggerDesc));
+	CHECK(cache.write(&writer, RT64::DescriptorWriter::Type::UnorderedAccess, 0, fakeResource(1), 1, biggerDesc));
+
+	// Other slots are tracked on their own.
+	CHECK(cache.write(&writer, RT64::DescriptorWriter::Type::UnorderedAccess, 1, fakeResource(1), 1, biggerDesc));
+	CHECK(writer.writtenSlots.size() == 5);
+}
+
+TEST(DescriptorCacheWritesRecreatedResourceAtSameAddress) {
+	RT64::DescriptorCache cache;
+	RecordingWriter writer;
+	cache.resize(2);
+	const FakeDesc desc = { 1, 16 };
+	CHECK(cache.write(&writer, RT64::DescriptorWriter::Type::ShaderResource, 0, fakeResource(0), 1, desc));
+
+	// A resource that was released and created again can land in the same memory with the same description. Only the
+	// new generation tells the cache that the descriptor points to a resource that no longer exists.
+	CHECK(cache.write(&writer, RT64::DescriptorWriter::Type::ShaderResource, 0, fakeResource(0), 2, desc));
+	CHECK(!cache.write(&writer, RT64::DescriptorWriter::Type::ShaderResource, 0, fakeResource(0), 2, desc));
+	CHECK(writer.writtenSlots.size() == 2);
+}
+
+TEST(DescriptorCacheResizeForgetsAllSlots) {
+	RT64::DescriptorCache cache;
+	RecordingWriter writer;
+	const FakeDesc desc = { 1, 16 };
+	cache.resize(3);
+	for (uint32_t slot = 0; slot < 3; slot++) {
+		cache.write(&writer, RT64::DescriptorWriter::Type::ConstantBuffer, slot, fakeResource(slot), 1, desc);
+	}
+
+	// Growing the heap recreates it, so the slots that were kept must be written again.
+	cache.resize(5);
+	CHECK(cache.size() == 5);
+	for (uint32_t slot = 0; slot < 3; slot++) {
+		CHECK(cache.write(&writer, RT64::DescriptorWriter::Type::ConstantBuffer, slot, fakeResource(slot), 1, desc));
+	}
+
+	// So does shrinking it or resizing it to the same size.
+	cache.resize(2);
+	CHECK(cache.write(&writer, RT64::DescriptorWriter::Type::ConstantBuffer, 1, fakeResource(1), 1, desc));
+	cache.resize(2);
+	CHECK(cache.write(&writer, RT64::DescriptorWriter::Type::ConstantBuffer, 1, fakeResource(1), 1, desc));
+	CHECK(writer.writtenSlots.size() == 8);
+}
+
+TEST(DescriptorCacheInvalidateForgetsAllSlots) {
+	RT64::DescriptorCache cache;
+	RecordingWriter writer;
+	const FakeDesc desc = { 1, 16 };
+	cache.resize(2);
+	cache.write(&writer, RT64::DescriptorWriter::Type::ShaderResource, 0, fakeResource(0), 1, desc);
+	cache.write(&writer, RT64::DescriptorWriter::Type::ShaderResource, 1, fakeResource(1), 1, desc);
+	cache.invalidate();
+	CHECK(cache.size() == 2);
+	CHECK(cache.write(&writer, RT64::DescriptorWriter::Type::ShaderResource, 0, fakeResource(0), 1, desc));
+	CHECK(cache.write(&writer, RT64::DescriptorWriter::Type::ShaderResource, 1, fakeResource(1), 1, desc));
+}
+
+#endif
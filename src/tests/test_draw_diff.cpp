@@ -0,0 +1,235 @@
+//
+// RT64 TESTS
+//
+
+#include "tests.h"
+
+#ifndef RT64_MINIMAL
+
+#include "rt64_draw_diff.h"
+
+#include <random>
+#include <unordered_map>
+
+namespace {
+	// The std::unordered_map version DrawDiff used before its open-addressing table. The results must stay identical.
+	class ReferenceDrawDiff {
+	private:
+		std::vector<uint64_t> slotHashes;
+		std::vector<uint32_t> slotNext;
+		std::vector<uint8_t> slotMatched;
+		std::vector<uint32_t> activeSlots;
+		std::vector<uint32_t> freeSlots;
+		std::unordered_map<uint64_t, uint32_t> hashSlots;
+
+		uint32_t allocateSlot() {
+			if (!freeSlots.empty()) {
+				uint32_t slot = freeSlots.back();
+				freeSlots.pop_back();
+				return slot;
+			}
+
+			uint32_t slot = (uint32_t)(slotHashes.size());
+			slotHashes.push_back(0);
+			slotNext.push_back(RT64::DrawDiff::InvalidSlot);
+			slotMatched.push_back(0);
+			return slot;
+		}
+	public:
+		RT64::DrawDiff::Stats stats = {};
+
+		void diff(const std::vector<uint64_t> &hashes, std::vector<RT64::DrawDiff::Result> &results, std::vector<uint32_t> &retiredSlots) {
+			stats = {};
+			results.resize(hashes.size());
+			retiredSlots.clear();
+
+			hashSlots.clear();
+			for (size_t i = activeSlots.size(); i > 0; i--) {
+				uint32_t slot = activeSlots[i - 1];
+				auto it = hashSlots.find(slotHashes[slot]);
+				if (it != hashSlots.end()) {
+					slotNext[slot] = it->second;
+					it->second = slot;
+				}
+				else {
+					slotNext[slot] = RT64::DrawDiff::InvalidSlot;
+					hashSlots[slotHashes[slot]] = slot;
+				}
+
+				slotMatched[slot] = 0;
+			}
+
+			for (size_t i = 0; i < hashes.size(); i++) {
+				auto it = hashSlots.find(hashes[i]);
+				if ((it != hashSlots.end()) && (it->second != RT64::DrawDiff::InvalidSlot)) {
+					uint32_t slot = it->second;
+					it->second = slotNext[slot];
+					slotMatched[slot] = 1;
+					results[i] = { RT64::DrawDiff::Match::Reused, slot };
+					stats.reused++;
+				}
+				else {
+					results[i] = { RT64::DrawDiff::Match::Created, RT64::DrawDiff::InvalidSlot };
+				}
+			}
+
+			size_t recycleIndex = 0;
+			for (size_t i = 0; i < hashes.size(); i++) {
+				if (results[i].slot != RT64::DrawDiff::InvalidSlot) {
+					continue;
+				}
+
+				while ((recycleIndex < activeSlots.size()) && slotMatched[activeSlots[recycleIndex]]) {
+					recycleIndex++;
+				}
+
+				if (recycleIndex < activeSlots.size()) {
+					uint32_t slot = activeSlots[recycleIndex++];
+					slotMatched[slot] = 1;
+					results[i] = { RT64::DrawDiff::Match::Recycled, slot };
+					stats.recycled++;
+				}
+				else {
+					results[i] = { RT64::DrawDiff::Match::Created, allocateSlot() };
+					stats.created++;
+				}
+
+				slotHashes[results[i].slot] = hashes[i];
+			}
+
+			for (uint32_t slot : activeSlots) {
+				if (!slotMatched[slot]) {
+					retiredSlots.push_back(slot);
+					freeSlots.push_back(slot);
+					stats.retired++;
+				}
+			}
+
+			activeSlots.clear();
+			for (const RT64::DrawDiff::Result &result : results) {
+				activeSlots.push_back(result.slot);
+			}
+		}
+
+		size_t getSlotCount() const {
+			return slotHashes.size();
+		}
+	};
+
+	bool sameResults(const std::vector<RT64::DrawDiff::Result> &a, const std::vector<RT64::DrawDiff::Result> &b) {
+		if (a.size() != b.size()) {
+			return false;
+		}
+
+		for (size_t i = 0; i < a.size(); i++) {
+			if ((a[i].match != b[i].match) || (a[i].slot != b[i].slot)) {
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	bool sameStats(const RT64::DrawDiff::Stats &a, const RT64::DrawDiff::Stats &b) {
+		return (a.reused == b.reused) && (a.recycled == b.recycled) && (a.created == b.created) && (a.retired == b.retired);
+	}
+
+	// Runs both diffs over the same random frames and counts the frames where they disagree.
+	int countMismatchedFrames(uint32_t seed, int frameCount, size_t maxDrawCount, uint64_t hashCount, int hashShift) {
+		std::mt19937 random(seed);
+		RT64::DrawDiff drawDiff;
+		ReferenceDrawDiff referenceDiff;
+		std::vector<uint64_t> hashes;
+		std::vector<RT64::DrawDiff::Result> results, referenceResults;
+		std::vector<uint32_t> retiredSlots, referenceRetiredSlots;
+		int mismatchedFrames = 0;
+		for (int f = 0; f < frameCount; f++) {
+			// Most frames only change a few draws from the previous one, like a game would.
+			if (hashes.empty() || ((random() % 8) == 0)) {
+				hashes.resize(random() % (maxDrawCount + 1));
+				for (uint64_t &hash : hashes) {
+					hash = (random() % hashCount) << hashShift;
+				}
+			}
+			else {
+				size_t changes = random() % 4;
+				for (size_t c = 0; (c < changes) && !hashes.empty(); c++) {
+					hashes[random() % hashes.size()] = (random() % hashCount) << hashShift;
+				}
+
+				if ((random() % 4) == 0) {
+					hashes.push_back((random() % hashCount) << hashShift);
+				}
+				else if (((random() % 4) == 0) && !hashes.empty()) {
+					hashes.erase(hashes.begin() + (random() % hashes.size()));
+				}
+			}
+
+			drawDiff.diff(hashes, results, retiredSlots);
+			referenceDiff.diff(hashes, referenceResults, referenceRetiredSlots);
+			bool sameFrame = sameResults(results, referenceResults) && (retiredSlots == referenceRetiredSlots) &&
+				sameStats(drawDiff.getStats(), referenceDiff.stats) && (drawDiff.getSlotCount() == referenceDiff.getSlotCount());
+
+			if (!sameFrame) {
+				mismatchedFrames++;
+			}
+		}
+
+		return mismatchedFrames;
+	}
+};
+
+TEST(DrawDiffMatchesReferenceWithUniqueHashes) {
+	CHECK(countMismatchedFrames(1, 1000, 64, 1ULL << 32, 0) == 0);
+}
+
+TEST(DrawDiffMatchesReferenceWithRepeatedHashes) {
+	// Few distinct hashes, so most draws share their content with several others.
+	CHECK(countMismatchedFrames(2, 1000, 64, 6, 0) == 0);
+}
+
+TEST(DrawDiffMatchesReferenceWithCollidingBuckets) {
+	// The lower bits of every hash are the same, so all of them probe from the same bucket.
+	CHECK(countMismatchedFrames(3, 1000, 48, 32, 40) == 0);
+}
+
+TEST(DrawDiffMatchesReferenceWithGrowingFrames) {
+	// Large frames make the table grow past its initial size.
+	CHECK(countMismatchedFrames(4, 200, 2000, 300, 0) == 0);
+}
+
+TEST(DrawDiffReusesRepeatedContentInOrder) {
+	RT64::DrawDiff drawDiff;
+	std::vector<RT64::DrawDiff::Result> results;
+	std::vector<uint32_t> retiredSlots;
+	drawDiff.diff({ 7, 7, 9 }, results, retiredSlots);
+	CHECK(drawDiff.getStats().created == 3);
+	const uint32_t firstSlot = results[0].slot;
+	const uint32_t secondSlot = results[1].slot;
+
+	drawDiff.diff({ 9, 7, 7 }, results, retiredSlots);
+	CHECK(drawDiff.getStats().reused == 3);
+	CHECK(retiredSlots.empty());
+	CHECK((results[1].slot == firstSlot) && (results[2].slot == secondSlot));
+}
+
+TEST(DrawDiffRecyclesBeforeCreating) {
+	RT64::DrawDiff drawDiff;
+	std::vector<RT64::DrawDiff::Result> results;
+	std::vector<uint32_t> retiredSlots;
+	drawDiff.diff({ 1, 2, 3 }, results, retiredSlots);
+	drawDiff.diff({ 1, 4, 5, 6 }, results, retiredSlots);
+	CHECK(results[0].match == RT64::DrawDiff::Match::Reused);
+	CHECK((results[1].match == RT64::DrawDiff::Match::Recycled) && (results[2].match == RT64::DrawDiff::Match::Recycled));
+	CHECK(results[3].match == RT64::DrawDiff::Match::Created);
+	CHECK(drawDiff.getSlotCount() == 4);
+
+	// The slots left over by a smaller frame are retired and created again later.
+	drawDiff.diff({ 1 }, results, retiredSlots);
+	CHECK(retiredSlots.size() == 3);
+	drawDiff.diff({ 1, 8 }, results, retiredSlots);
+	CHECK(results[1].match == RT64::DrawDiff::Match::Created);
+	CHECK(drawDiff.getSlotCount() == 4);
+}
+
+#endif
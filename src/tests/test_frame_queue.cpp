@@ -0,0 +1,142 @@
+//
+// RT64 TESTS
+//
+
+#include "tests.h"
+
+#ifndef RT64_MINIMAL
+
+#include "rt64_frame_queue.h"
+
+#include <stdint.h>
+#include <thread>
+#include <vector>
+
+namespace {
+	// Stands in for the device's frame snapshots: a sequence number and the draws recorded for the frame.
+	struct FakeFrame {
+		uint32_t sequence;
+		std::vector<uint32_t> draws;
+	};
+
+	void recordFrame(FakeFrame &frame, uint32_t sequence) {
+		frame.sequence = sequence;
+		frame.draws.clear();
+		for (uint32_t i = 0; i < (sequence % 7) + 1; i++) {
+			frame.draws.push_back(sequence * 16 + i);
+		}
+	}
+
+	// Fake draw consumer. Returns whether the frame holds the draws recorded for the expected sequence number.
+	bool drawFrame(const FakeFrame &frame, uint32_t expectedSequence) {
+		if ((frame.sequence != expectedSequence) || (frame.draws.size() != ((expectedSequence % 7) + 1))) {
+			return false;
+		}
+
+		for (uint32_t i = 0; i < frame.draws.size(); i++) {
+			if (frame.draws[i] != (expectedSequence * 16 + i)) {
+				return false;
+			}
+		}
+
+		return true;
+	}
+};
+
+TEST(FrameQueueEmptyAndFull) {
+	RT64::FrameQueue<FakeFrame, 2> queue;
+	CHECK(queue.beginRead() == nullptr);
+	CHECK(queue.size() == 0);
+
+	for (uint32_t i = 0; i < 2; i++) {
+		FakeFrame *frame = queue.beginWrite();
+		CHECK(frame != nullptr);
+		if (frame != nullptr) {
+			recordFrame(*frame, i);
+			queue.endWrite();
+		}
+	}
+
+	CHECK(queue.size() == 2);
+	CHECK(queue.beginWrite() == nullptr);
+
+	// Reading a frame without releasing it keeps the slot taken.
+	CHECK(queue.beginRead() != nullptr);
+	CHECK(queue.beginWrite() == nullptr);
+	queue.endRead();
+	CHECK(queue.beginWrite() != nullptr);
+
+	queue.beginRead();
+	queue.endRead();
+	CHECK(queue.beginRead() == nullptr);
+	CHECK(queue.size() == 0);
+}
+
+TEST(FrameQueueOrderAcrossWraparound) {
+	RT64::FrameQueue<FakeFrame, 3> queue;
+	uint32_t writeSequence = 0;
+	uint32_t readSequence = 0;
+	int mismatches = 0;
+
+	// Alternate between filling the queue and draining part of it, so the indices wrap around many times at different offsets.
+	for (int round = 0; round < 50; round++) {
+		FakeFrame *frame;
+		while ((frame = queue.beginWrite()) != nullptr) {
+			recordFrame(*frame, writeSequence++);
+			queue.endWrite();
+		}
+
+		const int readCount = (round % 3) + 1;
+		for (int i = 0; i < readCount; i++) {
+			frame = queue.beginRead();
+			if ((frame == nullptr) || !drawFrame(*frame, readSequence)) {
+				mismatches++;
+			}
+
+			readSequence++;
+			queue.endRead();
+		}
+	}
+
+	CHECK(mismatches == 0);
+	CHECK(queue.size() == (writeSequence - readSequence));
+}
+
+TEST(FrameQueueProducerConsumerThreads) {
+	const uint32_t FrameCount = 20000;
+	RT64::FrameQueue<FakeFrame, 2> queue;
+	std::thread producer([&]() {
+		for (uint32_t i = 0; i < FrameCount; i++) {
+			FakeFrame *frame;
+			while ((frame = queue.beginWrite()) == nullptr) {
+				std::this_thread::yield();
+			}
+
+			recordFrame(*frame, i);
+			queue.endWrite();
+		}
+	});
+
+	uint32_t drawnFrames = 0;
+	int mismatches = 0;
+	while (drawnFrames < FrameCount) {
+		FakeFrame *frame = queue.beginRead();
+		if (frame == nullptr) {
+			std::this_thread::yield();
+			continue;
+		}
+
+		if (!drawFrame(*frame, drawnFrames)) {
+			mismatches++;
+		}
+
+		drawnFrames++;
+		queue.endRead();
+	}
+
+	producer.join();
+	CHECK(mismatches == 0);
+	CHECK(queue.beginRead() == nullptr);
+}
+
+#endif
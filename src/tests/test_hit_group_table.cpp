@@ -0,0 +1,67 @@
+//
+// RT64 TESTS
+//
+
+#include "tests.h"
+
+#ifndef RT64_MINIMAL
+
+#include "rt64_hit_group_table.h"
+
+#include <vector>
+
+namespace {
+	// The table never dereferences the shaders, so any distinct addresses work.
+	RT64::Shader *fakeShader(size_t index) {
+		static std::vector<char> storage(4096 * 16);
+		return reinterpret_cast<RT64::Shader *>(&storage[index * 16]);
+	}
+};
+
+TEST(HitGroupTableSharesIndicesPerShader) {
+	RT64::HitGroupTable table;
+	table.begin();
+	CHECK(table.intern(fakeShader(3)) == 0);
+	CHECK(table.intern(fakeShader(1)) == 1);
+	CHECK(table.intern(fakeShader(3)) == 0);
+	CHECK(table.intern(fakeShader(2)) == 2);
+	CHECK(table.intern(fakeShader(1)) == 1);
+	CHECK(table.size() == 3);
+
+	// The shaders keep the order they were first seen in, which is the order of their hit groups.
+	const std::vector<RT64::Shader *> &shaders = table.getShaders();
+	CHECK((shaders.size() == 3) && (shaders[0] == fakeShader(3)) && (shaders[1] == fakeShader(1)) && (shaders[2] == fakeShader(2)));
+}
+
+TEST(HitGroupTableBeginForgetsShaders) {
+	RT64::HitGroupTable table;
+	table.begin();
+	table.intern(fakeShader(0));
+	table.intern(fakeShader(1));
+	table.begin();
+	CHECK(table.size() == 0);
+	CHECK(table.intern(fakeShader(1)) == 0);
+	CHECK(table.intern(fakeShader(0)) == 1);
+}
+
+TEST(HitGroupTableGrowsPastInitialBuckets) {
+	// Shaders that are placed right next to each other share the lower bits of their addresses.
+	const size_t ShaderCount = 4096;
+	RT64::HitGroupTable table;
+	for (int pass = 0; pass < 2; pass++) {
+		table.begin();
+		int mismatches = 0;
+		for (size_t repeat = 0; repeat < 2; repeat++) {
+			for (size_t i = 0; i < ShaderCount; i++) {
+				if (table.intern(fakeShader(i)) != i) {
+					mismatches++;
+				}
+			}
+		}
+
+		CHECK(mismatches == 0);
+		CHECK(table.size() == ShaderCount);
+	}
+}
+
+#endif
@@ -0,0 +1,140 @@
+//
+// RT64 TESTS
+//
+
+#include "tests.h"
+
+#ifndef RT64_MINIMAL
+
+#include "rt64_instance_extraction.h"
+#include "rt64_worker_pool.h"
+
+#include <vector>
+
+namespace {
+	const size_t ListCount = RT64::InstanceExtraction::ListCount;
+
+	// Lists hold the index of every instance in the scene, which is what the view's lists point back to.
+	struct Lists {
+		std::vector<size_t> sceneIndices[ListCount];
+	};
+
+	// Spreads the instances unevenly so the chunks contribute a different amount to every list.
+	size_t classifyInstance(size_t i) {
+		if ((i % 7) == 0) {
+			return 1;
+		}
+		else if ((i % 3) == 0) {
+			return 2;
+		}
+		else {
+			return 0;
+		}
+	}
+
+	Lists extract(unsigned int threadCount, size_t instanceCount) {
+		RT64::WorkerPool workerPool(threadCount - 1);
+		RT64::InstanceExtraction extraction;
+		extraction.classify(workerPool, instanceCount, [](size_t i) {
+			return classifyInstance(i);
+		});
+
+		Lists lists;
+		for (size_t l = 0; l < ListCount; l++) {
+			lists.sceneIndices[l].assign(extraction.getListSize(l), SIZE_MAX);
+		}
+
+		extraction.fill(workerPool, [&](size_t i, size_t listIndex, size_t j) {
+			lists.sceneIndices[listIndex][j] = i;
+		});
+
+		return lists;
+	}
+
+	// Every instance must show up once, in the list it was classified into, after the instances that come before it.
+	bool inSceneOrder(const Lists &lists, size_t instanceCount) {
+		size_t totalCount = 0;
+		for (size_t l = 0; l < ListCount; l++) {
+			const std::vector<size_t> &sceneIndices = lists.sceneIndices[l];
+			for (size_t j = 0; j < sceneIndices.size(); j++) {
+				if ((sceneIndices[j] >= instanceCount) || (classifyInstance(sceneIndices[j]) != l)) {
+					return false;
+				}
+
+				if ((j > 0) && (sceneIndices[j] <= sceneIndices[j - 1])) {
+					return false;
+				}
+			}
+
+			totalCount += sceneIndices.size();
+		}
+
+		return totalCount == instanceCount;
+	}
+
+	bool listsEqual(const Lists &a, const Lists &b) {
+		for (size_t l = 0; l < ListCount; l++) {
+			if (a.sceneIndices[l] != b.sceneIndices[l]) {
+				return false;
+			}
+		}
+
+		return true;
+	}
+};
+
+TEST(InstanceExtractionEmpty) {
+	Lists lists = extract(4, 0);
+	for (size_t l = 0; l < ListCount; l++) {
+		CHECK(lists.sceneIndices[l].empty());
+	}
+}
+
+TEST(InstanceExtractionSingleThreadKeepsSceneOrder) {
+	// Less than a chunk, exactly one chunk and a partial last chunk.
+	const size_t ChunkSize = RT64::InstanceExtraction::ChunkSize;
+	const size_t InstanceCounts[] = { 1, 100, ChunkSize, ChunkSize * 5 + 17 };
+	for (size_t instanceCount : InstanceCounts) {
+		CHECK(inSceneOrder(extract(1, instanceCount), instanceCount));
+	}
+}
+
+TEST(InstanceExtractionThreadsMatchSingleThread) {
+	const size_t InstanceCount = RT64::InstanceExtraction::ChunkSize * 40 + 123;
+	Lists singleThread = extract(1, InstanceCount);
+	CHECK(inSceneOrder(singleThread, InstanceCount));
+
+	const unsigned int ThreadCounts[] = { 2, 4, 8 };
+	for (unsigned int threadCount : ThreadCounts) {
+		Lists multipleThreads = extract(threadCount, InstanceCount);
+		CHECK(inSceneOrder(multipleThreads, InstanceCount));
+		CHECK(listsEqual(multipleThreads, singleThread));
+	}
+}
+
+TEST(InstanceExtractionReusedWithFewerInstances) {
+	// The extraction is kept by the view between updates, so a smaller scene must not see the offsets of a larger one.
+	const size_t ChunkSize = RT64::InstanceExtraction::ChunkSize;
+	RT64::WorkerPool workerPool(3);
+	RT64::InstanceExtraction extraction;
+	const size_t InstanceCounts[] = { ChunkSize * 10, ChunkSize + 5, 3 };
+	for (size_t instanceCount : InstanceCounts) {
+		extraction.classify(workerPool, instanceCount, [](size_t i) {
+			return classifyInstance(i);
+		});
+
+		Lists lists;
+		for (size_t l = 0; l < ListCount; l++) {
+			lists.sceneIndices[l].assign(extraction.getListSize(l), SIZE_MAX);
+		}
+
+		extraction.fill(workerPool, [&](size_t i, size_t listIndex, size_t j) {
+			lists.sceneIndices[listIndex][j] = i;
+		});
+
+		CHECK(inSceneOrder(lists, instanceCount));
+		CHECK(listsEqual(lists, extract(1, instanceCount)));
+	}
+}
+
+#endif
@@ -0,0 +1,171 @@
+//
+// RT64 TESTS
+//
+
+#include "tests.h"
+
+#ifndef RT64_MINIMAL
+
+#include "rt64_material_table.h"
+
+#include <utility>
+#include <vector>
+
+namespace {
+	RT64_MATERIAL makeMaterial(int diffuseTexIndex, float reflectionFactor) {
+		RT64_MATERIAL material = {};
+		material.diffuseTexIndex = diffuseTexIndex;
+		material.normalTexIndex = -1;
+		material.specularTexIndex = -1;
+		material.reflectionFactor = reflectionFactor;
+		material.diffuseColorMix = { 1.0f, 0.5f, 0.25f, 0.0f };
+		return material;
+	}
+
+	// Runs a whole pass and returns whether the table reported a change.
+	bool internPass(RT64::MaterialTable &table, const std::vector<RT64_MATERIAL> &materials, std::vector<uint32_t> &indices) {
+		table.begin();
+		indices.clear();
+		for (const RT64_MATERIAL &material : materials) {
+			indices.push_back(table.intern(material));
+		}
+
+		return table.end();
+	}
+};
+
+TEST(MaterialTableDeduplicatesByContent) {
+	RT64::MaterialTable table;
+	table.begin();
+	uint32_t first = table.intern(makeMaterial(0, 0.5f));
+	uint32_t second = table.intern(makeMaterial(1, 0.5f));
+	uint32_t third = table.intern(makeMaterial(0, 0.75f));
+
+	// Separate copies with the same contents share the index.
+	RT64_MATERIAL copy = makeMaterial(1, 0.5f);
+	CHECK(table.intern(copy) == second);
+	CHECK(table.intern(makeMaterial(0, 0.5f)) == first);
+	CHECK(table.intern(makeMaterial(0, 0.75f)) == third);
+	CHECK((first != second) && (second != third) && (first != third));
+	CHECK(table.size() == 3);
+	table.end();
+}
+
+TEST(MaterialTableIgnoresEnabledAttributes) {
+	RT64::MaterialTable table;
+	table.begin();
+	RT64_MATERIAL material = makeMaterial(2, 0.0f);
+	material.enabledAttributes = RT64_ATTRIBUTE_DIFFUSE_COLOR_MIX;
+	uint32_t index = table.intern(material);
+
+	material.enabledAttributes = RT64_ATTRIBUTE_NONE;
+	CHECK(table.intern(material) == index);
+	material.enabledAttributes = RT64_ATTRIBUTE_DIFFUSE_COLOR_MIX | RT64_ATTRIBUTE_REFLECTION_FACTOR;
+	CHECK(table.intern(material) == index);
+	CHECK(table.size() == 1);
+
+	// The stored material doesn't keep the flags either, so they can't make the uploaded contents differ.
+	CHECK(table.getMaterials()[0].enabledAttributes == 0);
+	table.end();
+}
+
+TEST(MaterialTableKeepsFirstSeenOrder) {
+	RT64::MaterialTable table;
+	std::vector<RT64_MATERIAL> materials = { makeMaterial(3, 0.0f), makeMaterial(1, 0.0f), makeMaterial(3, 0.0f), makeMaterial(2, 0.0f), makeMaterial(1, 0.0f) };
+	std::vector<uint32_t> indices;
+	internPass(table, materials, indices);
+	CHECK(indices == std::vector<uint32_t>({ 0, 1, 0, 2, 1 }));
+	CHECK(table.size() == 3);
+	CHECK(table.getMaterials()[0].diffuseTexIndex == 3);
+	CHECK(table.getMaterials()[1].diffuseTexIndex == 1);
+	CHECK(table.getMaterials()[2].diffuseTexIndex == 2);
+
+	// Every pass starts over, so the indices follow the order of the new pass instead of the old one.
+	std::vector<RT64_MATERIAL> reordered = { makeMaterial(2, 0.0f), makeMaterial(3, 0.0f) };
+	internPass(table, reordered, indices);
+	CHECK(indices == std::vector<uint32_t>({ 0, 1 }));
+	CHECK(table.size() == 2);
+	CHECK(table.getMaterials()[0].diffuseTexIndex == 2);
+	CHECK(table.getMaterials()[1].diffuseTexIndex == 3);
+}
+
+TEST(MaterialTableEndReportsChanges) {
+	RT64::MaterialTable table;
+	std::vector<uint32_t> indices;
+	std::vector<RT64_MATERIAL> materials = { makeMaterial(0, 0.0f), makeMaterial(1, 0.0f) };
+	CHECK(internPass(table, materials, indices));
+
+	// The same contents in the same order aren't a change, even with different flags.
+	CHECK(!internPass(table, materials, indices));
+	materials[1].enabledAttributes = RT64_ATTRIBUTE_REFLECTION_FACTOR;
+	CHECK(!internPass(table, materials, indices));
+
+	// Growing and shrinking change the size.
+	materials.push_back(makeMaterial(2, 0.0f));
+	CHECK(internPass(table, materials, indices));
+	CHECK(!internPass(table, materials, indices));
+	materials.pop_back();
+	CHECK(internPass(table, materials, indices));
+	CHECK(!internPass(table, materials, indices));
+
+	// Same size with different contents or a different order.
+	materials[1].reflectionFactor = 0.5f;
+	CHECK(internPass(table, materials, indices));
+	CHECK(!internPass(table, materials, indices));
+	std::swap(materials[0], materials[1]);
+	CHECK(internPass(table, materials, indices));
+	CHECK(!internPass(table, materials, indices));
+
+	// Going empty and coming back are changes, but staying empty isn't.
+	CHECK(internPass(table, {}, indices));
+	CHECK(!internPass(table, {}, indices));
+	CHECK(internPass(table, materials, indices));
+}
+
+TEST(MaterialTableGrowsPastInitialBuckets) {
+	// The buckets start at 64 and are kept at most half full, so this grows them a few times during a single pass.
+	const int MaterialCount = 1000;
+	RT64::MaterialTable table;
+	std::vector<RT64_MATERIAL> materials;
+	for (int i = 0; i < MaterialCount; i++) {
+		materials.push_back(makeMaterial(i, (float)(i % 7)));
+	}
+
+	std::vector<uint32_t> indices;
+	CHECK(internPass(table, materials, indices));
+	CHECK(table.size() == MaterialCount);
+	bool sequential = true;
+	for (int i = 0; i < MaterialCount; i++) {
+		sequential = sequential && (indices[i] == (uint32_t)(i));
+	}
+
+	CHECK(sequential);
+
+	// Every material is still found after the buckets were rebuilt.
+	table.begin();
+	bool found = true;
+	for (int i = MaterialCount - 1; i >= 0; i--) {
+		found = found && (table.intern(materials[i]) == (uint32_t)(MaterialCount - 1 - i));
+	}
+
+	CHECK(found);
+	CHECK(table.size() == MaterialCount);
+	CHECK(table.end());
+
+	// Interning the pass again after growing finds the duplicates in the larger buckets.
+	table.begin();
+	for (int i = 0; i < MaterialCount; i++) {
+		table.intern(materials[i]);
+	}
+
+	bool deduplicated = true;
+	for (int i = 0; i < MaterialCount; i++) {
+		deduplicated = deduplicated && (table.intern(materials[i]) == (uint32_t)(i));
+	}
+
+	CHECK(deduplicated);
+	CHECK(table.size() == MaterialCount);
+	table.end();
+}
+
+#endif
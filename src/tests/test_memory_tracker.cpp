@@ -0,0 +1,132 @@
+//
+// RT64 TESTS
+//
+
+#include "tests.h"
+
+#ifndef RT64_MINIMAL
+
+#include "rt64_memory_tracker.h"
+
+namespace {
+	// The tracker never dereferences the allocations, so any distinct addresses work.
+	const void *fakeAllocation(int index) {
+		static char storage[16];
+		return &storage[index];
+	}
+
+	struct BudgetCalls {
+		int count = 0;
+		unsigned long long usedBytes = 0;
+		unsigned long long thresholdBytes = 0;
+	};
+
+	void budgetCallback(void *userData, unsigned long long usedBytes, unsigned long long thresholdBytes) {
+		BudgetCalls *calls = (BudgetCalls *)(userData);
+		calls->count++;
+		calls->usedBytes = usedBytes;
+		calls->thresholdBytes = thresholdBytes;
+	}
+};
+
+TEST(MemoryTrackerSumsAllocationsPerCategory) {
+	RT64::MemoryTracker tracker;
+	tracker.add(fakeAllocation(0), 1, 100);
+	tracker.add(fakeAllocation(1), 1, 50);
+	tracker.add(fakeAllocation(2), 3, 1000);
+
+	RT64::MemoryTracker::Totals totals = tracker.getTotals();
+	CHECK(totals.categoryBytes[0] == 0);
+	CHECK(totals.categoryBytes[1] == 150);
+	CHECK(totals.categoryAllocationCount[1] == 2);
+	CHECK(totals.categoryBytes[3] == 1000);
+	CHECK(totals.categoryAllocationCount[3] == 1);
+	CHECK(totals.totalBytes == 1150);
+}
+
+TEST(MemoryTrackerRemovesAllocations) {
+	RT64::MemoryTracker tracker;
+	tracker.add(fakeAllocation(0), 2, 64);
+	tracker.add(fakeAllocation(1), 2, 32);
+	tracker.remove(fakeAllocation(0));
+
+	RT64::MemoryTracker::Totals totals = tracker.getTotals();
+	CHECK(totals.categoryBytes[2] == 32);
+	CHECK(totals.categoryAllocationCount[2] == 1);
+	CHECK(totals.totalBytes == 32);
+
+	// Allocations that aren't tracked are ignored, including ones that were already removed.
+	tracker.remove(fakeAllocation(0));
+	tracker.remove(fakeAllocation(5));
+	totals = tracker.getTotals();
+	CHECK(totals.totalBytes == 32);
+	CHECK(totals.categoryAllocationCount[2] == 1);
+
+	// The same address can be tracked again once it was released.
+	tracker.add(fakeAllocation(0), 4, 8);
+	totals = tracker.getTotals();
+	CHECK(totals.categoryBytes[4] == 8);
+	CHECK(totals.totalBytes == 40);
+}
+
+TEST(MemoryTrackerFiresBudgetOnceWhenCrossed) {
+	RT64::MemoryTracker tracker;
+	BudgetCalls calls;
+	tracker.setBudget(100, budgetCallback, &calls);
+	tracker.add(fakeAllocation(0), 0, 60);
+	CHECK(calls.count == 0);
+
+	tracker.add(fakeAllocation(1), 0, 40);
+	CHECK(calls.count == 1);
+	CHECK(calls.usedBytes == 100);
+	CHECK(calls.thresholdBytes == 100);
+
+	// Staying over the threshold doesn't notify the host again.
+	tracker.add(fakeAllocation(2), 0, 10);
+	CHECK(calls.count == 1);
+}
+
+TEST(MemoryTrackerRearmsBudgetBelowThreshold) {
+	RT64::MemoryTracker tracker;
+	BudgetCalls calls;
+	tracker.setBudget(100, budgetCallback, &calls);
+	tracker.add(fakeAllocation(0), 0, 80);
+	tracker.add(fakeAllocation(1), 0, 30);
+	CHECK(calls.count == 1);
+
+	tracker.remove(fakeAllocation(1));
+	CHECK(calls.count == 1);
+
+	tracker.add(fakeAllocation(2), 0, 20);
+	CHECK(calls.count == 2);
+	CHECK(calls.usedBytes == 100);
+}
+
+TEST(MemoryTrackerFiresBudgetWhenSetBelowUsage) {
+	RT64::MemoryTracker tracker;
+	BudgetCalls calls;
+	tracker.add(fakeAllocation(0), 0, 500);
+	tracker.setBudget(200, budgetCallback, &calls);
+	CHECK(calls.count == 1);
+	CHECK(calls.usedBytes == 500);
+	CHECK(calls.thresholdBytes == 200);
+
+	// Setting the budget again arms it, even if the usage was already over the previous one.
+	tracker.setBudget(300, budgetCallback, &calls);
+	CHECK(calls.count == 2);
+	CHECK(calls.thresholdBytes == 300);
+
+	tracker.setBudget(1000, budgetCallback, &calls);
+	CHECK(calls.count == 2);
+}
+
+TEST(MemoryTrackerIgnoresBudgetWithoutCallback) {
+	RT64::MemoryTracker tracker;
+	BudgetCalls calls;
+	tracker.setBudget(10, budgetCallback, &calls);
+	tracker.setBudget(10, nullptr, nullptr);
+	tracker.add(fakeAllocation(0), 0, 100);
+	CHECK(calls.count == 0);
+}
+
+#endif
@@ -0,0 +1,211 @@
+//
+// RT64 TESTS
+//
+
+#include "tests.h"
+
+#ifndef RT64_MINIMAL
+
+#include "rt64_normal_matrix_cache.h"
+
+#include <math.h>
+#include <random>
+#include <vector>
+
+namespace {
+	typedef RT64::NormalMatrixCache::Matrix Matrix;
+
+	// Inverts the upper 3x3 in double precision with Gauss-Jordan elimination and transposes it, so the reference
+	// shares none of the kernels' cross product formulation.
+	Matrix referenceNormalMatrix(const float *transform) {
+		double a[3][6];
+		for (int r = 0; r < 3; r++) {
+			for (int c = 0; c < 3; c++) {
+				a[r][c] = transform[r * 4 + c];
+				a[r][c + 3] = (r == c) ? 1.0 : 0.0;
+			}
+		}
+
+		for (int p = 0; p < 3; p++) {
+			int pivot = p;
+			for (int r = p + 1; r < 3; r++) {
+				if (fabs(a[r][p]) > fabs(a[pivot][p])) {
+					pivot = r;
+				}
+			}
+
+			for (int c = 0; c < 6; c++) {
+				double t = a[p][c];
+				a[p][c] = a[pivot][c];
+				a[pivot][c] = t;
+			}
+
+			double invPivot = 1.0 / a[p][p];
+			for (int c = 0; c < 6; c++) {
+				a[p][c] *= invPivot;
+			}
+
+			for (int r = 0; r < 3; r++) {
+				if (r != p) {
+					double f = a[r][p];
+					for (int c = 0; c < 6; c++) {
+						a[r][c] -= f * a[p][c];
+					}
+				}
+			}
+		}
+
+		Matrix result = {};
+		for (int r = 0; r < 3; r++) {
+			for (int c = 0; c < 3; c++) {
+				result.m[r][c] = (float)(a[c][r + 3]);
+			}
+		}
+
+		result.m[3][3] = 1.0f;
+		return result;
+	}
+
+	bool nearlyEqual(const Matrix &a, const Matrix &b) {
+		for (int r = 0; r < 4; r++) {
+			for (int c = 0; c < 4; c++) {
+				float tolerance = 1e-4f * fmaxf(1.0f, fabsf(b.m[r][c]));
+				if (fabsf(a.m[r][c] - b.m[r][c]) > tolerance) {
+					return false;
+				}
+			}
+		}
+
+		return true;
+	}
+
+	// Rotation, non-uniform scale and translation, like the transforms games submit. Scales stay away from zero so the
+	// matrices are well conditioned.
+	void randomTransform(std::mt19937 &random, float *transform) {
+		std::uniform_real_distribution<float> angle(-3.14159f, 3.14159f);
+		std::uniform_real_distribution<float> scale(0.25f, 4.0f);
+		std::uniform_real_distribution<float> offset(-1000.0f, 1000.0f);
+		float y = angle(random), p = angle(random);
+		float s[3] = { scale(random), scale(random), scale(random) };
+		float rot[3][3] = {
+			{ cosf(y), 0.0f, -sinf(y) },
+			{ sinf(y) * sinf(p), cosf(p), cosf(y) * sinf(p) },
+			{ sinf(y) * cosf(p), -sinf(p), cosf(y) * cosf(p) }
+		};
+
+		for (int r = 0; r < 3; r++) {
+			for (int c = 0; c < 3; c++) {
+				transform[r * 4 + c] = rot[r][c] * s[r];
+			}
+
+			transform[r * 4 + 3] = 0.0f;
+		}
+
+		transform[12] = offset(random);
+		transform[13] = offset(random);
+		transform[14] = offset(random);
+		transform[15] = 1.0f;
+	}
+};
+
+TEST(NormalMatrixScalarKernelMatchesReference) {
+	std::mt19937 random(1);
+	float transform[16];
+	int mismatches = 0;
+	for (int i = 0; i < 1000; i++) {
+		randomTransform(random, transform);
+		Matrix normalMatrix;
+		RT64::NormalMatrixCache::computeNormalMatrix(transform, normalMatrix);
+		if (!nearlyEqual(normalMatrix, referenceNormalMatrix(transform))) {
+			mismatches++;
+		}
+	}
+
+	CHECK(mismatches == 0);
+}
+
+TEST(NormalMatrixBatchedKernelMatchesReference) {
+	// Runs the SSE kernel on x86 builds and the scalar fallback elsewhere.
+	std::mt19937 random(2);
+	float transforms[4][16];
+	Matrix normalMatrices[4];
+	const float *transformPointers[4] = { transforms[0], transforms[1], transforms[2], transforms[3] };
+	Matrix *const normalMatrixPointers[4] = { &normalMatrices[0], &normalMatrices[1], &normalMatrices[2], &normalMatrices[3] };
+	int mismatches = 0;
+	for (int i = 0; i < 250; i++) {
+		for (int j = 0; j < 4; j++) {
+			randomTransform(random, transforms[j]);
+		}
+
+		RT64::NormalMatrixCache::computeNormalMatrices4(transformPointers, normalMatrixPointers);
+		for (int j = 0; j < 4; j++) {
+			Matrix scalarMatrix;
+			RT64::NormalMatrixCache::computeNormalMatrix(transforms[j], scalarMatrix);
+			if (!nearlyEqual(normalMatrices[j], referenceNormalMatrix(transforms[j])) || !nearlyEqual(normalMatrices[j], scalarMatrix)) {
+				mismatches++;
+			}
+		}
+	}
+
+	CHECK(mismatches == 0);
+}
+
+TEST(NormalMatrixBatchedKernelKeepsLanesApart) {
+	// Each lane must only see its own matrix, so four different scales give four different results.
+	float transforms[4][16] = {};
+	for (int j = 0; j < 4; j++) {
+		transforms[j][0] = transforms[j][5] = transforms[j][10] = (float)(j + 1);
+		transforms[j][15] = 1.0f;
+	}
+
+	Matrix normalMatrices[4];
+	const float *transformPointers[4] = { transforms[3], transforms[1], transforms[2], transforms[0] };
+	Matrix *const normalMatrixPointers[4] = { &normalMatrices[0], &normalMatrices[1], &normalMatrices[2], &normalMatrices[3] };
+	RT64::NormalMatrixCache::computeNormalMatrices4(transformPointers, normalMatrixPointers);
+	CHECK(nearlyEqual(normalMatrices[0], referenceNormalMatrix(transforms[3])));
+	CHECK(nearlyEqual(normalMatrices[1], referenceNormalMatrix(transforms[1])));
+	CHECK(nearlyEqual(normalMatrices[2], referenceNormalMatrix(transforms[2])));
+	CHECK(nearlyEqual(normalMatrices[3], referenceNormalMatrix(transforms[0])));
+}
+
+TEST(NormalMatrixCacheOnlyRecomputesChangedBases) {
+	std::mt19937 random(3);
+	const size_t TransformCount = 11;
+	std::vector<float> transforms(TransformCount * 16);
+	for (size_t i = 0; i < TransformCount; i++) {
+		randomTransform(random, &transforms[i * 16]);
+	}
+
+	RT64::NormalMatrixCache cache;
+	cache.update(transforms.data(), sizeof(float) * 16, TransformCount);
+	CHECK(cache.getComputedCount() == TransformCount);
+
+	// Moving a transform keeps its normal matrix.
+	transforms[2 * 16 + 12] += 5.0f;
+	cache.update(transforms.data(), sizeof(float) * 16, TransformCount);
+	CHECK(cache.getComputedCount() == 0);
+
+	// Five changed bases go through one batch of four and one scalar computation.
+	const size_t changedIndices[] = { 0, 3, 4, 7, 10 };
+	for (size_t index : changedIndices) {
+		randomTransform(random, &transforms[index * 16]);
+	}
+
+	cache.update(transforms.data(), sizeof(float) * 16, TransformCount);
+	CHECK(cache.getComputedCount() == 5);
+
+	int mismatches = 0;
+	for (size_t i = 0; i < TransformCount; i++) {
+		if (!nearlyEqual(cache.getNormalMatrix(i), referenceNormalMatrix(&transforms[i * 16]))) {
+			mismatches++;
+		}
+	}
+
+	CHECK(mismatches == 0);
+
+	cache.clear();
+	cache.update(transforms.data(), sizeof(float) * 16, TransformCount);
+	CHECK(cache.getComputedCount() == TransformCount);
+}
+
+#endif
@@ -0,0 +1,210 @@
+//
+// RT64 TESTS
+//
+
+#include "tests.h"
+
+#ifndef RT64_MINIMAL
+
+#include "rt64_shader_binding_table.h"
+
+#include <random>
+#include <string.h>
+#include <vector>
+
+namespace {
+	typedef RT64::ShaderBindingTable::Section Section;
+
+	struct Identifier {
+		uint8_t bytes[RT64::ShaderBindingTable::IdentifierSize];
+	};
+
+	Identifier fakeIdentifier(uint8_t value) {
+		Identifier identifier;
+		memset(identifier.bytes, value, sizeof(identifier.bytes));
+		return identifier;
+	}
+
+	// Same layout the view uses: five ray generation shaders with one argument, two miss shaders without any and two
+	// arguments per hit group.
+	void setViewLayout(RT64::ShaderBindingTable &table, uint32_t hitGroupCount) {
+		table.setLayout(5, 1, 2, 0, hitGroupCount, 2);
+	}
+
+	void setViewRecords(RT64::ShaderBindingTable &table, const std::vector<uint64_t> &hitGroupArguments, uint32_t hitGroupCount) {
+		const uint64_t rayGenArgument = 0x1000;
+		for (uint32_t i = 0; i < 5; i++) {
+			Identifier identifier = fakeIdentifier((uint8_t)(1 + i));
+			table.setRecord(Section::RayGeneration, i, identifier.bytes, &rayGenArgument, 1);
+		}
+
+		for (uint32_t i = 0; i < 2; i++) {
+			Identifier identifier = fakeIdentifier((uint8_t)(10 + i));
+			table.setRecord(Section::Miss, i, identifier.bytes, nullptr, 0);
+		}
+
+		for (uint32_t i = 0; i < hitGroupCount; i++) {
+			Identifier identifier = fakeIdentifier((uint8_t)(20 + (i & 1)));
+			table.setRecord(Section::HitGroup, i, identifier.bytes, &hitGroupArguments[i * 2], 2);
+		}
+	}
+
+	// Copies what the view would upload to the GPU into a mirror of the table.
+	void upload(RT64::ShaderBindingTable &table, std::vector<uint8_t> &gpuData) {
+		if (gpuData.size() < table.getDataSize()) {
+			gpuData.resize(table.getDataSize(), 0);
+		}
+
+		if (table.isAllDirty()) {
+			memcpy(gpuData.data(), table.getData(), table.getDataSize());
+		}
+		else {
+			for (const RT64::ShaderBindingTable::DirtyRecord &record : table.getDirtyRecords()) {
+				memcpy(&gpuData[record.offset], table.getData() + record.offset, record.size);
+			}
+		}
+
+		table.clearDirty();
+	}
+};
+
+TEST(ShaderBindingTableLayout) {
+	RT64::ShaderBindingTable table;
+	setViewLayout(table, 6);
+	CHECK(table.getRecordSize(Section::RayGeneration) == 64);
+	CHECK(table.getRecordSize(Section::Miss) == 64);
+	CHECK(table.getRecordSize(Section::HitGroup) == 64);
+	CHECK(table.getSectionOffset(Section::RayGeneration) == 0);
+	CHECK(table.getSectionOffset(Section::Miss) == (5 * 64));
+	CHECK(table.getSectionOffset(Section::HitGroup) == (7 * 64));
+	CHECK(table.getSectionSize(Section::HitGroup) == (6 * 64));
+	CHECK(table.getSize() == 1024);
+	CHECK((table.getSize() % RT64::ShaderBindingTable::SizeAlignment) == 0);
+}
+
+TEST(ShaderBindingTableRecordContents) {
+	RT64::ShaderBindingTable table;
+	table.setLayout(1, 0, 1, 0, 1, 2);
+	const Identifier identifier = fakeIdentifier(0xAB);
+	const uint64_t arguments[2] = { 0x1122334455667788ULL, 0x99 };
+	table.setRecord(Section::HitGroup, 0, identifier.bytes, arguments, 2);
+
+	// The identifier goes first, then the arguments, and the rest of the record is padding.
+	const uint8_t *record = table.getData() + table.getSectionOffset(Section::HitGroup);
+	CHECK(memcmp(record, identifier.bytes, sizeof(identifier.bytes)) == 0);
+	CHECK(memcmp(record + RT64::ShaderBindingTable::IdentifierSize, arguments, sizeof(arguments)) == 0);
+
+	bool paddingZero = true;
+	for (uint32_t i = RT64::ShaderBindingTable::IdentifierSize + sizeof(arguments); i < table.getRecordSize(Section::HitGroup); i++) {
+		paddingZero = paddingZero && (record[i] == 0);
+	}
+
+	CHECK(paddingZero);
+}
+
+TEST(ShaderBindingTableStartsAllDirty) {
+	RT64::ShaderBindingTable table;
+	std::vector<uint64_t> arguments(8, 0);
+	setViewLayout(table, 4);
+	setViewRecords(table, arguments, 4);
+	CHECK(table.isAllDirty());
+	CHECK(table.getDirtyRecords().empty());
+	table.clearDirty();
+	CHECK(!table.isAllDirty());
+}
+
+TEST(ShaderBindingTableSkipsIdenticalRecords) {
+	RT64::ShaderBindingTable table;
+	std::vector<uint64_t> arguments(8, 7);
+	setViewLayout(table, 4);
+	setViewRecords(table, arguments, 4);
+	table.clearDirty();
+
+	setViewLayout(table, 4);
+	setViewRecords(table, arguments, 4);
+	CHECK(!table.isAllDirty());
+	CHECK(table.getDirtyRecords().empty());
+}
+
+TEST(ShaderBindingTableMarksChangedRecord) {
+	RT64::ShaderBindingTable table;
+	std::vector<uint64_t> arguments(8, 7);
+	setViewLayout(table, 4);
+	setViewRecords(table, arguments, 4);
+	table.clearDirty();
+
+	arguments[2 * 2 + 1] = 8;
+	setViewLayout(table, 4);
+	setViewRecords(table, arguments, 4);
+	const std::vector<RT64::ShaderBindingTable::DirtyRecord> &dirtyRecords = table.getDirtyRecords();
+	CHECK(dirtyRecords.size() == 1);
+	CHECK((dirtyRecords.size() == 1) && (dirtyRecords[0].offset == (table.getSectionOffset(Section::HitGroup) + 2 * table.getRecordSize(Section::HitGroup))));
+	CHECK((dirtyRecords.size() == 1) && (dirtyRecords[0].size == table.getRecordSize(Section::HitGroup)));
+}
+
+TEST(ShaderBindingTableHitGroupCountKeepsRecords) {
+	RT64::ShaderBindingTable table;
+	std::vector<uint64_t> arguments(16, 7);
+	setViewLayout(table, 4);
+	setViewRecords(table, arguments, 4);
+	table.clearDirty();
+
+	// Adding hit groups only dirties the new ones.
+	setViewLayout(table, 6);
+	setViewRecords(table, arguments, 6);
+	CHECK(!table.isAllDirty());
+	CHECK(table.getDirtyRecords().size() == 2);
+	table.clearDirty();
+
+	// The records of the hit groups that were dropped are kept, so bringing them back doesn't dirty anything.
+	setViewLayout(table, 2);
+	setViewRecords(table, arguments, 2);
+	CHECK(table.getDirtyRecords().empty());
+	setViewLayout(table, 6);
+	setViewRecords(table, arguments, 6);
+	CHECK(!table.isAllDirty());
+	CHECK(table.getDirtyRecords().empty());
+	CHECK(table.getDataSize() >= table.getSize());
+}
+
+TEST(ShaderBindingTableMovedSectionsDirtyEverything) {
+	RT64::ShaderBindingTable table;
+	std::vector<uint64_t> arguments(8, 7);
+	setViewLayout(table, 4);
+	setViewRecords(table, arguments, 4);
+	table.clearDirty();
+
+	// A different amount of miss shaders moves the hit groups.
+	table.setLayout(5, 1, 3, 0, 4, 2);
+	CHECK(table.isAllDirty());
+	table.clearDirty();
+
+	// So does a different amount of arguments per hit group, as it changes their record size.
+	table.setLayout(5, 1, 3, 0, 4, 6);
+	CHECK(table.isAllDirty());
+}
+
+TEST(ShaderBindingTableDirtyRecordsKeepGPUCopyInSync) {
+	std::mt19937 random(1);
+	RT64::ShaderBindingTable table;
+	std::vector<uint8_t> gpuData;
+	std::vector<uint64_t> arguments(64 * 2, 0);
+	int mismatchedFrames = 0;
+	for (int frame = 0; frame < 500; frame++) {
+		uint32_t hitGroupCount = 2 * (1 + (random() % 32));
+		for (int c = 0; c < 3; c++) {
+			arguments[random() % arguments.size()] = random() % 4;
+		}
+
+		setViewLayout(table, hitGroupCount);
+		setViewRecords(table, arguments, hitGroupCount);
+		upload(table, gpuData);
+		if (memcmp(gpuData.data(), table.getData(), table.getSize()) != 0) {
+			mismatchedFrames++;
+		}
+	}
+
+	CHECK(mismatchedFrames == 0);
+}
+
+#endif
@@ -0,0 +1,160 @@
+//
+// RT64 TESTS
+//
+
+#include "tests.h"
+
+#ifndef RT64_MINIMAL
+
+#include "rt64_slot_map.h"
+
+#include <vector>
+
+namespace {
+	typedef RT64::SlotMap<int> IntSlotMap;
+
+	std::vector<RT64::SlotHandle> insertRange(IntSlotMap &map, int first, int count) {
+		std::vector<RT64::SlotHandle> handles;
+		for (int i = 0; i < count; i++) {
+			handles.push_back(map.insert(first + i));
+		}
+
+		return handles;
+	}
+
+	bool valuesEqual(const IntSlotMap &map, const std::vector<int> &expected) {
+		return map.getValues() == expected;
+	}
+};
+
+TEST(SlotMapInsertAndGet) {
+	IntSlotMap map;
+	CHECK(map.empty());
+
+	std::vector<RT64::SlotHandle> handles = insertRange(map, 10, 3);
+	CHECK(map.size() == 3);
+	CHECK(!map.empty());
+	for (int i = 0; i < 3; i++) {
+		CHECK(map.contains(handles[i]));
+		CHECK((map.get(handles[i]) != nullptr) && (*map.get(handles[i]) == (10 + i)));
+	}
+
+	CHECK(valuesEqual(map, { 10, 11, 12 }));
+}
+
+TEST(SlotMapHandlesGoStaleAfterRemove) {
+	IntSlotMap map;
+	std::vector<RT64::SlotHandle> handles = insertRange(map, 0, 3);
+	CHECK(map.remove(handles[1]));
+	CHECK(!map.contains(handles[1]));
+	CHECK(map.get(handles[1]) == nullptr);
+
+	// Removing twice is reported instead of removing a different value.
+	CHECK(!map.remove(handles[1]));
+	CHECK(map.size() == 2);
+	CHECK(map.contains(handles[0]) && map.contains(handles[2]));
+
+	// Handles with an index that was never handed out are stale as well.
+	RT64::SlotHandle unknown = { 100, 0 };
+	CHECK(!map.contains(unknown));
+	CHECK(map.get(unknown) == nullptr);
+}
+
+TEST(SlotMapSlotReuseBumpsGeneration) {
+	IntSlotMap map;
+	RT64::SlotHandle first = map.insert(1);
+	map.remove(first);
+
+	RT64::SlotHandle second = map.insert(2);
+	CHECK(second.index == first.index);
+	CHECK(second.generation == (first.generation + 1));
+
+	// The old handle must not reach the value that reused its slot.
+	CHECK(!map.contains(first));
+	CHECK(map.get(first) == nullptr);
+	CHECK(!map.remove(first));
+	CHECK((map.get(second) != nullptr) && (*map.get(second) == 2));
+
+	map.remove(second);
+	RT64::SlotHandle third = map.insert(3);
+	CHECK(third.index == first.index);
+	CHECK(third.generation == (first.generation + 2));
+	CHECK(!map.contains(second));
+}
+
+TEST(SlotMapSizeWithHoles) {
+	IntSlotMap map;
+	std::vector<RT64::SlotHandle> handles = insertRange(map, 0, 6);
+	map.remove(handles[0]);
+	map.remove(handles[3]);
+	map.remove(handles[5]);
+	CHECK(map.size() == 3);
+
+	// Reusing a slot adds a value without closing any of the holes.
+	map.insert(6);
+	CHECK(map.size() == 4);
+
+	map.compact();
+	CHECK(map.size() == 4);
+
+	map.remove(handles[1]);
+	map.remove(handles[2]);
+	map.remove(handles[4]);
+	CHECK(map.size() == 1);
+	map.compact();
+	CHECK(map.size() == 1);
+	CHECK(valuesEqual(map, { 6 }));
+}
+
+TEST(SlotMapCompactPreservesOrder) {
+	IntSlotMap map;
+	std::vector<RT64::SlotHandle> handles = insertRange(map, 0, 8);
+	map.remove(handles[0]);
+	map.remove(handles[3]);
+	map.remove(handles[4]);
+	map.remove(handles[7]);
+
+	// New values go after the ones that are left, even when they reuse an earlier slot.
+	RT64::SlotHandle added = map.insert(8);
+	map.compact();
+	CHECK(valuesEqual(map, { 1, 2, 5, 6, 8 }));
+
+	// Handles keep reaching their values after they're moved.
+	CHECK(*map.get(handles[1]) == 1);
+	CHECK(*map.get(handles[2]) == 2);
+	CHECK(*map.get(handles[5]) == 5);
+	CHECK(*map.get(handles[6]) == 6);
+	CHECK(*map.get(added) == 8);
+
+	// Compacting again without holes changes nothing.
+	map.compact();
+	CHECK(valuesEqual(map, { 1, 2, 5, 6, 8 }));
+}
+
+TEST(SlotMapMoveToBackOrdering) {
+	IntSlotMap map;
+	std::vector<RT64::SlotHandle> handles = insertRange(map, 0, 6);
+
+	// The moved values keep the order they're given in, and the rest keep their relative order.
+	map.moveToBack({ handles[3], handles[0], handles[4] });
+	CHECK(valuesEqual(map, { 1, 2, 5, 3, 0, 4 }));
+	for (int i = 0; i < 6; i++) {
+		CHECK(*map.get(handles[i]) == i);
+	}
+
+	// Holes are closed before moving.
+	map.remove(handles[2]);
+	map.moveToBack({ handles[1] });
+	CHECK(valuesEqual(map, { 5, 3, 0, 4, 1 }));
+	CHECK(map.size() == 5);
+	CHECK(*map.get(handles[1]) == 1);
+	CHECK(*map.get(handles[5]) == 5);
+
+	// Moving nothing keeps the order, and moving everything uses the order given.
+	map.moveToBack({});
+	CHECK(valuesEqual(map, { 5, 3, 0, 4, 1 }));
+	map.moveToBack({ handles[0], handles[1], handles[3], handles[4], handles[5] });
+	CHECK(valuesEqual(map, { 0, 1, 3, 4, 5 }));
+}
+
+#endif
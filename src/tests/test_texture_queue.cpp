@@ -0,0 +1,90 @@
+//
+// RT64 TESTS
+//
+
+#include "tests.h"
+
+#ifndef RT64_MINIMAL
+
+#include "rt64_texture_queue.h"
+
+namespace {
+	// The queue never dereferences the textures, so any distinct addresses work.
+	RT64::Texture *fakeTexture(int index) {
+		static char storage[16];
+		return reinterpret_cast<RT64::Texture *>(&storage[index]);
+	}
+};
+
+TEST(TextureQueueRetiresUpToCompletedFence) {
+	RT64::TextureQueue queue;
+	queue.push(fakeTexture(0), 1);
+	queue.push(fakeTexture(1), 1);
+	queue.push(fakeTexture(2), 2);
+	queue.push(fakeTexture(3), 4);
+
+	std::vector<RT64::Texture *> retired;
+	queue.retire(0, retired);
+	CHECK(retired.empty());
+	CHECK(queue.size() == 4);
+
+	queue.retire(2, retired);
+	CHECK(retired.size() == 3);
+	CHECK((retired.size() == 3) && (retired[0] == fakeTexture(0)) && (retired[1] == fakeTexture(1)) && (retired[2] == fakeTexture(2)));
+	CHECK(queue.size() == 1);
+	CHECK(!queue.contains(fakeTexture(0)));
+	CHECK(queue.contains(fakeTexture(3)));
+
+	// A fence that was reached without any uploads in between retires nothing new.
+	queue.retire(3, retired);
+	CHECK(retired.empty());
+	CHECK(queue.size() == 1);
+
+	queue.retire(10, retired);
+	CHECK((retired.size() == 1) && (retired[0] == fakeTexture(3)));
+	CHECK(queue.size() == 0);
+}
+
+TEST(TextureQueueRetireClearsPreviousResults) {
+	RT64::TextureQueue queue;
+	std::vector<RT64::Texture *> retired = { fakeTexture(5), fakeTexture(6) };
+	queue.retire(100, retired);
+	CHECK(retired.empty());
+}
+
+TEST(TextureQueueRemovesPendingTextures) {
+	// A texture destroyed before its upload is retired must not be retired later.
+	RT64::TextureQueue queue;
+	queue.push(fakeTexture(0), 1);
+	queue.push(fakeTexture(1), 1);
+	queue.push(fakeTexture(2), 2);
+
+	CHECK(queue.remove(fakeTexture(1)));
+	CHECK(!queue.contains(fakeTexture(1)));
+	CHECK(queue.size() == 2);
+	CHECK(!queue.remove(fakeTexture(1)));
+	CHECK(!queue.remove(fakeTexture(7)));
+
+	std::vector<RT64::Texture *> retired;
+	queue.retire(2, retired);
+	CHECK((retired.size() == 2) && (retired[0] == fakeTexture(0)) && (retired[1] == fakeTexture(2)));
+}
+
+TEST(TextureQueueAcceptsTexturesAgainAfterRetiring) {
+	// Replacing the data of a texture queues it again once the previous upload has been retired.
+	RT64::TextureQueue queue;
+	queue.push(fakeTexture(0), 1);
+
+	std::vector<RT64::Texture *> retired;
+	queue.retire(1, retired);
+	CHECK(retired.size() == 1);
+
+	queue.push(fakeTexture(0), 2);
+	CHECK(queue.contains(fakeTexture(0)));
+	queue.retire(1, retired);
+	CHECK(retired.empty());
+	queue.retire(2, retired);
+	CHECK((retired.size() == 1) && (retired[0] == fakeTexture(0)));
+}
+
+#endif
@@ -0,0 +1,98 @@
+//
+// RT64 TESTS
+//
+
+#include "tests.h"
+
+#ifndef RT64_MINIMAL
+
+#include "rt64_texture_slot_allocator.h"
+
+#include <vector>
+
+TEST(TextureSlotAllocatorStartsEmpty) {
+	RT64::TextureSlotAllocator allocator;
+	CHECK(allocator.getCapacity() == 0);
+	CHECK(allocator.getSlotCount() == 0);
+	CHECK(allocator.getUsedCount() == 0);
+	CHECK(!allocator.isUsed(0));
+}
+
+TEST(TextureSlotAllocatorHandsOutSequentialSlots) {
+	RT64::TextureSlotAllocator allocator;
+	for (uint32_t i = 0; i < 10; i++) {
+		CHECK(allocator.allocate() == i);
+	}
+
+	CHECK(allocator.getSlotCount() == 10);
+	CHECK(allocator.getUsedCount() == 10);
+	CHECK(allocator.getCapacity() == RT64::TextureSlotAllocator::PageSize);
+	CHECK(allocator.isUsed(9));
+	CHECK(!allocator.isUsed(10));
+}
+
+TEST(TextureSlotAllocatorReusesLowestFreeSlotFirst) {
+	RT64::TextureSlotAllocator allocator;
+	for (int i = 0; i < 8; i++) {
+		allocator.allocate();
+	}
+
+	allocator.free(6);
+	allocator.free(2);
+	allocator.free(4);
+	CHECK(allocator.getUsedCount() == 5);
+	CHECK(!allocator.isUsed(2) && !allocator.isUsed(4) && !allocator.isUsed(6));
+
+	CHECK(allocator.allocate() == 2);
+	CHECK(allocator.allocate() == 4);
+	CHECK(allocator.allocate() == 6);
+
+	// Once the freed slots are used up, the range grows again.
+	CHECK(allocator.allocate() == 8);
+	CHECK(allocator.getSlotCount() == 9);
+	CHECK(allocator.getUsedCount() == 9);
+}
+
+TEST(TextureSlotAllocatorDoublesCapacityWhenFull) {
+	const uint32_t PageSize = RT64::TextureSlotAllocator::PageSize;
+	RT64::TextureSlotAllocator allocator;
+	for (uint32_t i = 0; i < PageSize; i++) {
+		allocator.allocate();
+	}
+
+	CHECK(allocator.getCapacity() == PageSize);
+	allocator.allocate();
+	CHECK(allocator.getCapacity() == (PageSize * 2));
+
+	for (uint32_t i = PageSize + 1; i < (PageSize * 2 + 1); i++) {
+		allocator.allocate();
+	}
+
+	CHECK(allocator.getCapacity() == (PageSize * 4));
+}
+
+TEST(TextureSlotAllocatorKeepsCapacityWhileReusingSlots) {
+	const uint32_t PageSize = RT64::TextureSlotAllocator::PageSize;
+	RT64::TextureSlotAllocator allocator;
+	std::vector<uint32_t> slots;
+	for (uint32_t i = 0; i < PageSize; i++) {
+		slots.push_back(allocator.allocate());
+	}
+
+	// Textures that are destroyed and created over and over never make the heaps grow.
+	for (int round = 0; round < 4; round++) {
+		for (uint32_t i = 0; i < PageSize; i += 2) {
+			allocator.free(slots[i]);
+		}
+
+		for (uint32_t i = 0; i < PageSize; i += 2) {
+			slots[i] = allocator.allocate();
+		}
+	}
+
+	CHECK(allocator.getCapacity() == PageSize);
+	CHECK(allocator.getSlotCount() == PageSize);
+	CHECK(allocator.getUsedCount() == PageSize);
+}
+
+#endif
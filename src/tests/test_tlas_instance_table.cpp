@@ -0,0 +1,263 @@
+//
+// RT64 TESTS
+//
+
+#include "tests.h"
+
+#ifndef RT64_MINIMAL
+
+#include "rt64_tlas_instance_table.h"
+
+#include <string.h>
+#include <vector>
+
+namespace {
+	typedef RT64::TopLevelASInstanceTable::Desc Desc;
+
+	const size_t DescSize = sizeof(Desc);
+	const uint8_t Untouched = 0xCD;
+
+	// Translation in the last row, like XMMATRIX. Every element is different so a wrong transpose can't go unnoticed.
+	void makeTransform(float *transform, float offset) {
+		for (int i = 0; i < 16; i++) {
+			transform[i] = offset + (float)(i);
+		}
+	}
+
+	void setInstance(RT64::TopLevelASInstanceTable &table, size_t index, float offset) {
+		float transform[16];
+		makeTransform(transform, offset);
+		table.setInstance(index, transform, (uint32_t)(index), 0xFF, 0, 0, 0x1000 + index * 0x100);
+	}
+
+	void setInstances(RT64::TopLevelASInstanceTable &table, size_t count, float offset) {
+		table.resize(count);
+		for (size_t i = 0; i < count; i++) {
+			setInstance(table, i, offset);
+		}
+	}
+
+	// Stands in for the upload buffer. Descriptors that weren't written keep the marker bytes.
+	struct Buffer {
+		std::vector<Desc> descs;
+
+		Buffer(size_t capacity) {
+			descs.resize(capacity);
+			reset();
+		}
+
+		void reset() {
+			memset(descs.data(), Untouched, descs.size() * DescSize);
+		}
+
+		bool written(size_t index) const {
+			const uint8_t *bytes = reinterpret_cast<const uint8_t *>(&descs[index]);
+			for (size_t i = 0; i < DescSize; i++) {
+				if (bytes[i] != Untouched) {
+					return true;
+				}
+			}
+
+			return false;
+		}
+
+		// Returns whether exactly the descriptors in [first, last] were written, and that they match the table.
+		bool writtenRange(const RT64::TopLevelASInstanceTable &table, size_t first, size_t last) const {
+			for (size_t i = 0; i < descs.size(); i++) {
+				bool inRange = (i >= first) && (i <= last);
+				if (written(i) != inRange) {
+					return false;
+				}
+
+				if (inRange && (memcmp(&descs[i], &table.getDescs()[i], DescSize) != 0)) {
+					return false;
+				}
+			}
+
+			return true;
+		}
+	};
+};
+
+TEST(TopLevelASInstanceTableFirstUploadWritesEverything) {
+	RT64::TopLevelASInstanceTable table;
+	Buffer buffer(16);
+	setInstances(table, 10, 0.0f);
+	CHECK(table.size() == 10);
+	CHECK(table.upload(buffer.descs.data()) == (10 * DescSize));
+	CHECK(buffer.writtenRange(table, 0, 9));
+}
+
+TEST(TopLevelASInstanceTableUnchangedWritesNothing) {
+	RT64::TopLevelASInstanceTable table;
+	Buffer buffer(16);
+	setInstances(table, 10, 0.0f);
+	table.upload(buffer.descs.data());
+
+	for (int frame = 0; frame < 3; frame++) {
+		buffer.reset();
+		setInstances(table, 10, 0.0f);
+		CHECK(table.upload(buffer.descs.data()) == 0);
+		CHECK(!buffer.written(0) && !buffer.written(9));
+	}
+}
+
+TEST(TopLevelASInstanceTableSingleDirtyInstance) {
+	RT64::TopLevelASInstanceTable table;
+	Buffer buffer(16);
+	setInstances(table, 10, 0.0f);
+	table.upload(buffer.descs.data());
+
+	buffer.reset();
+	setInstances(table, 10, 0.0f);
+	setInstance(table, 4, 100.0f);
+	CHECK(table.upload(buffer.descs.data()) == DescSize);
+	CHECK(buffer.writtenRange(table, 4, 4));
+}
+
+TEST(TopLevelASInstanceTableContiguousDirtyRuns) {
+	RT64::TopLevelASInstanceTable table;
+	Buffer buffer(16);
+	setInstances(table, 12, 0.0f);
+	table.upload(buffer.descs.data());
+
+	// A single run in the middle.
+	buffer.reset();
+	table.resize(12);
+	for (size_t i = 0; i < 12; i++) {
+		setInstance(table, i, ((i >= 3) && (i <= 7)) ? 50.0f : 0.0f);
+	}
+
+	CHECK(table.upload(buffer.descs.data()) == (5 * DescSize));
+	CHECK(buffer.writtenRange(table, 3, 7));
+
+	// Two runs with a gap between them, ending on the last instance.
+	buffer.reset();
+	table.resize(12);
+	for (size_t i = 0; i < 12; i++) {
+		bool moved = (i <= 1) || (i >= 9);
+		setInstance(table, i, moved ? 75.0f : (((i >= 3) && (i <= 7)) ? 50.0f : 0.0f));
+	}
+
+	CHECK(table.upload(buffer.descs.data()) == (5 * DescSize));
+	CHECK(buffer.written(0) && buffer.written(1) && !buffer.written(2));
+	CHECK(!buffer.written(8) && buffer.written(9) && buffer.written(11));
+	CHECK(memcmp(&buffer.descs[9], &table.getDescs()[9], 3 * DescSize) == 0);
+}
+
+TEST(TopLevelASInstanceTableShrinkAndGrowWithoutInvalidation) {
+	RT64::TopLevelASInstanceTable table;
+	Buffer buffer(16);
+	setInstances(table, 10, 0.0f);
+	table.upload(buffer.descs.data());
+
+	// The buffer still holds the descriptors past the end, so they don't need to be written again when they come back.
+	buffer.reset();
+	setInstances(table, 4, 0.0f);
+	CHECK(table.size() == 4);
+	CHECK(table.upload(buffer.descs.data()) == 0);
+
+	setInstances(table, 10, 0.0f);
+	CHECK(table.size() == 10);
+	CHECK(table.upload(buffer.descs.data()) == 0);
+
+	// Coming back different only writes the ones that changed.
+	setInstances(table, 6, 0.0f);
+	table.upload(buffer.descs.data());
+	table.resize(10);
+	for (size_t i = 0; i < 10; i++) {
+		setInstance(table, i, (i == 8) ? 30.0f : 0.0f);
+	}
+
+	CHECK(table.upload(buffer.descs.data()) == DescSize);
+	CHECK(buffer.writtenRange(table, 8, 8));
+
+	// Growing past anything that was uploaded always writes the new descriptors.
+	buffer.reset();
+	table.resize(13);
+	for (size_t i = 0; i < 13; i++) {
+		setInstance(table, i, (i == 8) ? 30.0f : 0.0f);
+	}
+
+	CHECK(table.upload(buffer.descs.data()) == (3 * DescSize));
+	CHECK(buffer.writtenRange(table, 10, 12));
+}
+
+TEST(TopLevelASInstanceTableInvalidateBeforeSet) {
+	RT64::TopLevelASInstanceTable table;
+	Buffer buffer(16);
+	setInstances(table, 8, 0.0f);
+	table.upload(buffer.descs.data());
+
+	// Like a recreated buffer: nothing changed, but everything must be written.
+	buffer.reset();
+	table.invalidate();
+	setInstances(table, 8, 0.0f);
+	CHECK(table.upload(buffer.descs.data()) == (8 * DescSize));
+	CHECK(buffer.writtenRange(table, 0, 7));
+
+	buffer.reset();
+	setInstances(table, 8, 0.0f);
+	CHECK(table.upload(buffer.descs.data()) == 0);
+}
+
+TEST(TopLevelASInstanceTableInvalidateAfterSet) {
+	RT64::TopLevelASInstanceTable table;
+	Buffer buffer(16);
+	setInstances(table, 8, 0.0f);
+	table.upload(buffer.descs.data());
+
+	// The instances that were already set keep their new contents and are written along with the rest.
+	buffer.reset();
+	setInstances(table, 8, 0.0f);
+	setInstance(table, 2, 20.0f);
+	table.invalidate();
+	CHECK(table.upload(buffer.descs.data()) == (8 * DescSize));
+	CHECK(buffer.writtenRange(table, 0, 7));
+
+	float transform[16];
+	makeTransform(transform, 20.0f);
+	CHECK(buffer.descs[2].transform[0][3] == transform[12]);
+
+	buffer.reset();
+	setInstances(table, 8, 0.0f);
+	CHECK(table.upload(buffer.descs.data()) == DescSize);
+	CHECK(buffer.writtenRange(table, 2, 2));
+}
+
+TEST(TopLevelASInstanceTableTransposesAgainstReference) {
+	RT64::TopLevelASInstanceTable table;
+	float transform[16];
+	makeTransform(transform, 1.0f);
+	table.resize(1);
+	table.setInstance(0, transform, 0x123456, 0xAB, 0x654321, 0x02, 0x1122334455667788ULL);
+
+	// D3D12 takes the upper 3x4 of the column-major matrix, which is the transpose of the first three columns.
+	Desc reference;
+	for (int r = 0; r < 3; r++) {
+		for (int c = 0; c < 4; c++) {
+			reference.transform[r][c] = transform[c * 4 + r];
+		}
+	}
+
+	reference.instanceIDAndMask = 0x123456 | (0xABU << 24);
+	reference.hitGroupIndexAndFlags = 0x654321 | (0x02U << 24);
+	reference.accelerationStructure = 0x1122334455667788ULL;
+
+	const Desc &desc = table.getDescs()[0];
+	CHECK(memcmp(&desc, &reference, DescSize) == 0);
+
+	// Spot checks against the layout written out by hand: the translation ends up in the last column.
+	CHECK(desc.transform[0][0] == 1.0f);
+	CHECK(desc.transform[0][1] == 5.0f);
+	CHECK(desc.transform[1][0] == 2.0f);
+	CHECK(desc.transform[0][3] == 13.0f);
+	CHECK(desc.transform[1][3] == 14.0f);
+	CHECK(desc.transform[2][3] == 15.0f);
+
+	Buffer buffer(1);
+	CHECK(table.upload(buffer.descs.data()) == DescSize);
+	CHECK(memcmp(&buffer.descs[0], &reference, DescSize) == 0);
+}
+
+#endif
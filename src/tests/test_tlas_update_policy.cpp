@@ -0,0 +1,177 @@
+//
+// RT64 TESTS
+//
+
+#include "tests.h"
+
+#ifndef RT64_MINIMAL
+
+#include "rt64_tlas_update_policy.h"
+
+#include <utility>
+#include <vector>
+
+namespace {
+	typedef RT64::TopLevelASUpdatePolicy::Decision Decision;
+
+	// Transforms are read with a stride, so they're stored with other data in between like the view's instances do.
+	struct FakeInstance {
+		float transform[16];
+		uint32_t flags;
+	};
+
+	// The policy only compares the bottom level AS by their address, so any distinct addresses work.
+	const void *fakeBottomLevelAS(int index) {
+		static char storage[16];
+		return &storage[index];
+	}
+
+	struct Scene {
+		std::vector<FakeInstance> instances;
+		std::vector<const void *> bottomLevelAS;
+
+		void add(float x, float y, float z, int bottomLevelASIndex) {
+			FakeInstance instance = {};
+			instance.transform[0] = instance.transform[5] = instance.transform[10] = instance.transform[15] = 1.0f;
+			instance.transform[12] = x;
+			instance.transform[13] = y;
+			instance.transform[14] = z;
+			instances.push_back(instance);
+			bottomLevelAS.push_back(fakeBottomLevelAS(bottomLevelASIndex));
+		}
+
+		void move(size_t index, float dx, float dy, float dz) {
+			instances[index].transform[12] += dx;
+			instances[index].transform[13] += dy;
+			instances[index].transform[14] += dz;
+		}
+
+		Decision decide(RT64::TopLevelASUpdatePolicy &policy) const {
+			return policy.decide(bottomLevelAS.data(), instances.empty() ? nullptr : instances[0].transform, sizeof(FakeInstance), instances.size());
+		}
+	};
+
+	// Two instances 100 units apart, so the default ratio allows them to move 10 units.
+	Scene twoInstanceScene() {
+		Scene scene;
+		scene.add(0.0f, 0.0f, 0.0f, 0);
+		scene.add(100.0f, 0.0f, 0.0f, 1);
+		return scene;
+	}
+};
+
+TEST(TopLevelASUpdatePolicyBuildsFirst) {
+	RT64::TopLevelASUpdatePolicy policy;
+	Scene scene = twoInstanceScene();
+	CHECK(scene.decide(policy) == Decision::Build);
+	CHECK(policy.getRefitCount() == 0);
+	CHECK(scene.decide(policy) == Decision::Refit);
+	CHECK(scene.decide(policy) == Decision::Refit);
+	CHECK(policy.getRefitCount() == 2);
+}
+
+TEST(TopLevelASUpdatePolicyBuildsWhenBottomLevelASChange) {
+	RT64::TopLevelASUpdatePolicy policy;
+	Scene scene = twoInstanceScene();
+	scene.decide(policy);
+
+	// A different bottom level AS.
+	scene.bottomLevelAS[1] = fakeBottomLevelAS(2);
+	CHECK(scene.decide(policy) == Decision::Build);
+	CHECK(scene.decide(policy) == Decision::Refit);
+
+	// The same ones in a different order.
+	std::swap(scene.bottomLevelAS[0], scene.bottomLevelAS[1]);
+	CHECK(scene.decide(policy) == Decision::Build);
+
+	// A different amount of instances.
+	scene.add(50.0f, 0.0f, 0.0f, 3);
+	CHECK(scene.decide(policy) == Decision::Build);
+	scene.instances.pop_back();
+	scene.bottomLevelAS.pop_back();
+	CHECK(scene.decide(policy) == Decision::Build);
+	CHECK(policy.getRefitCount() == 0);
+}
+
+TEST(TopLevelASUpdatePolicyBuildsAfterMaxRefits) {
+	RT64::TopLevelASUpdatePolicy policy;
+	policy.setLimits(3, RT64::TopLevelASUpdatePolicy::DefaultMaxDisplacementRatio);
+	Scene scene = twoInstanceScene();
+	CHECK(scene.decide(policy) == Decision::Build);
+	CHECK(scene.decide(policy) == Decision::Refit);
+	CHECK(scene.decide(policy) == Decision::Refit);
+	CHECK(scene.decide(policy) == Decision::Refit);
+	CHECK(policy.getRefitCount() == 3);
+	CHECK(scene.decide(policy) == Decision::Build);
+	CHECK(policy.getRefitCount() == 0);
+	CHECK(scene.decide(policy) == Decision::Refit);
+
+	// Without any refits, every update is a build.
+	policy.setLimits(0, RT64::TopLevelASUpdatePolicy::DefaultMaxDisplacementRatio);
+	CHECK(scene.decide(policy) == Decision::Build);
+	CHECK(scene.decide(policy) == Decision::Build);
+}
+
+TEST(TopLevelASUpdatePolicyBuildsAfterLargeDisplacement) {
+	RT64::TopLevelASUpdatePolicy policy;
+	Scene scene = twoInstanceScene();
+	scene.decide(policy);
+
+	scene.move(0, 0.0f, 9.0f, 0.0f);
+	CHECK(scene.decide(policy) == Decision::Refit);
+	scene.move(0, 0.0f, 2.0f, 0.0f);
+	CHECK(scene.decide(policy) == Decision::Build);
+
+	// The displacement is measured from the positions of the last build, not the previous update, so small steps
+	// add up until a build is needed.
+	int refits = 0;
+	while (scene.decide(policy) == Decision::Refit) {
+		scene.move(1, 0.0f, 0.0f, 1.5f);
+		refits++;
+	}
+
+	CHECK(refits == 7);
+}
+
+TEST(TopLevelASUpdatePolicyDisplacementRatio) {
+	RT64::TopLevelASUpdatePolicy policy;
+	policy.setLimits(RT64::TopLevelASUpdatePolicy::DefaultMaxRefitCount, 0.5f);
+	Scene scene = twoInstanceScene();
+	scene.decide(policy);
+	scene.move(1, -30.0f, 30.0f, 0.0f);
+	CHECK(scene.decide(policy) == Decision::Refit);
+	scene.move(1, 0.0f, 20.0f, 0.0f);
+	CHECK(scene.decide(policy) == Decision::Build);
+}
+
+TEST(TopLevelASUpdatePolicyWithoutExtent) {
+	// A single instance covers no area, so it can only be refitted while it doesn't move at all.
+	RT64::TopLevelASUpdatePolicy policy;
+	Scene scene;
+	scene.add(5.0f, 5.0f, 5.0f, 0);
+	CHECK(scene.decide(policy) == Decision::Build);
+	CHECK(scene.decide(policy) == Decision::Refit);
+	scene.move(0, 0.001f, 0.0f, 0.0f);
+	CHECK(scene.decide(policy) == Decision::Build);
+}
+
+TEST(TopLevelASUpdatePolicyInvalidate) {
+	RT64::TopLevelASUpdatePolicy policy;
+	Scene scene = twoInstanceScene();
+	scene.decide(policy);
+	CHECK(scene.decide(policy) == Decision::Refit);
+	policy.invalidate();
+	CHECK(scene.decide(policy) == Decision::Build);
+	CHECK(scene.decide(policy) == Decision::Refit);
+}
+
+TEST(TopLevelASUpdatePolicyEmptyScene) {
+	RT64::TopLevelASUpdatePolicy policy;
+	Scene scene;
+	CHECK(scene.decide(policy) == Decision::Build);
+	CHECK(scene.decide(policy) == Decision::Refit);
+	scene.add(0.0f, 0.0f, 0.0f, 0);
+	CHECK(scene.decide(policy) == Decision::Build);
+}
+
+#endif
@@ -0,0 +1,61 @@
+//
+// RT64 TESTS
+//
+
+#include "tests.h"
+
+#ifndef RT64_MINIMAL
+
+#include "rt64.h"
+#include "rt64_view_update_flags.h"
+
+TEST(ViewUpdateFlagsRebuildUnclassifiedInstances) {
+	CHECK(RT64::updateFlagsFromDirtyFields(0) == RT64::UpdateAll);
+}
+
+TEST(ViewUpdateFlagsRebuildListsForSortingFields) {
+	CHECK(RT64::updateFlagsFromDirtyFields(RT64_INSTANCE_FIELD_MESH) == RT64::UpdateAll);
+	CHECK(RT64::updateFlagsFromDirtyFields(RT64_INSTANCE_FIELD_SHADER) == RT64::UpdateAll);
+	CHECK(RT64::updateFlagsFromDirtyFields(RT64_INSTANCE_FIELD_FLAGS) == RT64::UpdateAll);
+	CHECK(RT64::updateFlagsFromDirtyFields(RT64_INSTANCE_FIELD_ALL) == RT64::UpdateAll);
+}
+
+TEST(ViewUpdateFlagsForTransforms) {
+	CHECK(RT64::updateFlagsFromDirtyFields(RT64_INSTANCE_FIELD_TRANSFORM) == (RT64::UpdateInstances | RT64::UpdateTopLevelAS | RT64::UpdateTransforms));
+
+	// The previous transform is only used for motion vectors, so the top level AS stays as it is.
+	CHECK(RT64::updateFlagsFromDirtyFields(RT64_INSTANCE_FIELD_PREVIOUS_TRANSFORM) == (RT64::UpdateInstances | RT64::UpdateTransforms));
+}
+
+TEST(ViewUpdateFlagsForMaterialsAndTextures) {
+	const unsigned int expectedFlags = RT64::UpdateInstances | RT64::UpdateMaterials;
+	CHECK(RT64::updateFlagsFromDirtyFields(RT64_INSTANCE_FIELD_MATERIAL) == expectedFlags);
+	CHECK(RT64::updateFlagsFromDirtyFields(RT64_INSTANCE_FIELD_DIFFUSE_TEXTURE) == expectedFlags);
+	CHECK(RT64::updateFlagsFromDirtyFields(RT64_INSTANCE_FIELD_NORMAL_TEXTURE) == expectedFlags);
+	CHECK(RT64::updateFlagsFromDirtyFields(RT64_INSTANCE_FIELD_SPECULAR_TEXTURE) == expectedFlags);
+}
+
+TEST(ViewUpdateFlagsForRects) {
+	CHECK(RT64::updateFlagsFromDirtyFields(RT64_INSTANCE_FIELD_SCISSOR_RECT) == RT64::UpdateInstances);
+	CHECK(RT64::updateFlagsFromDirtyFields(RT64_INSTANCE_FIELD_VIEWPORT_RECT) == RT64::UpdateInstances);
+}
+
+TEST(ViewUpdateFlagsCombineFields) {
+	const unsigned int dirtyFields = RT64_INSTANCE_FIELD_TRANSFORM | RT64_INSTANCE_FIELD_MATERIAL | RT64_INSTANCE_FIELD_SCISSOR_RECT;
+	const unsigned int expectedFlags = RT64::UpdateInstances | RT64::UpdateTopLevelAS | RT64::UpdateTransforms | RT64::UpdateMaterials;
+	CHECK(RT64::updateFlagsFromDirtyFields(dirtyFields) == expectedFlags);
+
+	// Nothing that doesn't change the lists touches the shader binding table or the geometry.
+	const unsigned int nonSortingFields = RT64_INSTANCE_FIELD_ALL & ~(RT64_INSTANCE_FIELD_MESH | RT64_INSTANCE_FIELD_SHADER | RT64_INSTANCE_FIELD_FLAGS);
+	CHECK((RT64::updateFlagsFromDirtyFields(nonSortingFields) & (RT64::UpdateShaderBindingTable | RT64::UpdateGeometry)) == 0);
+}
+
+TEST(ViewUpdateFlagsForMeshChanges) {
+	// Buffers updated in place and refitted bottom level AS keep the instance in the same list.
+	CHECK(RT64::updateFlagsFromMeshChange(false) == (RT64::UpdateTopLevelAS | RT64::UpdateGeometry));
+
+	// Gaining, losing or replacing the bottom level AS can move the instance to a different list.
+	CHECK(RT64::updateFlagsFromMeshChange(true) == RT64::UpdateAll);
+}
+
+#endif
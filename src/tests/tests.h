@@ -0,0 +1,30 @@
+//
+// RT64 TESTS
+//
+
+#pragma once
+
+namespace Tests {
+	typedef void (*Function)();
+
+	// Adds a test to the list run by main. Use the TEST macro instead of creating these directly.
+	struct Registration {
+		Registration(const char *name, Function function);
+	};
+
+	// Marks the running test as failed. Use the CHECK macro instead of calling this directly.
+	void fail(const char *file, int line, const char *expression);
+};
+
+#define TEST(name) \
+	static void name(); \
+	static Tests::Registration name##Registration(#name, name); \
+	static void name()
+
+// Failed checks are reported and the test keeps running, so every failure in a test is shown at once.
+#define CHECK(expression) \
+	do { \
+		if (!(expression)) { \
+			Tests::fail(__FILE__, __LINE__, #expression); \
+		} \
+	} while (0)